@@ -0,0 +1,610 @@
+/***************************************************************************//**
+ * @file ws_br_agent_bench.c
+ * @brief Micro-benchmarks for the Wi-SUN SoC Border Router Agent hot paths
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <systemd/sd-bus.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "bench"
+#include "ws_br_agent_defs.h"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_msg.h"
+#include "ws_br_agent_settings.h"
+#include "ws_br_agent_soc_host.h"
+#include "ws_br_agent_dbus.h"
+#include "ws_br_agent_crc.h"
+#include "ws_br_agent_topo.h"
+#include "ws_br_agent_node_stats.h"
+
+#define HELP_STR \
+"Usage: wisun-br-bridge-agent-bench [--sizes <n,n,...>] \
+[--reps <count>] \
+[--warmup-ms <ms>] \
+[--min-time-ms <ms>] \
+[--cpu <index>|-1] \
+[--filter <name>] \
+[--output <json file>] \
+[--help]\n"
+
+/// Default topology sizes in entries, up to the largest topology a SoC may send
+#define DEFAULT_SIZES_STR "1,10,100,1000,8192"
+
+/// Maximum number of topology sizes
+#define MAX_SIZES 16U
+
+/// Maximum number of repetitions
+#define MAX_REPS 1000U
+
+/// Default number of measured repetitions
+#define DEFAULT_REPS 10U
+
+/// Default warm-up duration in ms
+#define DEFAULT_WARMUP_MS 100U
+
+/// Default minimal repetition duration in ms
+#define DEFAULT_MIN_TIME_MS 20U
+
+/// D-Bus names used for the routing graph message
+#define BENCH_DBUS_NAME "com.silabs.Wisun.SocBorderRouterAgent"
+#define BENCH_DBUS_PATH "/com/silabs/Wisun/SocBorderRouterAgent"
+
+/// @brief Benchmark case
+typedef struct bench_case {
+  /// Case name
+  const char *name;
+  /// True if the case runs across the topology sizes
+  bool sized;
+  /// Work items per iteration when not sized (config lines, log entries)
+  uint32_t items;
+  /// Prepare the inputs for a topology size
+  ws_br_agent_ret_t (*setup)(uint32_t entry_count);
+  /// Run one iteration
+  ws_br_agent_ret_t (*run)(void);
+  /// Release the inputs
+  void (*teardown)(void);
+} bench_case_t;
+
+/// @brief Benchmark inputs
+typedef struct bench_ctx {
+  /// Topology of the current size
+  ws_br_agent_soc_host_topology_t topology;
+  /// Message carrying the topology
+  ws_br_agent_msg_t msg;
+  /// Built TOPOLOGY buffer
+  uint8_t *buf;
+  /// Built TOPOLOGY buffer size
+  size_t buf_size;
+  /// Bus used to create the routing graph messages
+  sd_bus *bus;
+  /// Settings updated by the config parser
+  ws_br_agent_settings_t settings;
+  /// TLV encoded settings
+  uint8_t tlv[WS_BR_AGENT_SETTINGS_TLV_MAX_SIZE];
+  /// Last CRC32C, kept so that the computation is not optimized out
+  uint32_t crc;
+  /// Struct-of-arrays topology, its block reused by each build
+  ws_br_agent_topo_t topo;
+  /// NODE_STATS entries, one per topology entry
+  ws_br_agent_node_stats_entry_t *node_stats;
+} bench_ctx_t;
+
+/// Representative configuration file lines
+static const char * const config_lines[] = {
+  "# Wi-SUN network name. Remember that you can use escape sequences to place\n",
+  "network_name = Wi-SUN\\x20Network\n",
+  "size = SMALL\n",
+  "domain = EU\n",
+  "chan_plan_id = 32\n",
+  "phy_mode_id = 1\n",
+  "\n",
+  "pan_id = 0x1234 # inline comment\n",
+};
+
+static bench_ctx_t ctx = { 0 };
+static uint64_t alloc_count = 0U;
+static uint64_t min_time_ns = DEFAULT_MIN_TIME_MS * 1000000ULL;
+static uint64_t warmup_ns = DEFAULT_WARMUP_MS * 1000000ULL;
+static uint32_t reps = DEFAULT_REPS;
+
+static ws_br_agent_ret_t topology_setup(uint32_t entry_count);
+static void topology_teardown(void);
+static ws_br_agent_ret_t bench_msg_build_buf(void);
+static ws_br_agent_ret_t bench_msg_parse_buf(void);
+static ws_br_agent_ret_t bench_copy_topology(void);
+static ws_br_agent_ret_t bench_set_topology(void);
+static ws_br_agent_ret_t bench_dbus_routing_graph(void);
+static ws_br_agent_ret_t bench_parse_config_line(void);
+static ws_br_agent_ret_t bench_settings_tlv(void);
+static ws_br_agent_ret_t bench_crc32c(void);
+static ws_br_agent_ret_t bench_topo_build(void);
+static ws_br_agent_ret_t bench_node_stats(void);
+static ws_br_agent_ret_t bench_log_filtered(void);
+static ws_br_agent_ret_t bench_log_file(void);
+static ws_br_agent_ret_t run_case(FILE *out, const bench_case_t * const bench, uint32_t entry_count,
+                                  bool first);
+
+// Heap allocations of the agent code, counted through the linker --wrap option
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+char *__real_strdup(const char *s);
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t nmemb, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+char *__wrap_strdup(const char *s);
+
+static const bench_case_t bench_cases[] = {
+  { "msg_build_buf", true, 0U, topology_setup, bench_msg_build_buf, topology_teardown },
+  { "msg_parse_buf", true, 0U, topology_setup, bench_msg_parse_buf, topology_teardown },
+  { "copy_topology", true, 0U, topology_setup, bench_copy_topology, topology_teardown },
+  { "set_topology", true, 0U, topology_setup, bench_set_topology, topology_teardown },
+  { "dbus_routing_graph", true, 0U, topology_setup, bench_dbus_routing_graph, topology_teardown },
+  { "crc32c", true, 0U, topology_setup, bench_crc32c, topology_teardown },
+  { "topo_build", true, 0U, topology_setup, bench_topo_build, topology_teardown },
+  { "node_stats", true, 0U, topology_setup, bench_node_stats, topology_teardown },
+  { "parse_config_line", false, sizeof(config_lines) / sizeof(config_lines[0]), NULL,
+    bench_parse_config_line, NULL },
+  { "settings_tlv", false, 1U, NULL, bench_settings_tlv, NULL },
+  { "log_filtered", false, 1U, NULL, bench_log_filtered, NULL },
+  { "log_file", false, 1U, NULL, bench_log_file, NULL },
+};
+
+int main(int argc, char *argv[])
+{
+  const char *sizes_str = DEFAULT_SIZES_STR;
+  const char *filter = NULL;
+  const char *output_path = NULL;
+  uint32_t sizes[MAX_SIZES] = { 0U };
+  size_t size_count = 0U;
+  char *sizes_dup = NULL;
+  char *token = NULL;
+  char *saveptr = NULL;
+  int cpu = -2;
+  int fds[2] = { -1, -1 };
+  cpu_set_t cpu_set;
+  bool first = true;
+  FILE *out = stdout;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--sizes") && (i + 1 < argc)) {
+      sizes_str = argv[++i];
+    } else if (!strcmp(argv[i], "--reps") && (i + 1 < argc)) {
+      reps = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--warmup-ms") && (i + 1 < argc)) {
+      warmup_ns = strtoull(argv[++i], NULL, 0) * 1000000ULL;
+    } else if (!strcmp(argv[i], "--min-time-ms") && (i + 1 < argc)) {
+      min_time_ns = strtoull(argv[++i], NULL, 0) * 1000000ULL;
+    } else if (!strcmp(argv[i], "--cpu") && (i + 1 < argc)) {
+      cpu = (int)strtol(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--filter") && (i + 1 < argc)) {
+      filter = argv[++i];
+    } else if (!strcmp(argv[i], "--output") && (i + 1 < argc)) {
+      output_path = argv[++i];
+    } else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+      printf(HELP_STR);
+      return EXIT_SUCCESS;
+    } else {
+      printf("Unknown argument: %s\n", argv[i]);
+      printf(HELP_STR);
+      return EXIT_FAILURE;
+    }
+  }
+
+  sizes_dup = strdup(sizes_str);
+  if (sizes_dup == NULL) {
+    return EXIT_FAILURE;
+  }
+  for (token = strtok_r(sizes_dup, ",", &saveptr); token != NULL && size_count < MAX_SIZES;
+       token = strtok_r(NULL, ",", &saveptr)) {
+    sizes[size_count] = (uint32_t)strtoul(token, NULL, 0);
+    if (!sizes[size_count] || sizes[size_count] > WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES) {
+      break;
+    }
+    size_count++;
+  }
+  free(sizes_dup);
+  if (!size_count || token != NULL || !reps || reps > MAX_REPS || !min_time_ns) {
+    printf("Invalid parameters\n");
+    printf(HELP_STR);
+    return EXIT_FAILURE;
+  }
+
+  // Pin to a single CPU so that migrations do not show up in the timings
+  if (cpu == -2) {
+    cpu = sched_getcpu();
+  }
+  if (cpu >= 0) {
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+      fprintf(stderr, "Failed to pin to CPU %d\n", cpu);
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Log benchmarks write to /dev/null, nothing is printed otherwise
+  ws_br_agent_log_file_path = "/dev/null";
+  ws_br_agent_log_sinks = WS_BR_AGENT_LOG_SINK_FILE;
+  if (ws_br_agent_log_init() != WS_BR_AGENT_RET_OK
+      || ws_br_agent_soc_host_init(WS_BR_AGENT_SOC_HOST_MAX_COUNT) != WS_BR_AGENT_RET_OK) {
+    fprintf(stderr, "Init failed\n");
+    return EXIT_FAILURE;
+  }
+  memcpy(&ctx.settings, ws_br_agent_soc_host_get_default_settings(), sizeof(ctx.settings));
+
+  // Messages can be built on a bus that is started on an unconnected socket
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0
+      || sd_bus_new(&ctx.bus) < 0
+      || sd_bus_set_fd(ctx.bus, fds[0], fds[0]) < 0
+      || sd_bus_start(ctx.bus) < 0) {
+    fprintf(stderr, "Failed to set up the D-Bus message factory\n");
+    return EXIT_FAILURE;
+  }
+
+  if (output_path != NULL) {
+    out = fopen(output_path, "w");
+    if (out == NULL) {
+      fprintf(stderr, "Failed to open output file: %s\n", output_path);
+      return EXIT_FAILURE;
+    }
+  }
+
+  fprintf(out, "{\n  \"cpu\": %d,\n  \"reps\": %u,\n  \"warmup_ms\": %llu,\n"
+               "  \"min_time_ms\": %llu,\n  \"results\": [\n",
+          cpu, reps, (unsigned long long)(warmup_ns / 1000000ULL),
+          (unsigned long long)(min_time_ns / 1000000ULL));
+  for (size_t i = 0U; i < sizeof(bench_cases) / sizeof(bench_cases[0]); ++i) {
+    if (filter != NULL && strstr(bench_cases[i].name, filter) == NULL) {
+      continue;
+    }
+    for (size_t j = 0U; j < (bench_cases[i].sized ? size_count : 1U); ++j) {
+      if (run_case(out, &bench_cases[i], bench_cases[i].sized ? sizes[j] : 0U, first)
+          != WS_BR_AGENT_RET_OK) {
+        fprintf(stderr, "Benchmark %s failed\n", bench_cases[i].name);
+        return EXIT_FAILURE;
+      }
+      first = false;
+    }
+  }
+  fprintf(out, "\n  ]\n}\n");
+
+  if (out != stdout) {
+    fclose(out);
+  }
+  // Nothing to flush, the bus never reaches its peer
+  sd_bus_close(ctx.bus);
+  sd_bus_unref(ctx.bus);
+  close(fds[1]);
+  ws_br_agent_log_deinit();
+
+  return EXIT_SUCCESS;
+}
+
+void *__wrap_malloc(size_t size)
+{
+  alloc_count++;
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+  alloc_count++;
+  return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+  alloc_count++;
+  return __real_realloc(ptr, size);
+}
+
+char *__wrap_strdup(const char *s)
+{
+  alloc_count++;
+  return __real_strdup(s);
+}
+
+static uint64_t get_time_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static ws_br_agent_ret_t run_batch(const bench_case_t * const bench, uint64_t iterations,
+                                   uint64_t * const elapsed_ns)
+{
+  uint64_t start_ns = get_time_ns();
+
+  for (uint64_t i = 0U; i < iterations; ++i) {
+    if (bench->run() != WS_BR_AGENT_RET_OK) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+  }
+  *elapsed_ns = get_time_ns() - start_ns;
+  return WS_BR_AGENT_RET_OK;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+  double va = *(const double *)a;
+  double vb = *(const double *)b;
+  return (va > vb) - (va < vb);
+}
+
+static ws_br_agent_ret_t run_case(FILE *out, const bench_case_t * const bench, uint32_t entry_count,
+                                  bool first)
+{
+  double ns_per_op[MAX_REPS];
+  uint64_t iterations = 1U;
+  uint64_t elapsed_ns = 0U;
+  uint64_t start_ns = 0U;
+  double mean = 0.0;
+  double variance = 0.0;
+  double median = 0.0;
+  uint64_t allocs = 0U;
+  uint32_t items = bench->sized ? entry_count : bench->items;
+
+  if (bench->setup != NULL && bench->setup(entry_count) != WS_BR_AGENT_RET_OK) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Warm up caches and allocator, and size a repetition to last at least the minimal time
+  start_ns = get_time_ns();
+  do {
+    if (run_batch(bench, iterations, &elapsed_ns) != WS_BR_AGENT_RET_OK) {
+      goto error;
+    }
+    if (elapsed_ns < min_time_ns) {
+      iterations *= 2U;
+    }
+  } while (elapsed_ns < min_time_ns || get_time_ns() - start_ns < warmup_ns);
+
+  allocs = alloc_count;
+  for (uint32_t i = 0U; i < reps; ++i) {
+    if (run_batch(bench, iterations, &elapsed_ns) != WS_BR_AGENT_RET_OK) {
+      goto error;
+    }
+    ns_per_op[i] = (double)elapsed_ns / (double)iterations;
+    mean += ns_per_op[i];
+  }
+  allocs = alloc_count - allocs;
+  mean /= reps;
+  for (uint32_t i = 0U; i < reps; ++i) {
+    variance += (ns_per_op[i] - mean) * (ns_per_op[i] - mean);
+  }
+  variance /= reps;
+  qsort(ns_per_op, reps, sizeof(double), compare_double);
+  median = reps % 2U ? ns_per_op[reps / 2U]
+                     : (ns_per_op[reps / 2U - 1U] + ns_per_op[reps / 2U]) / 2.0;
+
+  fprintf(out, "%s    { \"name\": \"%s\", \"entries\": %u, \"items\": %u, \"iterations\": %llu, "
+               "\"ns_per_op\": { \"min\": %.1f, \"median\": %.1f, \"mean\": %.1f, "
+               "\"stddev\": %.1f, \"max\": %.1f }, \"items_per_s\": %.0f, \"allocs_per_op\": %.2f }",
+          first ? "" : ",\n", bench->name, entry_count, items, (unsigned long long)iterations,
+          ns_per_op[0], median, mean, sqrt(variance), ns_per_op[reps - 1U],
+          median > 0.0 ? (double)items * 1e9 / median : 0.0,
+          (double)allocs / ((double)iterations * reps));
+
+  if (bench->teardown != NULL) {
+    bench->teardown();
+  }
+  return WS_BR_AGENT_RET_OK;
+
+error:
+  if (bench->teardown != NULL) {
+    bench->teardown();
+  }
+  return WS_BR_AGENT_RET_ERR;
+}
+
+static ws_br_agent_ret_t topology_setup(uint32_t entry_count)
+{
+  ws_br_agent_soc_host_topology_entry_t *entry = NULL;
+
+  ctx.topology.entries = calloc(entry_count, sizeof(ws_br_agent_soc_host_topology_entry_t));
+  if (ctx.topology.entries == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  ctx.topology.entry_count = entry_count;
+  ctx.node_stats = calloc(entry_count, sizeof(ws_br_agent_node_stats_entry_t));
+  if (ctx.node_stats == NULL) {
+    topology_teardown();
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Border Router first, four children per node, a backup parent for every other node
+  for (uint32_t i = 0U; i < entry_count; ++i) {
+    entry = &ctx.topology.entries[i];
+    entry->target[0] = 0xfd;
+    entry->target[1] = 0x12;
+    entry->target[2] = 0x34;
+    entry->target[3] = 0x56;
+    entry->target[12] = (uint8_t)(i >> 24);
+    entry->target[13] = (uint8_t)(i >> 16);
+    entry->target[14] = (uint8_t)(i >> 8);
+    entry->target[15] = (uint8_t)i;
+    if (i) {
+      memcpy(entry->preferred, ctx.topology.entries[(i - 1U) / 4U].target, 16U);
+    }
+    if (i > 1U && i % 2U) {
+      memcpy(entry->backup, ctx.topology.entries[(i - 1U) / 4U - (i > 4U ? 1U : 0U)].target, 16U);
+    }
+    memcpy(ctx.node_stats[i].target, entry->target, 16U);
+    ctx.node_stats[i].rsl_in = (uint8_t)(WS_BR_AGENT_NODE_STATS_RSL_OFFSET - 70 - i % 30U);
+    ctx.node_stats[i].rsl_out = (uint8_t)(WS_BR_AGENT_NODE_STATS_RSL_OFFSET - 72 - i % 30U);
+    ws_br_agent_put_be16(ctx.node_stats[i].etx, (uint16_t)(WS_BR_AGENT_NODE_STATS_ETX_UNIT + i % 128U));
+    ws_br_agent_put_be32(ctx.node_stats[i].last_heard_s, i % 60U);
+  }
+
+  ctx.msg.msg_code = WS_BR_AGENT_MSG_CODE_TOPOLOGY;
+  ctx.msg.payload_len = entry_count * sizeof(ws_br_agent_soc_host_topology_entry_t);
+  ctx.msg.payload = (uint8_t *)ctx.topology.entries;
+  ctx.buf = ws_br_agent_msg_build_buf(&ctx.msg, &ctx.buf_size);
+  if (ctx.buf == NULL) {
+    topology_teardown();
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Host copy for the getters
+  return ws_br_agent_soc_host_set_topology(&ctx.topology, NULL);
+}
+
+static void topology_teardown(void)
+{
+  ws_br_agent_msg_free_buf(ctx.buf);
+  ctx.buf = NULL;
+  ctx.buf_size = 0U;
+  free(ctx.topology.entries);
+  ctx.topology.entries = NULL;
+  ctx.topology.entry_count = 0U;
+  free(ctx.node_stats);
+  ctx.node_stats = NULL;
+  ws_br_agent_topo_free(&ctx.topo);
+}
+
+static ws_br_agent_ret_t bench_msg_build_buf(void)
+{
+  size_t buf_size = 0U;
+  uint8_t *buf = ws_br_agent_msg_build_buf(&ctx.msg, &buf_size);
+
+  if (buf == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  ws_br_agent_msg_free_buf(buf);
+  return WS_BR_AGENT_RET_OK;
+}
+
+static ws_br_agent_ret_t bench_msg_parse_buf(void)
+{
+  ws_br_agent_msg_t *msg = ws_br_agent_msg_parse_buf(ctx.buf, ctx.buf_size);
+
+  if (msg == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  ws_br_agent_msg_free(msg);
+  return WS_BR_AGENT_RET_OK;
+}
+
+static ws_br_agent_ret_t bench_copy_topology(void)
+{
+  ws_br_agent_soc_host_topology_t topology = { 0U, NULL };
+
+  // Copy of the host topology, as done for every RoutingGraph read
+  if (ws_br_agent_soc_host_get_topology(&topology) != WS_BR_AGENT_RET_OK) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  return ws_br_agent_soc_host_free_topology(&topology);
+}
+
+static ws_br_agent_ret_t bench_set_topology(void)
+{
+  // Unchanged topology: copy, full comparison and swap
+  return ws_br_agent_soc_host_set_topology(&ctx.topology, NULL);
+}
+
+static ws_br_agent_ret_t bench_dbus_routing_graph(void)
+{
+  sd_bus_message *reply = NULL;
+  int r = 0;
+
+  r = sd_bus_message_new_method_call(ctx.bus, &reply, BENCH_DBUS_NAME, BENCH_DBUS_PATH,
+                                     "org.freedesktop.DBus.Properties", "Get");
+  if (r >= 0) {
+    r = ws_br_agent_dbus_append_routing_graph(reply, &ctx.topology);
+  }
+  sd_bus_message_unref(reply);
+  return r < 0 ? WS_BR_AGENT_RET_ERR : WS_BR_AGENT_RET_OK;
+}
+
+static ws_br_agent_ret_t bench_parse_config_line(void)
+{
+  for (size_t i = 0U; i < sizeof(config_lines) / sizeof(config_lines[0]); ++i) {
+    if (ws_br_agent_settings_parse_line(config_lines[i], &ctx.settings) != WS_BR_AGENT_RET_OK) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+static ws_br_agent_ret_t bench_settings_tlv(void)
+{
+  size_t len = 0U;
+
+  if (ws_br_agent_settings_tlv_encode(&ctx.settings, NULL, 0U, ctx.tlv, sizeof(ctx.tlv), &len)
+      != WS_BR_AGENT_RET_OK) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  return ws_br_agent_settings_tlv_decode(ctx.tlv, len, &ctx.settings, NULL);
+}
+
+static ws_br_agent_ret_t bench_crc32c(void)
+{
+  // Frame trailer of the TOPOLOGY buffer
+  ctx.crc = ws_br_agent_crc32c(0U, ctx.buf, ctx.buf_size);
+  return WS_BR_AGENT_RET_OK;
+}
+
+static ws_br_agent_ret_t bench_topo_build(void)
+{
+  // Changed TOPOLOGY: prefix interning and parent resolution
+  return ws_br_agent_topo_build(&ctx.topo, &ctx.topology);
+}
+
+static ws_br_agent_ret_t bench_node_stats(void)
+{
+  uint32_t unknown = 0U;
+
+  // NODE_STATS refresh of every node, in topology order
+  return ws_br_agent_soc_host_shard_set_node_stats(0U, ctx.node_stats, ctx.topology.entry_count, &unknown);
+}
+
+static ws_br_agent_ret_t bench_log_filtered(void)
+{
+  // Lock and sink checks only
+  ws_br_agent_log_sinks = 0U;
+  ws_br_agent_log_info("Topology updated: %u entries\n", ctx.topology.entry_count);
+  ws_br_agent_log_sinks = WS_BR_AGENT_LOG_SINK_FILE;
+  return WS_BR_AGENT_RET_OK;
+}
+
+static ws_br_agent_ret_t bench_log_file(void)
+{
+  ws_br_agent_log_info("Topology updated: %u entries\n", ctx.topology.entry_count);
+  return WS_BR_AGENT_RET_OK;
+}
@@ -0,0 +1,100 @@
+/***************************************************************************//**
+ * @file ws_br_agent_addr.h
+ * @brief Vectorized IPv6 address kernels over topology entry arrays
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#ifndef WS_BR_AGENT_ADDR_H
+#define WS_BR_AGENT_ADDR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ws_br_agent_soc_host.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Address size in bytes
+#define WS_BR_AGENT_ADDR_SIZE 16U
+
+/// Prefix size in bytes (/64)
+#define WS_BR_AGENT_ADDR_PREFIX_SIZE 8U
+
+/// Number of 64-bit words of a bitmap over count entries
+#define WS_BR_AGENT_ADDR_BITMAP_WORDS(count) (((count) + 63U) / 64U)
+
+/// @brief Address of a topology entry
+typedef enum ws_br_agent_addr_field {
+  /// Routed node
+  WS_BR_AGENT_ADDR_FIELD_TARGET = 0,
+  /// Preferred parent
+  WS_BR_AGENT_ADDR_FIELD_PREFERRED,
+  /// Backup parent
+  WS_BR_AGENT_ADDR_FIELD_BACKUP,
+} ws_br_agent_addr_field_t;
+
+/**
+ * @brief Test a single address for the unspecified address (::).
+ * @param[in] addr Address, no alignment required.
+ * @return true if all the bytes are zero.
+ */
+static inline bool ws_br_agent_addr_is_zero(const uint8_t addr[WS_BR_AGENT_ADDR_SIZE])
+{
+  uint64_t w[2];
+
+  memcpy(w, addr, sizeof(w));
+  return !(w[0] | w[1]);
+}
+
+/**
+ * @brief Zero-test an address of each entry.
+ * @param[in] entries Topology entries.
+ * @param[in] count Number of entries.
+ * @param[in] field Address tested.
+ * @param[out] bitmap Bit i set if the address of entry i is zero, 
+ *                    WS_BR_AGENT_ADDR_BITMAP_WORDS(count) words.
+ * @return Number of zero addresses.
+ */
+size_t ws_br_agent_addr_zero_bitmap(const ws_br_agent_soc_host_topology_entry_t *entries, size_t count,
+                                    ws_br_agent_addr_field_t field, uint64_t *bitmap);
+
+/**
+ * @brief Get the name of the kernels in use, picked on first use from the CPU features.
+ * @return "avx2", "sse2", "neon" or "scalar".
+ */
+const char *ws_br_agent_addr_impl(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_ADDR_H
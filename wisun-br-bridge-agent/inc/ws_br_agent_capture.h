@@ -0,0 +1,158 @@
+/***************************************************************************//**
+ * @file ws_br_agent_capture.h
+ * @brief Protocol capture for Wi-SUN SoC Border Router Agent
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef WS_BR_AGENT_CAPTURE_H
+#define WS_BR_AGENT_CAPTURE_H
+
+#include <stdio.h>
+#include <netinet/in.h>
+
+#include "ws_br_agent_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// pcapng link type used for agent frames (LINKTYPE_USER0)
+#define WS_BR_AGENT_CAPTURE_LINKTYPE 147U
+
+/// Size of the pseudo header prepended to each captured frame
+#define WS_BR_AGENT_CAPTURE_PSEUDO_HDR_SIZE 20U
+
+/// Maximum number of interfaces tracked by a reader
+#define WS_BR_AGENT_CAPTURE_MAX_IF_COUNT 8U
+
+/// Capture record direction, values match pcapng epb_flags inbound/outbound bits
+typedef enum ws_br_agent_capture_dir {
+  /// Frame received by the agent
+  WS_BR_AGENT_CAPTURE_DIR_IN = 1,
+  /// Frame sent by the agent
+  WS_BR_AGENT_CAPTURE_DIR_OUT = 2,
+} ws_br_agent_capture_dir_t;
+
+/// Capture record channel
+typedef enum ws_br_agent_capture_channel {
+  /// Agent service connection (port 11500)
+  WS_BR_AGENT_CAPTURE_CHANNEL_SRV = 0,
+  /// SoC connection (port 11501)
+  WS_BR_AGENT_CAPTURE_CHANNEL_SOC = 1,
+} ws_br_agent_capture_channel_t;
+
+/// @brief Capture record
+typedef struct ws_br_agent_capture_record {
+  /// Wall clock timestamp in microseconds
+  uint64_t timestamp_us;
+  /// Direction
+  ws_br_agent_capture_dir_t dir;
+  /// Channel
+  ws_br_agent_capture_channel_t channel;
+  /// Peer address
+  struct in6_addr peer_addr;
+  /// Peer port
+  uint16_t peer_port;
+  /// Frame data (owned by the reader, valid until the next read)
+  const uint8_t *data;
+  /// Frame length
+  size_t len;
+} ws_br_agent_capture_record_t;
+
+/// @brief Capture file reader
+typedef struct ws_br_agent_capture_reader {
+  /// Capture file
+  FILE *file;
+  /// Block buffer
+  uint8_t *buf;
+  /// Block buffer size
+  size_t buf_size;
+  /// Link type of each interface of the current section
+  uint16_t if_linktypes[WS_BR_AGENT_CAPTURE_MAX_IF_COUNT];
+  /// Number of interfaces of the current section
+  uint32_t if_count;
+  /// Section byte order differs from host byte order
+  bool swapped;
+  /// End of file reached
+  bool eof;
+} ws_br_agent_capture_reader_t;
+
+/**
+ * @brief Start capturing agent traffic to a pcapng file.
+ * @param[in] path Capture file path (truncated if it exists).
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_capture_open(const char *path);
+
+/**
+ * @brief Stop capturing and close the capture file.
+ */
+void ws_br_agent_capture_close(void);
+
+/**
+ * @brief Record a frame if capture is enabled.
+ * @param[in] dir Frame direction
+ * @param[in] channel Channel the frame was exchanged on
+ * @param[in] peer Peer address
+ * @param[in] buf Frame data
+ * @param[in] len Frame length
+ */
+void ws_br_agent_capture_record(ws_br_agent_capture_dir_t dir,
+                                ws_br_agent_capture_channel_t channel,
+                                const struct sockaddr_in6 * const peer,
+                                const uint8_t * const buf, size_t len);
+
+/**
+ * @brief Open a capture file for reading.
+ * @param[out] reader Reader to initialize
+ * @param[in] path Capture file path
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_capture_reader_open(ws_br_agent_capture_reader_t * const reader,
+                                                  const char *path);
+
+/**
+ * @brief Read the next agent frame record.
+ * @details Blocks that are not agent frames are skipped.
+ * @param[in,out] reader Capture reader
+ * @param[out] record Record to fill
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise (reader->eof is set at end of file).
+ */
+ws_br_agent_ret_t ws_br_agent_capture_reader_next(ws_br_agent_capture_reader_t * const reader,
+                                                  ws_br_agent_capture_record_t * const record);
+
+/**
+ * @brief Close a capture reader.
+ * @param[in,out] reader Capture reader
+ */
+void ws_br_agent_capture_reader_close(ws_br_agent_capture_reader_t * const reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_CAPTURE_H
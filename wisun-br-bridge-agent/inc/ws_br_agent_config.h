@@ -0,0 +1,69 @@
+/***************************************************************************//**
+ * @file ws_br_agent_config.h
+ * @brief Configuration file loading and hot reload
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#ifndef WS_BR_AGENT_CONFIG_H
+#define WS_BR_AGENT_CONFIG_H
+
+#include "ws_br_agent_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Load the configuration file into the primary SoC settings and watch it for changes.
+ * @details The file is reloaded when it is written or replaced (inotify on its directory) and
+ *          on SIGHUP. Must be called after the SoC host, state and event loop modules init.
+ * @param[in] path Configuration file path, NULL to disable.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_config_init(const char *path);
+
+/**
+ * @brief Stop watching the configuration file.
+ */
+void ws_br_agent_config_deinit(void);
+
+/**
+ * @brief Reload the configuration file and apply the fields that changed.
+ * @details The whole file is validated first, a file with an invalid line is rejected. Changed
+ *          fields are applied to the primary SoC settings, announced by one PropertiesChanged
+ *          signal with the changed properties only, and pushed to the SoC if any of them is used
+ *          by its PHY configuration type. Keys removed from the file keep their current value.
+ * @return WS_BR_AGENT_RET_OK if the file is valid (changed or not), error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_config_reload(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_CONFIG_H
@@ -0,0 +1,63 @@
+/***************************************************************************//**
+ * @file ws_br_agent_crc.h
+ * @brief CRC32C frame checksum
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+
+#ifndef WS_BR_AGENT_CRC_H
+#define WS_BR_AGENT_CRC_H
+
+#include "ws_br_agent_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Compute a CRC32C (Castagnoli), or continue a running one.
+ * @details Uses the SSE4.2 or ARMv8 CRC32 instructions when the CPU has them,
+ *          a slicing-by-8 table otherwise. The implementation is picked on first use.
+ * @param[in] crc CRC of the previous data, 0 for the first block.
+ * @param[in] buf Data, no alignment required.
+ * @param[in] len Data length.
+ * @return CRC32C of all the data so far.
+ */
+uint32_t ws_br_agent_crc32c(uint32_t crc, const void *buf, size_t len);
+
+/**
+ * @brief Get the name of the CRC32C implementation in use.
+ * @return "sse4.2", "armv8" or "table".
+ */
+const char *ws_br_agent_crc32c_impl(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_CRC_H
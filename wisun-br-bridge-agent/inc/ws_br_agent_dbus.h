@@ -32,7 +32,10 @@
 #define WS_BR_AGENT_DBUS_H
 
 #include <pthread.h>
+#include <systemd/sd-bus.h>
 #include "ws_br_agent_defs.h"
+#include "ws_br_agent_soc_host.h"
+#include "ws_br_agent_trace.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -52,18 +55,68 @@ ws_br_agent_ret_t ws_br_agent_dbus_init(void);
 void ws_br_agent_dbus_deinit(void);
 
 /**
- * @brief Notify D-Bus clients that the topology has changed.
+ * @brief Notify D-Bus clients that the topology of a SoC has changed.
  * @details This function emits a signal indicating that the RoutingGraph property has changed.
+ *          With a trace, the RoutingGraphTrace property (trace ID, monotonic receive time)
+ *          is updated and carried by the same signal. The signal is emitted on the SoC object,
+ *          and on the root object for the primary SoC.
+ * @param[in] shard SoC host shard index.
+ * @param[in] trace Optional update trace. Can be NULL.
  * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
  */
-ws_br_agent_ret_t ws_br_agent_dbus_notify_topology_changed(void);
+ws_br_agent_ret_t ws_br_agent_dbus_notify_topology_changed(size_t shard,
+                                                           const ws_br_agent_trace_t * const trace);
 
 /**
- * @brief Notify D-Bus clients that the settings have changed.
+ * @brief Notify D-Bus clients that the settings of a SoC have changed.
  * @details This function emits signals for each of settings property that has changed.
+ *          With a trace, the SettingsTrace property (trace ID, monotonic receive time)
+ *          is updated and carried by the same signal.
+ * @param[in] shard SoC host shard index.
+ * @param[in] trace Optional update trace. Can be NULL.
  * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
  */
-ws_br_agent_ret_t ws_br_agent_dbus_notify_settings_changed(void);
+ws_br_agent_ret_t ws_br_agent_dbus_notify_settings_changed(size_t shard,
+                                                           const ws_br_agent_trace_t * const trace);
+
+/**
+ * @brief Notify D-Bus clients that some settings fields of a SoC have changed.
+ * @details One signal carries the properties of the changed fields only. A PHY configuration
+ *          type change announces every settings property. Fields without a property are not
+ *          announced.
+ * @param[in] shard SoC host shard index.
+ * @param[in] fields Changed fields.
+ * @param[in] count Number of changed fields.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_dbus_notify_settings_fields_changed(size_t shard,
+                                                                  const ws_br_agent_settings_field_t * const fields[],
+                                                                  size_t count);
+
+/**
+ * @brief Notify D-Bus clients that the Stale property of a SoC has changed.
+ * @param[in] shard SoC host shard index.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_dbus_notify_stale_changed(size_t shard);
+
+/**
+ * @brief Announce the object of a new SoC (ObjectManager InterfacesAdded).
+ * @param[in] shard SoC host shard index.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_dbus_notify_soc_added(size_t shard);
+
+/**
+ * @brief Append a topology to a D-Bus message as a RoutingGraph value.
+ * @details The value has the a(aybaay) signature: target address, external flag
+ *          and parent addresses (none for the Border Router, preferred then backup otherwise).
+ * @param[in] reply Message to append to.
+ * @param[in] topology Topology to serialize.
+ * @return Non-negative on success, negative errno-style error otherwise.
+ */
+int ws_br_agent_dbus_append_routing_graph(sd_bus_message *reply,
+                                          const ws_br_agent_soc_host_topology_t * const topology);
 
 #if defined(__cplusplus)
 }
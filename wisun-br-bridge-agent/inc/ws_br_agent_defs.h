@@ -71,6 +71,14 @@ typedef int32_t ws_br_agent_ret_t;
 /// Size of the request/response buffer
 #define WS_BR_AGENT_MAX_BUF_SIZE 2048U
 
+/// Maximum number of entries in a TOPOLOGY message
+#define WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES 8192U
+
+/// Maximum number of SoCs served by one agent, each in its own shard
+#ifndef WS_BR_AGENT_SOC_HOST_MAX_COUNT
+#define WS_BR_AGENT_SOC_HOST_MAX_COUNT 16U
+#endif
+
 /// Maximum size of the IPv6 address string
 #define WS_BR_AGENT_IPV6_ADDR_STR_SIZE 40U
 
@@ -86,6 +94,34 @@ typedef int32_t ws_br_agent_ret_t;
 /// Size of the channel mask
 #define WS_BR_AGENT_CHANNEL_MASK_SIZE 32U
 
+/// Read a big endian 16-bit value, the buffer needs no alignment
+static inline uint16_t ws_br_agent_get_be16(const uint8_t * const buf)
+{
+  return (uint16_t)((buf[0] << 8) | buf[1]);
+}
+
+/// Read a big endian 32-bit value, the buffer needs no alignment
+static inline uint32_t ws_br_agent_get_be32(const uint8_t * const buf)
+{
+  return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) | ((uint32_t)buf[2] << 8) | buf[3];
+}
+
+/// Write a big endian 16-bit value, the buffer needs no alignment
+static inline void ws_br_agent_put_be16(uint8_t * const buf, uint16_t val)
+{
+  buf[0] = (uint8_t)(val >> 8);
+  buf[1] = (uint8_t)val;
+}
+
+/// Write a big endian 32-bit value, the buffer needs no alignment
+static inline void ws_br_agent_put_be32(uint8_t * const buf, uint32_t val)
+{
+  buf[0] = (uint8_t)(val >> 24);
+  buf[1] = (uint8_t)(val >> 16);
+  buf[2] = (uint8_t)(val >> 8);
+  buf[3] = (uint8_t)val;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,79 @@
+/***************************************************************************//**
+ * @file ws_br_agent_event.h
+ * @brief Wi-SUN SoC Border Router Agent single-threaded event loop
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#ifndef WS_BR_AGENT_EVENT_H
+#define WS_BR_AGENT_EVENT_H
+
+#include <systemd/sd-event.h>
+
+#include "ws_br_agent_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create the agent event loop.
+ * @details Once created, the server, D-Bus, metrics and SoC request modules run as sources
+ *          of this loop instead of their own threads: their init functions must be called after
+ *          this one. SIGINT and SIGTERM exit the loop.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_event_init(void);
+
+/**
+ * @brief Release the event loop.
+ * @details The modules must have removed their sources (deinitialized) before.
+ */
+void ws_br_agent_event_deinit(void);
+
+/**
+ * @brief Get the agent event loop.
+ * @return Event loop, or NULL if the agent runs its modules in threads.
+ */
+sd_event *ws_br_agent_event_get(void);
+
+/**
+ * @brief Run the event loop until ws_br_agent_event_exit() or a termination signal.
+ * @return WS_BR_AGENT_RET_OK on a normal exit, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_event_run(void);
+
+/**
+ * @brief Request the event loop to exit.
+ */
+void ws_br_agent_event_exit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_EVENT_H
@@ -0,0 +1,134 @@
+/***************************************************************************//**
+ * @file ws_br_agent_history.h
+ * @brief Bounded topology history: keyframes and deltas in a ring
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+
+#ifndef WS_BR_AGENT_HISTORY_H
+#define WS_BR_AGENT_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <netinet/in.h>
+
+#include "ws_br_agent_defs.h"
+#include "ws_br_agent_soc_host.h"
+#include "ws_br_agent_topo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Default history ring size in bytes
+#ifndef WS_BR_AGENT_HISTORY_SIZE
+#define WS_BR_AGENT_HISTORY_SIZE (4U * 1024U * 1024U)
+#endif
+
+/// Smallest history ring size in bytes
+#define WS_BR_AGENT_HISTORY_MIN_SIZE (64U * 1024U)
+
+/// History file format version, bumped on any layout change
+#define WS_BR_AGENT_HISTORY_VERSION 2U
+
+/**
+ * @brief Node history callback, called for each recorded change of a node.
+ * @param[in] ctx User context.
+ * @param[in] time_us Time the topology version was received (us since the Epoch).
+ * @param[in] entry Entry of the node in this version, NULL if the node is absent.
+ * @return 0 to continue, negative to stop.
+ */
+typedef int (*ws_br_agent_history_node_cb_t)(void *ctx, uint64_t time_us,
+                                              const ws_br_agent_soc_host_topology_entry_t *entry);
+
+/**
+ * @brief Initialize the topology history ring.
+ * @details The ring is an anonymous mapping, or a shared mapping of the history file,
+ *          whose records are kept across restarts if the file matches the size and format.
+ *          The mapping is accounted in the memory budget (WS_BR_AGENT_MEM_SUBSYS_HISTORY),
+ *          so ws_br_agent_mem_init() must be called first.
+ * @param[in] size Ring size in bytes, 0 disables the history.
+ * @param[in] path History file path, NULL for an anonymous mapping.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_history_init(size_t size, const char *path);
+
+/**
+ * @brief Release the history ring (the history file keeps its records).
+ */
+void ws_br_agent_history_deinit(void);
+
+/**
+ * @brief Record a new topology version of a SoC.
+ * @details Recorded as the entries changed from the previous version, or as a full keyframe
+ *          when there is no usable keyframe or the deltas since the last one would outweigh it.
+ *          Versions are keyed by SoC address and ordered by a sequence number and CLOCK_MONOTONIC,
+ *          the wall clock time is kept for display. The oldest records are overwritten.
+ * @param[in] shard SoC shard index.
+ * @param[in] soc SoC address.
+ * @param[in] prev Previous topology of the shard (last recorded version).
+ * @param[in] topology New topology.
+ */
+void ws_br_agent_history_record(size_t shard, const struct in6_addr * const soc,
+                                const ws_br_agent_topo_t * const prev,
+                                const ws_br_agent_soc_host_topology_t * const topology);
+
+/**
+ * @brief Reconstruct the topology of a SoC at a given time.
+ * @details Decoded outside of the recording lock: recording is not held by the queries.
+ * @param[in] soc SoC address.
+ * @param[in] time_us Time (us since the Epoch), mapped on the version order by the current
+ *                    offset between the wall clock and CLOCK_MONOTONIC.
+ * @param[in,out] topology Topology in force at that time, its entries are reused when large enough.
+ *                         Freed with ws_br_agent_soc_host_free_topology().
+ * @param[out] version_us Time the topology version returned was received (us since the Epoch).
+ * @return WS_BR_AGENT_RET_OK on success, error code if no version is recorded at that time.
+ */
+ws_br_agent_ret_t ws_br_agent_history_get_topology(const struct in6_addr * const soc, uint64_t time_us,
+                                                   ws_br_agent_soc_host_topology_t * const topology,
+                                                   uint64_t * const version_us);
+
+/**
+ * @brief Walk the recorded changes of a node of a SoC, oldest first.
+ * @details Reported from its first appearance, then on each change of its presence or parents.
+ *          Decoded outside of the recording lock.
+ * @param[in] soc SoC address.
+ * @param[in] addr Node target address.
+ * @param[in] cb Callback.
+ * @param[in] ctx Callback context.
+ * @return WS_BR_AGENT_RET_OK on success, error code if the history is disabled, the callback failed
+ *         or the records were overwritten by new versions while reported.
+ */
+ws_br_agent_ret_t ws_br_agent_history_get_node(const struct in6_addr * const soc, const uint8_t addr[16],
+                                               ws_br_agent_history_node_cb_t cb, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_HISTORY_H
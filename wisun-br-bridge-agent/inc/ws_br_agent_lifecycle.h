@@ -0,0 +1,173 @@
+/***************************************************************************//**
+ * @file ws_br_agent_lifecycle.h
+ * @brief Per-node lifecycle tracking
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+
+#ifndef WS_BR_AGENT_LIFECYCLE_H
+#define WS_BR_AGENT_LIFECYCLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ws_br_agent_defs.h"
+#include "ws_br_agent_soc_host.h"
+#include "ws_br_agent_topo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Maximum number of nodes tracked per SoC, the nodes that left included (power of two).
+/// When full, the node absent for the longest time makes room for a new one.
+#ifndef WS_BR_AGENT_LIFECYCLE_MAX_NODES
+#define WS_BR_AGENT_LIFECYCLE_MAX_NODES WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES
+#endif
+
+/// Absence after which a node that left the topology is forgotten (seconds)
+#ifndef WS_BR_AGENT_LIFECYCLE_MAX_ABSENCE_S
+#define WS_BR_AGENT_LIFECYCLE_MAX_ABSENCE_S (7U * 24U * 3600U)
+#endif
+
+/// @brief Lifecycle of a node (topology target)
+typedef struct ws_br_agent_lifecycle_node {
+  /// @brief Target address
+  uint8_t target[16];
+  /// @brief Current (or last known) preferred parent
+  uint8_t parent[16];
+  /// @brief Preferred parent before the last change, zero if none
+  uint8_t prev_parent[16];
+  /// @brief First topology listing the node (us since the Epoch)
+  uint64_t first_seen_us;
+  /// @brief Last topology listing the node (us since the Epoch)
+  uint64_t last_seen_us;
+  /// @brief Preferred parent changes
+  uint32_t reparents;
+  /// @brief Returns after leaving the topology
+  uint32_t flaps;
+  /// @brief Listed by the last topology
+  bool present;
+} ws_br_agent_lifecycle_node_t;
+
+/// @brief Lifecycle table of a SoC.
+/// @details Nodes are indexed by target address in an open addressing table. An update only visits
+///          the entries changed from the previous topology and the targets they replaced. The last seen
+///          time of the present nodes is the last update time, so unchanged nodes are not touched.
+///          The nodes that left are chained in departure order, so that the oldest ones are evicted first.
+///          All the arrays are carved from a single block, sized for WS_BR_AGENT_LIFECYCLE_MAX_NODES
+///          on the first update.
+typedef struct ws_br_agent_lifecycle {
+  /// @brief Nodes, in first seen order until an eviction moves the last node to the freed index
+  ws_br_agent_lifecycle_node_t *nodes;
+  /// @brief Absent node list links of each node (node indexes), UINT32_MAX at the ends
+  uint32_t *prev_gone;
+  uint32_t *next_gone;
+  /// @brief Update mark of each node: listed by a changed entry of the update in progress
+  uint32_t *marks;
+  /// @brief Node index + 1 of each slot, 0 if free
+  uint32_t *slots;
+  /// @brief Changed entry indexes of the update in progress
+  uint32_t *changes;
+  /// @brief Number of nodes
+  uint32_t count;
+  /// @brief Absent nodes, from the longest gone (UINT32_MAX if none)
+  uint32_t first_gone;
+  uint32_t last_gone;
+  /// @brief Current update mark
+  uint32_t mark;
+  /// @brief Last update time (us since the Epoch)
+  uint64_t update_us;
+  /// @brief The table is full of present nodes, new nodes are not tracked
+  bool full;
+} ws_br_agent_lifecycle_t;
+
+/**
+ * @brief Node callback.
+ * @param[in] ctx User context.
+ * @param[in] node Node lifecycle.
+ * @return 0 to continue, negative to stop.
+ */
+typedef int (*ws_br_agent_lifecycle_cb_t)(void *ctx, const ws_br_agent_lifecycle_node_t *node);
+
+/**
+ * @brief Update the lifecycles from a new topology.
+ * @param[in,out] lc Lifecycle table.
+ * @param[in] prev Previous topology (empty on the first update).
+ * @param[in] topology New topology.
+ * @param[in] time_us Update time (us since the Epoch).
+ * @details The nodes absent for more than WS_BR_AGENT_LIFECYCLE_MAX_ABSENCE_S are forgotten.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise (table unchanged).
+ */
+ws_br_agent_ret_t ws_br_agent_lifecycle_update(ws_br_agent_lifecycle_t * const lc,
+                                               const ws_br_agent_topo_t * const prev,
+                                               const ws_br_agent_soc_host_topology_t * const topology,
+                                               uint64_t time_us);
+
+/**
+ * @brief Account a topology identical to the previous one: the present nodes are seen again.
+ * @param[in,out] lc Lifecycle table.
+ * @param[in] time_us Update time (us since the Epoch).
+ */
+static inline void ws_br_agent_lifecycle_touch(ws_br_agent_lifecycle_t * const lc, uint64_t time_us)
+{
+  lc->update_us = time_us;
+}
+
+/**
+ * @brief Get the lifecycle of a node.
+ * @param[in] lc Lifecycle table.
+ * @param[in] addr Target address.
+ * @param[out] node Node lifecycle.
+ * @return WS_BR_AGENT_RET_OK on success, error code if the node was never seen.
+ */
+ws_br_agent_ret_t ws_br_agent_lifecycle_get(const ws_br_agent_lifecycle_t * const lc, const uint8_t addr[16],
+                                            ws_br_agent_lifecycle_node_t * const node);
+
+/**
+ * @brief Walk the lifecycles of all the nodes.
+ * @param[in] lc Lifecycle table.
+ * @param[in] cb Callback.
+ * @param[in] ctx Callback context.
+ * @return WS_BR_AGENT_RET_OK on success, error code if the callback failed.
+ */
+ws_br_agent_ret_t ws_br_agent_lifecycle_foreach(const ws_br_agent_lifecycle_t * const lc,
+                                                ws_br_agent_lifecycle_cb_t cb, void *ctx);
+
+/**
+ * @brief Release a lifecycle table.
+ * @param[in,out] lc Lifecycle table, emptied.
+ */
+void ws_br_agent_lifecycle_free(ws_br_agent_lifecycle_t * const lc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_LIFECYCLE_H
@@ -57,6 +57,45 @@ extern "C" {
 #define WS_BR_AGENT_LOG_ENABLE_FILE_LOG     1U
 #endif
 
+#ifndef WS_BR_AGENT_LOG_ENABLE_JOURNAL_LOG
+#define WS_BR_AGENT_LOG_ENABLE_JOURNAL_LOG  1U
+#endif
+
+/// Subsystem name attached to journal entries, override before including this header
+#ifndef WS_BR_AGENT_LOG_SUBSYSTEM
+#define WS_BR_AGENT_LOG_SUBSYSTEM "main"
+#endif
+
+/// Log sink flags
+#define WS_BR_AGENT_LOG_SINK_CONSOLE  (1U << 0)
+#define WS_BR_AGENT_LOG_SINK_FILE     (1U << 1)
+#define WS_BR_AGENT_LOG_SINK_JOURNAL  (1U << 2)
+
+/// Sink mask is selected at init time (console + file, or journal under systemd)
+#define WS_BR_AGENT_LOG_SINK_AUTO     (0U)
+
+/// Unset structured field value
+#define WS_BR_AGENT_LOG_FIELD_NONE    (-1LL)
+
+/// Initializer for a structured field set with no field set
+#define WS_BR_AGENT_LOG_FIELDS_INIT \
+  { WS_BR_AGENT_LOG_FIELD_NONE, NULL, WS_BR_AGENT_LOG_FIELD_NONE, WS_BR_AGENT_LOG_FIELD_NONE, \
+    WS_BR_AGENT_LOG_FIELD_NONE }
+
+/// @brief Structured fields attached to journal entries
+typedef struct ws_br_agent_log_fields {
+  /// Message code (#WS_BR_AGENT_LOG_FIELD_NONE if not set)
+  int64_t msg_code;
+  /// Peer IPv6 address string (NULL if not set)
+  const char *peer_addr;
+  /// Topology entry count (#WS_BR_AGENT_LOG_FIELD_NONE if not set)
+  int64_t entry_count;
+  /// Latency in microseconds (#WS_BR_AGENT_LOG_FIELD_NONE if not set)
+  int64_t latency_us;
+  /// Update trace ID (#WS_BR_AGENT_LOG_FIELD_NONE if not set)
+  int64_t trace_id;
+} ws_br_agent_log_fields_t;
+
 /// Color definitions for terminal output
 #if WS_BR_AGENT_LOG_ENABLE_COLORS
 #define WS_BR_AGENT_LOG_COLOR_RED     "\x1b[31m"
@@ -82,13 +121,17 @@ extern "C" {
 
 /// Log file path (default: /var/log/wisun-br-bridge-agent.log)
 extern const char *ws_br_agent_log_file_path;
+/// Enabled log sinks (#WS_BR_AGENT_LOG_SINK_AUTO until ws_br_agent_log_init() resolves it)
+extern uint32_t ws_br_agent_log_sinks;
 extern FILE *_log_file;
 extern pthread_mutex_t _log_mutex;
 
 /**
  * @brief Init logging
- * @brief Open the log file for appending (default: /var/log/wisun-br-bridge-agent.log) 
- *        and init logging mutex
+ * @brief Resolve the enabled sinks, open the log file for appending
+ *        (default: /var/log/wisun-br-bridge-agent.log) and init logging mutex
+ * @details With #WS_BR_AGENT_LOG_SINK_AUTO, only the journal sink is used when stdout
+ *          is already connected to journald, console and file sinks otherwise.
  * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
  */
 ws_br_agent_ret_t ws_br_agent_log_init(void);
@@ -99,6 +142,34 @@ ws_br_agent_ret_t ws_br_agent_log_init(void);
  */
 void ws_br_agent_log_deinit(void);
 
+/**
+ * @brief Parse a comma separated sink list ("console,file,journal")
+ * @param[in] str Sink list string
+ * @param[out] sinks Pointer to the resulting sink mask
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_log_parse_sinks(const char *str, uint32_t * const sinks);
+
+/**
+ * @brief Send an entry to the systemd journal (Internal use only)
+ * @param[in] priority Syslog priority
+ * @param[in] subsystem Subsystem name
+ * @param[in] file Source file
+ * @param[in] line Source line
+ * @param[in] func Source function
+ * @param[in] fields Optional structured fields (NULL if none)
+ * @param[in] fmt Message format
+ */
+void _log_print_to_journal(int priority, const char *subsystem,
+                           const char *file, int line, const char *func,
+                           const ws_br_agent_log_fields_t * const fields,
+                           const char *fmt, ...) __attribute__((format(printf, 7, 8)));
+
+/**
+ * @brief Lock the logging mutex and account the wait time (Internal use only)
+ */
+void _log_lock(void);
+
 /**
  * @brief Get current time string (Internal use only)
  * @return Pointer to a static string containing the current time in "YYYY-MM-DD HH:MM:SS" format.
@@ -118,7 +189,8 @@ const char *_log_get_timestr(void);
 #if WS_BR_AGENT_LOG_ENABLE_FILE_LOG
 #define __log_print_to_file(level, fmt, ...)                   \
   do {                                                         \
-    if (_log_file) {                                           \
+    if (_log_file                                              \
+        && (ws_br_agent_log_sinks & WS_BR_AGENT_LOG_SINK_FILE)) { \
       fprintf(_log_file, "%s ", _log_get_timestr());           \
       fprintf(_log_file, "[" level "] " fmt, ##__VA_ARGS__);   \
       fflush(_log_file);                                       \
@@ -135,9 +207,11 @@ const char *_log_get_timestr(void);
 #if WS_BR_AGENT_LOG_ENABLE_CONSOLE_LOG
 #define __log_print_to_console(color, level, fmt, ...)         \
   do {                                                         \
-    fprintf(stdout, color "[" level "] " fmt                   \
-            WS_BR_AGENT_LOG_COLOR_RESET, ##__VA_ARGS__);       \
-    fflush(stdout);                                            \
+    if (ws_br_agent_log_sinks & WS_BR_AGENT_LOG_SINK_CONSOLE) { \
+      fprintf(stdout, color "[" level "] " fmt                 \
+              WS_BR_AGENT_LOG_COLOR_RESET, ##__VA_ARGS__);     \
+      fflush(stdout);                                          \
+    }                                                          \
   } while (0)
 #else 
 #define __log_print_to_console(color, level, fmt, ...)         \
@@ -147,46 +221,69 @@ const char *_log_get_timestr(void);
 
 #endif
 
-/// @brief Info log printer
-#define ws_br_agent_log_info(fmt, ...)                         \
+/// @brief Log printer to systemd journal (internal use only)
+#if WS_BR_AGENT_LOG_ENABLE_JOURNAL_LOG
+#define __log_print_to_journal(priority, fields, fmt, ...)     \
+  do {                                                         \
+    if (ws_br_agent_log_sinks & WS_BR_AGENT_LOG_SINK_JOURNAL) { \
+      _log_print_to_journal(priority, WS_BR_AGENT_LOG_SUBSYSTEM, \
+                            __FILE__, __LINE__, __func__,      \
+                            fields, fmt, ##__VA_ARGS__);       \
+    }                                                          \
+  } while (0)
+#else
+#define __log_print_to_journal(priority, fields, fmt, ...)     \
+  do {                                                         \
+    (void)priority; (void)(fields); (void)fmt;                 \
+    (void)#__VA_ARGS__;                                        \
+  } while (0)
+#endif
+
+/// @brief Log printer to all enabled sinks (internal use only)
+#define __log_print(color, level, priority, fields, fmt, ...)  \
 do {                                                           \
-  pthread_mutex_lock(&_log_mutex);                             \
-  __log_print_to_console(WS_BR_AGENT_LOG_COLOR_WHITE, "INFO",  \
-                         fmt, ##__VA_ARGS__);                  \
-  __log_print_to_file("INFO", fmt, ##__VA_ARGS__);             \
+  _log_lock();                                                 \
+  __log_print_to_console(color, level, fmt, ##__VA_ARGS__);    \
+  __log_print_to_file(level, fmt, ##__VA_ARGS__);              \
   pthread_mutex_unlock(&_log_mutex);                           \
+  __log_print_to_journal(priority, fields, fmt, ##__VA_ARGS__); \
 } while (0)
 
+/// @brief Info log printer
+#define ws_br_agent_log_info(fmt, ...)                         \
+  __log_print(WS_BR_AGENT_LOG_COLOR_WHITE, "INFO", 6, NULL,    \
+              fmt, ##__VA_ARGS__)
+
 /// @brief Warning log printer
 #define ws_br_agent_log_warn(fmt, ...)                         \
-do {                                                           \
-  pthread_mutex_lock(&_log_mutex);                             \
-  __log_print_to_console(WS_BR_AGENT_LOG_COLOR_YELLOW, "WARN", \
-                         fmt, ##__VA_ARGS__);                  \
-  __log_print_to_file("WARN", fmt, ##__VA_ARGS__);             \
-  pthread_mutex_unlock(&_log_mutex);                           \
-} while (0)
+  __log_print(WS_BR_AGENT_LOG_COLOR_YELLOW, "WARN", 4, NULL,   \
+              fmt, ##__VA_ARGS__)
 
 /// @brief Error log printer
 #define ws_br_agent_log_error(fmt, ...)                        \
-do {                                                           \
-  pthread_mutex_lock(&_log_mutex);                             \
-  __log_print_to_console(WS_BR_AGENT_LOG_COLOR_RED, "ERROR",   \
-                         fmt, ##__VA_ARGS__);                  \
-  __log_print_to_file("ERROR", fmt, ##__VA_ARGS__);            \
-  pthread_mutex_unlock(&_log_mutex);                           \
-} while (0)
+  __log_print(WS_BR_AGENT_LOG_COLOR_RED, "ERROR", 3, NULL,     \
+              fmt, ##__VA_ARGS__)
+
+/// @brief Info log printer with structured journal fields
+#define ws_br_agent_log_info_fields(fields, fmt, ...)          \
+  __log_print(WS_BR_AGENT_LOG_COLOR_WHITE, "INFO", 6, fields,  \
+              fmt, ##__VA_ARGS__)
+
+/// @brief Warning log printer with structured journal fields
+#define ws_br_agent_log_warn_fields(fields, fmt, ...)          \
+  __log_print(WS_BR_AGENT_LOG_COLOR_YELLOW, "WARN", 4, fields, \
+              fmt, ##__VA_ARGS__)
+
+/// @brief Error log printer with structured journal fields
+#define ws_br_agent_log_error_fields(fields, fmt, ...)         \
+  __log_print(WS_BR_AGENT_LOG_COLOR_RED, "ERROR", 3, fields,   \
+              fmt, ##__VA_ARGS__)
 
 /// @brief Debug log printer
 #if WS_BR_AGENT_LOG_ENABLE_DEBUG
 #define ws_br_agent_log_debug(fmt, ...)                        \
-do {                                                           \
-  pthread_mutex_lock(&_log_mutex);                             \
-  __log_print_to_console(WS_BR_AGENT_LOG_COLOR_CYAN, "DEBUG",  \
-                         fmt, ##__VA_ARGS__);                  \
-  __log_print_to_file("DEBUG", fmt, ##__VA_ARGS__);            \
-  pthread_mutex_unlock(&_log_mutex);                           \
-} while (0)
+  __log_print(WS_BR_AGENT_LOG_COLOR_CYAN, "DEBUG", 7, NULL,    \
+              fmt, ##__VA_ARGS__)
 #else
 #define ws_br_agent_log_debug(fmt, ...)                        \
   do {                                                         \
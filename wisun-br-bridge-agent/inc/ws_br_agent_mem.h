@@ -0,0 +1,245 @@
+/***************************************************************************//**
+ * @file ws_br_agent_mem.h
+ * @brief Wi-SUN SoC Border Router Agent memory accounting and pools
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#ifndef WS_BR_AGENT_MEM_H
+#define WS_BR_AGENT_MEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ws_br_agent_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Small pool block size (message structures)
+#ifndef WS_BR_AGENT_MEM_POOL_SMALL_SIZE
+#define WS_BR_AGENT_MEM_POOL_SMALL_SIZE     64U
+#endif
+/// Small pool block count (recycled blocks kept in heap mode, mapped blocks in pool mode)
+#ifndef WS_BR_AGENT_MEM_POOL_SMALL_COUNT
+#define WS_BR_AGENT_MEM_POOL_SMALL_COUNT    16U
+#endif
+/// Medium pool block size (SoC receive buffers, settings messages)
+#ifndef WS_BR_AGENT_MEM_POOL_MEDIUM_SIZE
+#define WS_BR_AGENT_MEM_POOL_MEDIUM_SIZE    WS_BR_AGENT_MAX_BUF_SIZE
+#endif
+/// Medium pool block count (recycled blocks kept in heap mode, mapped blocks in pool mode)
+#ifndef WS_BR_AGENT_MEM_POOL_MEDIUM_COUNT
+#define WS_BR_AGENT_MEM_POOL_MEDIUM_COUNT   8U
+#endif
+/// Large pool block size: a full TOPOLOGY message (8-byte header and 48-byte entries)
+#ifndef WS_BR_AGENT_MEM_POOL_LARGE_SIZE
+#define WS_BR_AGENT_MEM_POOL_LARGE_SIZE     (8U + WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES * 48U)
+#endif
+/// Large pool block count: received payloads, update and D-Bus copies
+#ifndef WS_BR_AGENT_MEM_POOL_LARGE_COUNT
+#define WS_BR_AGENT_MEM_POOL_LARGE_COUNT    6U
+#endif
+/// Table pool block size: a host topology (about 29 bytes a node with its hash tables)
+/// or a node metrics table (22 bytes a row) of WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES nodes
+#ifndef WS_BR_AGENT_MEM_POOL_TABLE_SIZE
+#define WS_BR_AGENT_MEM_POOL_TABLE_SIZE     (WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES * 32U)
+#endif
+/// Table pool blocks per SoC: host topology and its spare, node metrics and their spare
+#ifndef WS_BR_AGENT_MEM_POOL_TABLE_PER_SOC
+#define WS_BR_AGENT_MEM_POOL_TABLE_PER_SOC  4U
+#endif
+/// Lifecycle pool block size: the lifecycle table of a SoC, for WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES nodes
+/// (80-byte record, absence list links, update mark, two hash slots and a changed entry index per node)
+#ifndef WS_BR_AGENT_MEM_POOL_LIFECYCLE_SIZE
+#define WS_BR_AGENT_MEM_POOL_LIFECYCLE_SIZE (WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES * 104U)
+#endif
+/// Lifecycle pool blocks per SoC
+#ifndef WS_BR_AGENT_MEM_POOL_LIFECYCLE_PER_SOC
+#define WS_BR_AGENT_MEM_POOL_LIFECYCLE_PER_SOC 1U
+#endif
+
+/// Allocating subsystems
+typedef enum ws_br_agent_mem_subsys {
+  /// Message structures, payloads and built buffers
+  WS_BR_AGENT_MEM_SUBSYS_MSG = 0,
+  /// Topology arrays
+  WS_BR_AGENT_MEM_SUBSYS_TOPOLOGY,
+  /// SoC request buffers
+  WS_BR_AGENT_MEM_SUBSYS_SOC_HOST,
+  /// Server connections (event loop mode)
+  WS_BR_AGENT_MEM_SUBSYS_SRV,
+  /// Host topology and node metrics tables of the SoC shards, served by their own pools
+  WS_BR_AGENT_MEM_SUBSYS_TABLES,
+  /// Node lifecycle tables of the SoC shards, served by their own pool
+  WS_BR_AGENT_MEM_SUBSYS_LIFECYCLE,
+  /// Topology history ring, mapped by the history itself
+  WS_BR_AGENT_MEM_SUBSYS_HISTORY,
+  /// Number of subsystems
+  WS_BR_AGENT_MEM_SUBSYS_COUNT
+} ws_br_agent_mem_subsys_t;
+
+/// @brief Allocation statistics of a subsystem
+typedef struct ws_br_agent_mem_stats {
+  /// Successful allocations
+  uint64_t allocs;
+  /// Frees
+  uint64_t frees;
+  /// Failed allocations (budget exceeded, pools exhausted or heap failure)
+  uint64_t failures;
+  /// Bytes in use
+  size_t bytes;
+  /// Highest bytes in use
+  size_t peak_bytes;
+} ws_br_agent_mem_stats_t;
+
+/// @brief Statistics of a pool
+typedef struct ws_br_agent_mem_pool_stats {
+  /// Usable block size in bytes
+  size_t block_size;
+  /// Maximum number of blocks
+  uint32_t block_count;
+  /// Blocks held by the pool, in use or free
+  uint32_t allocated;
+  /// Blocks in use
+  uint32_t in_use;
+  /// Highest number of blocks in use
+  uint32_t high_water;
+  /// Allocations served by a free block
+  uint64_t hits;
+  /// Allocations that needed a new block, the heap or a larger pool
+  uint64_t misses;
+  /// Allocations that found the pool empty and full-sized
+  uint64_t exhausted;
+} ws_br_agent_mem_pool_stats_t;
+
+/// Subsystem names, indexed by #ws_br_agent_mem_subsys_t
+extern const char * const ws_br_agent_mem_subsys_strs[WS_BR_AGENT_MEM_SUBSYS_COUNT];
+
+/**
+ * @brief Initialize memory accounting.
+ * @details Allocations are served by the smallest fitting pool. In heap mode, pool blocks are
+ *          allocated on demand and recycled when freed, up to the pool block count; requests
+ *          larger than the large blocks or finding the pool full-sized and busy go to the heap.
+ *          In pool mode, the pools are mapped here: no heap allocation is made afterwards,
+ *          a request spills to a larger pool when its pool is empty and fails when none fits.
+ *          The tables of the SoC shards (WS_BR_AGENT_MEM_SUBSYS_TABLES and _LIFECYCLE) have pools
+ *          of their own, sized for soc_count SoCs, that they do not spill from. They are used in pool
+ *          mode only: in heap mode, the tables are heap allocations of the requested size.
+ *          Without initialization, heap mode is used with no budget.
+ *          Must be called before the first allocation.
+ * @param[in] budget Maximum bytes in use (0 for no limit). In pool mode, the pools must fit in it.
+ * @param[in] pool_mode Serve all allocations from pools
+ * @param[in] soc_count Number of SoCs the table pools are sized for,
+ *                      1 to WS_BR_AGENT_SOC_HOST_MAX_COUNT
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_mem_init(size_t budget, bool pool_mode, size_t soc_count);
+
+/**
+ * @brief Release the pools.
+ * @details Free blocks are released. In pool mode, all the blocks must have been freed.
+ */
+void ws_br_agent_mem_deinit(void);
+
+/**
+ * @brief Allocate memory for a subsystem.
+ * @param[in] subsys Allocating subsystem
+ * @param[in] size Size in bytes
+ * @return Pointer to the memory, or NULL on failure.
+ */
+void *ws_br_agent_mem_alloc(ws_br_agent_mem_subsys_t subsys, size_t size);
+
+/**
+ * @brief Free memory allocated by ws_br_agent_mem_alloc().
+ * @param[in] ptr Pointer to the memory, can be NULL
+ */
+void ws_br_agent_mem_free(void *ptr);
+
+/**
+ * @brief Account memory mapped by a subsystem itself, against the budget.
+ * @details For mappings made once at start-up, in heap or pool mode.
+ * @param[in] subsys Mapping subsystem
+ * @param[in] size Size in bytes
+ * @return WS_BR_AGENT_RET_OK on success, error code if the budget would be exceeded.
+ */
+ws_br_agent_ret_t ws_br_agent_mem_reserve(ws_br_agent_mem_subsys_t subsys, size_t size);
+
+/**
+ * @brief Release memory accounted by ws_br_agent_mem_reserve().
+ * @param[in] subsys Mapping subsystem
+ * @param[in] size Size in bytes
+ */
+void ws_br_agent_mem_release(ws_br_agent_mem_subsys_t subsys, size_t size);
+
+/**
+ * @brief Get the usable size of an allocation.
+ * @details For pool blocks, this is the pool block size.
+ * @param[in] ptr Pointer to the memory
+ * @return Usable size in bytes (0 for NULL).
+ */
+size_t ws_br_agent_mem_usable_size(const void *ptr);
+
+/**
+ * @brief Get the allocation statistics of a subsystem.
+ * @param[in] subsys Subsystem
+ * @param[out] stats Statistics
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_mem_get_stats(ws_br_agent_mem_subsys_t subsys,
+                                            ws_br_agent_mem_stats_t * const stats);
+
+/**
+ * @brief Get the statistics of a pool.
+ * @param[in] index Pool index, from the smallest blocks
+ * @param[out] stats Statistics
+ * @return WS_BR_AGENT_RET_OK on success, error code if the pool does not exist.
+ */
+ws_br_agent_ret_t ws_br_agent_mem_get_pool_stats(size_t index,
+                                                 ws_br_agent_mem_pool_stats_t * const stats);
+
+/**
+ * @brief Get the memory budget.
+ * @return Budget in bytes (0 for no limit).
+ */
+size_t ws_br_agent_mem_get_budget(void);
+
+/**
+ * @brief Parse a size with an optional k, M or G suffix (powers of 1024).
+ * @param[in] str Size string
+ * @param[out] size Size in bytes
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_mem_parse_size(const char *str, size_t * const size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_MEM_H
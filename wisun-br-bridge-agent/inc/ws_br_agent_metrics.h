@@ -0,0 +1,213 @@
+/***************************************************************************//**
+ * @file ws_br_agent_metrics.h
+ * @brief Metrics registry for Wi-SUN SoC Border Router Agent
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef WS_BR_AGENT_METRICS_H
+#define WS_BR_AGENT_METRICS_H
+
+#include <pthread.h>
+
+#include "ws_br_agent_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Default metrics endpoint port
+#define WS_BR_AGENT_METRICS_DEFAULT_PORT 11502U
+
+/// Highest message code counted individually (higher codes are counted as unknown)
+#define WS_BR_AGENT_METRICS_MAX_MSG_CODE 15U
+
+/// Maximum number of buckets per histogram (+Inf excluded)
+#define WS_BR_AGENT_METRICS_MAX_BUCKETS 16U
+
+/// Counters
+typedef enum ws_br_agent_metric_counter {
+  /// Bytes received (agent service and SoC responses)
+  WS_BR_AGENT_METRIC_RX_BYTES = 0,
+  /// Bytes sent (agent service responses and SoC requests)
+  WS_BR_AGENT_METRIC_TX_BYTES,
+  /// Messages that failed to parse
+  WS_BR_AGENT_METRIC_PARSE_FAILURES,
+  /// Requests sent to the SoC
+  WS_BR_AGENT_METRIC_SOC_REQUESTS,
+  /// SoC connection failures
+  WS_BR_AGENT_METRIC_SOC_CONNECT_FAILURES,
+  /// State file saves
+  WS_BR_AGENT_METRIC_STATE_SAVES,
+  /// State file save failures
+  WS_BR_AGENT_METRIC_STATE_SAVE_FAILURES,
+  /// Configuration file reloads
+  WS_BR_AGENT_METRIC_CONFIG_RELOADS,
+  /// Configuration file reloads rejected (invalid file)
+  WS_BR_AGENT_METRIC_CONFIG_RELOAD_FAILURES,
+  /// Received frames with a bad CRC32C trailer
+  WS_BR_AGENT_METRIC_CRC_FAILURES,
+  /// Topology versions recorded in the history as keyframes
+  WS_BR_AGENT_METRIC_HISTORY_KEYFRAMES,
+  /// Topology versions recorded in the history as deltas
+  WS_BR_AGENT_METRIC_HISTORY_DELTAS,
+  /// Preferred parent changes of the nodes
+  WS_BR_AGENT_METRIC_NODE_REPARENTS,
+  /// Nodes back in the topology after leaving it
+  WS_BR_AGENT_METRIC_NODE_FLAPS,
+  /// Nodes that left the topology
+  WS_BR_AGENT_METRIC_NODE_LEAVES,
+  /// Lifecycle records dropped: absent for too long, or making room for a new node
+  WS_BR_AGENT_METRIC_NODE_EVICTIONS,
+  /// NODE_STATS entries stored
+  WS_BR_AGENT_METRIC_NODE_STATS_ENTRIES,
+  /// NODE_STATS entries for targets not in the topology
+  WS_BR_AGENT_METRIC_NODE_STATS_UNKNOWN,
+  /// Number of counters
+  WS_BR_AGENT_METRIC_COUNTER_COUNT
+} ws_br_agent_metric_counter_t;
+
+/// Gauges
+typedef enum ws_br_agent_metric_gauge {
+  /// Entry count of the last received topology
+  WS_BR_AGENT_METRIC_TOPOLOGY_ENTRIES = 0,
+  /// Number of SoCs whose data is restored from the state file and not refreshed yet
+  WS_BR_AGENT_METRIC_STATE_STALE,
+  /// Number of SoC shards in use
+  WS_BR_AGENT_METRIC_SOC_HOSTS,
+  /// Bytes of topology history held in the ring
+  WS_BR_AGENT_METRIC_HISTORY_BYTES,
+  /// Nodes with a lifecycle record, the nodes that left included
+  WS_BR_AGENT_METRIC_NODES_TRACKED,
+  /// Nodes listed by the last topology of their SoC
+  WS_BR_AGENT_METRIC_NODES_PRESENT,
+  /// Number of gauges
+  WS_BR_AGENT_METRIC_GAUGE_COUNT
+} ws_br_agent_metric_gauge_t;
+
+/// Histograms
+typedef enum ws_br_agent_metric_hist {
+  /// Entry count of received TOPOLOGY messages
+  WS_BR_AGENT_METRIC_HIST_TOPOLOGY_ENTRIES = 0,
+  /// Agent service request handling latency (accept to handled)
+  WS_BR_AGENT_METRIC_HIST_HANDLER_LATENCY,
+  /// D-Bus RoutingGraph getter latency
+  WS_BR_AGENT_METRIC_HIST_DBUS_ROUTING_GRAPH_LATENCY,
+  /// D-Bus settings getters latency
+  WS_BR_AGENT_METRIC_HIST_DBUS_SETTINGS_LATENCY,
+  /// SoC request round trip time
+  WS_BR_AGENT_METRIC_HIST_SOC_RTT,
+  /// Host mutex wait time
+  WS_BR_AGENT_METRIC_HIST_HOST_MUTEX_WAIT,
+  /// Log mutex wait time
+  WS_BR_AGENT_METRIC_HIST_LOG_MUTEX_WAIT,
+  /// TOPOLOGY update stages, in ws_br_agent_trace_stage_t order, then total
+  WS_BR_AGENT_METRIC_HIST_TOPOLOGY_RECV,
+  WS_BR_AGENT_METRIC_HIST_TOPOLOGY_PARSE,
+  WS_BR_AGENT_METRIC_HIST_TOPOLOGY_STORE,
+  WS_BR_AGENT_METRIC_HIST_TOPOLOGY_DIFF,
+  WS_BR_AGENT_METRIC_HIST_TOPOLOGY_EMIT,
+  WS_BR_AGENT_METRIC_HIST_TOPOLOGY_TOTAL,
+  /// SET_CONFIG_PARAMS update stages, in ws_br_agent_trace_stage_t order, then total
+  WS_BR_AGENT_METRIC_HIST_SETTINGS_RECV,
+  WS_BR_AGENT_METRIC_HIST_SETTINGS_PARSE,
+  WS_BR_AGENT_METRIC_HIST_SETTINGS_STORE,
+  WS_BR_AGENT_METRIC_HIST_SETTINGS_DIFF,
+  WS_BR_AGENT_METRIC_HIST_SETTINGS_EMIT,
+  WS_BR_AGENT_METRIC_HIST_SETTINGS_TOTAL,
+  /// Number of histograms
+  WS_BR_AGENT_METRIC_HIST_COUNT
+} ws_br_agent_metric_hist_t;
+
+/**
+ * @brief Start the metrics endpoint.
+ * @details The endpoint serves the registry in OpenMetrics text format over HTTP.
+ *          Accepted forms: "<port>" (loopback), "[<IPv6 address>]:<port>" or "unix:<path>".
+ * @param[in] endpoint Endpoint description
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_metrics_init(const char *endpoint);
+
+/**
+ * @brief Stop the metrics endpoint.
+ */
+void ws_br_agent_metrics_deinit(void);
+
+/**
+ * @brief Add a value to a counter.
+ * @param[in] id Counter
+ * @param[in] val Value to add
+ */
+void ws_br_agent_metrics_add(ws_br_agent_metric_counter_t id, uint64_t val);
+
+/**
+ * @brief Count a received message.
+ * @param[in] msg_code Message code
+ */
+void ws_br_agent_metrics_inc_rx_msg(uint32_t msg_code);
+
+/**
+ * @brief Set a gauge.
+ * @param[in] id Gauge
+ * @param[in] val Value
+ */
+void ws_br_agent_metrics_set(ws_br_agent_metric_gauge_t id, int64_t val);
+
+/**
+ * @brief Add to a gauge.
+ * @param[in] id Gauge
+ * @param[in] delta Value to add, negative to decrease
+ */
+void ws_br_agent_metrics_add_gauge(ws_br_agent_metric_gauge_t id, int64_t delta);
+
+/**
+ * @brief Record an observation in a histogram.
+ * @param[in] id Histogram
+ * @param[in] val Observed value (microseconds for latencies)
+ */
+void ws_br_agent_metrics_observe(ws_br_agent_metric_hist_t id, uint64_t val);
+
+/**
+ * @brief Lock a mutex and record the wait time.
+ * @details Uncontended locks are recorded without reading the clock.
+ * @param[in] mutex Mutex to lock
+ * @param[in] id Wait time histogram
+ * @return pthread_mutex_lock() result
+ */
+int ws_br_agent_metrics_mutex_lock(pthread_mutex_t *mutex, ws_br_agent_metric_hist_t id);
+
+/**
+ * @brief Render the registry in OpenMetrics text format.
+ * @param[out] size Pointer to store the text size
+ * @return Dynamically allocated text, or NULL on error. The caller is responsible for freeing it.
+ */
+char *ws_br_agent_metrics_render(size_t * const size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_METRICS_H
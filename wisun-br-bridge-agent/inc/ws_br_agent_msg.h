@@ -50,15 +50,27 @@ extern "C" {
 #define WS_BR_AGENT_MSG_CODE_RESTART_BR         (0x00000004U)
 /// Stop Border Router msg code
 #define WS_BR_AGENT_MSG_CODE_STOP_BR            (0x00000005U)
+/// Node link metrics msg code (SoC to agent, ws_br_agent_node_stats_entry_t entries)
+#define WS_BR_AGENT_MSG_CODE_NODE_STATS         (0x00000006U)
+
+/// Message code flag: the frame ends with a CRC32C trailer (big endian, over header and payload)
+#define WS_BR_AGENT_MSG_FLAG_CRC32C             (0x80000000U)
+
+/// CRC32C trailer size
+#define WS_BR_AGENT_MSG_CRC_SIZE                4U
 
 /// Minimum buffer size for a message (header only, no payload)
 #define WS_BR_AGENT_MSG_MIN_BUF_SIZE \
   (sizeof(ws_br_agent_msg_raw_code_t) + sizeof(ws_br_agent_msg_len_t))
 
-/// Buffer size for SET_CONFIG_PARAMS message
+/// Buffer size for SET_CONFIG_PARAMS message (legacy encoding)
 #define WS_BR_AGENT_MSG_SET_PARAM_MSG_BUF_SIZE \
   (WS_BR_AGENT_MSG_MIN_BUF_SIZE + sizeof(ws_br_agent_msg_settings_payload_t))
 
+/// Maximum buffer size for SET_CONFIG_PARAMS message, any encoding
+#define WS_BR_AGENT_MSG_SET_PARAM_MSG_MAX_BUF_SIZE \
+  (WS_BR_AGENT_MSG_MIN_BUF_SIZE + WS_BR_AGENT_SETTINGS_TLV_MAX_SIZE + WS_BR_AGENT_MSG_CRC_SIZE)
+
 /// @brief Type for message payload length
 typedef uint32_t ws_br_agent_msg_len_t;
 
@@ -68,8 +80,20 @@ typedef uint32_t ws_br_agent_msg_raw_code_t;
 /// @brief Type for SET_CONFIG_PARAMS message payload
 typedef ws_br_agent_settings_t ws_br_agent_msg_settings_payload_t;
 
+/// @brief Settings encoding of SET_CONFIG_PARAMS payloads
+/// @details A SoC selects the TLV encoding by sending TLV settings, or a GET_CONFIG_PARAMS request
+///          whose payload is a TLV header. The agent then answers and pushes TLV settings to it.
+typedef enum ws_br_agent_msg_settings_enc {
+  /// Packed #ws_br_agent_settings_t
+  WS_BR_AGENT_MSG_SETTINGS_ENC_LEGACY = 0,
+  /// Versioned TLV, possibly partial (see ws_br_agent_settings_tlv_encode())
+  WS_BR_AGENT_MSG_SETTINGS_ENC_TLV,
+} ws_br_agent_msg_settings_enc_t;
+
 /// Packet structure:
-/// [msg code 4 byte] [payload len 4 byte] [payload data n byte]
+/// [msg code 4 byte] [payload len 4 byte] [payload data n byte] [CRC32C 4 byte, optional]
+/// The sender of the first frame of a connection chooses whether it carries a CRC32C trailer 
+/// (WS_BR_AGENT_MSG_FLAG_CRC32C), the answer on the same connection does the same.
 typedef struct ws_br_agent_msg {
   /// @brief Message code
   ws_br_agent_msg_raw_code_t msg_code;
@@ -77,28 +101,67 @@ typedef struct ws_br_agent_msg {
   ws_br_agent_msg_len_t payload_len;
   /// @brief Pointer to the payload data (NULL if no payload)
   uint8_t *payload;
+  /// @brief Frame with a CRC32C trailer
+  bool crc;
 } ws_br_agent_msg_t;
 
 /**
  * @brief Build a message buffer from a message structure.
- * @details The buffer is dynamically allocated and should be freed by the caller.
+ * @details A CRC32C trailer is appended if msg->crc is set.
+ *          The buffer is dynamically allocated and should be freed by the caller using
+ *          ws_br_agent_msg_free_buf(). TOPOLOGY, NODE_STATS and SET_CONFIG_PARAMS messages carry the given payload, 
+ *          SET_CONFIG_PARAMS messages without payload carry the current host settings (legacy encoding).
  * @param[in] msg Pointer to the message structure.
  * @param[out] buf_size Pointer to a variable to store the size of the built buffer.
  * @return Pointer to the built buffer, or NULL on error. The caller is responsible for freeing the buffer.
  */
 uint8_t *ws_br_agent_msg_build_buf(const ws_br_agent_msg_t * const msg, size_t * const buf_size);
 
+/**
+ * @brief Get the size of a frame from its header.
+ * @param[in] hdr Frame header, WS_BR_AGENT_MSG_MIN_BUF_SIZE bytes.
+ * @return Frame size: header, payload and CRC32C trailer if flagged, SIZE_MAX if it does not fit a size_t.
+ */
+size_t ws_br_agent_msg_frame_size(const uint8_t * const hdr);
+
+/**
+ * @brief Verify the CRC32C trailer of a received frame, before parsing it.
+ * @details Failures are logged and counted (crc_failures_total).
+ * @param[in] buf Frame.
+ * @param[in] buf_size Frame size.
+ * @return WS_BR_AGENT_RET_OK if the frame has no trailer or a valid one, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_msg_check_crc(const uint8_t * const buf, const size_t buf_size);
+
 /**
  * @brief Parse a message buffer into a message structure.
- * @details The message structure is dynamically allocated and should be freed by the caller using ws_br_agent_msg_free().
+ * @details The CRC32C trailer is not verified here (see ws_br_agent_msg_check_crc()).
+ *          The message structure is dynamically allocated and should be freed by the caller using ws_br_agent_msg_free().
  * @param[in] buf Pointer to the buffer containing the message.
  * @param[in] buf_size Size of the buffer in bytes.
  * @return Pointer to the parsed message structure, or NULL on error. The caller is responsible for freeing the message structure.
  */
 ws_br_agent_msg_t *ws_br_agent_msg_parse_buf(const uint8_t * const buf, const size_t buf_size);
 
+/**
+ * @brief Get the settings encoding of a SET_CONFIG_PARAMS or GET_CONFIG_PARAMS message.
+ * @param[in] msg Pointer to the message structure.
+ * @return WS_BR_AGENT_MSG_SETTINGS_ENC_TLV if the payload starts with a TLV header, legacy otherwise.
+ */
+ws_br_agent_msg_settings_enc_t ws_br_agent_msg_get_settings_enc(const ws_br_agent_msg_t * const msg);
+
+/**
+ * @brief Free a message structure returned by ws_br_agent_msg_parse_buf().
+ * @param[in] msg Pointer to the message structure, can be NULL.
+ */
 void ws_br_agent_msg_free(ws_br_agent_msg_t *msg);
 
+/**
+ * @brief Free a buffer returned by ws_br_agent_msg_build_buf().
+ * @param[in] buf Pointer to the buffer, can be NULL.
+ */
+void ws_br_agent_msg_free_buf(uint8_t *buf);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,182 @@
+/***************************************************************************//**
+ * @file ws_br_agent_node_stats.h
+ * @brief Per-node link metrics pushed by the SoC
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+
+#ifndef WS_BR_AGENT_NODE_STATS_H
+#define WS_BR_AGENT_NODE_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ws_br_agent_defs.h"
+#include "ws_br_agent_topo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// RSL encoding offset: dBm + 174, as in the Wi-SUN RSL-IE
+#define WS_BR_AGENT_NODE_STATS_RSL_OFFSET 174
+
+/// ETX fixed point unit (ETX 1.0)
+#define WS_BR_AGENT_NODE_STATS_ETX_UNIT 128U
+
+/// @brief NODE_STATS message entry, multi-byte fields big endian
+typedef struct __attribute__((packed, aligned(1))) ws_br_agent_node_stats_entry {
+  /// @brief Node target address, as listed in the topology
+  uint8_t target[16];
+  /// @brief RSL of the frames received from the node (dBm + 174)
+  uint8_t rsl_in;
+  /// @brief RSL of the frames received by the node, as it reported it (dBm + 174)
+  uint8_t rsl_out;
+  /// @brief ETX to the node (1/128 units)
+  uint8_t etx[2];
+  /// @brief PHY mode ID in use with the node
+  uint8_t phy_mode_id;
+  /// @brief Reserved, 0
+  uint8_t reserved;
+  /// @brief Seconds since the node was last heard
+  uint8_t last_heard_s[4];
+} ws_br_agent_node_stats_entry_t;
+
+/// @brief Link metrics of a node
+typedef struct ws_br_agent_node_stats_row {
+  /// @brief Node target address
+  uint8_t target[16];
+  /// @brief Topology entry index
+  uint32_t index;
+  /// @brief RSL in and out (dBm)
+  int16_t rsl_in_dbm;
+  int16_t rsl_out_dbm;
+  /// @brief ETX (1/128 units)
+  uint16_t etx;
+  /// @brief PHY mode ID in use
+  uint8_t phy_mode_id;
+  /// @brief Last heard time (us since the Epoch)
+  uint64_t last_heard_us;
+} ws_br_agent_node_stats_row_t;
+
+/// @brief Link metrics table of a SoC, in struct-of-arrays form.
+/// @details Row i holds the metrics of the topology node i. Entries are matched to their row
+///          by position first (a SoC lists them in topology order), then through a target index
+///          built on demand. When the topology changes, the rows are moved to the new node indexes.
+///          The columns and the index are carved from a single block, a spare one is kept for the moves,
+///          so a refresh does not allocate.
+typedef struct ws_br_agent_node_stats {
+  /// @brief Number of rows (topology node count)
+  uint32_t row_count;
+  /// @brief Row capacity of the block
+  uint32_t cap;
+  /// @brief Last heard time of each row (us since the Epoch)
+  uint64_t *last_heard_us;
+  /// @brief ETX of each row (1/128 units)
+  uint16_t *etx;
+  /// @brief RSL in and out of each row (dBm + 174)
+  uint8_t *rsl_in;
+  uint8_t *rsl_out;
+  /// @brief PHY mode ID of each row
+  uint8_t *phy_mode_id;
+  /// @brief Metrics received for the row since it was added
+  uint8_t *valid;
+  /// @brief Target index: row + 1 of each slot, 0 if free
+  uint32_t *slots;
+  /// @brief Slot count - 1 (power of two)
+  uint32_t slot_mask;
+  /// @brief The target index matches the topology
+  bool indexed;
+  /// @brief Column block, spare block for the moves
+  void *block;
+  void *spare;
+  /// @brief Last refresh time (us since the Epoch)
+  uint64_t update_us;
+} ws_br_agent_node_stats_t;
+
+/**
+ * @brief Node metrics callback.
+ * @param[in] ctx User context.
+ * @param[in] row Node metrics.
+ * @return 0 to continue, negative to stop.
+ */
+typedef int (*ws_br_agent_node_stats_cb_t)(void *ctx, const ws_br_agent_node_stats_row_t *row);
+
+/**
+ * @brief Store the metrics of a NODE_STATS message.
+ * @param[in,out] stats Metrics table.
+ * @param[in] topo Current topology of the SoC.
+ * @param[in] entries Message entries.
+ * @param[in] count Number of entries.
+ * @param[in] time_us Reception time (us since the Epoch).
+ * @param[out] unknown Number of entries whose target is not in the topology (ignored).
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise (table unchanged).
+ */
+ws_br_agent_ret_t ws_br_agent_node_stats_update(ws_br_agent_node_stats_t * const stats,
+                                                const ws_br_agent_topo_t * const topo,
+                                                const ws_br_agent_node_stats_entry_t * const entries,
+                                                uint32_t count, uint64_t time_us, uint32_t * const unknown);
+
+/**
+ * @brief Move the rows to the node indexes of a new topology.
+ * @details Rows of nodes no longer listed are dropped. Nothing is done before the first metrics.
+ * @param[in,out] stats Metrics table.
+ * @param[in] prev Previous topology.
+ * @param[in] topo New topology.
+ */
+void ws_br_agent_node_stats_remap(ws_br_agent_node_stats_t * const stats,
+                                  const ws_br_agent_topo_t * const prev,
+                                  const ws_br_agent_topo_t * const topo);
+
+/**
+ * @brief Walk the nodes with metrics, in topology order.
+ * @param[in] stats Metrics table.
+ * @param[in] topo Current topology of the SoC.
+ * @param[in] first First topology entry index.
+ * @param[in] count Number of entries to walk, 0 for all.
+ * @param[in] cb Callback.
+ * @param[in] ctx Callback context.
+ * @return WS_BR_AGENT_RET_OK on success, error code if the callback failed.
+ */
+ws_br_agent_ret_t ws_br_agent_node_stats_foreach(const ws_br_agent_node_stats_t * const stats,
+                                                 const ws_br_agent_topo_t * const topo,
+                                                 uint32_t first, uint32_t count,
+                                                 ws_br_agent_node_stats_cb_t cb, void *ctx);
+
+/**
+ * @brief Release a metrics table.
+ * @param[in,out] stats Metrics table, emptied.
+ */
+void ws_br_agent_node_stats_free(ws_br_agent_node_stats_t * const stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_NODE_STATS_H
@@ -0,0 +1,75 @@
+/***************************************************************************//**
+ * @file ws_br_agent_probe.h
+ * @brief USDT probes for Wi-SUN SoC Border Router Agent
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef WS_BR_AGENT_PROBE_H
+#define WS_BR_AGENT_PROBE_H
+
+/// Enable USDT probes (requires <sys/sdt.h>, set by the WS_BR_AGENT_ENABLE_USDT CMake option)
+#ifndef WS_BR_AGENT_ENABLE_USDT
+#define WS_BR_AGENT_ENABLE_USDT 0
+#endif
+
+#if WS_BR_AGENT_ENABLE_USDT
+#include <sys/sdt.h>
+
+// All probes belong to the "wisun_br_agent" provider
+
+/// @brief Fire a probe without argument
+#define ws_br_agent_probe0(name) \
+  DTRACE_PROBE(wisun_br_agent, name)
+
+/// @brief Fire a probe with one argument
+#define ws_br_agent_probe1(name, a1) \
+  DTRACE_PROBE1(wisun_br_agent, name, a1)
+
+/// @brief Fire a probe with two arguments
+#define ws_br_agent_probe2(name, a1, a2) \
+  DTRACE_PROBE2(wisun_br_agent, name, a1, a2)
+
+/// @brief Fire a probe with three arguments
+#define ws_br_agent_probe3(name, a1, a2, a3) \
+  DTRACE_PROBE3(wisun_br_agent, name, a1, a2, a3)
+
+#else
+// Arguments are not evaluated when probes are compiled out
+#define ws_br_agent_probe0(name) \
+  do { } while (0)
+
+#define ws_br_agent_probe1(name, a1) \
+  do { (void)sizeof(a1); } while (0)
+
+#define ws_br_agent_probe2(name, a1, a2) \
+  do { (void)sizeof(a1); (void)sizeof(a2); } while (0)
+
+#define ws_br_agent_probe3(name, a1, a2, a3) \
+  do { (void)sizeof(a1); (void)sizeof(a2); (void)sizeof(a3); } while (0)
+#endif
+
+#endif // WS_BR_AGENT_PROBE_H
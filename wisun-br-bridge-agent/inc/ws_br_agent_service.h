@@ -0,0 +1,120 @@
+/***************************************************************************//**
+ * @file ws_br_agent_service.h
+ * @brief Wi-SUN SoC Border Router Agent systemd service integration
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#ifndef WS_BR_AGENT_SERVICE_H
+#define WS_BR_AGENT_SERVICE_H
+
+#include <stdint.h>
+
+#include "ws_br_agent_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Agent loops supervised by the systemd watchdog in threaded mode
+typedef enum ws_br_agent_service_loop {
+  /// TCP server thread
+  WS_BR_AGENT_SERVICE_LOOP_SRV = 0,
+  /// D-Bus thread
+  WS_BR_AGENT_SERVICE_LOOP_DBUS,
+  /// Metrics thread
+  WS_BR_AGENT_SERVICE_LOOP_METRICS,
+  /// State file writer thread
+  WS_BR_AGENT_SERVICE_LOOP_STATE,
+  /// Configuration file watcher thread
+  WS_BR_AGENT_SERVICE_LOOP_CONFIG,
+  /// Number of loops
+  WS_BR_AGENT_SERVICE_LOOP_COUNT
+} ws_br_agent_service_loop_t;
+
+/**
+ * @brief Initialize the systemd service integration.
+ * @details Reads the watchdog settings from the environment set by systemd.
+ *          Does nothing when the agent is not started by systemd.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_service_init(void);
+
+/**
+ * @brief Get a listen socket passed by systemd socket activation.
+ * @details The socket is switched to non-blocking mode.
+ * @param[in] port TCP port the socket must listen on.
+ * @return Listen socket, or -1 if none was passed for this port.
+ */
+int ws_br_agent_service_get_listen_fd(uint16_t port);
+
+/**
+ * @brief Notify systemd that the agent is ready (READY=1).
+ */
+void ws_br_agent_service_notify_ready(void);
+
+/**
+ * @brief Notify systemd that the agent is stopping (STOPPING=1).
+ */
+void ws_br_agent_service_notify_stopping(void);
+
+/**
+ * @brief Get the interval at which the loops must report progress.
+ * @return Interval in ms, -1 if the watchdog is disabled (usable as a poll() timeout).
+ */
+int ws_br_agent_service_watchdog_interval_ms(void);
+
+/**
+ * @brief Register a loop: the watchdog is only pinged while it reports progress.
+ * @param[in] loop Loop identifier.
+ */
+void ws_br_agent_service_watchdog_start(ws_br_agent_service_loop_t loop);
+
+/**
+ * @brief Unregister a loop.
+ * @param[in] loop Loop identifier.
+ */
+void ws_br_agent_service_watchdog_stop(ws_br_agent_service_loop_t loop);
+
+/**
+ * @brief Report the progress of a loop, once per iteration.
+ * @param[in] loop Loop identifier.
+ */
+void ws_br_agent_service_watchdog_kick(ws_br_agent_service_loop_t loop);
+
+/**
+ * @brief Ping the watchdog (WATCHDOG=1) if every registered loop reported progress
+ *        since the previous check.
+ * @details Called by the main thread every watchdog interval.
+ */
+void ws_br_agent_service_watchdog_check(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_SERVICE_H
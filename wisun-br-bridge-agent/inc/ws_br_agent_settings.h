@@ -285,14 +285,216 @@ typedef struct __attribute__((packed, aligned(1))) ws_br_agent_settings {
   uint16_t pan_id;
 } ws_br_agent_settings_t;
 
+/// SoC host address set by the command line or the config file (NULL if not set)
+extern const char *soc_host_addr;
+
+struct ws_br_agent_name_value;
+
+/// Settings field value types
+typedef enum ws_br_agent_settings_field_type {
+  /// Unsigned integer (1, 2 or 4 bytes)
+  WS_BR_AGENT_SETTINGS_FIELD_UINT = 0,
+  /// Signed integer (1, 2 or 4 bytes)
+  WS_BR_AGENT_SETTINGS_FIELD_INT,
+  /// Boolean
+  WS_BR_AGENT_SETTINGS_FIELD_BOOL,
+  /// Unsigned integer named by a name/value table, numbers are accepted as well
+  WS_BR_AGENT_SETTINGS_FIELD_ENUM,
+  /// NUL terminated string, \xHH escape sequences are accepted in text form
+  WS_BR_AGENT_SETTINGS_FIELD_STR,
+  /// Byte array, hex encoded in text form
+  WS_BR_AGENT_SETTINGS_FIELD_BYTES,
+} ws_br_agent_settings_field_type_t;
+
+/// Maximum number of settings fields
+#define WS_BR_AGENT_SETTINGS_FIELD_MAX 64U
+
+/// PHY configuration type mask bit of a settings field
+#define WS_BR_AGENT_SETTINGS_PHY(type) (1U << (type))
+
+/// Settings field descriptor
+typedef struct ws_br_agent_settings_field {
+  /// Configuration file key, also used by the D-Bus GetSetting/SetSetting methods
+  const char *key;
+  /// D-Bus property name (NULL if the field has no dedicated property)
+  const char *dbus_name;
+  /// D-Bus type of the value: a basic type ('s' for names and strings) or 'a' for "ay"
+  char dbus_type;
+  /// Value type (#ws_br_agent_settings_field_type_t)
+  uint8_t type;
+  /// PHY configuration types the field applies to (WS_BR_AGENT_SETTINGS_PHY() mask, 0 for all)
+  uint8_t phy_types;
+  /// Offset in #ws_br_agent_settings_t
+  uint16_t offset;
+  /// Size in bytes
+  uint16_t size;
+  /// TLV encoding tag (0 for an alias of the previous field, not encoded)
+  uint16_t tag;
+  /// Name/value table of WS_BR_AGENT_SETTINGS_FIELD_ENUM fields
+  const struct ws_br_agent_name_value *table;
+  /// Minimum integer value (min == max == 0: range of the field type)
+  int64_t min;
+  /// Maximum integer value
+  int64_t max;
+} ws_br_agent_settings_field_t;
+
+/// Text form buffer size fitting any settings field (64 hex digits or a 65 character string)
+#define WS_BR_AGENT_SETTINGS_FIELD_TEXT_MAX_SIZE 96U
+
+/**
+ * @brief Get the settings field table.
+ * @param[out] count Number of fields.
+ * @return Field table, in #ws_br_agent_settings_t order.
+ */
+const ws_br_agent_settings_field_t *ws_br_agent_settings_fields(size_t * const count);
+
+/**
+ * @brief Find a settings field by configuration key (hashed lookup).
+ * @param[in] key Key, not necessarily NUL terminated.
+ * @param[in] key_len Key length.
+ * @return Field or NULL if unknown.
+ */
+const ws_br_agent_settings_field_t *ws_br_agent_settings_find_field(const char *key, size_t key_len);
+
+/**
+ * @brief Find a settings field by D-Bus property name (hashed lookup).
+ * @param[in] name Property name.
+ * @return Field or NULL if the property is not a settings field.
+ */
+const ws_br_agent_settings_field_t *ws_br_agent_settings_find_dbus_field(const char *name);
+
+/**
+ * @brief Check whether a field applies to the PHY configuration type of the settings.
+ * @param[in] field Field.
+ * @param[in] settings Settings.
+ * @return true if the field is in use.
+ */
+bool ws_br_agent_settings_field_applies(const ws_br_agent_settings_field_t * const field,
+                                        const ws_br_agent_settings_t * const settings);
+
+/**
+ * @brief Get an integer field (UINT, INT, BOOL or ENUM).
+ * @param[in] field Field.
+ * @param[in] settings Settings.
+ * @param[out] value Value.
+ * @return WS_BR_AGENT_RET_OK on success, WS_BR_AGENT_RET_ERR if the field is not an integer.
+ */
+ws_br_agent_ret_t ws_br_agent_settings_get_int(const ws_br_agent_settings_field_t * const field,
+                                               const ws_br_agent_settings_t * const settings,
+                                               int64_t * const value);
+
+/**
+ * @brief Set an integer field (UINT, INT, BOOL or ENUM), the value is range checked.
+ * @param[in] field Field.
+ * @param[in,out] settings Settings.
+ * @param[in] value Value.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_settings_set_int(const ws_br_agent_settings_field_t * const field,
+                                               ws_br_agent_settings_t * const settings,
+                                               int64_t value);
+
+/**
+ * @brief Set a field from its text form (configuration file syntax).
+ * @param[in] field Field.
+ * @param[in,out] settings Settings, unchanged on error.
+ * @param[in] value Text value.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_settings_set_str(const ws_br_agent_settings_field_t * const field,
+                                               ws_br_agent_settings_t * const settings,
+                                               const char *value);
+
+/**
+ * @brief Format a field in its text form.
+ * @param[in] field Field.
+ * @param[in] settings Settings.
+ * @param[out] buf Output buffer, WS_BR_AGENT_SETTINGS_FIELD_TEXT_MAX_SIZE bytes are always enough.
+ * @param[in] size Output buffer size.
+ * @return Output buffer.
+ */
+const char *ws_br_agent_settings_format(const ws_br_agent_settings_field_t * const field,
+                                        const ws_br_agent_settings_t * const settings,
+                                        char * const buf, size_t size);
+
+/// TLV settings encoding magic, first bytes of the payload (a legacy payload starts with the network name)
+#define WS_BR_AGENT_SETTINGS_TLV_MAGIC 0x00544C56U
+/// TLV settings encoding version
+#define WS_BR_AGENT_SETTINGS_TLV_VERSION 1U
+/// TLV settings header size: magic (4), version (1), reserved (1), field count (2)
+#define WS_BR_AGENT_SETTINGS_TLV_HDR_SIZE 8U
+/// TLV settings field header size: tag (2), value length (2)
+#define WS_BR_AGENT_SETTINGS_TLV_FIELD_HDR_SIZE 4U
+/// TLV settings maximum size, all the fields encoded
+#define WS_BR_AGENT_SETTINGS_TLV_MAX_SIZE                                                  \
+  (WS_BR_AGENT_SETTINGS_TLV_HDR_SIZE                                                       \
+   + WS_BR_AGENT_SETTINGS_FIELD_MAX * WS_BR_AGENT_SETTINGS_TLV_FIELD_HDR_SIZE              \
+   + sizeof(ws_br_agent_settings_t))
+
+/**
+ * @brief Check whether a settings payload uses the TLV encoding.
+ * @param[in] buf Payload.
+ * @param[in] len Payload length.
+ * @return true if the payload starts with a TLV header.
+ */
+bool ws_br_agent_settings_tlv_detect(const uint8_t * const buf, size_t len);
+
+/**
+ * @brief Encode settings fields in the TLV encoding.
+ * @details Big endian header then one (tag, length, value) per field, all big endian and byte
+ *          aligned. Integers take the field size, strings are not NUL terminated.
+ * @param[in] settings Settings.
+ * @param[in] fields Fields to encode, NULL for all the fields in use by the PHY configuration type.
+ * @param[in] count Number of fields (ignored if fields is NULL).
+ * @param[out] buf Output buffer, WS_BR_AGENT_SETTINGS_TLV_MAX_SIZE bytes are always enough.
+ * @param[in] size Output buffer size.
+ * @param[out] len Encoded length.
+ * @return WS_BR_AGENT_RET_OK on success, WS_BR_AGENT_RET_ERR if the buffer is too small.
+ */
+ws_br_agent_ret_t ws_br_agent_settings_tlv_encode(const ws_br_agent_settings_t * const settings,
+                                                  const ws_br_agent_settings_field_t * const fields[],
+                                                  size_t count, uint8_t * const buf, size_t size,
+                                                  size_t * const len);
+
+/**
+ * @brief Decode a TLV encoded payload onto settings.
+ * @details Only the fields present are applied (partial update). The whole payload is checked
+ *          first: any truncated, malformed or out of range field rejects it. Unknown tags are
+ *          skipped for forward compatibility.
+ * @param[in] buf Payload.
+ * @param[in] len Payload length.
+ * @param[in,out] settings Settings, unchanged on error.
+ * @param[out] field_count Number of fields applied (may be NULL).
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_settings_tlv_decode(const uint8_t * const buf, size_t len,
+                                                  ws_br_agent_settings_t * const settings,
+                                                  size_t * const field_count);
+
 /**
  * @brief Load configuration from a file.
  * @param[in] conf_file Path to the configuration file.
  * @param[out] settings Pointer to settings structure to be filled.
+ * @param[out] invalid_lines Number of lines that failed to parse (may be NULL).
  * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
  */
 ws_br_agent_ret_t ws_br_agent_settings_load_config(const char * conf_file, 
-                                                   ws_br_agent_settings_t *settings);
+                                                   ws_br_agent_settings_t *settings,
+                                                   size_t * const invalid_lines);
+
+/// Maximum configuration line size, including the terminating NUL
+#define WS_BR_AGENT_SETTINGS_LINE_MAX_SIZE 512U
+
+/**
+ * @brief Parse a single configuration line ("key = value", comments and blank lines are ignored).
+ * @details Lines are tokenized in place on the stack and keys are resolved through the
+ *          hashed field table, longer lines are truncated to WS_BR_AGENT_SETTINGS_LINE_MAX_SIZE - 1
+ *          characters. Fields of another PHY configuration type are ignored.
+ * @param[in] line Configuration line.
+ * @param[in,out] settings Pointer to settings structure to be updated.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_settings_parse_line(const char *line, ws_br_agent_settings_t *settings);
 
 #ifdef __cplusplus
 }
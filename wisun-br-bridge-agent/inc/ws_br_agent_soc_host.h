@@ -31,14 +31,21 @@
 #ifndef WS_BR_AGENT_CLNT_H
 #define WS_BR_AGENT_CLNT_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <netinet/in.h>
 
 #include "ws_br_agent_msg.h"
+#include "ws_br_agent_trace.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/// Primary SoC shard: the first SoC to connect, or the one given by --soc or the state file.
+/// The functions without a shard argument operate on it.
+#define WS_BR_AGENT_SOC_HOST_PRIMARY 0U
+
 /// @brief Wi-SUN SoC Border Router host information
 typedef struct ws_br_agent_soc_host {
   /// @brief Local IPv6 address string
@@ -63,7 +70,7 @@ ws_br_agent_soc_host_topology_entry {
 /// @brief Topology information
 typedef struct ws_br_agent_soc_host_topology {
   /// @brief Number of entries
-  uint8_t entry_count;
+  uint32_t entry_count;
   /// @brief Pointer to the entries (dynamically allocated, NULL if entry_count is 0)
   ws_br_agent_soc_host_topology_entry_t *entries;
 } ws_br_agent_soc_host_topology_t;
@@ -74,9 +81,33 @@ typedef ws_br_agent_ret_t (*ws_br_agent_soc_host_process_resp_cb_t)
 
 /**
  * @brief Initialize the Wi-SUN SoC Border Router Agent client module.
+ * @details A SoC beyond max_count is refused, its tables would not fit in the memory pools.
+ * @param[in] max_count Maximum number of SoCs, 1 to WS_BR_AGENT_SOC_HOST_MAX_COUNT
  * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
  */
-ws_br_agent_ret_t ws_br_agent_soc_host_init(void);
+ws_br_agent_ret_t ws_br_agent_soc_host_init(size_t max_count);
+
+/**
+ * @brief Find the shard of a SoC by its address.
+ * @details Lookups only take a shared lock. The first SoC takes the primary shard over,
+ *          the next ones get a new shard with default settings.
+ * @param[in] addr SoC IPv6 address.
+ * @param[in] create True to add the SoC if it is not known yet.
+ * @param[out] shard Shard index.
+ * @param[out] created Optional, set to true if a new shard was added. Can be NULL.
+ * @return WS_BR_AGENT_RET_OK on success, error code if not found or the table is full.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_lookup(const struct in6_addr * const addr,
+                                                    bool create,
+                                                    size_t * const shard,
+                                                    bool * const created);
+
+/**
+ * @brief Get the number of shards in use.
+ * @details Shards are never removed, indexes below the count are valid.
+ * @return Shard count, at least 1 (primary shard).
+ */
+size_t ws_br_agent_soc_host_shard_count(void);
 
 /**
  * @brief Send a request message to the SoC and optionally process the response.
@@ -88,6 +119,19 @@ ws_br_agent_ret_t ws_br_agent_soc_host_init(void);
 ws_br_agent_ret_t ws_br_agent_soc_host_send_req(const ws_br_agent_msg_t * const req_msg, 
                                                 ws_br_agent_soc_host_process_resp_cb_t resp_cb);
 
+/**
+ * @brief Send a request message to the SoC of a shard.
+ * @details A SET_CONFIG_PARAMS request without payload carries the settings of this SoC,
+ *          in the encoding negotiated with it.
+ * @param[in] shard Shard index.
+ * @param[in] req_msg Pointer to the request message structure.
+ * @param[in] resp_cb Optional callback function to process the response message. Can be NULL.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_send_req(size_t shard,
+                                                      const ws_br_agent_msg_t * const req_msg, 
+                                                      ws_br_agent_soc_host_process_resp_cb_t resp_cb);
+
 /**
  * @brief Set the SoC host address and optionally the settings.
  * @details If settings is NULL, default settings will be used.
@@ -107,8 +151,18 @@ ws_br_agent_ret_t ws_br_agent_soc_host_set(const char *addr,
  */
 ws_br_agent_ret_t ws_br_agent_soc_host_get(ws_br_agent_soc_host_t * const dst_host);
 
+/**
+ * @brief Get the host information of a shard.
+ * @param[in] shard Shard index.
+ * @param[out] dst_host Pointer to the destination host structure to fill.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_get(size_t shard,
+                                                 ws_br_agent_soc_host_t * const dst_host);
+
 /**
  * @brief Set the remote IPv6 address of the SoC host.
+ * @details Binds the primary shard to this SoC.
  * @param[in] addr Pointer to the IPv6 address structure to set.
  * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
  */
@@ -130,9 +184,23 @@ const ws_br_agent_settings_t *ws_br_agent_soc_host_get_default_settings(void);
 /**
  * @brief Set the current settings for the SoC host.
  * @param[in] settings Pointer to the settings structure to set.
+ * @param[in,out] trace Optional update trace, stamped with the store and diff stages
+ *                      and flagged if the settings changed. Can be NULL.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_set_settings(const ws_br_agent_settings_t * const settings,
+                                                    ws_br_agent_trace_t * const trace);
+
+/**
+ * @brief Set the current settings of a shard.
+ * @param[in] shard Shard index.
+ * @param[in] settings Pointer to the settings structure to set.
+ * @param[in,out] trace Optional update trace, see ws_br_agent_soc_host_set_settings().
  * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
  */
-ws_br_agent_ret_t ws_br_agent_soc_host_set_settings(const ws_br_agent_settings_t * const settings);
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_set_settings(size_t shard,
+                                                          const ws_br_agent_settings_t * const settings,
+                                                          ws_br_agent_trace_t * const trace);
 
 /**
  * @brief Get the current settings for the SoC host.
@@ -141,20 +209,205 @@ ws_br_agent_ret_t ws_br_agent_soc_host_set_settings(const ws_br_agent_settings_t
  */
 ws_br_agent_ret_t ws_br_agent_soc_host_get_settings(ws_br_agent_settings_t * const settings);
 
+/**
+ * @brief Get the current settings of a shard.
+ * @param[in] shard Shard index.
+ * @param[out] settings Pointer to the settings structure to fill.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_get_settings(size_t shard,
+                                                          ws_br_agent_settings_t * const settings);
+
+/**
+ * @brief Get a single settings field of a shard.
+ * @details Only the field and the PHY configuration type are copied to the settings structure.
+ * @param[in] shard Shard index.
+ * @param[in] field Settings field.
+ * @param[out] settings Pointer to the settings structure to fill.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_get_setting(size_t shard,
+                                                         const ws_br_agent_settings_field_t * const field,
+                                                         ws_br_agent_settings_t * const settings);
+
+/**
+ * @brief Set a single settings field of a shard.
+ * @param[in] shard Shard index.
+ * @param[in] field Settings field.
+ * @param[in] settings Settings structure holding the new field value.
+ * @param[out] changed Set to true if the value changed (may be NULL).
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_set_setting(size_t shard,
+                                                         const ws_br_agent_settings_field_t * const field,
+                                                         const ws_br_agent_settings_t * const settings,
+                                                         bool * const changed);
+
+/**
+ * @brief Apply TLV encoded settings to a shard, only the fields present are updated.
+ * @param[in] shard Shard index.
+ * @param[in] buf TLV payload.
+ * @param[in] len TLV payload length.
+ * @param[in,out] trace Update trace, its changed flag is set (may be NULL).
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise (settings unchanged).
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_update_settings_tlv(size_t shard,
+                                                                 const uint8_t * const buf, size_t len,
+                                                                 ws_br_agent_trace_t * const trace);
+
+/**
+ * @brief Set the settings encoding negotiated with the SoC of a shard.
+ * @param[in] shard Shard index.
+ * @param[in] enc Settings encoding used by the SoC.
+ */
+void ws_br_agent_soc_host_shard_set_settings_enc(size_t shard, ws_br_agent_msg_settings_enc_t enc);
+
+/**
+ * @brief Get the settings encoding negotiated with the SoC of a shard.
+ * @param[in] shard Shard index.
+ * @return Settings encoding, legacy until the SoC selects the TLV encoding.
+ */
+ws_br_agent_msg_settings_enc_t ws_br_agent_soc_host_shard_get_settings_enc(size_t shard);
+
+/**
+ * @brief Set whether the SoC of a shard sends frames with a CRC32C trailer.
+ * @details Follows the last frame received from the SoC, the requests to it do the same.
+ * @param[in] shard Shard index.
+ * @param[in] crc CRC32C trailer in use.
+ */
+void ws_br_agent_soc_host_shard_set_crc(size_t shard, bool crc);
+
+/**
+ * @brief Get whether the SoC of a shard sends frames with a CRC32C trailer.
+ * @param[in] shard Shard index.
+ * @return true if the requests to the SoC carry a CRC32C trailer.
+ */
+bool ws_br_agent_soc_host_shard_get_crc(size_t shard);
+
+/**
+ * @brief Encode the settings of a shard as SET_CONFIG_PARAMS payload.
+ * @param[in] shard Shard index.
+ * @param[in] enc Settings encoding.
+ * @param[in] fields TLV encoding: fields to encode, NULL for all the fields in use. 
+ *                   The legacy encoding always carries all the settings.
+ * @param[in] count Number of fields.
+ * @param[out] buf Output buffer, WS_BR_AGENT_SETTINGS_TLV_MAX_SIZE bytes are always enough.
+ * @param[in] size Output buffer size.
+ * @param[out] len Payload length.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_encode_settings(size_t shard,
+                                                             ws_br_agent_msg_settings_enc_t enc,
+                                                             const ws_br_agent_settings_field_t * const fields[],
+                                                             size_t count, uint8_t * const buf,
+                                                             size_t size, size_t * const len);
+
+/**
+ * @brief Push settings fields to the SoC of a shard (SET_CONFIG_PARAMS).
+ * @details A SoC using the TLV encoding only receives the given fields, a legacy SoC all the settings.
+ * @param[in] shard Shard index.
+ * @param[in] fields Changed fields.
+ * @param[in] count Number of fields.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_push_settings(size_t shard,
+                                                           const ws_br_agent_settings_field_t * const fields[],
+                                                           size_t count);
+
 /**
  * @brief Set the current topology information for the SoC host.
  * @param[in] topology Pointer to the topology structure to set.
+ * @param[in,out] trace Optional update trace, stamped with the store and diff stages
+ *                      and flagged if the topology changed. Can be NULL.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_set_topology(const ws_br_agent_soc_host_topology_t *topology,
+                                                    ws_br_agent_trace_t * const trace);
+
+/**
+ * @brief Set the current topology information of a shard.
+ * @param[in] shard Shard index.
+ * @param[in] topology Pointer to the topology structure to set.
+ * @param[in,out] trace Optional update trace, see ws_br_agent_soc_host_set_topology().
  * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
  */
-ws_br_agent_ret_t ws_br_agent_soc_host_set_topology(const ws_br_agent_soc_host_topology_t *topology);
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_set_topology(size_t shard,
+                                                          const ws_br_agent_soc_host_topology_t *topology,
+                                                          ws_br_agent_trace_t * const trace);
 
 /**
  * @brief Get the current topology information for the SoC host.
- * @param[out] topology Pointer to the topology structure to fill.
+ * @details Entries left by a previous call are reused when large enough.
+ * @param[in,out] topology Pointer to the topology structure to fill.
  * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
  */
 ws_br_agent_ret_t ws_br_agent_soc_host_get_topology(ws_br_agent_soc_host_topology_t * const topology);
 
+/**
+ * @brief Get the current topology information of a shard.
+ * @param[in] shard Shard index.
+ * @param[in,out] topology Pointer to the topology structure to fill.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_get_topology(size_t shard,
+                                                          ws_br_agent_soc_host_topology_t * const topology);
+
+/// Node lifecycle, see ws_br_agent_lifecycle.h
+struct ws_br_agent_lifecycle_node;
+
+/**
+ * @brief Get the lifecycle of a node of a shard.
+ * @param[in] shard Shard index.
+ * @param[in] addr Node target address.
+ * @param[out] node Node lifecycle.
+ * @return WS_BR_AGENT_RET_OK on success, error code if the node was never seen.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_get_lifecycle(size_t shard, const uint8_t addr[16],
+                                                           struct ws_br_agent_lifecycle_node * const node);
+
+/**
+ * @brief Walk the node lifecycles of a shard, under the shard lock.
+ * @param[in] shard Shard index.
+ * @param[in] cb Callback, returns a negative value to stop.
+ * @param[in] ctx Callback context.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_foreach_lifecycle(size_t shard,
+                                                               int (*cb)(void *ctx,
+                                                                         const struct ws_br_agent_lifecycle_node *node),
+                                                               void *ctx);
+
+/// NODE_STATS entry and node metrics, see ws_br_agent_node_stats.h
+struct ws_br_agent_node_stats_entry;
+struct ws_br_agent_node_stats_row;
+
+/**
+ * @brief Store the node metrics pushed by a SoC.
+ * @param[in] shard Shard index.
+ * @param[in] entries NODE_STATS entries.
+ * @param[in] count Number of entries.
+ * @param[out] unknown Number of entries whose target is not in the topology.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_set_node_stats(size_t shard,
+                                                            const struct ws_br_agent_node_stats_entry *entries,
+                                                            uint32_t count, uint32_t * const unknown);
+
+/**
+ * @brief Walk the node metrics of a shard in topology order, under the shard lock.
+ * @param[in] shard Shard index.
+ * @param[in] first First topology entry index.
+ * @param[in] count Number of entries to walk, 0 for all.
+ * @param[in] cb Callback, returns a negative value to stop.
+ * @param[in] ctx Callback context.
+ * @param[out] node_count Optional topology entry count.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_foreach_node_stats(size_t shard, uint32_t first, uint32_t count,
+                                                                int (*cb)(void *ctx,
+                                                                          const struct ws_br_agent_node_stats_row *row),
+                                                                void *ctx, uint32_t * const node_count);
+
 /**
  * @brief Free memory allocated for topology entries.
  * @param[in,out] topology Pointer to the topology structure whose entries will be freed.
@@ -162,6 +415,35 @@ ws_br_agent_ret_t ws_br_agent_soc_host_get_topology(ws_br_agent_soc_host_topolog
  */
 ws_br_agent_ret_t ws_br_agent_soc_host_free_topology(ws_br_agent_soc_host_topology_t * const topology);
 
+/**
+ * @brief Flag the host data as stale or fresh.
+ * @details Data restored from a previous run is stale until the SoC pushes fresh data.
+ * @param[in] stale True if the host data is stale.
+ * @return Previous value of the flag.
+ */
+bool ws_br_agent_soc_host_set_stale(bool stale);
+
+/**
+ * @brief Flag the data of a shard as stale or fresh.
+ * @param[in] shard Shard index.
+ * @param[in] stale True if the shard data is stale.
+ * @return Previous value of the flag.
+ */
+bool ws_br_agent_soc_host_shard_set_stale(size_t shard, bool stale);
+
+/**
+ * @brief Check if the host data is stale.
+ * @return True if the host data was restored from a previous run and not refreshed since.
+ */
+bool ws_br_agent_soc_host_is_stale(void);
+
+/**
+ * @brief Check if the data of a shard is stale.
+ * @param[in] shard Shard index.
+ * @return True if the shard data was restored from a previous run and not refreshed since.
+ */
+bool ws_br_agent_soc_host_shard_is_stale(size_t shard);
+
 /**
  * @brief Update host settings from config file
  * @param[in] config file path
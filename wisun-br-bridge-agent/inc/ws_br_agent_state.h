@@ -0,0 +1,80 @@
+/***************************************************************************//**
+ * @file ws_br_agent_state.h
+ * @brief Wi-SUN SoC Border Router Agent warm-start state persistence
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#ifndef WS_BR_AGENT_STATE_H
+#define WS_BR_AGENT_STATE_H
+
+#include "ws_br_agent_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Default state file path
+#ifndef WS_BR_AGENT_STATE_FILE_PATH
+#define WS_BR_AGENT_STATE_FILE_PATH "/var/lib/wisun-br-bridge-agent/state"
+#endif
+
+/// Minimum interval between two state file saves in ms, updates in between are coalesced
+#ifndef WS_BR_AGENT_STATE_SAVE_INTERVAL_MS
+#define WS_BR_AGENT_STATE_SAVE_INTERVAL_MS 1000U
+#endif
+
+/// State file format version, bumped on any layout change
+#define WS_BR_AGENT_STATE_VERSION 2U
+
+/**
+ * @brief Initialize the state persistence and restore the saved state.
+ * @details The address, settings and topology of each SoC saved by a previous run are
+ *          restored into the SoC host shards and flagged as stale. Must be called after the SoC host
+ *          and event loop modules init. A missing or invalid state file is not an error.
+ * @param[in] path State file path, NULL to disable the persistence.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise.
+ */
+ws_br_agent_ret_t ws_br_agent_state_init(const char *path);
+
+/**
+ * @brief Save the state, flushing a pending save, and stop the persistence.
+ */
+void ws_br_agent_state_deinit(void);
+
+/**
+ * @brief Schedule a save of the current state of all SoCs.
+ * @details The state file is written atomically out of the caller context, at most once
+ *          per WS_BR_AGENT_STATE_SAVE_INTERVAL_MS.
+ */
+void ws_br_agent_state_save_later(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_STATE_H
@@ -0,0 +1,192 @@
+/***************************************************************************//**
+ * @file ws_br_agent_topo.h
+ * @brief Struct-of-arrays topology store with interned prefixes
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#ifndef WS_BR_AGENT_TOPO_H
+#define WS_BR_AGENT_TOPO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ws_br_agent_soc_host.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// No address (unset parent, unknown node)
+#define WS_BR_AGENT_TOPO_NONE UINT32_MAX
+
+/// Maximum number of distinct /64 prefixes of a topology
+#define WS_BR_AGENT_TOPO_MAX_PREFIXES UINT16_MAX
+
+/// Node flag: target already listed by a previous entry
+#define WS_BR_AGENT_TOPO_FLAG_DUPLICATE  (0x01U)
+/// Node flag: preferred parent not listed as a target
+#define WS_BR_AGENT_TOPO_FLAG_PARENT_EXT (0x02U)
+/// Node flag: backup parent not listed as a target
+#define WS_BR_AGENT_TOPO_FLAG_BACKUP_EXT (0x04U)
+
+/// @brief Node role, derived from the parents
+typedef enum ws_br_agent_topo_role {
+  /// No preferred parent: the Border Router
+  WS_BR_AGENT_TOPO_ROLE_BR = 0,
+  /// Preferred parent of at least one node
+  WS_BR_AGENT_TOPO_ROLE_ROUTER,
+  /// No children
+  WS_BR_AGENT_TOPO_ROLE_LEAF,
+} ws_br_agent_topo_role_t;
+
+/// @brief Topology in struct-of-arrays form.
+/// @details Addresses are split into an interned /64 prefix and a 64-bit interface ID. 
+///          Addresses 0 to node_count - 1 are the node targets, in entry order, 
+///          the parents not listed as targets follow. A node takes 20 bytes instead of 48.
+///          The hash tables of the build are kept for the lookups: about 8 more bytes a node.
+///          All the columns are carved from a single block, reused by the next build when large enough.
+typedef struct ws_br_agent_topo {
+  /// @brief Number of nodes (topology entries)
+  uint32_t node_count;
+  /// @brief Number of addresses: the node targets, then the external parents
+  uint32_t addr_count;
+  /// @brief Number of interned prefixes
+  uint32_t prefix_count;
+  /// @brief Capacities of the block
+  uint32_t node_cap;
+  uint32_t addr_cap;
+  uint32_t prefix_cap;
+  /// @brief Interned /64 prefixes (address bytes 0-7, as stored)
+  uint64_t *prefixes;
+  /// @brief Interface ID of each address (address bytes 8-15, as stored)
+  uint64_t *iids;
+  /// @brief Prefix index of each address
+  uint16_t *prefix_idx;
+  /// @brief Preferred parent address index of each node, WS_BR_AGENT_TOPO_NONE if unset
+  uint32_t *parent;
+  /// @brief Backup parent address index of each node, WS_BR_AGENT_TOPO_NONE if unset
+  uint32_t *backup;
+  /// @brief Address hash table: address index + 1, 0 if empty (duplicate targets left out)
+  uint32_t *addr_slots;
+  /// @brief Prefix hash table: prefix index + 1, 0 if empty
+  uint32_t *prefix_slots;
+  /// @brief Hash table sizes - 1 (powers of two)
+  uint32_t addr_mask;
+  uint32_t prefix_mask;
+  /// @brief Role of each node (ws_br_agent_topo_role_t)
+  uint8_t *role;
+  /// @brief Flags of each node (WS_BR_AGENT_TOPO_FLAG_*)
+  uint8_t *flags;
+  /// @brief Column block
+  void *block;
+} ws_br_agent_topo_t;
+
+/**
+ * @brief Build a topology from its wire form.
+ * @details The block of the destination is reused when large enough.
+ *          Duplicate targets are logged, the first entry wins for the parent lookups.
+ * @param[in,out] topo Destination topology.
+ * @param[in] topology Wire topology, at least one entry.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise (destination emptied).
+ */
+ws_br_agent_ret_t ws_br_agent_topo_build(ws_br_agent_topo_t * const topo,
+                                         const ws_br_agent_soc_host_topology_t * const topology);
+
+/**
+ * @brief Convert a topology back to its wire form.
+ * @details Entries left by a previous call are reused when large enough.
+ * @param[in] topo Source topology.
+ * @param[in,out] topology Wire topology to fill.
+ * @return WS_BR_AGENT_RET_OK on success, error code otherwise (empty topology included).
+ */
+ws_br_agent_ret_t ws_br_agent_topo_to_wire(const ws_br_agent_topo_t * const topo,
+                                           ws_br_agent_soc_host_topology_t * const topology);
+
+/**
+ * @brief Compare two topologies.
+ * @details Builds are deterministic: equal wire topologies give equal columns.
+ * @return true if both have the same nodes, in the same order, with the same parents.
+ */
+bool ws_br_agent_topo_equal(const ws_br_agent_topo_t * const a, const ws_br_agent_topo_t * const b);
+
+/**
+ * @brief Compare a topology with a wire topology, without building it.
+ * @param[in] topo Topology.
+ * @param[in] topology Wire topology.
+ * @return true if the wire topology converts back from the topology, entry for entry.
+ */
+bool ws_br_agent_topo_match(const ws_br_agent_topo_t * const topo,
+                            const ws_br_agent_soc_host_topology_t * const topology);
+
+/**
+ * @brief List the entries of a wire topology that differ from a topology.
+ * @details Entries past the topology node count are all listed.
+ * @param[in] topo Previous topology.
+ * @param[in] topology Wire topology.
+ * @param[out] indexes Changed entry indexes, in order, room for topology->entry_count.
+ * @return Number of changed entries.
+ */
+uint32_t ws_br_agent_topo_diff(const ws_br_agent_topo_t * const topo,
+                               const ws_br_agent_soc_host_topology_t * const topology,
+                               uint32_t * const indexes);
+
+/**
+ * @brief Find a node by target address, through the hash tables of the build.
+ * @param[in] topo Topology.
+ * @param[in] addr Target address.
+ * @return Node index (first entry of a duplicate target), WS_BR_AGENT_TOPO_NONE if not found.
+ */
+uint32_t ws_br_agent_topo_find(const ws_br_agent_topo_t * const topo, const uint8_t addr[16]);
+
+/**
+ * @brief Get an address of a topology.
+ * @param[in] topo Topology.
+ * @param[in] index Address index (node index for a target), WS_BR_AGENT_TOPO_NONE gives ::.
+ * @param[out] addr Address.
+ */
+void ws_br_agent_topo_get_addr(const ws_br_agent_topo_t * const topo, uint32_t index, uint8_t addr[16]);
+
+/**
+ * @brief Get the bytes used by the columns of a topology.
+ * @param[in] topo Topology.
+ * @return Bytes used, the block capacity excluded.
+ */
+size_t ws_br_agent_topo_size(const ws_br_agent_topo_t * const topo);
+
+/**
+ * @brief Release the block of a topology and empty it.
+ * @param[in,out] topo Topology.
+ */
+void ws_br_agent_topo_free(ws_br_agent_topo_t * const topo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_TOPO_H
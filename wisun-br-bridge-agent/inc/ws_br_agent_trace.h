@@ -0,0 +1,98 @@
+/***************************************************************************//**
+ * @file ws_br_agent_trace.h
+ * @brief Update latency tracing for Wi-SUN SoC Border Router Agent
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef WS_BR_AGENT_TRACE_H
+#define WS_BR_AGENT_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ws_br_agent_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Update stages, in processing order
+typedef enum ws_br_agent_trace_stage {
+  /// Connection accepted to full message received
+  WS_BR_AGENT_TRACE_STAGE_RECV = 0,
+  /// Message parsed
+  WS_BR_AGENT_TRACE_STAGE_PARSE,
+  /// Update copied into the host storage
+  WS_BR_AGENT_TRACE_STAGE_STORE,
+  /// Update compared with the previous state
+  WS_BR_AGENT_TRACE_STAGE_DIFF,
+  /// PropertiesChanged emitted (skipped when nothing changed)
+  WS_BR_AGENT_TRACE_STAGE_EMIT,
+  /// Number of stages
+  WS_BR_AGENT_TRACE_STAGE_COUNT
+} ws_br_agent_trace_stage_t;
+
+/// @brief Trace of a TOPOLOGY or SET_CONFIG_PARAMS update
+typedef struct ws_br_agent_trace {
+  /// Trace ID (unique per agent run, never 0)
+  uint64_t id;
+  /// Message code
+  uint32_t msg_code;
+  /// Monotonic receive time in us (CLOCK_MONOTONIC)
+  uint64_t recv_us;
+  /// Monotonic end time of each stage in us (0 if the stage was skipped)
+  uint64_t stage_end_us[WS_BR_AGENT_TRACE_STAGE_COUNT];
+  /// Update changed the stored state
+  bool changed;
+} ws_br_agent_trace_t;
+
+/**
+ * @brief Start a trace.
+ * @param[out] trace Trace to start
+ * @param[in] recv_us Monotonic receive time in us
+ */
+void ws_br_agent_trace_start(ws_br_agent_trace_t * const trace, uint64_t recv_us);
+
+/**
+ * @brief Stamp the end of a stage with the current monotonic time.
+ * @param[in,out] trace Trace, can be NULL
+ * @param[in] stage Completed stage
+ */
+void ws_br_agent_trace_stamp(ws_br_agent_trace_t * const trace, ws_br_agent_trace_stage_t stage);
+
+/**
+ * @brief Finish a trace and record its stage latencies.
+ * @details Only TOPOLOGY and SET_CONFIG_PARAMS traces are recorded.
+ * @param[in] trace Trace to finish
+ */
+void ws_br_agent_trace_finish(const ws_br_agent_trace_t * const trace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WS_BR_AGENT_TRACE_H
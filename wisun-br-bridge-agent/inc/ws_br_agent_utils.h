@@ -62,6 +62,15 @@ extern const ws_br_agent_name_value_t ws_br_agent_msg_code_strs[];
 /// Wi-SUN PHY types string table
 extern const ws_br_agent_name_value_t ws_br_agent_phy_type_strs[];
 
+/// Wi-SUN PHY configuration type keyword table (configuration file)
+extern const ws_br_agent_name_value_t ws_br_agent_phy_config_strs[];
+
+/// Wi-SUN FAN version table (configuration file)
+extern const ws_br_agent_name_value_t ws_br_agent_fan_version_strs[];
+
+/// Wi-SUN FAN1.0 operating mode table
+extern const ws_br_agent_name_value_t ws_br_agent_op_mode_strs[];
+
 /**
  * @brief Print the application banner to standard output.
  * @details Displays version and copyright information.
@@ -115,6 +124,18 @@ ws_br_agent_ret_t ws_br_agent_utils_str_to_val(const char *str,
                                                const ws_br_agent_name_value_t table[], 
                                                int *res);
 
+/**
+ * @brief Get the monotonic clock in microseconds.
+ * @return Current CLOCK_MONOTONIC time in microseconds.
+ */
+uint64_t ws_br_agent_utils_get_monotonic_us(void);
+
+/**
+ * @brief Get the wall clock in microseconds.
+ * @return Current CLOCK_REALTIME time in microseconds since the Epoch.
+ */
+uint64_t ws_br_agent_utils_get_realtime_us(void);
+
 #if defined(__cplusplus)
 }
 #endif
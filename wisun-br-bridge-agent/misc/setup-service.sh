@@ -12,14 +12,14 @@ if [[ $EUID -ne 0 ]]; then
    exit 1
 fi
 
-# Copy service file to systemd directory
-echo "Installing systemd service file..."
-cp wisun-br-bridge-agent.service /etc/systemd/system/
+# Copy service and socket files to systemd directory
+echo "Installing systemd service and socket files..."
+cp wisun-br-bridge-agent.service wisun-br-bridge-agent.socket /etc/systemd/system/
 
 # Reload systemd and enable service
 echo "Configuring systemd service..."
 systemctl daemon-reload
-systemctl enable wisun-br-bridge-agent.service
+systemctl enable wisun-br-bridge-agent.socket wisun-br-bridge-agent.service
 
 echo "Setup complete!"
 echo ""
@@ -31,7 +31,7 @@ echo "  View logs:        sudo journalctl -u wisun-br-bridge-agent -f"
 echo "  Restart service:  sudo systemctl restart wisun-br-bridge-agent"
 echo ""
 echo "To remove the service:"
-echo "  sudo systemctl stop wisun-br-bridge-agent"
-echo "  sudo systemctl disable wisun-br-bridge-agent"
-echo "  sudo rm /etc/systemd/system/wisun-br-bridge-agent.service"
+echo "  sudo systemctl stop wisun-br-bridge-agent.socket wisun-br-bridge-agent"
+echo "  sudo systemctl disable wisun-br-bridge-agent.socket wisun-br-bridge-agent"
+echo "  sudo rm /etc/systemd/system/wisun-br-bridge-agent.service /etc/systemd/system/wisun-br-bridge-agent.socket"
 echo "  sudo systemctl daemon-reload"
\ No newline at end of file
@@ -33,7 +33,11 @@
 #include <signal.h>
 #include <unistd.h>
 #include <string.h>
+#include <errno.h>
+#include <pthread.h>
 #include <arpa/inet.h>
+#include <poll.h>
+#include <sys/signalfd.h>
 
 #include "ws_br_agent_defs.h"
 #include "ws_br_agent_log.h"
@@ -41,14 +45,32 @@
 #include "ws_br_agent_srv.h"
 #include "ws_br_agent_utils.h"
 #include "ws_br_agent_dbus.h"
+#include "ws_br_agent_capture.h"
+#include "ws_br_agent_metrics.h"
+#include "ws_br_agent_mem.h"
+#include "ws_br_agent_event.h"
+#include "ws_br_agent_service.h"
+#include "ws_br_agent_state.h"
+#include "ws_br_agent_history.h"
+#include "ws_br_agent_config.h"
 
-const char *soc_host_addr = NULL;
-static void sigint_hnd(int signum);
-static volatile sig_atomic_t main_thread_stop = 0;
+static int main_open_signalfd(void);
+static void main_wait_signal(int signal_fd);
+static void main_stop(void);
 
 int main(int argc, char *argv[])
 {
   const char *conf_file_path = NULL;
+  const char *capture_file_path = NULL;
+  const char *metrics_endpoint = NULL;
+  const char *state_file_path = WS_BR_AGENT_STATE_FILE_PATH;
+  const char *history_file_path = NULL;
+  size_t mem_budget = 0U;
+  size_t history_size = WS_BR_AGENT_HISTORY_SIZE;
+  size_t max_socs = WS_BR_AGENT_SOC_HOST_MAX_COUNT;
+  char *end_ptr = NULL;
+  bool mem_pool_mode = false;
+  bool event_loop = false;
   ws_br_agent_msg_t msg = { 0U };
   ws_br_agent_settings_t settings = { 0U };
 
@@ -57,24 +79,78 @@ int main(int argc, char *argv[])
     .sin6_port = htons(WS_BR_AGENT_SOC_PORT)
   };
   
-  struct sigaction sa;
-  int opt;
+  int signal_fd = -1;
 
   // Parse arguments
   for (int i = 1; i < argc; ++i) {
-    if (!strcmp(argv[i], "--log")
-        || !strcmp(argv[i], "-l") && (i + 1 < argc)) {
+    if ((!strcmp(argv[i], "--log")
+         || !strcmp(argv[i], "-l")) && (i + 1 < argc)) {
       ws_br_agent_log_file_path = argv[i + 1];
       ++i;
     }
-    else if (!strcmp(argv[i], "--config")
-             || !strcmp(argv[i], "-c") && (i + 1 < argc)) {
+    else if (!strcmp(argv[i], "--log-sinks") && (i + 1 < argc)) {
+      if (ws_br_agent_log_parse_sinks(argv[i + 1], &ws_br_agent_log_sinks) != WS_BR_AGENT_RET_OK) {
+        printf("Invalid log sinks: %s\n", argv[i + 1]);
+        ws_br_agent_utils_print_help();
+        exit(EXIT_FAILURE);
+      }
+      ++i;
+    }
+    else if (!strcmp(argv[i], "--capture") && (i + 1 < argc)) {
+      capture_file_path = argv[i + 1];
+      ++i;
+    }
+    else if (!strcmp(argv[i], "--metrics") && (i + 1 < argc)) {
+      metrics_endpoint = argv[i + 1];
+      ++i;
+    }
+    else if (!strcmp(argv[i], "--mem-budget") && (i + 1 < argc)) {
+      if (ws_br_agent_mem_parse_size(argv[i + 1], &mem_budget) != WS_BR_AGENT_RET_OK) {
+        printf("Invalid memory budget: %s\n", argv[i + 1]);
+        ws_br_agent_utils_print_help();
+        exit(EXIT_FAILURE);
+      }
+      ++i;
+    }
+    else if (!strcmp(argv[i], "--mem-pool")) {
+      mem_pool_mode = true;
+    }
+    else if (!strcmp(argv[i], "--max-socs") && (i + 1 < argc)) {
+      max_socs = strtoul(argv[i + 1], &end_ptr, 10);
+      if (*end_ptr || !max_socs || max_socs > WS_BR_AGENT_SOC_HOST_MAX_COUNT) {
+        printf("Invalid SoC count: %s (1 to %u)\n", argv[i + 1], WS_BR_AGENT_SOC_HOST_MAX_COUNT);
+        ws_br_agent_utils_print_help();
+        exit(EXIT_FAILURE);
+      }
+      ++i;
+    }
+    else if (!strcmp(argv[i], "--event-loop")) {
+      event_loop = true;
+    }
+    else if (!strcmp(argv[i], "--state") && (i + 1 < argc)) {
+      state_file_path = strcmp(argv[i + 1], "none") ? argv[i + 1] : NULL;
+      ++i;
+    }
+    else if (!strcmp(argv[i], "--history") && (i + 1 < argc)) {
+      if (ws_br_agent_mem_parse_size(argv[i + 1], &history_size) != WS_BR_AGENT_RET_OK) {
+        printf("Invalid history size: %s\n", argv[i + 1]);
+        ws_br_agent_utils_print_help();
+        exit(EXIT_FAILURE);
+      }
+      ++i;
+    }
+    else if (!strcmp(argv[i], "--history-file") && (i + 1 < argc)) {
+      history_file_path = argv[i + 1];
+      ++i;
+    }
+    else if ((!strcmp(argv[i], "--config")
+              || !strcmp(argv[i], "-c")) && (i + 1 < argc)) {
       // parse settings
       conf_file_path = argv[i + 1];
       ++i;
     }
-    else if (!strcmp(argv[i], "--soc") ||
-              !strcmp(argv[i], "-s") && (i + 1 < argc)) {
+    else if ((!strcmp(argv[i], "--soc") ||
+              !strcmp(argv[i], "-s")) && (i + 1 < argc)) {
         // set SoC device path
         soc_host_addr = strdup(argv[i + 1]);
         ++i;
@@ -99,19 +175,51 @@ int main(int argc, char *argv[])
   ws_br_agent_utils_print_app_banner();
 
   assert(ws_br_agent_log_init() == WS_BR_AGENT_RET_OK);
-  assert(ws_br_agent_soc_host_init() == WS_BR_AGENT_RET_OK);
-  assert(ws_br_agent_srv_init() == WS_BR_AGENT_RET_OK);
-  assert(ws_br_agent_dbus_init() == WS_BR_AGENT_RET_OK);
-  
-  sa.sa_handler = sigint_hnd;
-  sigemptyset(&sa.sa_mask);
-  sa.sa_flags = 0;
-  sigaction(SIGINT, &sa, NULL);
+  if (ws_br_agent_mem_init(mem_budget, mem_pool_mode, max_socs) != WS_BR_AGENT_RET_OK) {
+    return EXIT_FAILURE;
+  }
+  if (ws_br_agent_service_init() != WS_BR_AGENT_RET_OK) {
+    return EXIT_FAILURE;
+  }
+  // The event loop must exist before the modules attach their sources to it.
+  // Without it, termination signals are blocked before the module threads inherit
+  // the signal mask, and read from a signalfd by the main thread.
+  if (event_loop && ws_br_agent_event_init() != WS_BR_AGENT_RET_OK) {
+    return EXIT_FAILURE;
+  } else if (!event_loop && (signal_fd = main_open_signalfd()) < 0) {
+    return EXIT_FAILURE;
+  }
+  if (capture_file_path != NULL) {
+    if (ws_br_agent_capture_open(capture_file_path) != WS_BR_AGENT_RET_OK) {
+      ws_br_agent_log_error("Failed to start capture: %s\n", capture_file_path);
+      return EXIT_FAILURE;
+    }
+  }
+  if (metrics_endpoint != NULL) {
+    if (ws_br_agent_metrics_init(metrics_endpoint) != WS_BR_AGENT_RET_OK) {
+      ws_br_agent_log_error("Failed to start metrics endpoint: %s\n", metrics_endpoint);
+      return EXIT_FAILURE;
+    }
+  }
+  assert(ws_br_agent_soc_host_init(max_socs) == WS_BR_AGENT_RET_OK);
+  // Last known state first, the configuration file settings take precedence
+  if (ws_br_agent_state_init(state_file_path) != WS_BR_AGENT_RET_OK) {
+    return EXIT_FAILURE;
+  }
+  // Restored topologies are the base of the first recorded versions
+  if (ws_br_agent_history_init(history_size, history_file_path) != WS_BR_AGENT_RET_OK) {
+    return EXIT_FAILURE;
+  }
 
-  if (conf_file_path != NULL) {
-    ws_br_agent_soc_host_update_settings(conf_file_path);
+  // Settings are loaded before the first client can be served
+  if (ws_br_agent_config_init(conf_file_path) != WS_BR_AGENT_RET_OK) {
+    return EXIT_FAILURE;
   }
 
+  // D-Bus first: a push queued by socket activation is served as soon as the server starts
+  assert(ws_br_agent_dbus_init() == WS_BR_AGENT_RET_OK);
+  assert(ws_br_agent_srv_init() == WS_BR_AGENT_RET_OK);
+
   if (soc_host_addr != NULL) {
     if (inet_pton(AF_INET6, soc_host_addr, &new_addr.sin6_addr) != 1) {
       ws_br_agent_log_error("Invalid SoC Host IPv6 address: %s\n", soc_host_addr);
@@ -123,7 +231,13 @@ int main(int argc, char *argv[])
       return EXIT_FAILURE;
     }
     ws_br_agent_log_info("Set SoC Host remote address: %s\n", soc_host_addr);
-    free((void *) soc_host_addr);
+  }
+
+  // D-Bus name acquired and settings loaded: ready before the first SoC push,
+  // which may wait for an unreachable SoC up to the request timeout
+  ws_br_agent_service_notify_ready();
+
+  if (soc_host_addr != NULL) {
     (void) ws_br_agent_soc_host_get_settings(&settings);
 
     msg.msg_code = WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS;
@@ -132,21 +246,83 @@ int main(int argc, char *argv[])
     if (ws_br_agent_soc_host_send_req(&msg, NULL) != WS_BR_AGENT_RET_OK) {
       ws_br_agent_log_warn("Failed to send SoC Host request\n");
     }
+    free((void *) soc_host_addr);
   }
 
-  while (!main_thread_stop) {
-    usleep(100000UL);
+  if (event_loop) {
+    (void) ws_br_agent_event_run();
+    main_stop();
+    ws_br_agent_event_deinit();
+    return EXIT_SUCCESS;
   }
 
+  main_wait_signal(signal_fd);
+  main_stop();
+  close(signal_fd);
+
   return EXIT_SUCCESS;
 }
 
-static void sigint_hnd(int signum)
+static int main_open_signalfd(void)
+{
+  sigset_t mask;
+  int fd = -1;
+
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  sigaddset(&mask, SIGHUP);
+  if (pthread_sigmask(SIG_BLOCK, &mask, NULL) != 0) {
+    ws_br_agent_log_error("Failed to block the termination signals\n");
+    return -1;
+  }
+  fd = signalfd(-1, &mask, SFD_CLOEXEC);
+  if (fd < 0) {
+    ws_br_agent_log_error("Failed to create the signalfd: %s\n", strerror(errno));
+  }
+  return fd;
+}
+
+static void main_wait_signal(int signal_fd)
+{
+  struct signalfd_siginfo si;
+  struct pollfd pfd = { .fd = signal_fd, .events = POLLIN };
+  ssize_t r = 0;
+
+  // Ping the watchdog on behalf of the module threads until a termination signal,
+  // SIGHUP reloads the configuration file
+  for (;;) {
+    r = poll(&pfd, 1U, ws_br_agent_service_watchdog_interval_ms());
+    if (r > 0) {
+      r = read(signal_fd, &si, sizeof(si));
+      if (r == (ssize_t)sizeof(si) && si.ssi_signo == SIGHUP) {
+        ws_br_agent_log_info("Received SIGHUP\n");
+        (void) ws_br_agent_config_reload();
+        continue;
+      }
+      break;
+    }
+    if (r < 0 && errno != EINTR) {
+      break;
+    }
+    ws_br_agent_service_watchdog_check();
+  }
+
+  if (r == (ssize_t)sizeof(si)) {
+    ws_br_agent_log_info("Received %s\n", si.ssi_signo == SIGTERM ? "SIGTERM" : "SIGINT");
+  }
+}
+
+static void main_stop(void)
 {
-  (void) signum;
+  ws_br_agent_service_notify_stopping();
+  ws_br_agent_config_deinit();
   ws_br_agent_srv_deinit();
+  ws_br_agent_state_deinit();
   ws_br_agent_dbus_deinit();
+  ws_br_agent_history_deinit();
+  ws_br_agent_capture_close();
+  ws_br_agent_metrics_deinit();
   ws_br_agent_log_warn("Stop application...\n");
   ws_br_agent_log_deinit();
-  main_thread_stop = 1;
 }
\ No newline at end of file
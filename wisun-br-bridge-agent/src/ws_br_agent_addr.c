@@ -0,0 +1,203 @@
+/***************************************************************************//**
+ * @file ws_br_agent_addr.c
+ * @brief Vectorized IPv6 address kernels over topology entry arrays
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+
+#include <string.h>
+#include <pthread.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "addr"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_addr.h"
+
+/// Topology entry stride
+#define ENTRY_SIZE sizeof(ws_br_agent_soc_host_topology_entry_t)
+
+/// @brief Kernel implementation
+typedef struct addr_kernels {
+  const char *name;
+  size_t (*zero_bitmap)(const uint8_t *addr, size_t count, uint64_t *bitmap);
+} addr_kernels_t;
+
+static const addr_kernels_t *kernels = NULL;
+static pthread_once_t kernels_once = PTHREAD_ONCE_INIT;
+
+static inline void bitmap_set(uint64_t *bitmap, size_t i)
+{
+  bitmap[i / 64U] |= 1ULL << (i % 64U);
+}
+
+// Scalar kernel: 64-bit words
+
+/// Entries from i to count, also the tail of the vector kernels
+static size_t zero_bitmap_from(const uint8_t *addr, size_t i, size_t count, uint64_t *bitmap)
+{
+  size_t zeros = 0U;
+
+  for (; i < count; ++i, addr += ENTRY_SIZE) {
+    if (ws_br_agent_addr_is_zero(addr)) {
+      bitmap_set(bitmap, i);
+      ++zeros;
+    }
+  }
+  return zeros;
+}
+
+static size_t addr_zero_bitmap_scalar(const uint8_t *addr, size_t count, uint64_t *bitmap)
+{
+  return zero_bitmap_from(addr, 0U, count, bitmap);
+}
+
+static const addr_kernels_t scalar_kernels = {
+  "scalar", addr_zero_bitmap_scalar
+};
+
+#if defined(__x86_64__)
+
+// SSE2 kernels (x86-64 baseline): one address per register
+
+static size_t addr_zero_bitmap_sse2(const uint8_t *addr, size_t count, uint64_t *bitmap)
+{
+  const __m128i zero = _mm_setzero_si128();
+  size_t zeros = 0U;
+
+  for (size_t i = 0U; i < count; ++i, addr += ENTRY_SIZE) {
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)addr), zero)) == 0xFFFF) {
+      bitmap_set(bitmap, i);
+      ++zeros;
+    }
+  }
+  return zeros;
+}
+
+static const addr_kernels_t sse2_kernels = {
+  "sse2", addr_zero_bitmap_sse2
+};
+
+// AVX2 kernels: two addresses per register
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static inline __m256i load2_avx2(const uint8_t *lo, const uint8_t *hi)
+{
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)lo)),
+                                 _mm_loadu_si128((const __m128i *)hi), 1);
+}
+
+AVX2 static size_t addr_zero_bitmap_avx2(const uint8_t *addr, size_t count, uint64_t *bitmap)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  size_t zeros = 0U;
+  size_t i = 0U;
+  uint32_t mask = 0U;
+
+  for (; i + 2U <= count; i += 2U, addr += 2U * ENTRY_SIZE) {
+    mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(load2_avx2(addr, addr + ENTRY_SIZE), zero));
+    if ((mask & 0x0000FFFFU) == 0x0000FFFFU) {
+      bitmap_set(bitmap, i);
+      ++zeros;
+    }
+    if ((mask & 0xFFFF0000U) == 0xFFFF0000U) {
+      bitmap_set(bitmap, i + 1U);
+      ++zeros;
+    }
+  }
+  return zeros + zero_bitmap_from(addr, i, count, bitmap);
+}
+
+static const addr_kernels_t avx2_kernels = {
+  "avx2", addr_zero_bitmap_avx2
+};
+
+#elif defined(__aarch64__)
+
+// NEON kernels (AArch64 baseline): one address per register
+
+static size_t addr_zero_bitmap_neon(const uint8_t *addr, size_t count, uint64_t *bitmap)
+{
+  size_t zeros = 0U;
+
+  for (size_t i = 0U; i < count; ++i, addr += ENTRY_SIZE) {
+    if (!vmaxvq_u8(vld1q_u8(addr))) {
+      bitmap_set(bitmap, i);
+      ++zeros;
+    }
+  }
+  return zeros;
+}
+
+static const addr_kernels_t neon_kernels = {
+  "neon", addr_zero_bitmap_neon
+};
+
+#endif
+
+static void addr_kernels_init(void)
+{
+  kernels = &scalar_kernels;
+#if defined(__x86_64__)
+  kernels = __builtin_cpu_supports("avx2") ? &avx2_kernels : &sse2_kernels;
+#elif defined(__aarch64__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  kernels = &neon_kernels;
+#endif
+  ws_br_agent_log_debug("Address kernels: %s\n", kernels->name);
+}
+
+static inline const addr_kernels_t *addr_kernels(void)
+{
+  (void) pthread_once(&kernels_once, addr_kernels_init);
+  return kernels;
+}
+
+static inline const uint8_t *field_base(const ws_br_agent_soc_host_topology_entry_t *entries,
+                                        ws_br_agent_addr_field_t field)
+{
+  return (const uint8_t *)entries + (size_t)field * WS_BR_AGENT_ADDR_SIZE;
+}
+
+size_t ws_br_agent_addr_zero_bitmap(const ws_br_agent_soc_host_topology_entry_t *entries, size_t count,
+                                    ws_br_agent_addr_field_t field, uint64_t *bitmap)
+{
+  if (entries == NULL || bitmap == NULL) {
+    return 0U;
+  }
+  memset(bitmap, 0, WS_BR_AGENT_ADDR_BITMAP_WORDS(count) * sizeof(uint64_t));
+  return addr_kernels()->zero_bitmap(field_base(entries, field), count, bitmap);
+}
+
+const char *ws_br_agent_addr_impl(void)
+{
+  return addr_kernels()->name;
+}
@@ -0,0 +1,403 @@
+/***************************************************************************//**
+ * @file ws_br_agent_capture.c
+ * @brief Protocol capture for Wi-SUN SoC Border Router Agent
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <byteswap.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "capture"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_defs.h"
+#include "ws_br_agent_msg.h"
+#include "ws_br_agent_soc_host.h"
+#include "ws_br_agent_capture.h"
+
+/// pcapng block types
+#define PCAPNG_BLOCK_TYPE_SHB 0x0A0D0D0AU
+#define PCAPNG_BLOCK_TYPE_IDB 0x00000001U
+#define PCAPNG_BLOCK_TYPE_EPB 0x00000006U
+
+/// pcapng section byte order magic
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4DU
+
+/// pcapng option codes
+#define PCAPNG_OPT_ENDOFOPT     0U
+#define PCAPNG_OPT_SHB_USERAPPL 4U
+#define PCAPNG_OPT_EPB_FLAGS    2U
+
+/// Size of the fixed part of an EPB (header, fields and trailing length)
+#define PCAPNG_EPB_FIXED_SIZE 32U
+
+/// Size of the EPB options written by the agent (epb_flags + opt_endofopt)
+#define PCAPNG_EPB_OPTS_SIZE  12U
+
+/// Round up to the 32-bit pcapng alignment
+#define PCAPNG_PAD4(x) (((x) + 3U) & ~(size_t)3U)
+
+/// Room left for the options of a block written by another tool
+#define PCAPNG_MAX_OPTS_SIZE  1024U
+
+/// Largest agent frame: a full TOPOLOGY message with its CRC32C trailer
+#define CAPTURE_MAX_FRAME_SIZE \
+  (WS_BR_AGENT_MSG_MIN_BUF_SIZE \
+   + WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES * sizeof(ws_br_agent_soc_host_topology_entry_t) \
+   + WS_BR_AGENT_MSG_CRC_SIZE)
+
+/// Largest block accepted by the reader, larger ones are corrupt
+#define PCAPNG_MAX_BLOCK_SIZE \
+  (PCAPNG_EPB_FIXED_SIZE + PCAPNG_PAD4(WS_BR_AGENT_CAPTURE_PSEUDO_HDR_SIZE + CAPTURE_MAX_FRAME_SIZE) \
+   + PCAPNG_MAX_OPTS_SIZE)
+
+/// User application string stored in the section header
+#define CAPTURE_USERAPPL "wisun-br-bridge-agent " WS_BR_AGENT_VERSION
+
+static FILE *capture_file = NULL;
+static pthread_mutex_t capture_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static ws_br_agent_ret_t write_header_blocks(FILE *file);
+static inline uint32_t opt_hdr(uint16_t code, uint16_t len);
+static inline uint32_t rd32(const ws_br_agent_capture_reader_t * const reader, const uint8_t *ptr);
+static inline uint16_t rd16(const ws_br_agent_capture_reader_t * const reader, const uint8_t *ptr);
+
+ws_br_agent_ret_t ws_br_agent_capture_open(const char *path)
+{
+  FILE *file = NULL;
+
+  if (path == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  file = fopen(path, "wb");
+  if (file == NULL) {
+    ws_br_agent_log_error("Failed to open capture file: %s\n", path);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  if (write_header_blocks(file) != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_error("Failed to write capture file header: %s\n", path);
+    fclose(file);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  pthread_mutex_lock(&capture_mutex);
+  if (capture_file != NULL) {
+    fclose(capture_file);
+  }
+  capture_file = file;
+  pthread_mutex_unlock(&capture_mutex);
+
+  ws_br_agent_log_info("Capturing agent traffic to %s\n", path);
+  return WS_BR_AGENT_RET_OK;
+}
+
+void ws_br_agent_capture_close(void)
+{
+  pthread_mutex_lock(&capture_mutex);
+  if (capture_file != NULL) {
+    fclose(capture_file);
+    capture_file = NULL;
+  }
+  pthread_mutex_unlock(&capture_mutex);
+}
+
+void ws_br_agent_capture_record(ws_br_agent_capture_dir_t dir,
+                                ws_br_agent_capture_channel_t channel,
+                                const struct sockaddr_in6 * const peer,
+                                const uint8_t * const buf, size_t len)
+{
+  uint32_t hdr[7];
+  uint8_t pseudo_hdr[WS_BR_AGENT_CAPTURE_PSEUDO_HDR_SIZE] = { 0U };
+  uint32_t opts[3];
+  static const uint8_t pad[4] = { 0U };
+  struct timespec ts;
+  uint64_t timestamp_us = 0ULL;
+  size_t data_len = 0U;
+  uint32_t total_len = 0U;
+
+  // Unlocked fast path, capture is off in production
+  if (capture_file == NULL || buf == NULL) {
+    return;
+  }
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  timestamp_us = (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+
+  // Pseudo header: [peer addr 16 byte] [peer port 2 byte] [channel 1 byte] [reserved 1 byte]
+  if (peer != NULL) {
+    memcpy(pseudo_hdr, &peer->sin6_addr, sizeof(peer->sin6_addr));
+    memcpy(&pseudo_hdr[16], &peer->sin6_port, sizeof(peer->sin6_port));
+  }
+  pseudo_hdr[18] = (uint8_t)channel;
+
+  data_len = WS_BR_AGENT_CAPTURE_PSEUDO_HDR_SIZE + len;
+  total_len = (uint32_t)(PCAPNG_EPB_FIXED_SIZE + PCAPNG_PAD4(data_len) + PCAPNG_EPB_OPTS_SIZE);
+
+  hdr[0] = PCAPNG_BLOCK_TYPE_EPB;
+  hdr[1] = total_len;
+  hdr[2] = 0U; // Interface ID
+  hdr[3] = (uint32_t)(timestamp_us >> 32);
+  hdr[4] = (uint32_t)timestamp_us;
+  hdr[5] = (uint32_t)data_len;
+  hdr[6] = (uint32_t)data_len;
+
+  opts[0] = opt_hdr(PCAPNG_OPT_EPB_FLAGS, 4U);
+  opts[1] = (uint32_t)dir;
+  opts[2] = PCAPNG_OPT_ENDOFOPT;
+
+  pthread_mutex_lock(&capture_mutex);
+  if (capture_file != NULL) {
+    fwrite(hdr, sizeof(hdr), 1, capture_file);
+    fwrite(pseudo_hdr, sizeof(pseudo_hdr), 1, capture_file);
+    fwrite(buf, 1, len, capture_file);
+    fwrite(pad, 1, PCAPNG_PAD4(data_len) - data_len, capture_file);
+    fwrite(opts, sizeof(opts), 1, capture_file);
+    fwrite(&total_len, sizeof(total_len), 1, capture_file);
+    fflush(capture_file);
+  }
+  pthread_mutex_unlock(&capture_mutex);
+}
+
+ws_br_agent_ret_t ws_br_agent_capture_reader_open(ws_br_agent_capture_reader_t * const reader,
+                                                  const char *path)
+{
+  if (reader == NULL || path == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  memset(reader, 0, sizeof(ws_br_agent_capture_reader_t));
+  reader->file = fopen(path, "rb");
+  if (reader->file == NULL) {
+    ws_br_agent_log_error("Failed to open capture file: %s\n", path);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  return WS_BR_AGENT_RET_OK;
+}
+
+ws_br_agent_ret_t ws_br_agent_capture_reader_next(ws_br_agent_capture_reader_t * const reader,
+                                                  ws_br_agent_capture_record_t * const record)
+{
+  uint8_t blk_hdr[8];
+  uint32_t blk_type = 0U;
+  uint32_t blk_len = 0U;
+  uint32_t if_id = 0U;
+  uint32_t cap_len = 0U;
+  const uint8_t *opt = NULL;
+  const uint8_t *opt_end = NULL;
+  uint16_t opt_code = 0U;
+  uint16_t opt_len = 0U;
+  uint8_t *tmp = NULL;
+
+  if (reader == NULL || reader->file == NULL || record == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  for (;;) {
+    if (fread(blk_hdr, sizeof(blk_hdr), 1, reader->file) != 1) {
+      reader->eof = feof(reader->file) != 0;
+      return WS_BR_AGENT_RET_ERR;
+    }
+
+    memcpy(&blk_type, blk_hdr, sizeof(blk_type));
+    if (blk_type == PCAPNG_BLOCK_TYPE_SHB) {
+      // New section, the byte order magic follows the block length
+      uint32_t magic = 0U;
+      if (fread(&magic, sizeof(magic), 1, reader->file) != 1) {
+        return WS_BR_AGENT_RET_ERR;
+      }
+      if (magic == PCAPNG_BYTE_ORDER_MAGIC) {
+        reader->swapped = false;
+      } else if (magic == bswap_32(PCAPNG_BYTE_ORDER_MAGIC)) {
+        reader->swapped = true;
+      } else {
+        ws_br_agent_log_error("Invalid pcapng section header\n");
+        return WS_BR_AGENT_RET_ERR;
+      }
+      reader->if_count = 0U;
+      if (fseek(reader->file, -(long)sizeof(magic), SEEK_CUR) < 0) {
+        return WS_BR_AGENT_RET_ERR;
+      }
+    } else {
+      blk_type = rd32(reader, blk_hdr);
+    }
+
+    blk_len = rd32(reader, &blk_hdr[4]);
+    if (blk_len < 12U || blk_len % 4U || blk_len > PCAPNG_MAX_BLOCK_SIZE) {
+      ws_br_agent_log_error("Invalid pcapng block length (%u)\n", blk_len);
+      return WS_BR_AGENT_RET_ERR;
+    }
+
+    // Read block body (everything after type and length)
+    if (reader->buf_size < blk_len) {
+      tmp = (uint8_t *)realloc(reader->buf, blk_len);
+      if (tmp == NULL) {
+        ws_br_agent_log_error("Capture reader: Memory allocation failed\n");
+        return WS_BR_AGENT_RET_ERR;
+      }
+      reader->buf = tmp;
+      reader->buf_size = blk_len;
+    }
+    if (fread(reader->buf, blk_len - sizeof(blk_hdr), 1, reader->file) != 1) {
+      reader->eof = feof(reader->file) != 0;
+      return WS_BR_AGENT_RET_ERR;
+    }
+
+    switch (blk_type) {
+      case PCAPNG_BLOCK_TYPE_IDB:
+        if (reader->if_count < WS_BR_AGENT_CAPTURE_MAX_IF_COUNT) {
+          reader->if_linktypes[reader->if_count] = rd16(reader, reader->buf);
+        }
+        reader->if_count++;
+        break;
+
+      case PCAPNG_BLOCK_TYPE_EPB:
+        if (blk_len < PCAPNG_EPB_FIXED_SIZE) {
+          return WS_BR_AGENT_RET_ERR;
+        }
+        if_id = rd32(reader, reader->buf);
+        if (if_id >= reader->if_count || if_id >= WS_BR_AGENT_CAPTURE_MAX_IF_COUNT
+            || reader->if_linktypes[if_id] != WS_BR_AGENT_CAPTURE_LINKTYPE) {
+          break;
+        }
+        cap_len = rd32(reader, &reader->buf[12]);
+        if (cap_len < WS_BR_AGENT_CAPTURE_PSEUDO_HDR_SIZE
+            || PCAPNG_EPB_FIXED_SIZE + PCAPNG_PAD4(cap_len) > blk_len) {
+          ws_br_agent_log_error("Invalid capture record length (%u)\n", cap_len);
+          return WS_BR_AGENT_RET_ERR;
+        }
+        record->timestamp_us = ((uint64_t)rd32(reader, &reader->buf[4]) << 32)
+                               | rd32(reader, &reader->buf[8]);
+        memcpy(&record->peer_addr, &reader->buf[20], sizeof(record->peer_addr));
+        memcpy(&record->peer_port, &reader->buf[36], sizeof(record->peer_port));
+        record->peer_port = ntohs(record->peer_port);
+        record->channel = (ws_br_agent_capture_channel_t)reader->buf[38];
+        record->data = &reader->buf[20 + WS_BR_AGENT_CAPTURE_PSEUDO_HDR_SIZE];
+        record->len = cap_len - WS_BR_AGENT_CAPTURE_PSEUDO_HDR_SIZE;
+        record->dir = WS_BR_AGENT_CAPTURE_DIR_IN;
+
+        // Walk options for the direction flags
+        opt = &reader->buf[20 + PCAPNG_PAD4(cap_len)];
+        opt_end = &reader->buf[blk_len - 12U];
+        while (opt + 4 <= opt_end) {
+          opt_code = rd16(reader, opt);
+          opt_len = rd16(reader, opt + 2);
+          if (opt_code == PCAPNG_OPT_ENDOFOPT || opt + 4 + opt_len > opt_end) {
+            break;
+          }
+          if (opt_code == PCAPNG_OPT_EPB_FLAGS && opt_len == 4U) {
+            record->dir = (ws_br_agent_capture_dir_t)(rd32(reader, opt + 4) & 0x3U);
+          }
+          opt += 4 + PCAPNG_PAD4(opt_len);
+        }
+        return WS_BR_AGENT_RET_OK;
+
+      default:
+        // SHB and unknown blocks carry nothing we replay
+        break;
+    }
+  }
+}
+
+void ws_br_agent_capture_reader_close(ws_br_agent_capture_reader_t * const reader)
+{
+  if (reader == NULL) {
+    return;
+  }
+  if (reader->file != NULL) {
+    fclose(reader->file);
+  }
+  free(reader->buf);
+  memset(reader, 0, sizeof(ws_br_agent_capture_reader_t));
+}
+
+static ws_br_agent_ret_t write_header_blocks(FILE *file)
+{
+  const size_t userappl_len = sizeof(CAPTURE_USERAPPL) - 1U;
+  uint32_t shb[(36U + PCAPNG_PAD4(sizeof(CAPTURE_USERAPPL) - 1U)) / 4U] = { 0U };
+  uint32_t idb[5];
+  uint32_t *ptr = shb;
+  uint32_t shb_len = 0U;
+  int64_t section_len = -1LL;
+
+  // Section Header Block
+  shb_len = (uint32_t)(28U + 4U + PCAPNG_PAD4(userappl_len) + 4U);
+  ptr[0] = PCAPNG_BLOCK_TYPE_SHB;
+  ptr[1] = shb_len;
+  ptr[2] = PCAPNG_BYTE_ORDER_MAGIC;
+  ptr[3] = opt_hdr(1U, 0U); // Version 1.0
+  memcpy(&ptr[4], &section_len, sizeof(section_len));
+  ptr[6] = opt_hdr(PCAPNG_OPT_SHB_USERAPPL, (uint16_t)userappl_len);
+  memcpy(&ptr[7], CAPTURE_USERAPPL, userappl_len);
+  // opt_endofopt is already zeroed
+  ptr[shb_len / 4U - 1U] = shb_len;
+
+  // Interface Description Block, microsecond timestamps (default resolution)
+  idb[0] = PCAPNG_BLOCK_TYPE_IDB;
+  idb[1] = sizeof(idb);
+  idb[2] = WS_BR_AGENT_CAPTURE_LINKTYPE;
+  idb[3] = 0U; // No snap length
+  idb[4] = sizeof(idb);
+
+  if (fwrite(shb, shb_len, 1, file) != 1 || fwrite(idb, sizeof(idb), 1, file) != 1) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  fflush(file);
+
+  return WS_BR_AGENT_RET_OK;
+}
+
+static inline uint32_t opt_hdr(uint16_t code, uint16_t len)
+{
+  uint16_t hdr[2] = { code, len };
+  uint32_t val = 0U;
+
+  // Two host order 16-bit fields: code then length (also used for the SHB version)
+  memcpy(&val, hdr, sizeof(val));
+  return val;
+}
+
+static inline uint32_t rd32(const ws_br_agent_capture_reader_t * const reader, const uint8_t *ptr)
+{
+  uint32_t val = 0U;
+
+  memcpy(&val, ptr, sizeof(val));
+  return reader->swapped ? bswap_32(val) : val;
+}
+
+static inline uint16_t rd16(const ws_br_agent_capture_reader_t * const reader, const uint8_t *ptr)
+{
+  uint16_t val = 0U;
+
+  memcpy(&val, ptr, sizeof(val));
+  return reader->swapped ? bswap_16(val) : val;
+}
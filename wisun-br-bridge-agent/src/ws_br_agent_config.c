@@ -0,0 +1,285 @@
+/***************************************************************************//**
+ * @file ws_br_agent_config.c
+ * @brief Configuration file loading and hot reload
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "config"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_settings.h"
+#include "ws_br_agent_soc_host.h"
+#include "ws_br_agent_dbus.h"
+#include "ws_br_agent_metrics.h"
+#include "ws_br_agent_event.h"
+#include "ws_br_agent_service.h"
+#include "ws_br_agent_state.h"
+#include "ws_br_agent_config.h"
+
+/// Directory events replacing or rewriting a file: in place writes and editor/atomic renames
+#define CONFIG_INOTIFY_MASK (IN_CLOSE_WRITE | IN_MOVED_TO)
+
+static char config_path[256] = { 0 };
+/// File name in the watched directory
+static const char *config_name = NULL;
+/// Serializes the reloads (watcher and signal)
+static pthread_mutex_t reload_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int inotify_fd = -1;
+static pthread_t config_thr;
+static volatile sig_atomic_t config_thread_stop = 0;
+/// Wakes the watcher thread up to stop (eventfd)
+static int config_wakeup_fd = -1;
+/// inotify source (event loop mode)
+static sd_event_source *inotify_source = NULL;
+
+static ws_br_agent_ret_t config_watch(void);
+static bool config_read_events(void);
+static void config_thr_fnc(void *arg);
+static int config_inotify_hnd(sd_event_source *s, int fd, uint32_t revents, void *userdata);
+
+ws_br_agent_ret_t ws_br_agent_config_init(const char *path)
+{
+  if (path == NULL) {
+    return WS_BR_AGENT_RET_OK;
+  }
+  if (strlen(path) >= sizeof(config_path)) {
+    ws_br_agent_log_error("Config file path too long: %s\n", path);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  snprintf(config_path, sizeof(config_path), "%s", path);
+  config_name = strrchr(config_path, '/');
+  config_name = config_name != NULL ? config_name + 1 : config_path;
+
+  // Settings are loaded before the first client can be served
+  (void) ws_br_agent_soc_host_update_settings(config_path);
+
+  // A missing watch only disables the automatic reload, SIGHUP still works
+  if (config_watch() != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_warn("Config file changes are not watched, reload with SIGHUP\n");
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+void ws_br_agent_config_deinit(void)
+{
+  if (config_wakeup_fd >= 0) {
+    config_thread_stop = 1;
+    (void) eventfd_write(config_wakeup_fd, 1U);
+    pthread_join(config_thr, NULL);
+    close(config_wakeup_fd);
+    config_wakeup_fd = -1;
+  }
+  inotify_source = sd_event_source_disable_unref(inotify_source);
+  if (inotify_fd >= 0) {
+    close(inotify_fd);
+    inotify_fd = -1;
+  }
+  config_path[0] = '\0';
+}
+
+ws_br_agent_ret_t ws_br_agent_config_reload(void)
+{
+  const ws_br_agent_settings_field_t *fields = NULL;
+  const ws_br_agent_settings_field_t *changed[WS_BR_AGENT_SETTINGS_FIELD_MAX];
+  ws_br_agent_settings_t live_settings = { 0 };
+  ws_br_agent_settings_t new_settings = { 0 };
+  size_t invalid_lines = 0U;
+  size_t field_count = 0U;
+  size_t changed_count = 0U;
+
+  if (!config_path[0]) {
+    ws_br_agent_log_info("No config file to reload\n");
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  pthread_mutex_lock(&reload_mutex);
+  ws_br_agent_log_info("Reloading %s\n", config_path);
+  ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_CONFIG_RELOADS, 1U);
+
+  // The file is applied on top of the live settings, then validated as a whole
+  if (ws_br_agent_soc_host_get_settings(&live_settings) != WS_BR_AGENT_RET_OK) {
+    pthread_mutex_unlock(&reload_mutex);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  memcpy(&new_settings, &live_settings, sizeof(new_settings));
+  if (ws_br_agent_settings_load_config(config_path, &new_settings, &invalid_lines)
+      != WS_BR_AGENT_RET_OK || invalid_lines) {
+    ws_br_agent_log_error("Config file rejected (%zu invalid lines), settings unchanged\n",
+                          invalid_lines);
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_CONFIG_RELOAD_FAILURES, 1U);
+    pthread_mutex_unlock(&reload_mutex);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Field level diff, aliases of the previous field and members of another PHY type excluded
+  fields = ws_br_agent_settings_fields(&field_count);
+  for (size_t i = 0U; i < field_count; ++i) {
+    if ((i && fields[i].offset == fields[i - 1U].offset && fields[i].size == fields[i - 1U].size)
+        || !ws_br_agent_settings_field_applies(&fields[i], &new_settings)
+        || !memcmp((const uint8_t *)&live_settings + fields[i].offset,
+                   (const uint8_t *)&new_settings + fields[i].offset, fields[i].size)) {
+      continue;
+    }
+    changed[changed_count++] = &fields[i];
+    (void) ws_br_agent_soc_host_shard_set_setting(WS_BR_AGENT_SOC_HOST_PRIMARY, &fields[i],
+                                                  &new_settings, NULL);
+    ws_br_agent_log_info("Changed %s\n", fields[i].key);
+  }
+  pthread_mutex_unlock(&reload_mutex);
+
+  if (!changed_count) {
+    ws_br_agent_log_info("Config file unchanged\n");
+    return WS_BR_AGENT_RET_OK;
+  }
+
+  (void) ws_br_agent_dbus_notify_settings_fields_changed(WS_BR_AGENT_SOC_HOST_PRIMARY,
+                                                         changed, changed_count);
+  ws_br_agent_state_save_later();
+
+  // Only reached when a field in use by the SoC changed: a push restarts its border router.
+  // A SoC using the TLV settings encoding only receives the changed fields.
+  if (ws_br_agent_soc_host_shard_push_settings(WS_BR_AGENT_SOC_HOST_PRIMARY, changed, changed_count)
+      != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_warn("Failed to push the reloaded settings to the SoC\n");
+  }
+
+  return WS_BR_AGENT_RET_OK;
+}
+
+static ws_br_agent_ret_t config_watch(void)
+{
+  char dir[sizeof(config_path)];
+  sd_event *event = ws_br_agent_event_get();
+  int r = 0;
+
+  // Watch the directory: editors and package managers replace the file
+  snprintf(dir, sizeof(dir), "%.*s", (int)(config_name - config_path), config_path);
+  if (!dir[0]) {
+    snprintf(dir, sizeof(dir), ".");
+  }
+
+  inotify_fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+  if (inotify_fd < 0 || inotify_add_watch(inotify_fd, dir, CONFIG_INOTIFY_MASK) < 0) {
+    ws_br_agent_log_warn("Failed to watch %s: %s\n", dir, strerror(errno));
+    if (inotify_fd >= 0) {
+      close(inotify_fd);
+      inotify_fd = -1;
+    }
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Event loop mode: the inotify descriptor is a source of the loop
+  if (event != NULL) {
+    r = sd_event_add_io(event, &inotify_source, inotify_fd, EPOLLIN, config_inotify_hnd, NULL);
+    if (r < 0) {
+      ws_br_agent_log_warn("Failed to add the config watch source: %s\n", strerror(-r));
+      return WS_BR_AGENT_RET_ERR;
+    }
+    return WS_BR_AGENT_RET_OK;
+  }
+
+  config_wakeup_fd = eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (config_wakeup_fd < 0) {
+    ws_br_agent_log_warn("Failed to create the config wakeup event: %s\n", strerror(errno));
+    return WS_BR_AGENT_RET_ERR;
+  }
+  config_thread_stop = 0;
+  if (pthread_create(&config_thr, NULL, (void *)config_thr_fnc, NULL) != 0) {
+    ws_br_agent_log_warn("Failed to create config thread\n");
+    close(config_wakeup_fd);
+    config_wakeup_fd = -1;
+    return WS_BR_AGENT_RET_ERR;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+/// Drain the pending inotify events, true if one of them is about the config file
+static bool config_read_events(void)
+{
+  char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  const struct inotify_event *ev = NULL;
+  bool match = false;
+  ssize_t len = 0;
+
+  while ((len = read(inotify_fd, buf, sizeof(buf))) > 0) {
+    for (char *ptr = buf; ptr < buf + len; ptr += sizeof(struct inotify_event) + ev->len) {
+      ev = (const struct inotify_event *)ptr;
+      if (ev->len && !strcmp(ev->name, config_name)) {
+        match = true;
+      }
+    }
+  }
+  return match;
+}
+
+static void config_thr_fnc(void *arg)
+{
+  struct pollfd pfd[2] = {
+    { .fd = inotify_fd, .events = POLLIN },
+    { .fd = config_wakeup_fd, .events = POLLIN },
+  };
+
+  (void) arg;
+
+  ws_br_agent_service_watchdog_start(WS_BR_AGENT_SERVICE_LOOP_CONFIG);
+  while (!config_thread_stop) {
+    ws_br_agent_service_watchdog_kick(WS_BR_AGENT_SERVICE_LOOP_CONFIG);
+    if (poll(pfd, 2U, ws_br_agent_service_watchdog_interval_ms()) <= 0) {
+      continue;
+    }
+    if ((pfd[0].revents & POLLIN) && config_read_events()) {
+      (void) ws_br_agent_config_reload();
+    }
+  }
+  ws_br_agent_service_watchdog_stop(WS_BR_AGENT_SERVICE_LOOP_CONFIG);
+}
+
+static int config_inotify_hnd(sd_event_source *s, int fd, uint32_t revents, void *userdata)
+{
+  (void) s;
+  (void) fd;
+  (void) revents;
+  (void) userdata;
+
+  if (config_read_events()) {
+    (void) ws_br_agent_config_reload();
+  }
+  return 0;
+}
@@ -0,0 +1,165 @@
+/***************************************************************************//**
+ * @file ws_br_agent_crc.c
+ * @brief CRC32C frame checksum
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#include <string.h>
+#include <pthread.h>
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#include <arm_acle.h>
+#endif
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "crc"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_crc.h"
+
+/// CRC32C reflected polynomial
+#define CRC32C_POLY 0x82F63B78U
+
+typedef uint32_t (*crc32c_fnc_t)(uint32_t crc, const uint8_t *buf, size_t len);
+
+/// Slicing-by-8 tables, built on first use
+static uint32_t crc32c_table[8][256];
+static crc32c_fnc_t crc32c_fnc = NULL;
+static const char *crc32c_name = "table";
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+
+/// Unaligned little endian 64-bit load
+static inline uint64_t load_le64(const uint8_t *buf)
+{
+  uint64_t val = 0U;
+
+  memcpy(&val, buf, sizeof(val));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  val = __builtin_bswap64(val);
+#endif
+  return val;
+}
+
+static uint32_t crc32c_sw(uint32_t crc, const uint8_t *buf, size_t len)
+{
+  uint64_t word = 0U;
+
+  // 8 bytes per step (reflected CRC: the first byte is the least significant)
+  while (len >= 8U) {
+    word = load_le64(buf) ^ crc;
+    crc = crc32c_table[7][word & 0xFFU] ^ crc32c_table[6][(word >> 8) & 0xFFU]
+          ^ crc32c_table[5][(word >> 16) & 0xFFU] ^ crc32c_table[4][(word >> 24) & 0xFFU]
+          ^ crc32c_table[3][(word >> 32) & 0xFFU] ^ crc32c_table[2][(word >> 40) & 0xFFU]
+          ^ crc32c_table[1][(word >> 48) & 0xFFU] ^ crc32c_table[0][word >> 56];
+    buf += 8U;
+    len -= 8U;
+  }
+  while (len--) {
+    crc = crc32c_table[0][(crc ^ *buf++) & 0xFFU] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t *buf, size_t len)
+{
+  uint64_t crc64 = crc;
+
+  while (len >= 8U) {
+    crc64 = _mm_crc32_u64(crc64, load_le64(buf));
+    buf += 8U;
+    len -= 8U;
+  }
+  crc = (uint32_t)crc64;
+  while (len--) {
+    crc = _mm_crc32_u8(crc, *buf++);
+  }
+  return crc;
+}
+#elif defined(__aarch64__)
+__attribute__((target("+crc")))
+static uint32_t crc32c_armv8(uint32_t crc, const uint8_t *buf, size_t len)
+{
+  while (len >= 8U) {
+    crc = __crc32cd(crc, load_le64(buf));
+    buf += 8U;
+    len -= 8U;
+  }
+  while (len--) {
+    crc = __crc32cb(crc, *buf++);
+  }
+  return crc;
+}
+#endif
+
+static void crc32c_init(void)
+{
+  uint32_t crc = 0U;
+
+  for (uint32_t i = 0U; i < 256U; ++i) {
+    crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (CRC32C_POLY & (0U - (crc & 1U)));
+    }
+    crc32c_table[0][i] = crc;
+  }
+  for (uint32_t i = 0U; i < 256U; ++i) {
+    for (size_t k = 1U; k < 8U; ++k) {
+      crc32c_table[k][i] = crc32c_table[0][crc32c_table[k - 1U][i] & 0xFFU]
+                           ^ (crc32c_table[k - 1U][i] >> 8);
+    }
+  }
+
+  crc32c_fnc = crc32c_sw;
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("sse4.2")) {
+    crc32c_fnc = crc32c_sse42;
+    crc32c_name = "sse4.2";
+  }
+#elif defined(__aarch64__)
+  if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+    crc32c_fnc = crc32c_armv8;
+    crc32c_name = "armv8";
+  }
+#endif
+  ws_br_agent_log_debug("CRC32C implementation: %s\n", crc32c_name);
+}
+
+uint32_t ws_br_agent_crc32c(uint32_t crc, const void *buf, size_t len)
+{
+  (void) pthread_once(&crc32c_once, crc32c_init);
+  return ~crc32c_fnc(~crc, (const uint8_t *)buf, len);
+}
+
+const char *ws_br_agent_crc32c_impl(void)
+{
+  (void) pthread_once(&crc32c_once, crc32c_init);
+  return crc32c_name;
+}
@@ -29,16 +29,41 @@
  ******************************************************************************/
 
 #include <assert.h>
+#include <errno.h>
+#include <stddef.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 #include <systemd/sd-bus.h>
 
+#define WS_BR_AGENT_LOG_SUBSYSTEM "dbus"
 #include "ws_br_agent_dbus.h"
 #include "ws_br_agent_log.h"
 #include "ws_br_agent_utils.h"
 #include "ws_br_agent_soc_host.h"
+#include "ws_br_agent_history.h"
+#include "ws_br_agent_lifecycle.h"
+#include "ws_br_agent_node_stats.h"
+#include "ws_br_agent_addr.h"
+#include "ws_br_agent_metrics.h"
+#include "ws_br_agent_probe.h"
+#include "ws_br_agent_event.h"
+#include "ws_br_agent_service.h"
+#include "ws_br_agent_state.h"
 
 #define WS_BR_AGENT_DBUS_PATH "/com/silabs/Wisun/SocBorderRouterAgent"
+/// Per-SoC objects are WS_BR_AGENT_DBUS_SOC_PATH/<shard index>
+#define WS_BR_AGENT_DBUS_SOC_PATH WS_BR_AGENT_DBUS_PATH "/Soc"
 #define WS_BR_AGENT_DBUS_INTERFACE "com.silabs.Wisun.SocBorderRouterAgent"
 #define WS_BR_AGENT_DBUS_PROPERTY_ROUTING_GRAPH "RoutingGraph"
+#define WS_BR_AGENT_DBUS_PROPERTY_ROUTING_GRAPH_TRACE "RoutingGraphTrace"
+#define WS_BR_AGENT_DBUS_PROPERTY_SETTINGS_TRACE "SettingsTrace"
+#define WS_BR_AGENT_DBUS_PROPERTY_STALE "Stale"
+#define WS_BR_AGENT_DBUS_PROPERTY_SOC_ADDRESS "SoCAddress"
 #define WS_BR_AGENT_DBUS_PROPERTY_NETWORK_NAME "WisunNetworkName"
 #define WS_BR_AGENT_DBUS_PROPERTY_NETWORK_SIZE "WisunSize"
 #define WS_BR_AGENT_DBUS_PROPERTY_REG_DOMAIN "WisunDomain"
@@ -51,49 +76,116 @@
 #define WS_BR_AGENT_DBUS_METHOD_START_SOC_BORDER_ROUTER "RestartSoCBorderRouter"
 #define WS_BR_AGENT_DBUS_METHOD_STOP_SOC_BORDER_ROUTER "StopSoCBorderRouter"
 #define WS_BR_AGENT_DBUS_METHOD_SET_SOC_BORDER_ROUTER_CONFIG "SetSoCBorderRouterConfig"
+#define WS_BR_AGENT_DBUS_METHOD_GET_SETTING "GetSetting"
+#define WS_BR_AGENT_DBUS_METHOD_SET_SETTING "SetSetting"
+#define WS_BR_AGENT_DBUS_METHOD_GET_SETTINGS "GetSettings"
+#define WS_BR_AGENT_DBUS_METHOD_GET_ROUTING_GRAPH_AT "GetRoutingGraphAt"
+#define WS_BR_AGENT_DBUS_METHOD_GET_NODE_HISTORY "GetNodeHistory"
+#define WS_BR_AGENT_DBUS_METHOD_GET_NODE_LIFECYCLE "GetNodeLifecycle"
+#define WS_BR_AGENT_DBUS_METHOD_GET_NODE_LIFECYCLES "GetNodeLifecycles"
+#define WS_BR_AGENT_DBUS_METHOD_GET_NODE_STATS "GetNodeStats"
+/// Maximum number of settings properties
+#define DBUS_SETTINGS_PROPERTIES_MAX 16U
 
 static void dbus_thr_fnc(void *arg);
+static void dbus_wakeup(void);
 static int dbus_get_routing_graph(sd_bus *bus, const char *path, const char *interface,
                                   const char *property, sd_bus_message *reply, 
                                   void *userdata, sd_bus_error *ret_error);
-static int dbus_get_network_name(sd_bus *bus, const char *path, const char *interface,
-                                 const char *property, sd_bus_message *reply, 
-                                 void *userdata, sd_bus_error *ret_error);
-static int dbus_get_network_size(sd_bus *bus, const char *path, const char *interface,
-                                 const char *property, sd_bus_message *reply, 
-                                 void *userdata, sd_bus_error *ret_error);
-static int dbus_get_reg_domain(sd_bus *bus, const char *path, const char *interface,
-                               const char *property, sd_bus_message *reply, 
-                               void *userdata, sd_bus_error *ret_error);
-static int dbus_get_phy_mode_id(sd_bus *bus, const char *path, const char *interface,
+static int dbus_get_trace(sd_bus *bus, const char *path, const char *interface,
+                          const char *property, sd_bus_message *reply, 
+                          void *userdata, sd_bus_error *ret_error);
+static int dbus_get_stale(sd_bus *bus, const char *path, const char *interface,
+                          const char *property, sd_bus_message *reply, 
+                          void *userdata, sd_bus_error *ret_error);
+static int dbus_get_soc_address(sd_bus *bus, const char *path, const char *interface,
                                 const char *property, sd_bus_message *reply, 
                                 void *userdata, sd_bus_error *ret_error);
-static int dbus_get_chan_plan_id(sd_bus *bus, const char *path, const char *interface,
-                                 const char *property, sd_bus_message *reply, 
-                                 void *userdata, sd_bus_error *ret_error);
+static int dbus_get_setting(sd_bus *bus, const char *path, const char *interface,
+                            const char *property, sd_bus_message *reply, 
+                            void *userdata, sd_bus_error *ret_error);
+static int dbus_set_setting(sd_bus *bus, const char *path, const char *interface,
+                            const char *property, sd_bus_message *value, 
+                            void *userdata, sd_bus_error *ret_error);
 static int dbus_get_fan_version(sd_bus *bus, const char *path, const char *interface,
                                const char *property, sd_bus_message *reply, 
                                void *userdata, sd_bus_error *ret_error);
-static int dbus_get_pan_id(sd_bus *bus, const char *path, const char *interface,
-                           const char *property, sd_bus_message *reply, 
-                           void *userdata, sd_bus_error *ret_error);
-static int dbus_get_mode(sd_bus *bus, const char *path, const char *interface,
-                         const char *property, sd_bus_message *reply, 
-                         void *userdata, sd_bus_error *ret_error);
-static int dbus_get_class(sd_bus *bus, const char *path, const char *interface,
-                          const char *property, sd_bus_message *reply, 
-                          void *userdata, sd_bus_error *ret_error);
 
 static int dbus_method_restart_br(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
 static int dbus_method_stop_br(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
 static int dbus_method_set_config(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
+static int dbus_method_get_setting(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
+static int dbus_method_set_setting(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
+static int dbus_method_get_settings(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
+static int dbus_method_get_routing_graph_at(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
+static int dbus_method_get_node_history(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
+static int dbus_method_get_node_lifecycle(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
+static int dbus_method_get_node_lifecycles(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
+static int dbus_method_get_node_stats(sd_bus_message *m, void *userdata, sd_bus_error *ret_error);
+
+static int dbus_find_soc(sd_bus *bus, const char *path, const char *interface,
+                         void *userdata, void **found, sd_bus_error *ret_error);
+static int dbus_enum_socs(sd_bus *bus, const char *prefix, void *userdata,
+                          char ***nodes, sd_bus_error *ret_error);
+static ws_br_agent_ret_t dbus_emit_changed_locked(size_t shard, char **properties);
+static ws_br_agent_ret_t dbus_emit_changed(size_t shard, char **properties);
+static void dbus_fields_properties(const ws_br_agent_settings_field_t * const fields[], size_t count,
+                                   char *properties[DBUS_SETTINGS_PROPERTIES_MAX + 1U]);
+
+static ws_br_agent_ret_t dbus_init(sd_bus **bus, sd_bus_slot **slot);
+
+/// Define a property getter wrapper observing the getter latency in the given histogram
+/// and firing the dbus_get_start/dbus_get_done probes
+#define DBUS_TIMED_GETTER(getter, hist)                                                 \
+  static int getter##_timed(sd_bus *bus, const char *path, const char *interface,      \
+                            const char *property, sd_bus_message *reply,               \
+                            void *userdata, sd_bus_error *ret_error)                   \
+  {                                                                                    \
+    uint64_t start_us = ws_br_agent_utils_get_monotonic_us();                          \
+    int r = 0;                                                                         \
+    ws_br_agent_probe1(dbus_get_start, property);                                      \
+    r = getter(bus, path, interface, property, reply, userdata, ret_error);            \
+    ws_br_agent_metrics_observe(hist, ws_br_agent_utils_get_monotonic_us() - start_us); \
+    ws_br_agent_probe2(dbus_get_done, property, r);                                    \
+    return r;                                                                          \
+  }
 
-static ws_br_agent_ret_t dbus_init(sd_bus **bus, sd_bus_slot **slot);static bool is_zero_addr(const uint8_t addr[16]);
+DBUS_TIMED_GETTER(dbus_get_routing_graph, WS_BR_AGENT_METRIC_HIST_DBUS_ROUTING_GRAPH_LATENCY)
+DBUS_TIMED_GETTER(dbus_get_setting, WS_BR_AGENT_METRIC_HIST_DBUS_SETTINGS_LATENCY)
+DBUS_TIMED_GETTER(dbus_get_fan_version, WS_BR_AGENT_METRIC_HIST_DBUS_SETTINGS_LATENCY)
 
 static pthread_t dbus_thr;
 static sd_bus *bus = NULL;
 static sd_bus_slot *slot = NULL;
 static volatile sig_atomic_t dbus_thread_stop = 0;
+/// Wakes the D-Bus thread up to stop or to flush messages queued by other threads (eventfd)
+static int dbus_wakeup_fd = -1;
+/// sd-bus is not thread safe: serializes message processing and signal emission
+static pthread_mutex_t bus_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/// @brief Last emitted update trace
+typedef struct dbus_trace {
+  /// Trace ID (0 if none yet)
+  uint64_t id;
+  /// Monotonic receive time in us
+  uint64_t recv_us;
+} dbus_trace_t;
+
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static dbus_trace_t topology_traces[WS_BR_AGENT_SOC_HOST_MAX_COUNT] = { 0U };
+static dbus_trace_t settings_traces[WS_BR_AGENT_SOC_HOST_MAX_COUNT] = { 0U };
+
+/// Settings properties (NULL terminated), from the settings field table
+static char *settings_properties[DBUS_SETTINGS_PROPERTIES_MAX + 1U] = { NULL };
+
+/// Object userdata: the shard index of each object, the root object serves the primary shard
+static size_t dbus_shards[WS_BR_AGENT_SOC_HOST_MAX_COUNT];
+
+/// Shard index of an object from its userdata
+static inline size_t dbus_shard(const void *userdata)
+{
+  return userdata != NULL ? *(const size_t *)userdata : WS_BR_AGENT_SOC_HOST_PRIMARY;
+}
 
 static const sd_bus_vtable dbus_vtable[] = {
   SD_BUS_VTABLE_START(0),
@@ -104,34 +196,96 @@ static const sd_bus_vtable dbus_vtable[] = {
   SD_BUS_METHOD(WS_BR_AGENT_DBUS_METHOD_SET_SOC_BORDER_ROUTER_CONFIG, "", NULL, 
                 dbus_method_set_config, 0),
   SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_ROUTING_GRAPH, "a(aybaay)", 
-                  dbus_get_routing_graph, 0, SD_BUS_VTABLE_PROPERTY_EMITS_INVALIDATION),
-  SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_NETWORK_NAME, "s", 
-                  dbus_get_network_name, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
-  SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_NETWORK_SIZE, "s", 
-                  dbus_get_network_size, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
-  SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_REG_DOMAIN, "s", 
-                  dbus_get_reg_domain, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
-  SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_PHY_MODE_ID, "u", 
-                  dbus_get_phy_mode_id, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
-  SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_CHAN_PLAN_ID, "u", 
-                  dbus_get_chan_plan_id, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+                  dbus_get_routing_graph_timed, 0, SD_BUS_VTABLE_PROPERTY_EMITS_INVALIDATION),
+  SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_ROUTING_GRAPH_TRACE, "(tt)", 
+                  dbus_get_trace, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+  SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_SETTINGS_TRACE, "(tt)", 
+                  dbus_get_trace, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+  SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_STALE, "b", 
+                  dbus_get_stale, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+  SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_SOC_ADDRESS, "s", 
+                  dbus_get_soc_address, 0, 0),
+  SD_BUS_METHOD(WS_BR_AGENT_DBUS_METHOD_GET_SETTING, "s", "v", 
+                dbus_method_get_setting, 0),
+  SD_BUS_METHOD(WS_BR_AGENT_DBUS_METHOD_SET_SETTING, "sv", "", 
+                dbus_method_set_setting, 0),
+  SD_BUS_METHOD(WS_BR_AGENT_DBUS_METHOD_GET_SETTINGS, "", "a{sv}", 
+                dbus_method_get_settings, 0),
+  SD_BUS_METHOD(WS_BR_AGENT_DBUS_METHOD_GET_ROUTING_GRAPH_AT, "t", "ta(aybaay)",
+                dbus_method_get_routing_graph_at, 0),
+  SD_BUS_METHOD(WS_BR_AGENT_DBUS_METHOD_GET_NODE_HISTORY, "ay", "a(tbayay)",
+                dbus_method_get_node_history, 0),
+  SD_BUS_METHOD(WS_BR_AGENT_DBUS_METHOD_GET_NODE_LIFECYCLE, "ay", "(bttayayuu)",
+                dbus_method_get_node_lifecycle, 0),
+  SD_BUS_METHOD(WS_BR_AGENT_DBUS_METHOD_GET_NODE_LIFECYCLES, "", "a(aybttayayuu)",
+                dbus_method_get_node_lifecycles, 0),
+  SD_BUS_METHOD(WS_BR_AGENT_DBUS_METHOD_GET_NODE_STATS, "uu", "a(uaynnqyt)u",
+                dbus_method_get_node_stats, 0),
+  // Settings properties are served from the settings field table
+  SD_BUS_WRITABLE_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_NETWORK_NAME, "s", dbus_get_setting_timed,
+                           dbus_set_setting, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+  SD_BUS_WRITABLE_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_NETWORK_SIZE, "s", dbus_get_setting_timed,
+                           dbus_set_setting, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+  SD_BUS_WRITABLE_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_REG_DOMAIN, "s", dbus_get_setting_timed,
+                           dbus_set_setting, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+  SD_BUS_WRITABLE_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_PHY_MODE_ID, "u", dbus_get_setting_timed,
+                           dbus_set_setting, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+  SD_BUS_WRITABLE_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_CHAN_PLAN_ID, "u", dbus_get_setting_timed,
+                           dbus_set_setting, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
   SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_FAN_VERSION, "y", 
-                  dbus_get_fan_version, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
-  SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_PAN_ID, "q", 
-                  dbus_get_pan_id, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
-  SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_CLASS, "u", 
-                  dbus_get_class, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
-  SD_BUS_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_MODE, "u", 
-                  dbus_get_mode, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+                  dbus_get_fan_version_timed, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+  SD_BUS_WRITABLE_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_PAN_ID, "q", dbus_get_setting_timed,
+                           dbus_set_setting, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+  SD_BUS_WRITABLE_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_CLASS, "u", dbus_get_setting_timed,
+                           dbus_set_setting, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
+  SD_BUS_WRITABLE_PROPERTY(WS_BR_AGENT_DBUS_PROPERTY_MODE, "u", dbus_get_setting_timed,
+                           dbus_set_setting, 0, SD_BUS_VTABLE_PROPERTY_EMITS_CHANGE),
   SD_BUS_VTABLE_END
 };
 
 
 ws_br_agent_ret_t ws_br_agent_dbus_init(void) 
 {
+  sd_event *event = ws_br_agent_event_get();
+  int r = 0;
+
+  // Event loop mode: the bus is a loop source
+  if (event != NULL) {
+    if (dbus_init(&bus, &slot) != WS_BR_AGENT_RET_OK) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+    r = sd_bus_attach_event(bus, event, SD_EVENT_PRIORITY_NORMAL);
+    if (r < 0) {
+      ws_br_agent_log_error("Failed to attach the bus to the event loop: %s\n", strerror(-r));
+      return WS_BR_AGENT_RET_ERR;
+    }
+    ws_br_agent_log_warn("D-Bus service started\n");
+    return WS_BR_AGENT_RET_OK;
+  }
+
+  dbus_wakeup_fd = eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (dbus_wakeup_fd < 0) {
+    ws_br_agent_log_error("Failed to create the D-Bus wakeup event: %s\n", strerror(errno));
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // The name is acquired before returning, so that start-up is only reported complete
+  // once the service is reachable. The thread takes the bus over.
+  if (dbus_init(&bus, &slot) != WS_BR_AGENT_RET_OK) {
+    slot = sd_bus_slot_unref(slot);
+    bus = sd_bus_unref(bus);
+    close(dbus_wakeup_fd);
+    dbus_wakeup_fd = -1;
+    return WS_BR_AGENT_RET_ERR;
+  }
+
   // Create thread with increased stack size
   if (pthread_create(&dbus_thr, NULL, (void *)dbus_thr_fnc, NULL) != 0) {
     ws_br_agent_log_error("Failed to create D-Bus thread\n");
+    slot = sd_bus_slot_unref(slot);
+    bus = sd_bus_unref(bus);
+    close(dbus_wakeup_fd);
+    dbus_wakeup_fd = -1;
     return WS_BR_AGENT_RET_ERR;
   }
   return WS_BR_AGENT_RET_OK;
@@ -139,46 +293,254 @@ ws_br_agent_ret_t ws_br_agent_dbus_init(void)
 
 void ws_br_agent_dbus_deinit(void)
 {
+  if (ws_br_agent_event_get() != NULL) {
+    (void) sd_bus_detach_event(bus);
+    slot = sd_bus_slot_unref(slot);
+    bus = sd_bus_flush_close_unref(bus);
+    ws_br_agent_log_warn("D-Bus service stopped\n");
+    return;
+  }
+  if (dbus_wakeup_fd < 0) {
+    return;
+  }
   dbus_thread_stop = 1;
+  dbus_wakeup();
   pthread_join(dbus_thr, NULL);
+  close(dbus_wakeup_fd);
+  dbus_wakeup_fd = -1;
 }
 
-ws_br_agent_ret_t ws_br_agent_dbus_notify_topology_changed(void)
+ws_br_agent_ret_t ws_br_agent_dbus_notify_topology_changed(size_t shard,
+                                                           const ws_br_agent_trace_t * const trace)
 {
-  if (bus == NULL) {
+  char *properties[] = {
+    WS_BR_AGENT_DBUS_PROPERTY_ROUTING_GRAPH,
+    trace != NULL ? WS_BR_AGENT_DBUS_PROPERTY_ROUTING_GRAPH_TRACE : NULL,
+    NULL
+  };
+
+  if (bus == NULL || shard >= WS_BR_AGENT_SOC_HOST_MAX_COUNT) {
     return WS_BR_AGENT_RET_ERR;
   }
 
-  if (sd_bus_emit_properties_changed(bus, WS_BR_AGENT_DBUS_PATH, 
-                                     WS_BR_AGENT_DBUS_INTERFACE, 
-                                     WS_BR_AGENT_DBUS_PROPERTY_ROUTING_GRAPH, NULL) < 0) {
+  if (trace != NULL) {
+    pthread_mutex_lock(&trace_mutex);
+    topology_traces[shard].id = trace->id;
+    topology_traces[shard].recv_us = trace->recv_us;
+    pthread_mutex_unlock(&trace_mutex);
+  }
+
+  // RoutingGraph is invalidated, the trace is carried by value in the same signal
+  return dbus_emit_changed(shard, properties);
+}
+
+ws_br_agent_ret_t ws_br_agent_dbus_notify_settings_changed(size_t shard,
+                                                           const ws_br_agent_trace_t * const trace)
+{
+  char *properties[DBUS_SETTINGS_PROPERTIES_MAX + 2U] = { NULL };
+  size_t count = 0U;
+
+  if (bus == NULL || shard >= WS_BR_AGENT_SOC_HOST_MAX_COUNT) {
     return WS_BR_AGENT_RET_ERR;
   }
 
-  return WS_BR_AGENT_RET_OK;
+  while (settings_properties[count] != NULL) {
+    properties[count] = settings_properties[count];
+    count++;
+  }
+  if (trace != NULL) {
+    properties[count] = WS_BR_AGENT_DBUS_PROPERTY_SETTINGS_TRACE;
+    pthread_mutex_lock(&trace_mutex);
+    settings_traces[shard].id = trace->id;
+    settings_traces[shard].recv_us = trace->recv_us;
+    pthread_mutex_unlock(&trace_mutex);
+  }
+  // Notify D-Bus clients that the any of settings property has changed
+  return dbus_emit_changed(shard, properties);
+}
+
+/// Settings properties of the changed fields (NULL terminated)
+static void dbus_fields_properties(const ws_br_agent_settings_field_t * const fields[], size_t count,
+                                   char *properties[DBUS_SETTINGS_PROPERTIES_MAX + 1U])
+{
+  size_t prop_count = 0U;
+
+  for (size_t i = 0U; i < count; ++i) {
+    if (fields[i]->offset == offsetof(ws_br_agent_settings_t, phy.type)) {
+      // The PHY configuration type selects the union member behind most properties
+      memcpy(properties, settings_properties, sizeof(settings_properties));
+      return;
+    }
+  }
+  for (size_t i = 0U; i < count && prop_count < DBUS_SETTINGS_PROPERTIES_MAX; ++i) {
+    if (fields[i]->dbus_name != NULL) {
+      properties[prop_count++] = (char *)fields[i]->dbus_name;
+    }
+  }
+  properties[prop_count] = NULL;
+}
+
+ws_br_agent_ret_t ws_br_agent_dbus_notify_settings_fields_changed(size_t shard,
+                                                                  const ws_br_agent_settings_field_t * const fields[],
+                                                                  size_t count)
+{
+  char *properties[DBUS_SETTINGS_PROPERTIES_MAX + 1U] = { NULL };
+
+  if (bus == NULL || shard >= WS_BR_AGENT_SOC_HOST_MAX_COUNT || fields == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  dbus_fields_properties(fields, count, properties);
+  if (properties[0] == NULL) {
+    return WS_BR_AGENT_RET_OK;
+  }
+
+  return dbus_emit_changed(shard, properties);
 }
 
-ws_br_agent_ret_t ws_br_agent_dbus_notify_settings_changed(void)
+ws_br_agent_ret_t ws_br_agent_dbus_notify_stale_changed(size_t shard)
 {
+  char *properties[] = { WS_BR_AGENT_DBUS_PROPERTY_STALE, NULL };
+
+  if (bus == NULL || shard >= WS_BR_AGENT_SOC_HOST_MAX_COUNT) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  return dbus_emit_changed(shard, properties);
+}
+
+ws_br_agent_ret_t ws_br_agent_dbus_notify_soc_added(size_t shard)
+{
+  char path[sizeof(WS_BR_AGENT_DBUS_SOC_PATH) + 24U];
+  int r = 0;
+
   if (bus == NULL) {
     return WS_BR_AGENT_RET_ERR;
   }
-  // Notify D-Bus clients that the any of settings property has changed
-  if (sd_bus_emit_properties_changed(bus, WS_BR_AGENT_DBUS_PATH, 
-                                     WS_BR_AGENT_DBUS_INTERFACE, 
-                                     WS_BR_AGENT_DBUS_PROPERTY_NETWORK_NAME, 
-                                     WS_BR_AGENT_DBUS_PROPERTY_NETWORK_SIZE,
-                                     WS_BR_AGENT_DBUS_PROPERTY_REG_DOMAIN,
-                                     WS_BR_AGENT_DBUS_PROPERTY_PHY_MODE_ID,
-                                     WS_BR_AGENT_DBUS_PROPERTY_CHAN_PLAN_ID,
-                                     WS_BR_AGENT_DBUS_PROPERTY_FAN_VERSION,
-                                     NULL) < 0) {
+
+  snprintf(path, sizeof(path), WS_BR_AGENT_DBUS_SOC_PATH "/%zu", shard);
+  pthread_mutex_lock(&bus_mutex);
+  r = sd_bus_emit_object_added(bus, path);
+  pthread_mutex_unlock(&bus_mutex);
+  dbus_wakeup();
+  if (r < 0) {
+    ws_br_agent_log_error("Failed to emit InterfacesAdded for %s: %s\n", path, strerror(-r));
     return WS_BR_AGENT_RET_ERR;
   }
-  
+
   return WS_BR_AGENT_RET_OK;
 }
 
+/// Emit PropertiesChanged on the object of a shard, and on the root object for the primary shard
+static ws_br_agent_ret_t dbus_emit_changed_locked(size_t shard, char **properties)
+{
+  char path[sizeof(WS_BR_AGENT_DBUS_SOC_PATH) + 24U];
+  int r = 0;
+
+  snprintf(path, sizeof(path), WS_BR_AGENT_DBUS_SOC_PATH "/%zu", shard);
+  r = sd_bus_emit_properties_changed_strv(bus, path, WS_BR_AGENT_DBUS_INTERFACE, properties);
+  if (r >= 0 && shard == WS_BR_AGENT_SOC_HOST_PRIMARY) {
+    r = sd_bus_emit_properties_changed_strv(bus, WS_BR_AGENT_DBUS_PATH,
+                                            WS_BR_AGENT_DBUS_INTERFACE, properties);
+  }
+  if (r < 0) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  return WS_BR_AGENT_RET_OK;
+}
+
+static ws_br_agent_ret_t dbus_emit_changed(size_t shard, char **properties)
+{
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_ERR;
+
+  pthread_mutex_lock(&bus_mutex);
+  ret = dbus_emit_changed_locked(shard, properties);
+  pthread_mutex_unlock(&bus_mutex);
+  dbus_wakeup();
+
+  return ret;
+}
+
+/// Resolve a per-SoC object path to its shard
+static int dbus_find_soc(sd_bus *bus, const char *path, const char *interface,
+                         void *userdata, void **found, sd_bus_error *ret_error)
+{
+  const char *label = NULL;
+  char *end = NULL;
+  unsigned long shard = 0UL;
+
+  (void) bus;
+  (void) interface;
+  (void) userdata;
+  (void) ret_error;
+
+  if (strncmp(path, WS_BR_AGENT_DBUS_SOC_PATH "/", sizeof(WS_BR_AGENT_DBUS_SOC_PATH))) {
+    return 0;
+  }
+  label = path + sizeof(WS_BR_AGENT_DBUS_SOC_PATH);
+  if (*label < '0' || *label > '9') {
+    return 0;
+  }
+  shard = strtoul(label, &end, 10);
+  if (*end != '\0' || shard >= ws_br_agent_soc_host_shard_count()) {
+    return 0;
+  }
+  *found = &dbus_shards[shard];
+  return 1;
+}
+
+/// List the per-SoC objects, for introspection and the ObjectManager
+static int dbus_enum_socs(sd_bus *bus, const char *prefix, void *userdata,
+                          char ***nodes, sd_bus_error *ret_error)
+{
+  size_t count = ws_br_agent_soc_host_shard_count();
+  char **paths = NULL;
+  size_t i = 0U;
+
+  (void) bus;
+  (void) prefix;
+  (void) userdata;
+  (void) ret_error;
+
+  // Returned to sd-bus, which frees it with free()
+  paths = calloc(count + 1U, sizeof(char *));
+  if (paths == NULL) {
+    return -ENOMEM;
+  }
+  for (i = 0U; i < count; ++i) {
+    paths[i] = malloc(sizeof(WS_BR_AGENT_DBUS_SOC_PATH) + 24U);
+    if (paths[i] == NULL) {
+      for (; i > 0U; --i) {
+        free(paths[i - 1U]);
+      }
+      free(paths);
+      return -ENOMEM;
+    }
+    snprintf(paths[i], sizeof(WS_BR_AGENT_DBUS_SOC_PATH) + 24U,
+             WS_BR_AGENT_DBUS_SOC_PATH "/%zu", i);
+  }
+  *nodes = paths;
+  return 0;
+}
+
+/// List the settings properties: fields with a property and the derived FAN version
+static void dbus_init_settings_properties(void)
+{
+  const ws_br_agent_settings_field_t *fields = NULL;
+  size_t field_count = 0U;
+  size_t count = 0U;
+
+  fields = ws_br_agent_settings_fields(&field_count);
+  for (size_t i = 0U; i < field_count && count < DBUS_SETTINGS_PROPERTIES_MAX - 1U; ++i) {
+    if (fields[i].dbus_name != NULL) {
+      settings_properties[count++] = (char *)fields[i].dbus_name;
+    }
+  }
+  settings_properties[count++] = WS_BR_AGENT_DBUS_PROPERTY_FAN_VERSION;
+  settings_properties[count] = NULL;
+}
+
 static ws_br_agent_ret_t dbus_init(sd_bus **bus, sd_bus_slot **slot)
 {
   int r;
@@ -188,15 +550,37 @@ static ws_br_agent_ret_t dbus_init(sd_bus **bus, sd_bus_slot **slot)
     return WS_BR_AGENT_RET_ERR;
   }
 
+  for (size_t i = 0U; i < WS_BR_AGENT_SOC_HOST_MAX_COUNT; ++i) {
+    dbus_shards[i] = i;
+  }
+
+  dbus_init_settings_properties();
+
+  // The root object serves the primary SoC
   r = sd_bus_add_object_vtable(*bus, slot,
                                WS_BR_AGENT_DBUS_PATH,
                                WS_BR_AGENT_DBUS_INTERFACE,
-                               dbus_vtable, NULL);
+                               dbus_vtable, &dbus_shards[WS_BR_AGENT_SOC_HOST_PRIMARY]);
   if (r < 0) {
     ws_br_agent_log_error("Failed to add vtable: %s\n", strerror(-r));
     return WS_BR_AGENT_RET_ERR;
   }
 
+  // One object per SoC under the root, announced by the ObjectManager.
+  // These slots are floating, released with the bus.
+  r = sd_bus_add_fallback_vtable(*bus, NULL, WS_BR_AGENT_DBUS_SOC_PATH,
+                                 WS_BR_AGENT_DBUS_INTERFACE, dbus_vtable, dbus_find_soc, NULL);
+  if (r >= 0) {
+    r = sd_bus_add_node_enumerator(*bus, NULL, WS_BR_AGENT_DBUS_SOC_PATH, dbus_enum_socs, NULL);
+  }
+  if (r >= 0) {
+    r = sd_bus_add_object_manager(*bus, NULL, WS_BR_AGENT_DBUS_PATH);
+  }
+  if (r < 0) {
+    ws_br_agent_log_error("Failed to add SoC objects: %s\n", strerror(-r));
+    return WS_BR_AGENT_RET_ERR;
+  }
+
   r = sd_bus_request_name(*bus, WS_BR_AGENT_DBUS_INTERFACE, 0);
   if (r < 0) {
     ws_br_agent_log_error("Failed to acquire service name: %s\n", strerror(-r));
@@ -206,35 +590,27 @@ static ws_br_agent_ret_t dbus_init(sd_bus **bus, sd_bus_slot **slot)
   return WS_BR_AGENT_RET_OK;
 } 
 
-// D-Bus property getter for RoutingGraph
-static int dbus_get_routing_graph(sd_bus *bus, const char *path, const char *interface,
-                                  const char *property, sd_bus_message *reply, 
-                                  void *userdata, sd_bus_error *ret_error)
+int ws_br_agent_dbus_append_routing_graph(sd_bus_message *reply,
+                                          const ws_br_agent_soc_host_topology_t * const topology)
 {
-  ws_br_agent_soc_host_topology_t topology = {0U, NULL};
   int r = -1;
+  uint64_t no_backup = 0U;
 
-  (void) bus;
-  (void) path;
-  (void) interface;
-  (void) property;
-  (void) userdata;
-  (void) ret_error;
-
-  if (ws_br_agent_soc_host_get_topology(&topology) != WS_BR_AGENT_RET_OK) {
-    ws_br_agent_log_error("Failed to get topology for D-Bus property\n");
-    return -1;
-  }
-
-  if (topology.entry_count == 0 || topology.entries == NULL) {
+  if (topology->entry_count == 0 || topology->entries == NULL) {
     return sd_bus_message_append(reply, "a(aybaay)", 0);
   }
 
   r = sd_bus_message_open_container(reply, 'a', "(aybaay)");
   if (r < 0) return r;
 
-  for (size_t i = 0; i < topology.entry_count; ++i) {
-    ws_br_agent_soc_host_topology_entry_t *entry = &topology.entries[i];
+  for (size_t i = 0; i < topology->entry_count; ++i) {
+    const ws_br_agent_soc_host_topology_entry_t *entry = &topology->entries[i];
+    // Backup parents zero-tested 64 entries at a time
+    if (!(i % 64U)) {
+      (void) ws_br_agent_addr_zero_bitmap(entry, topology->entry_count - i < 64U 
+                                                 ? topology->entry_count - i : 64U,
+                                          WS_BR_AGENT_ADDR_FIELD_BACKUP, &no_backup);
+    }
     r = sd_bus_message_open_container(reply, 'r', "aybaay");
     if (r < 0) return r;
     r = sd_bus_message_append_array(reply, 'y', entry->target, 16);
@@ -247,7 +623,7 @@ static int dbus_get_routing_graph(sd_bus *bus, const char *path, const char *int
     if (i) {
       r = sd_bus_message_append_array(reply, 'y', entry->preferred, 16);
       if (r < 0) return r;
-      if (!is_zero_addr(entry->backup)) {
+      if (!(no_backup & (1ULL << (i % 64U)))) {
         r = sd_bus_message_append_array(reply, 'y', entry->backup, 16);
         if (r < 0) return r;
       }
@@ -258,223 +634,628 @@ static int dbus_get_routing_graph(sd_bus *bus, const char *path, const char *int
     if (r < 0) return r;
   }
 
-  r = sd_bus_message_close_container(reply); // close 'a'
-
-  (void) ws_br_agent_soc_host_free_topology(&topology);
-
-  return r;
+  return sd_bus_message_close_container(reply); // close 'a'
 }
 
-
-static int dbus_get_network_name(sd_bus *bus, const char *path, const char *interface,
-                                 const char *property, sd_bus_message *reply, 
-                                 void *userdata, sd_bus_error *ret_error)
+// D-Bus property getter for RoutingGraph
+static int dbus_get_routing_graph(sd_bus *bus, const char *path, const char *interface,
+                                  const char *property, sd_bus_message *reply, 
+                                  void *userdata, sd_bus_error *ret_error)
 {
-  ws_br_agent_settings_t settings = { 0U };
-  
+  ws_br_agent_soc_host_topology_t topology = {0U, NULL};
+  int r = -1;
+
   (void) bus;
   (void) path;
   (void) interface;
   (void) property;
-  (void) userdata;
   (void) ret_error;
 
-  if (ws_br_agent_soc_host_get_settings(&settings) != WS_BR_AGENT_RET_OK) {
+  if (ws_br_agent_soc_host_shard_get_topology(dbus_shard(userdata), &topology)
+      != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_error("Failed to get topology for D-Bus property\n");
     return -1;
   }
-  
-  return sd_bus_message_append(reply, "s", settings.network_name);
+
+  r = ws_br_agent_dbus_append_routing_graph(reply, &topology);
+
+  (void) ws_br_agent_soc_host_free_topology(&topology);
+
+  return r;
 }
 
-static int dbus_get_network_size(sd_bus *bus, const char *path, const char *interface,
-                                 const char *property, sd_bus_message *reply, 
-                                 void *userdata, sd_bus_error *ret_error)
+// D-Bus property getter for RoutingGraphTrace and SettingsTrace
+static int dbus_get_trace(sd_bus *bus, const char *path, const char *interface,
+                          const char *property, sd_bus_message *reply, 
+                          void *userdata, sd_bus_error *ret_error)
 {
-  ws_br_agent_settings_t settings = { 0U };
+  dbus_trace_t trace = { 0U };
+  size_t shard = dbus_shard(userdata);
 
   (void) bus;
   (void) path;
   (void) interface;
-  (void) property;
-  (void) userdata;
   (void) ret_error;
 
-  if (ws_br_agent_soc_host_get_settings(&settings) != WS_BR_AGENT_RET_OK) {
-    return -1;
+  pthread_mutex_lock(&trace_mutex);
+  if (!strcmp(property, WS_BR_AGENT_DBUS_PROPERTY_ROUTING_GRAPH_TRACE)) {
+    trace = topology_traces[shard];
+  } else {
+    trace = settings_traces[shard];
   }
-  
-  return sd_bus_message_append(reply, "s",
-                               ws_br_agent_utils_val_to_str(settings.network_size, 
-                                                           ws_br_agent_nw_size_strs, 
-                                                           "Unknown"));
+  pthread_mutex_unlock(&trace_mutex);
 
+  return sd_bus_message_append(reply, "(tt)", trace.id, trace.recv_us);
 }
 
-static int dbus_get_reg_domain(sd_bus *bus, const char *path, const char *interface,
-                               const char *property, sd_bus_message *reply, 
-                               void *userdata, sd_bus_error *ret_error)
+static int dbus_get_stale(sd_bus *bus, const char *path, const char *interface,
+                          const char *property, sd_bus_message *reply, 
+                          void *userdata, sd_bus_error *ret_error)
 {
-  ws_br_agent_settings_t settings = { 0U };
-  uint8_t value = 0;
-
   (void) bus;
   (void) path;
   (void) interface;
   (void) property;
-  (void) userdata;
   (void) ret_error;
 
-  if (ws_br_agent_soc_host_get_settings(&settings) != WS_BR_AGENT_RET_OK) {
-    return -1;
-  }
-  switch (settings.phy.type) {
-    case WS_BR_AGENT_PHY_CONFIG_FAN11:
-      value = settings.phy.config.fan11.reg_domain;
-      break;
-    
-    case WS_BR_AGENT_PHY_CONFIG_FAN10:
-      value = settings.phy.config.fan10.reg_domain;
-      break;
-
-    default: 
-      value = 0U;
-      break;
-  }
-
-  return sd_bus_message_append(reply, "s",
-                                ws_br_agent_utils_val_to_str(value, 
-                                                             ws_br_agent_domains_strs, 
-                                                             "Unknown"));
+  return sd_bus_message_append(reply, "b", ws_br_agent_soc_host_shard_is_stale(dbus_shard(userdata)));
 }
 
-static int dbus_get_phy_mode_id(sd_bus *bus, const char *path, const char *interface,
-                               const char *property, sd_bus_message *reply, 
-                               void *userdata, sd_bus_error *ret_error)
+static int dbus_get_soc_address(sd_bus *bus, const char *path, const char *interface,
+                                const char *property, sd_bus_message *reply, 
+                                void *userdata, sd_bus_error *ret_error)
 {
-  ws_br_agent_settings_t settings = { 0U };
-  uint32_t value = 0U;
+  ws_br_agent_soc_host_t host;
 
   (void) bus;
   (void) path;
   (void) interface;
   (void) property;
-  (void) userdata;
   (void) ret_error;
 
-  if (ws_br_agent_soc_host_get_settings(&settings) != WS_BR_AGENT_RET_OK) {
+  if (ws_br_agent_soc_host_shard_get(dbus_shard(userdata), &host) != WS_BR_AGENT_RET_OK) {
     return -1;
   }
-  value = settings.phy.type != WS_BR_AGENT_PHY_CONFIG_FAN11 ? 0U :
-           settings.phy.config.fan11.phy_mode_id;
-  return sd_bus_message_append(reply, "u", value);
+
+  return sd_bus_message_append(reply, "s", host.remote_addr_str);
 }
 
-static int dbus_get_chan_plan_id(sd_bus *bus, const char *path, const char *interface,
-                                 const char *property, sd_bus_message *reply, 
-                                 void *userdata, sd_bus_error *ret_error)
+/// Zeroed settings, read in place of the fields of other PHY configuration types
+static const ws_br_agent_settings_t zero_settings = { 0 };
+
+/// Append a basic integer D-Bus value
+static int dbus_append_int(sd_bus_message *m, char type, int64_t value)
 {
-  ws_br_agent_settings_t settings = { 0U };
-  uint32_t value = 0U;
+  uint8_t u8 = (uint8_t)value;
+  int16_t i16 = (int16_t)value;
+  uint16_t u16 = (uint16_t)value;
+  int32_t i32 = (int32_t)value;
+  uint32_t u32 = (uint32_t)value;
+  int b = value != 0;
+
+  switch (type) {
+    case 'y': return sd_bus_message_append_basic(m, type, &u8);
+    case 'b': return sd_bus_message_append_basic(m, type, &b);
+    case 'n': return sd_bus_message_append_basic(m, type, &i16);
+    case 'q': return sd_bus_message_append_basic(m, type, &u16);
+    case 'i': return sd_bus_message_append_basic(m, type, &i32);
+    case 'u': return sd_bus_message_append_basic(m, type, &u32);
+    case 'x': return sd_bus_message_append_basic(m, type, &value);
+    default: return -EINVAL;
+  }
+}
+
+/// Read a basic integer D-Bus value
+static int dbus_read_int(sd_bus_message *m, char type, int64_t * const value)
+{
+  union { uint8_t y; int b; int16_t n; uint16_t q; int32_t i; uint32_t u; int64_t x; uint64_t t; } v;
+  int r = sd_bus_message_read_basic(m, type, &v);
+
+  if (r <= 0) {
+    return r < 0 ? r : -EINVAL;
+  }
+  switch (type) {
+    case 'y': *value = v.y; break;
+    case 'b': *value = v.b; break;
+    case 'n': *value = v.n; break;
+    case 'q': *value = v.q; break;
+    case 'i': *value = v.i; break;
+    case 'u': *value = v.u; break;
+    case 'x': *value = v.x; break;
+    case 't': *value = v.t > INT64_MAX ? INT64_MAX : (int64_t)v.t; break;
+    default: return -EINVAL;
+  }
+  return 0;
+}
+
+/// Append a settings field with its D-Bus type, as a variant if requested
+static int dbus_append_setting(sd_bus_message *m, const ws_br_agent_settings_field_t * const field,
+                               const ws_br_agent_settings_t *settings, bool variant)
+{
+  char text[WS_BR_AGENT_SETTINGS_FIELD_TEXT_MAX_SIZE];
+  const char type[2] = { field->dbus_type, '\0' };
+  int64_t value = 0;
+  int r = 0;
+
+  if (!ws_br_agent_settings_field_applies(field, settings)) {
+    settings = &zero_settings;
+  }
+  if (variant) {
+    r = sd_bus_message_open_container(m, 'v', field->dbus_type == 'a' ? "ay" : type);
+    if (r < 0) return r;
+  }
+
+  if (field->dbus_type == 'a') {
+    r = sd_bus_message_append_array(m, 'y', (const uint8_t *)settings + field->offset, field->size);
+  } else if (field->dbus_type == 's') {
+    r = sd_bus_message_append_basic(m, 's', ws_br_agent_settings_format(field, settings,
+                                                                        text, sizeof(text)));
+  } else {
+    (void) ws_br_agent_settings_get_int(field, settings, &value);
+    r = dbus_append_int(m, field->dbus_type, value);
+  }
+  if (r < 0 || !variant) {
+    return r;
+  }
+
+  return sd_bus_message_close_container(m);
+}
+
+/// Read a settings field from a value of the given D-Bus type: strings use the configuration
+/// file syntax, integers are range checked
+static int dbus_read_setting(sd_bus_message *m, const char *type,
+                             const ws_br_agent_settings_field_t * const field,
+                             ws_br_agent_settings_t * const settings)
+{
+  const char *str = NULL;
+  const void *bytes = NULL;
+  size_t len = 0U;
+  int64_t value = 0;
+  int r = 0;
+
+  if (!strcmp(type, "s")) {
+    r = sd_bus_message_read_basic(m, 's', &str);
+    if (r < 0) return r;
+    return ws_br_agent_settings_set_str(field, settings, str) == WS_BR_AGENT_RET_OK ? 0 : -EINVAL;
+  }
+  if (!strcmp(type, "ay")) {
+    r = sd_bus_message_read_array(m, 'y', &bytes, &len);
+    if (r < 0) return r;
+    if (field->type != WS_BR_AGENT_SETTINGS_FIELD_BYTES || len > field->size) {
+      return -EINVAL;
+    }
+    memset((uint8_t *)settings + field->offset, 0, field->size);
+    memcpy((uint8_t *)settings + field->offset, bytes, len);
+    return 0;
+  }
+  if (type[0] == '\0' || type[1] != '\0') {
+    return -EINVAL;
+  }
+  r = dbus_read_int(m, type[0], &value);
+  if (r < 0) return r;
+
+  return ws_br_agent_settings_set_int(field, settings, value) == WS_BR_AGENT_RET_OK ? 0 : -EINVAL;
+}
+
+/// Update a settings field of a shard from a D-Bus value, emit PropertiesChanged if it changed.
+/// Called from a message handler, with the bus lock held.
+static int dbus_update_setting(size_t shard, const ws_br_agent_settings_field_t * const field,
+                               sd_bus_message *m, const char *type, sd_bus_error *ret_error)
+{
+  char text[WS_BR_AGENT_SETTINGS_FIELD_TEXT_MAX_SIZE];
+  ws_br_agent_settings_t settings = { 0 };
+  char *properties[DBUS_SETTINGS_PROPERTIES_MAX + 1U] = { NULL };
+  bool changed = false;
+  int r = 0;
+
+  if (ws_br_agent_soc_host_shard_get_setting(shard, field, &settings) != WS_BR_AGENT_RET_OK) {
+    return sd_bus_error_setf(ret_error, SD_BUS_ERROR_FAILED, "Unknown SoC");
+  }
+  if (!ws_br_agent_settings_field_applies(field, &settings)) {
+    return sd_bus_error_setf(ret_error, SD_BUS_ERROR_INVALID_ARGS,
+                             "%s is not used by the PHY configuration type", field->key);
+  }
+  r = dbus_read_setting(m, type, field, &settings);
+  if (r < 0) {
+    return sd_bus_error_setf(ret_error, SD_BUS_ERROR_INVALID_ARGS, "Invalid %s value", field->key);
+  }
+  if (ws_br_agent_soc_host_shard_set_setting(shard, field, &settings, &changed) != WS_BR_AGENT_RET_OK) {
+    return sd_bus_error_setf(ret_error, SD_BUS_ERROR_FAILED, "Unknown SoC");
+  }
+  if (!changed) {
+    return 0;
+  }
+
+  ws_br_agent_log_info("D-Bus: %s set to %s\n", field->key,
+                       ws_br_agent_settings_format(field, &settings, text, sizeof(text)));
+  ws_br_agent_state_save_later();
+  dbus_fields_properties(&field, 1U, properties);
+  if (properties[0] != NULL) {
+    (void) dbus_emit_changed_locked(shard, properties);
+  }
+
+  return 0;
+}
+
+// Settings properties getter
+static int dbus_get_setting(sd_bus *bus, const char *path, const char *interface,
+                            const char *property, sd_bus_message *reply, 
+                            void *userdata, sd_bus_error *ret_error)
+{
+  const ws_br_agent_settings_field_t *field = ws_br_agent_settings_find_dbus_field(property);
+  ws_br_agent_settings_t settings = { 0 };
 
   (void) bus;
   (void) path;
   (void) interface;
-  (void) property;
-  (void) userdata;
   (void) ret_error;
 
-  if (ws_br_agent_soc_host_get_settings(&settings) != WS_BR_AGENT_RET_OK) {
+  if (field == NULL
+      || ws_br_agent_soc_host_shard_get_setting(dbus_shard(userdata), field, &settings)
+         != WS_BR_AGENT_RET_OK) {
     return -1;
   }
-  value = settings.phy.type != WS_BR_AGENT_PHY_CONFIG_FAN11 ? 0U :
-           settings.phy.config.fan11.chan_plan_id;
 
-  return sd_bus_message_append(reply, "u", value);
+  return dbus_append_setting(reply, field, &settings, false);
 }
 
-static int dbus_get_fan_version(sd_bus *bus, const char *path, const char *interface,
-                               const char *property, sd_bus_message *reply, 
-                               void *userdata, sd_bus_error *ret_error)
+// Settings properties setter
+static int dbus_set_setting(sd_bus *bus, const char *path, const char *interface,
+                            const char *property, sd_bus_message *value, 
+                            void *userdata, sd_bus_error *ret_error)
 {
-  ws_br_agent_settings_t settings = { 0U };
-  uint8_t value = 0U;
+  const ws_br_agent_settings_field_t *field = ws_br_agent_settings_find_dbus_field(property);
+  const char type[2] = { field != NULL ? field->dbus_type : '\0', '\0' };
 
   (void) bus;
   (void) path;
   (void) interface;
-  (void) property;
-  (void) userdata;
-  (void) ret_error;
 
-  if (ws_br_agent_soc_host_get_settings(&settings) != WS_BR_AGENT_RET_OK) {
-    return -1;
+  if (field == NULL) {
+    return -EINVAL;
   }
 
-  switch (settings.phy.type) {
-    case WS_BR_AGENT_PHY_CONFIG_FAN11:
-      value = 2U;
-      break;
-    
-    case WS_BR_AGENT_PHY_CONFIG_FAN10:
-      value = 1U;
-      break;
+  return dbus_update_setting(dbus_shard(userdata), field, value, type, ret_error);
+}
 
-    default: 
-      value = 0U;
-      break;
+static int dbus_method_get_setting(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
+{
+  const ws_br_agent_settings_field_t *field = NULL;
+  ws_br_agent_settings_t settings = { 0 };
+  sd_bus_message *reply = NULL;
+  const char *key = NULL;
+  int r = 0;
+
+  r = sd_bus_message_read(m, "s", &key);
+  if (r < 0) return r;
+  field = ws_br_agent_settings_find_field(key, strlen(key));
+  if (field == NULL) {
+    return sd_bus_error_setf(ret_error, SD_BUS_ERROR_INVALID_ARGS, "Unknown setting %s", key);
+  }
+  if (ws_br_agent_soc_host_shard_get_setting(dbus_shard(userdata), field, &settings)
+      != WS_BR_AGENT_RET_OK) {
+    return sd_bus_error_setf(ret_error, SD_BUS_ERROR_FAILED, "Unknown SoC");
   }
 
-  return sd_bus_message_append(reply, "y", value);
+  r = sd_bus_message_new_method_return(m, &reply);
+  if (r >= 0) {
+    r = dbus_append_setting(reply, field, &settings, true);
+  }
+  if (r >= 0) {
+    r = sd_bus_send(NULL, reply, NULL);
+  }
+  sd_bus_message_unref(reply);
+
+  return r;
 }
 
-static int dbus_get_pan_id(sd_bus *bus, const char *path, const char *interface,
-                           const char *property, sd_bus_message *reply, 
-                           void *userdata, sd_bus_error *ret_error)
+static int dbus_method_set_setting(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
 {
-  uint16_t pan_id = 0U;
-  ws_br_agent_settings_t settings = { 0U };
-  int r = -1;
-  uint32_t value = 0U;
+  const ws_br_agent_settings_field_t *field = NULL;
+  const char *key = NULL;
+  const char *type = NULL;
+  int r = 0;
 
-  (void)userdata;
-  (void)bus;
-  (void)path;
-  (void)interface;
-  (void)property;
+  r = sd_bus_message_read(m, "s", &key);
+  if (r < 0) return r;
+  field = ws_br_agent_settings_find_field(key, strlen(key));
+  if (field == NULL) {
+    return sd_bus_error_setf(ret_error, SD_BUS_ERROR_INVALID_ARGS, "Unknown setting %s", key);
+  }
+  r = sd_bus_message_peek_type(m, NULL, &type);
+  if (r < 0) return r;
+  r = sd_bus_message_enter_container(m, 'v', type);
+  if (r < 0) return r;
+  r = dbus_update_setting(dbus_shard(userdata), field, m, type, ret_error);
+  if (r < 0) return r;
 
-  if (ws_br_agent_soc_host_get_settings(&settings) != WS_BR_AGENT_RET_OK) {
-    return -1;
+  return sd_bus_reply_method_return(m, NULL);
+}
+
+static int dbus_method_get_settings(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
+{
+  const ws_br_agent_settings_field_t *fields = NULL;
+  ws_br_agent_settings_t settings = { 0 };
+  sd_bus_message *reply = NULL;
+  size_t count = 0U;
+  int r = 0;
+
+  if (ws_br_agent_soc_host_shard_get_settings(dbus_shard(userdata), &settings)
+      != WS_BR_AGENT_RET_OK) {
+    return sd_bus_error_setf(ret_error, SD_BUS_ERROR_FAILED, "Unknown SoC");
+  }
+
+  // Fields of the current PHY configuration type only
+  fields = ws_br_agent_settings_fields(&count);
+  r = sd_bus_message_new_method_return(m, &reply);
+  if (r >= 0) {
+    r = sd_bus_message_open_container(reply, 'a', "{sv}");
+  }
+  for (size_t i = 0U; r >= 0 && i < count; ++i) {
+    if (!ws_br_agent_settings_field_applies(&fields[i], &settings)) {
+      continue;
+    }
+    r = sd_bus_message_open_container(reply, 'e', "sv");
+    if (r >= 0) r = sd_bus_message_append_basic(reply, 's', fields[i].key);
+    if (r >= 0) r = dbus_append_setting(reply, &fields[i], &settings, true);
+    if (r >= 0) r = sd_bus_message_close_container(reply);
+  }
+  if (r >= 0) {
+    r = sd_bus_message_close_container(reply);
   }
-  pan_id = settings.pan_id;
+  if (r >= 0) {
+    r = sd_bus_send(NULL, reply, NULL);
+  }
+  sd_bus_message_unref(reply);
 
-  return sd_bus_message_append(reply, "q", pan_id);
+  return r;
 }
 
-static int dbus_get_mode(sd_bus *bus, const char *path, const char *interface,
-                         const char *property, sd_bus_message *reply, 
-                         void *userdata, sd_bus_error *ret_error)
+// History records are keyed by SoC address: a shard can serve another SoC after a restart
+static int dbus_soc_addr(const void *userdata, struct in6_addr * const addr)
 {
-  ws_br_agent_settings_t settings = { 0U };
-  uint8_t value = 0U;
+  ws_br_agent_soc_host_t host;
 
-  (void) bus;
-  (void) path;
-  (void) interface;
-  (void) property;
-  (void) userdata;
-  (void) ret_error;
+  if (ws_br_agent_soc_host_shard_get(dbus_shard(userdata), &host) != WS_BR_AGENT_RET_OK) {
+    return -ENOENT;
+  }
+  *addr = host.remote_addr.sin6_addr;
+  return 0;
+}
 
-  if (ws_br_agent_soc_host_get_settings(&settings) != WS_BR_AGENT_RET_OK) {
-    return -1;
+static int dbus_method_get_routing_graph_at(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
+{
+  ws_br_agent_soc_host_topology_t topology = { 0U, NULL };
+  sd_bus_message *reply = NULL;
+  struct in6_addr soc = { 0 };
+  uint64_t time_us = 0U;
+  uint64_t version_us = 0U;
+  int r = 0;
+
+  r = sd_bus_message_read(m, "t", &time_us);
+  if (r < 0) return r;
+  r = dbus_soc_addr(userdata, &soc);
+  if (r < 0) return r;
+  if (ws_br_agent_history_get_topology(&soc, time_us, &topology, &version_us)
+      != WS_BR_AGENT_RET_OK) {
+    (void) ws_br_agent_soc_host_free_topology(&topology);
+    return sd_bus_error_setf(ret_error, SD_BUS_ERROR_INVALID_ARGS,
+                             "No topology recorded at %llu", (unsigned long long)time_us);
   }
-  value = settings.phy.type != WS_BR_AGENT_PHY_CONFIG_FAN10 ? 0U :
-           settings.phy.config.fan10.op_mode;
 
-  return sd_bus_message_append(reply, "u", value);
+  r = sd_bus_message_new_method_return(m, &reply);
+  if (r >= 0) {
+    r = sd_bus_message_append(reply, "t", version_us);
+  }
+  if (r >= 0) {
+    r = ws_br_agent_dbus_append_routing_graph(reply, &topology);
+  }
+  if (r >= 0) {
+    r = sd_bus_send(NULL, reply, NULL);
+  }
+  sd_bus_message_unref(reply);
+  (void) ws_br_agent_soc_host_free_topology(&topology);
+
+  return r;
 }
-static int dbus_get_class(sd_bus *bus, const char *path, const char *interface,
-                          const char *property, sd_bus_message *reply, 
-                          void *userdata, sd_bus_error *ret_error)
+
+// GetNodeHistory element: version time, presence, preferred parent, backup parent
+static int dbus_append_node_version(void *ctx, uint64_t time_us,
+                                    const ws_br_agent_soc_host_topology_entry_t *entry)
+{
+  static const uint8_t zero[16] = { 0U };
+  sd_bus_message *reply = (sd_bus_message *)ctx;
+  int r = 0;
+
+  r = sd_bus_message_open_container(reply, 'r', "tbayay");
+  if (r >= 0) r = sd_bus_message_append(reply, "tb", time_us, entry != NULL);
+  if (r >= 0) r = sd_bus_message_append_array(reply, 'y', entry != NULL ? entry->preferred : zero,
+                                              entry != NULL ? 16U : 0U);
+  if (r >= 0) r = sd_bus_message_append_array(reply, 'y', entry != NULL ? entry->backup : zero,
+                                              entry != NULL && memcmp(entry->backup, zero, 16U) ? 16U : 0U);
+  if (r >= 0) r = sd_bus_message_close_container(reply);
+
+  return r;
+}
+
+static int dbus_method_get_node_history(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
+{
+  sd_bus_message *reply = NULL;
+  struct in6_addr soc = { 0 };
+  const void *addr = NULL;
+  size_t len = 0U;
+  int r = 0;
+
+  r = sd_bus_message_read_array(m, 'y', &addr, &len);
+  if (r < 0) return r;
+  if (len != 16U) {
+    return sd_bus_error_setf(ret_error, SD_BUS_ERROR_INVALID_ARGS, "Invalid IPv6 address length %zu", len);
+  }
+  r = dbus_soc_addr(userdata, &soc);
+  if (r < 0) return r;
+
+  r = sd_bus_message_new_method_return(m, &reply);
+  if (r >= 0) {
+    r = sd_bus_message_open_container(reply, 'a', "(tbayay)");
+  }
+  if (r >= 0 && ws_br_agent_history_get_node(&soc, (const uint8_t *)addr,
+                                             dbus_append_node_version, reply) != WS_BR_AGENT_RET_OK) {
+    r = sd_bus_error_setf(ret_error, SD_BUS_ERROR_FAILED, "Topology history unavailable");
+  }
+  if (r >= 0) {
+    r = sd_bus_message_close_container(reply);
+  }
+  if (r >= 0) {
+    r = sd_bus_send(NULL, reply, NULL);
+  }
+  sd_bus_message_unref(reply);
+
+  return r;
+}
+
+// Node lifecycle fields: presence, first and last seen times, parent and previous parent
+// (empty when unset), reparent and flap counts
+static int dbus_append_lifecycle(sd_bus_message *reply, const ws_br_agent_lifecycle_node_t * const node)
+{
+  static const uint8_t zero[16] = { 0U };
+  int r = 0;
+
+  r = sd_bus_message_append(reply, "btt", node->present, node->first_seen_us, node->last_seen_us);
+  if (r >= 0) r = sd_bus_message_append_array(reply, 'y', node->parent,
+                                              memcmp(node->parent, zero, 16U) ? 16U : 0U);
+  if (r >= 0) r = sd_bus_message_append_array(reply, 'y', node->prev_parent,
+                                              memcmp(node->prev_parent, zero, 16U) ? 16U : 0U);
+  if (r >= 0) r = sd_bus_message_append(reply, "uu", node->reparents, node->flaps);
+
+  return r;
+}
+
+static int dbus_method_get_node_lifecycle(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
+{
+  ws_br_agent_lifecycle_node_t node = { 0 };
+  sd_bus_message *reply = NULL;
+  struct in6_addr soc = { 0 };
+  const void *addr = NULL;
+  size_t len = 0U;
+  int r = 0;
+
+  r = sd_bus_message_read_array(m, 'y', &addr, &len);
+  if (r < 0) return r;
+  if (len != 16U) {
+    return sd_bus_error_setf(ret_error, SD_BUS_ERROR_INVALID_ARGS, "Invalid IPv6 address length %zu", len);
+  }
+  r = dbus_soc_addr(userdata, &soc);
+  if (r < 0) return r;
+  if (ws_br_agent_soc_host_shard_get_lifecycle(dbus_shard(userdata), (const uint8_t *)addr, &node)
+      != WS_BR_AGENT_RET_OK) {
+    return sd_bus_error_setf(ret_error, SD_BUS_ERROR_INVALID_ARGS, "Unknown node");
+  }
+
+  r = sd_bus_message_new_method_return(m, &reply);
+  if (r >= 0) r = sd_bus_message_open_container(reply, 'r', "bttayayuu");
+  if (r >= 0) r = dbus_append_lifecycle(reply, &node);
+  if (r >= 0) r = sd_bus_message_close_container(reply);
+  if (r >= 0) {
+    r = sd_bus_send(NULL, reply, NULL);
+  }
+  sd_bus_message_unref(reply);
+
+  return r;
+}
+
+// GetNodeLifecycles element: target address, then the lifecycle fields
+static int dbus_append_lifecycle_entry(void *ctx, const ws_br_agent_lifecycle_node_t *node)
+{
+  sd_bus_message *reply = (sd_bus_message *)ctx;
+  int r = 0;
+
+  r = sd_bus_message_open_container(reply, 'r', "aybttayayuu");
+  if (r >= 0) r = sd_bus_message_append_array(reply, 'y', node->target, 16U);
+  if (r >= 0) r = dbus_append_lifecycle(reply, node);
+  if (r >= 0) r = sd_bus_message_close_container(reply);
+
+  return r;
+}
+
+static int dbus_method_get_node_lifecycles(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
+{
+  sd_bus_message *reply = NULL;
+  int r = 0;
+
+  r = sd_bus_message_new_method_return(m, &reply);
+  if (r >= 0) {
+    r = sd_bus_message_open_container(reply, 'a', "(aybttayayuu)");
+  }
+  if (r >= 0 && ws_br_agent_soc_host_shard_foreach_lifecycle(dbus_shard(userdata), dbus_append_lifecycle_entry,
+                                                             reply) != WS_BR_AGENT_RET_OK) {
+    r = sd_bus_error_setf(ret_error, SD_BUS_ERROR_FAILED, "Unknown SoC");
+  }
+  if (r >= 0) {
+    r = sd_bus_message_close_container(reply);
+  }
+  if (r >= 0) {
+    r = sd_bus_send(NULL, reply, NULL);
+  }
+  sd_bus_message_unref(reply);
+
+  return r;
+}
+
+// GetNodeStats element: topology index, target address, then the link metrics
+static int dbus_append_node_stats(void *ctx, const ws_br_agent_node_stats_row_t *row)
+{
+  sd_bus_message *reply = (sd_bus_message *)ctx;
+  int r = 0;
+
+  r = sd_bus_message_open_container(reply, 'r', "uaynnqyt");
+  if (r >= 0) r = sd_bus_message_append(reply, "u", row->index);
+  if (r >= 0) r = sd_bus_message_append_array(reply, 'y', row->target, 16U);
+  if (r >= 0) r = sd_bus_message_append(reply, "nnqyt", row->rsl_in_dbm, row->rsl_out_dbm,
+                                        row->etx, row->phy_mode_id, row->last_heard_us);
+  if (r >= 0) r = sd_bus_message_close_container(reply);
+
+  return r;
+}
+
+static int dbus_method_get_node_stats(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
+{
+  sd_bus_message *reply = NULL;
+  uint32_t node_count = 0U;
+  uint32_t first = 0U;
+  uint32_t count = 0U;
+  int r = 0;
+
+  // Batch read: entries [first, first + count) of the topology, count 0 for all
+  r = sd_bus_message_read(m, "uu", &first, &count);
+  if (r < 0) return r;
+
+  r = sd_bus_message_new_method_return(m, &reply);
+  if (r >= 0) {
+    r = sd_bus_message_open_container(reply, 'a', "(uaynnqyt)");
+  }
+  if (r >= 0 && ws_br_agent_soc_host_shard_foreach_node_stats(dbus_shard(userdata), first, count,
+                                                              dbus_append_node_stats, reply,
+                                                              &node_count) != WS_BR_AGENT_RET_OK) {
+    r = sd_bus_error_setf(ret_error, SD_BUS_ERROR_FAILED, "Unknown SoC");
+  }
+  if (r >= 0) {
+    r = sd_bus_message_close_container(reply);
+  }
+  // Topology entry count, for paging
+  if (r >= 0) {
+    r = sd_bus_message_append(reply, "u", node_count);
+  }
+  if (r >= 0) {
+    r = sd_bus_send(NULL, reply, NULL);
+  }
+  sd_bus_message_unref(reply);
+
+  return r;
+}
+
+static int dbus_get_fan_version(sd_bus *bus, const char *path, const char *interface,
+                               const char *property, sd_bus_message *reply, 
+                               void *userdata, sd_bus_error *ret_error)
 {
   ws_br_agent_settings_t settings = { 0U };
   uint8_t value = 0U;
@@ -483,16 +1264,28 @@ static int dbus_get_class(sd_bus *bus, const char *path, const char *interface,
   (void) path;
   (void) interface;
   (void) property;
-  (void) userdata;
   (void) ret_error;
 
-  if (ws_br_agent_soc_host_get_settings(&settings) != WS_BR_AGENT_RET_OK) {
+  if (ws_br_agent_soc_host_shard_get_settings(dbus_shard(userdata), &settings)
+      != WS_BR_AGENT_RET_OK) {
     return -1;
   }
-  value = settings.phy.type != WS_BR_AGENT_PHY_CONFIG_FAN10 ? 0U :
-           settings.phy.config.fan10.op_class;
 
-  return sd_bus_message_append(reply, "u", value);
+  switch (settings.phy.type) {
+    case WS_BR_AGENT_PHY_CONFIG_FAN11:
+      value = 2U;
+      break;
+    
+    case WS_BR_AGENT_PHY_CONFIG_FAN10:
+      value = 1U;
+      break;
+
+    default: 
+      value = 0U;
+      break;
+  }
+
+  return sd_bus_message_append(reply, "y", value);
 }
 
 static int dbus_method_restart_br(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
@@ -503,12 +1296,11 @@ static int dbus_method_restart_br(sd_bus_message *m, void *userdata, sd_bus_erro
     .payload_len = 0 
   };
   
-  (void) userdata;
   (void) ret_error;
   
   ws_br_agent_log_info("D-Bus method RestartSoCBorderRouter called\n");
-  // Send request to SoC host
-  if (ws_br_agent_soc_host_send_req(&msg, NULL) != WS_BR_AGENT_RET_OK) {
+  // Send request to the SoC of this object
+  if (ws_br_agent_soc_host_shard_send_req(dbus_shard(userdata), &msg, NULL) != WS_BR_AGENT_RET_OK) {
     ws_br_agent_log_error("D-Bus: Failed to send restart BR request to SoC host\n");
   } else {
     ws_br_agent_log_info("D-Bus: Restart BR request sent successfully\n");
@@ -525,12 +1317,11 @@ static int dbus_method_stop_br(sd_bus_message *m, void *userdata, sd_bus_error *
     .payload_len = 0 
   };
   
-  (void) userdata;
   (void) ret_error;
 
   ws_br_agent_log_info("D-Bus method StopSoCBorderRouter called\n");
-  // Send request to SoC host
-  if (ws_br_agent_soc_host_send_req(&msg, NULL) != WS_BR_AGENT_RET_OK) {
+  // Send request to the SoC of this object
+  if (ws_br_agent_soc_host_shard_send_req(dbus_shard(userdata), &msg, NULL) != WS_BR_AGENT_RET_OK) {
     ws_br_agent_log_error("D-Bus: Failed to send stop BR request to SoC host\n");
   } else {
     ws_br_agent_log_info("D-Bus: Stop BR request sent successfully\n");
@@ -547,12 +1338,11 @@ static int dbus_method_set_config(sd_bus_message *m, void *userdata, sd_bus_erro
     .payload_len = sizeof(ws_br_agent_settings_t)
   };
   
-  (void) userdata;
   (void) ret_error;
 
   ws_br_agent_log_info("D-Bus method SetSoCBorderRouterConfig called\n");
-  // Send request to SoC host
-  if (ws_br_agent_soc_host_send_req(&msg, NULL) != WS_BR_AGENT_RET_OK) {
+  // Send request to the SoC of this object
+  if (ws_br_agent_soc_host_shard_send_req(dbus_shard(userdata), &msg, NULL) != WS_BR_AGENT_RET_OK) {
     ws_br_agent_log_error("D-Bus: Failed to send set config request to SoC host\n");
   } else {
     ws_br_agent_log_info("D-Bus: Set config request sent successfully\n");
@@ -563,29 +1353,67 @@ static int dbus_method_set_config(sd_bus_message *m, void *userdata, sd_bus_erro
 
 static void dbus_thr_fnc(void *arg)
 {
+  struct pollfd pfd[2] = { 0 };
+  struct timespec now = { 0 };
+  uint64_t timeout_us = 0ULL;
+  uint64_t now_us = 0ULL;
+  eventfd_t val = 0U;
+  int timeout_ms = -1;
+  int events = 0;
+  int r = 0;
+
   (void) arg;
 
-  assert(dbus_init(&bus, &slot) == WS_BR_AGENT_RET_OK);
   ws_br_agent_log_warn("D-Bus service started\n");
+  ws_br_agent_service_watchdog_start(WS_BR_AGENT_SERVICE_LOOP_DBUS);
+  pfd[0].fd = sd_bus_get_fd(bus);
+  pfd[1].fd = dbus_wakeup_fd;
+  pfd[1].events = POLLIN;
   while (!dbus_thread_stop) {
-    sd_bus_process(bus, NULL);
+    ws_br_agent_service_watchdog_kick(WS_BR_AGENT_SERVICE_LOOP_DBUS);
+    // Dispatch everything pending, then sleep until the bus or the wakeup event is ready
+    pthread_mutex_lock(&bus_mutex);
+    do {
+      r = sd_bus_process(bus, NULL);
+    } while (r > 0);
+    events = sd_bus_get_events(bus);
+    if (sd_bus_get_timeout(bus, &timeout_us) < 0) {
+      timeout_us = UINT64_MAX;
+    }
+    pthread_mutex_unlock(&bus_mutex);
     if (dbus_thread_stop) {
       break;
     }
-    sd_bus_wait(bus, 1000000UL); // 1 second
+
+    // sd-bus timeouts are absolute CLOCK_MONOTONIC times
+    timeout_ms = -1;
+    if (timeout_us != UINT64_MAX) {
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      now_us = (uint64_t)now.tv_sec * 1000000ULL + (uint64_t)now.tv_nsec / 1000ULL;
+      timeout_ms = timeout_us > now_us ? (int)((timeout_us - now_us + 999ULL) / 1000ULL) : 0;
+    }
+    if (ws_br_agent_service_watchdog_interval_ms() >= 0
+        && (timeout_ms < 0 || timeout_ms > ws_br_agent_service_watchdog_interval_ms())) {
+      timeout_ms = ws_br_agent_service_watchdog_interval_ms();
+    }
+    pfd[0].events = (short)(events > 0 ? events : POLLIN);
+    if (poll(pfd, 2U, timeout_ms) > 0 && (pfd[1].revents & POLLIN)) {
+      (void) eventfd_read(dbus_wakeup_fd, &val);
+    }
   }
 
-  sd_bus_slot_unref(slot);
-  sd_bus_unref(bus);
+  ws_br_agent_service_watchdog_stop(WS_BR_AGENT_SERVICE_LOOP_DBUS);
+  pthread_mutex_lock(&bus_mutex);
+  slot = sd_bus_slot_unref(slot);
+  bus = sd_bus_unref(bus);
+  pthread_mutex_unlock(&bus_mutex);
   ws_br_agent_log_warn("D-Bus service stopped\n");
 }
 
-static bool is_zero_addr(const uint8_t addr[16]) 
+static void dbus_wakeup(void)
 {
-  for (size_t i = 0; i < 16U; ++i) {
-    if (addr[i]) {
-      return false;
-    }
+  // No thread to wake up in event loop mode
+  if (dbus_wakeup_fd >= 0) {
+    (void) eventfd_write(dbus_wakeup_fd, 1U);
   }
-  return true;
-}
\ No newline at end of file
+}
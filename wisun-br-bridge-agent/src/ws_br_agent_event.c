@@ -0,0 +1,123 @@
+/***************************************************************************//**
+ * @file ws_br_agent_event.c
+ * @brief Wi-SUN SoC Border Router Agent single-threaded event loop
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#include <signal.h>
+#include <string.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "event"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_event.h"
+#include "ws_br_agent_config.h"
+
+static sd_event *event = NULL;
+
+static int event_signal_hnd(sd_event_source *s, const struct signalfd_siginfo *si, void *userdata);
+
+ws_br_agent_ret_t ws_br_agent_event_init(void)
+{
+  sigset_t mask;
+  int r = 0;
+
+  r = sd_event_default(&event);
+  if (r < 0) {
+    ws_br_agent_log_error("Failed to create the event loop: %s\n", strerror(-r));
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Termination and reload signals are read from a signalfd by the loop
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  sigaddset(&mask, SIGHUP);
+  sigprocmask(SIG_BLOCK, &mask, NULL);
+  if (sd_event_add_signal(event, NULL, SIGINT, event_signal_hnd, NULL) < 0
+      || sd_event_add_signal(event, NULL, SIGTERM, event_signal_hnd, NULL) < 0
+      || sd_event_add_signal(event, NULL, SIGHUP, event_signal_hnd, NULL) < 0) {
+    ws_br_agent_log_error("Failed to add the signal sources\n");
+    event = sd_event_unref(event);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Pings the systemd watchdog from the loop itself, when enabled
+  if (sd_event_set_watchdog(event, 1) < 0) {
+    ws_br_agent_log_warn("Failed to enable the watchdog\n");
+  }
+
+  ws_br_agent_log_info("Single-threaded event loop mode\n");
+  return WS_BR_AGENT_RET_OK;
+}
+
+void ws_br_agent_event_deinit(void)
+{
+  event = sd_event_unref(event);
+}
+
+sd_event *ws_br_agent_event_get(void)
+{
+  return event;
+}
+
+ws_br_agent_ret_t ws_br_agent_event_run(void)
+{
+  int r = 0;
+
+  if (event == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  r = sd_event_loop(event);
+  if (r < 0) {
+    ws_br_agent_log_error("Event loop failed: %s\n", strerror(-r));
+    return WS_BR_AGENT_RET_ERR;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+void ws_br_agent_event_exit(void)
+{
+  if (event != NULL) {
+    (void) sd_event_exit(event, 0);
+  }
+}
+
+static int event_signal_hnd(sd_event_source *s, const struct signalfd_siginfo *si, void *userdata)
+{
+  (void) s;
+  (void) userdata;
+
+  if (si->ssi_signo == SIGHUP) {
+    ws_br_agent_log_info("Received SIGHUP\n");
+    (void) ws_br_agent_config_reload();
+    return 0;
+  }
+  ws_br_agent_log_info("Received %s\n", si->ssi_signo == SIGTERM ? "SIGTERM" : "SIGINT");
+  ws_br_agent_event_exit();
+  return 0;
+}
@@ -0,0 +1,750 @@
+/***************************************************************************//**
+ * @file ws_br_agent_history.c
+ * @brief Bounded topology history: keyframes and deltas in a ring
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "history"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_mem.h"
+#include "ws_br_agent_metrics.h"
+#include "ws_br_agent_utils.h"
+#include "ws_br_agent_history.h"
+
+/// History file magic ("WSBH")
+#define HISTORY_MAGIC 0x57534248UL
+/// Ring offset in the mapping, after the header page
+#define HISTORY_DATA_OFFSET 4096U
+/// Record alignment
+#define HISTORY_ALIGN 8U
+/// Topology entry size
+#define HISTORY_ENTRY_SIZE sizeof(ws_br_agent_soc_host_topology_entry_t)
+/// Delta change size: entry index and entry
+#define HISTORY_CHANGE_SIZE (sizeof(uint32_t) + HISTORY_ENTRY_SIZE)
+/// Reconstruction buffer size, a full topology
+#define HISTORY_TOPOLOGY_SIZE (WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES * HISTORY_ENTRY_SIZE)
+/// Ring bytes kept free behind the oldest record: a query reads the records outside of the lock,
+/// they stay intact until that many bytes are recorded meanwhile
+#define HISTORY_GUARD(capacity) ((capacity) / 8U)
+/// Query attempts when the records read are overwritten meanwhile
+#define HISTORY_READ_ATTEMPTS 3U
+/// history_read_next() result when a record was overwritten while read
+#define HISTORY_TORN UINT64_MAX
+
+/// @brief Record types
+typedef enum history_rec_type {
+  /// Unused end of the ring
+  HISTORY_REC_PAD = 0,
+  /// Full topology: entry_count entries
+  HISTORY_REC_KEYFRAME,
+  /// Changes from the previous version of the SoC: change_count indexes, then change_count entries
+  HISTORY_REC_DELTA,
+} history_rec_type_t;
+
+/// @brief Query results
+typedef enum history_read {
+  /// Found
+  HISTORY_READ_OK = 0,
+  /// No version of the SoC at that time
+  HISTORY_READ_NONE,
+  /// Records overwritten while read
+  HISTORY_READ_TORN,
+  /// Stopped by the callback
+  HISTORY_READ_STOPPED,
+} history_read_t;
+
+/// @brief Mapping header, followed by the ring at HISTORY_DATA_OFFSET
+typedef struct history_hdr {
+  /// HISTORY_MAGIC
+  uint32_t magic;
+  /// WS_BR_AGENT_HISTORY_VERSION
+  uint16_t version;
+  /// Record header size
+  uint16_t rec_hdr_size;
+  /// Topology entry size
+  uint32_t entry_size;
+  /// Reserved, 0
+  uint32_t reserved;
+  /// Ring size
+  uint64_t capacity;
+  /// Logical position of the oldest record (ring offset: position % capacity)
+  uint64_t head;
+  /// Logical position of the next record
+  uint64_t tail;
+  /// Sequence number of the next record
+  uint64_t next_seq;
+} history_hdr_t;
+
+/// @brief Record header, followed by its payload
+typedef struct history_rec {
+  /// Record size, header included, multiple of HISTORY_ALIGN
+  uint32_t size;
+  /// history_rec_type_t
+  uint8_t type;
+  /// Reserved, 0
+  uint8_t reserved[3];
+  /// Sequence number, one more than the previous record (from 1)
+  uint64_t seq;
+  /// Version time on the history clock, which orders the versions (us)
+  uint64_t order_us;
+  /// Version wall clock time, for display only (us since the Epoch)
+  uint64_t time_us;
+  /// Topology entry count of the version
+  uint32_t entry_count;
+  /// Delta: changed entry count, keyframe: entry_count
+  uint32_t change_count;
+  /// SoC address
+  uint8_t soc[16];
+} history_rec_t;
+
+_Static_assert(sizeof(history_rec_t) % HISTORY_ALIGN == 0U, "Records must stay aligned");
+
+/// @brief Recording state of a SoC
+typedef struct history_shard {
+  /// SoC address of the shard when last recorded
+  uint8_t soc[16];
+  /// A keyframe of that SoC was recorded since start-up (the deltas apply to it)
+  bool keyframe;
+  /// Logical position of the last keyframe
+  uint64_t keyframe_pos;
+  /// Delta bytes recorded since the last keyframe
+  size_t delta_bytes;
+} history_shard_t;
+
+/// Serializes the recording and the query snapshots, queries decode outside of it
+static pthread_mutex_t history_mutex = PTHREAD_MUTEX_INITIALIZER;
+static history_hdr_t *hdr = NULL;
+static uint8_t *ring = NULL;
+static size_t map_size = 0U;
+static int history_fd = -1;
+static history_shard_t shards[WS_BR_AGENT_SOC_HOST_MAX_COUNT];
+/// Changed entry indexes of the version being recorded
+static uint32_t changes[WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES];
+/// History clock: CLOCK_MONOTONIC plus this offset, which carries on from the restored records
+static int64_t order_base_us = 0;
+/// End of the ring region written so far or being written, published before the write:
+/// a query checks its records against it once read
+static atomic_uint_fast64_t history_frontier = 0U;
+
+static bool history_check(uint64_t * const last_order_us, uint64_t * const last_time_us);
+static void history_reset(void);
+static uint64_t history_reserve(size_t size);
+static void history_apply(const history_rec_t * const rec, const uint8_t *payload,
+                          ws_br_agent_soc_host_topology_t * const topology);
+static ws_br_agent_ret_t history_alloc_topology(ws_br_agent_soc_host_topology_t * const topology);
+static bool history_snapshot(uint64_t * const head, uint64_t * const tail);
+static history_read_t history_read_topology(const uint8_t soc[16], uint64_t order_us, uint64_t head, uint64_t tail,
+                                            ws_br_agent_soc_host_topology_t * const topology,
+                                            uint64_t * const version_us);
+static history_read_t history_read_node(const uint8_t soc[16], const uint8_t addr[16], uint64_t head,
+                                        uint64_t tail, ws_br_agent_soc_host_topology_t * const state,
+                                        ws_br_agent_history_node_cb_t cb, void *ctx, bool * const reported);
+
+static inline size_t history_align(size_t size)
+{
+  return (size + HISTORY_ALIGN - 1U) & ~(size_t)(HISTORY_ALIGN - 1U);
+}
+
+/// Record at a logical position, NULL in the gap too small for a record at the end of the ring
+static inline history_rec_t *history_rec_at(uint64_t pos)
+{
+  size_t off = pos % hdr->capacity;
+
+  if (hdr->capacity - off < sizeof(history_rec_t)) {
+    return NULL;
+  }
+  return (history_rec_t *)(ring + off);
+}
+
+/// Position following the record (or gap) at pos
+static inline uint64_t history_next(uint64_t pos)
+{
+  const history_rec_t *rec = history_rec_at(pos);
+
+  return rec != NULL ? pos + rec->size : pos + (hdr->capacity - pos % hdr->capacity);
+}
+
+/// Current time on the history clock
+static inline uint64_t history_order_now(void)
+{
+  return (uint64_t)((int64_t)ws_br_agent_utils_get_monotonic_us() + order_base_us);
+}
+
+/// History clock time of a wall clock time, through the current offset between the clocks
+static uint64_t history_order_of(uint64_t time_us)
+{
+  uint64_t now_order = history_order_now();
+  uint64_t now_us = ws_br_agent_utils_get_realtime_us();
+
+  if (time_us >= now_us) {
+    return time_us - now_us > UINT64_MAX - now_order ? UINT64_MAX : now_order + (time_us - now_us);
+  }
+  return now_us - time_us > now_order ? 0U : now_order - (now_us - time_us);
+}
+
+/// Record header consistent with its position and the limits, whatever the ring content
+static bool history_rec_valid(uint64_t pos, const history_rec_t * const rec)
+{
+  size_t room = hdr->capacity - pos % hdr->capacity;
+  size_t payload = 0U;
+
+  if (rec->size < sizeof(history_rec_t) || rec->size % HISTORY_ALIGN || rec->size > room
+      || rec->type > HISTORY_REC_DELTA) {
+    return false;
+  }
+  if (rec->type == HISTORY_REC_PAD) {
+    return rec->size == room;
+  }
+  payload = rec->type == HISTORY_REC_DELTA ? (size_t)rec->change_count * HISTORY_CHANGE_SIZE
+                                           : (size_t)rec->change_count * HISTORY_ENTRY_SIZE;
+  return rec->entry_count <= WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES
+         && rec->change_count <= WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES
+         && sizeof(history_rec_t) + payload <= rec->size;
+}
+
+/// The ring content read at pos is still the one recorded there (called once read)
+static inline bool history_intact(uint64_t pos)
+{
+  atomic_thread_fence(memory_order_acquire);
+  return atomic_load_explicit(&history_frontier, memory_order_relaxed) <= pos + hdr->capacity;
+}
+
+/**
+ * Copy of the first topology record header at or after pos, outside of the lock.
+ * @param[in] pos Logical position.
+ * @param[in] tail Snapshot tail.
+ * @param[in,out] seq Expected sequence number (0: any), then the next one.
+ * @param[out] rec Record header.
+ * @return Position of the record, tail if none, HISTORY_TORN if the headers read were overwritten.
+ */
+static uint64_t history_read_next(uint64_t pos, uint64_t tail, uint64_t * const seq, history_rec_t * const rec)
+{
+  uint64_t start = pos;
+
+  while (pos < tail) {
+    if (history_rec_at(pos) == NULL) {
+      pos += hdr->capacity - pos % hdr->capacity;
+      continue;
+    }
+    memcpy(rec, history_rec_at(pos), sizeof(*rec));
+    if (!history_rec_valid(pos, rec)) {
+      return HISTORY_TORN;
+    }
+    if (rec->type != HISTORY_REC_PAD) {
+      if ((*seq && rec->seq != *seq) || !history_intact(start)) {
+        return HISTORY_TORN;
+      }
+      *seq = rec->seq + 1U;
+      return pos;
+    }
+    pos += rec->size;
+  }
+  return history_intact(start) ? tail : HISTORY_TORN;
+}
+
+ws_br_agent_ret_t ws_br_agent_history_init(size_t size, const char *path)
+{
+  size_t capacity = size & ~(size_t)(HISTORY_ALIGN - 1U);
+  struct stat st = { 0 };
+  void *map = NULL;
+  uint64_t last_order_us = 0U;
+  uint64_t last_time_us = 0U;
+  uint64_t now_us = 0U;
+
+  if (!size) {
+    ws_br_agent_log_info("Topology history disabled\n");
+    return WS_BR_AGENT_RET_OK;
+  }
+  if (capacity < WS_BR_AGENT_HISTORY_MIN_SIZE) {
+    ws_br_agent_log_error("Topology history size too small: %zu (min %u bytes)\n",
+                          size, WS_BR_AGENT_HISTORY_MIN_SIZE);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  map_size = HISTORY_DATA_OFFSET + capacity;
+  // Resident as the ring fills, file mapping or not
+  if (ws_br_agent_mem_reserve(WS_BR_AGENT_MEM_SUBSYS_HISTORY, map_size) != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_error("Topology history (%zu bytes) exceeds the memory budget\n", map_size);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  if (path != NULL) {
+    history_fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (history_fd < 0 || fstat(history_fd, &st) < 0
+        || ((size_t)st.st_size != map_size && ftruncate(history_fd, (off_t)map_size) < 0)) {
+      ws_br_agent_log_error("Failed to open %s: %s\n", path, strerror(errno));
+      if (history_fd >= 0) {
+        close(history_fd);
+        history_fd = -1;
+      }
+      ws_br_agent_mem_release(WS_BR_AGENT_MEM_SUBSYS_HISTORY, map_size);
+      return WS_BR_AGENT_RET_ERR;
+    }
+    map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, history_fd, 0);
+  } else {
+    // Only the pages written so far are resident
+    map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if (map == MAP_FAILED) {
+    ws_br_agent_log_error("Failed to map the topology history: %s\n", strerror(errno));
+    if (history_fd >= 0) {
+      close(history_fd);
+      history_fd = -1;
+    }
+    ws_br_agent_mem_release(WS_BR_AGENT_MEM_SUBSYS_HISTORY, map_size);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  pthread_mutex_lock(&history_mutex);
+  hdr = (history_hdr_t *)map;
+  ring = (uint8_t *)map + HISTORY_DATA_OFFSET;
+  memset(shards, 0, sizeof(shards));
+  now_us = ws_br_agent_utils_get_realtime_us();
+  if (path != NULL && history_check(&last_order_us, &last_time_us)) {
+    ws_br_agent_log_info("Restored %llu bytes of topology history from %s\n",
+                         (unsigned long long)(hdr->tail - hdr->head), path);
+    // The history clock carries on from the last record, by the wall clock time elapsed if it went forward
+    now_us = last_order_us + (now_us > last_time_us ? now_us - last_time_us : 0U);
+  } else {
+    history_reset();
+  }
+  order_base_us = (int64_t)now_us - (int64_t)ws_br_agent_utils_get_monotonic_us();
+  atomic_store(&history_frontier, hdr->tail);
+  ws_br_agent_metrics_set(WS_BR_AGENT_METRIC_HISTORY_BYTES, (int64_t)(hdr->tail - hdr->head));
+  pthread_mutex_unlock(&history_mutex);
+
+  ws_br_agent_log_info("Topology history: %zu bytes%s%s\n", capacity,
+                       path != NULL ? " in " : "", path != NULL ? path : "");
+  return WS_BR_AGENT_RET_OK;
+}
+
+void ws_br_agent_history_deinit(void)
+{
+  pthread_mutex_lock(&history_mutex);
+  if (hdr != NULL) {
+    (void) munmap(hdr, map_size);
+    ws_br_agent_mem_release(WS_BR_AGENT_MEM_SUBSYS_HISTORY, map_size);
+    hdr = NULL;
+    ring = NULL;
+  }
+  if (history_fd >= 0) {
+    close(history_fd);
+    history_fd = -1;
+  }
+  pthread_mutex_unlock(&history_mutex);
+}
+
+void ws_br_agent_history_record(size_t shard, const struct in6_addr * const soc,
+                                const ws_br_agent_topo_t * const prev,
+                                const ws_br_agent_soc_host_topology_t * const topology)
+{
+  static bool too_large_logged = false;
+  history_shard_t *hs = NULL;
+  history_rec_t *rec = NULL;
+  uint8_t *payload = NULL;
+  uint32_t change_count = 0U;
+  size_t key_size = 0U;
+  size_t delta_size = 0U;
+  uint64_t pos = 0U;
+  bool keyframe = false;
+
+  if (shard >= WS_BR_AGENT_SOC_HOST_MAX_COUNT || soc == NULL || topology == NULL || topology->entries == NULL
+      || topology->entry_count > WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES) {
+    return;
+  }
+
+  pthread_mutex_lock(&history_mutex);
+  if (hdr == NULL) {
+    pthread_mutex_unlock(&history_mutex);
+    return;
+  }
+  hs = &shards[shard];
+  // A shard taken over by another SoC starts a new chain
+  if (memcmp(hs->soc, soc->s6_addr, sizeof(hs->soc))) {
+    memcpy(hs->soc, soc->s6_addr, sizeof(hs->soc));
+    hs->keyframe = false;
+  }
+  key_size = history_align(sizeof(history_rec_t) + topology->entry_count * HISTORY_ENTRY_SIZE);
+  if (key_size > hdr->capacity - HISTORY_GUARD(hdr->capacity)) {
+    // The next version that fits starts a new chain
+    hs->keyframe = false;
+    pthread_mutex_unlock(&history_mutex);
+    if (!too_large_logged) {
+      too_large_logged = true;
+      ws_br_agent_log_warn("Topology of %u entries too large for the history\n", topology->entry_count);
+    }
+    return;
+  }
+
+  // Delta from the previous version, unless its keyframe is gone or the replay would cost
+  // more than a keyframe: churn-heavy updates are stored as keyframes
+  keyframe = !hs->keyframe || hs->keyframe_pos < hdr->head || !prev->node_count;
+  if (!keyframe) {
+    change_count = ws_br_agent_topo_diff(prev, topology, changes);
+    if (!change_count && topology->entry_count == prev->node_count) {
+      pthread_mutex_unlock(&history_mutex);
+      return;
+    }
+    delta_size = history_align(sizeof(history_rec_t) + change_count * HISTORY_CHANGE_SIZE);
+    keyframe = hs->delta_bytes + delta_size > key_size;
+  }
+  if (!keyframe) {
+    pos = history_reserve(delta_size);
+    // The room made may have evicted the keyframe
+    keyframe = hs->keyframe_pos < hdr->head;
+  }
+  if (keyframe) {
+    change_count = topology->entry_count;
+    pos = history_reserve(key_size);
+  }
+
+  rec = history_rec_at(pos);
+  *rec = (history_rec_t) {
+    .size = (uint32_t)(keyframe ? key_size : delta_size),
+    .type = keyframe ? HISTORY_REC_KEYFRAME : HISTORY_REC_DELTA,
+    .seq = hdr->next_seq,
+    .order_us = history_order_now(),
+    .time_us = ws_br_agent_utils_get_realtime_us(),
+    .entry_count = topology->entry_count,
+    .change_count = change_count,
+  };
+  memcpy(rec->soc, soc->s6_addr, sizeof(rec->soc));
+  payload = (uint8_t *)(rec + 1);
+  if (keyframe) {
+    memcpy(payload, topology->entries, topology->entry_count * HISTORY_ENTRY_SIZE);
+    hs->keyframe = true;
+    hs->keyframe_pos = pos;
+    hs->delta_bytes = 0U;
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_HISTORY_KEYFRAMES, 1U);
+  } else {
+    memcpy(payload, changes, change_count * sizeof(uint32_t));
+    payload += change_count * sizeof(uint32_t);
+    for (uint32_t i = 0U; i < change_count; ++i) {
+      memcpy(payload + i * HISTORY_ENTRY_SIZE, &topology->entries[changes[i]], HISTORY_ENTRY_SIZE);
+    }
+    hs->delta_bytes += delta_size;
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_HISTORY_DELTAS, 1U);
+  }
+  // Committed last: an interrupted write is not part of the ring
+  hdr->next_seq++;
+  hdr->tail = pos + rec->size;
+  ws_br_agent_metrics_set(WS_BR_AGENT_METRIC_HISTORY_BYTES, (int64_t)(hdr->tail - hdr->head));
+  pthread_mutex_unlock(&history_mutex);
+}
+
+ws_br_agent_ret_t ws_br_agent_history_get_topology(const struct in6_addr * const soc, uint64_t time_us,
+                                                   ws_br_agent_soc_host_topology_t * const topology,
+                                                   uint64_t * const version_us)
+{
+  history_read_t res = HISTORY_READ_TORN;
+  uint64_t head = 0U;
+  uint64_t tail = 0U;
+
+  if (soc == NULL || topology == NULL || version_us == NULL
+      || history_alloc_topology(topology) != WS_BR_AGENT_RET_OK) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  // Decoded outside of the lock, again if recording overwrote the records meanwhile
+  for (uint32_t i = 0U; i < HISTORY_READ_ATTEMPTS && res == HISTORY_READ_TORN; ++i) {
+    if (!history_snapshot(&head, &tail)) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+    res = history_read_topology(soc->s6_addr, history_order_of(time_us), head, tail, topology, version_us);
+  }
+  if (res != HISTORY_READ_OK) {
+    topology->entry_count = 0U;
+    return WS_BR_AGENT_RET_ERR;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+ws_br_agent_ret_t ws_br_agent_history_get_node(const struct in6_addr * const soc, const uint8_t addr[16],
+                                               ws_br_agent_history_node_cb_t cb, void *ctx)
+{
+  ws_br_agent_soc_host_topology_t state = { 0U, NULL };
+  history_read_t res = HISTORY_READ_TORN;
+  uint64_t head = 0U;
+  uint64_t tail = 0U;
+  bool reported = false;
+
+  if (soc == NULL || addr == NULL || cb == NULL || history_alloc_topology(&state) != WS_BR_AGENT_RET_OK) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  // Decoded outside of the lock, again if recording overwrote the records before any was reported
+  for (uint32_t i = 0U; i < HISTORY_READ_ATTEMPTS && res == HISTORY_READ_TORN && !reported; ++i) {
+    if (!history_snapshot(&head, &tail)) {
+      break;
+    }
+    res = history_read_node(soc->s6_addr, addr, head, tail, &state, cb, ctx, &reported);
+  }
+  (void) ws_br_agent_soc_host_free_topology(&state);
+  return res == HISTORY_READ_OK ? WS_BR_AGENT_RET_OK : WS_BR_AGENT_RET_ERR;
+}
+
+/// Ring span to query, false if the history is disabled
+static bool history_snapshot(uint64_t * const head, uint64_t * const tail)
+{
+  pthread_mutex_lock(&history_mutex);
+  if (hdr == NULL) {
+    pthread_mutex_unlock(&history_mutex);
+    return false;
+  }
+  *head = hdr->head;
+  *tail = hdr->tail;
+  pthread_mutex_unlock(&history_mutex);
+  return true;
+}
+
+/// Replay the version of a SoC in force at a history clock time: its last keyframe, then its deltas
+static history_read_t history_read_topology(const uint8_t soc[16], uint64_t order_us, uint64_t head, uint64_t tail,
+                                            ws_br_agent_soc_host_topology_t * const topology,
+                                            uint64_t * const version_us)
+{
+  history_rec_t rec = { 0 };
+  uint64_t keyframe_pos = UINT64_MAX;
+  uint64_t seq = 0U;
+  uint64_t pos = head;
+
+  while ((pos = history_read_next(pos, tail, &seq, &rec)) < tail && rec.order_us <= order_us) {
+    if (rec.type == HISTORY_REC_KEYFRAME && !memcmp(rec.soc, soc, sizeof(rec.soc))) {
+      keyframe_pos = pos;
+    }
+    pos += rec.size;
+  }
+  if (pos == HISTORY_TORN) {
+    return HISTORY_READ_TORN;
+  }
+  if (keyframe_pos == UINT64_MAX) {
+    return HISTORY_READ_NONE;
+  }
+
+  seq = 0U;
+  pos = keyframe_pos;
+  while ((pos = history_read_next(pos, tail, &seq, &rec)) < tail && rec.order_us <= order_us) {
+    if (!memcmp(rec.soc, soc, sizeof(rec.soc))) {
+      history_apply(&rec, (const uint8_t *)history_rec_at(pos) + sizeof(rec), topology);
+      *version_us = rec.time_us;
+    }
+    if (!history_intact(pos)) {
+      return HISTORY_READ_TORN;
+    }
+    pos += rec.size;
+  }
+  return pos == HISTORY_TORN ? HISTORY_READ_TORN : HISTORY_READ_OK;
+}
+
+/// Replay the versions of a SoC from its oldest keyframe, following the entry of a node:
+/// after a delta, it is either at the same index or at a changed one
+static history_read_t history_read_node(const uint8_t soc[16], const uint8_t addr[16], uint64_t head,
+                                        uint64_t tail, ws_br_agent_soc_host_topology_t * const state,
+                                        ws_br_agent_history_node_cb_t cb, void *ctx, bool * const reported)
+{
+  const ws_br_agent_soc_host_topology_entry_t *entry = NULL;
+  const uint8_t *payload = NULL;
+  history_rec_t rec = { 0 };
+  uint8_t last_parents[2U * 16U] = { 0U };
+  uint32_t index = UINT32_MAX;
+  uint32_t change = 0U;
+  uint64_t seq = 0U;
+  uint64_t pos = head;
+  bool started = false;
+  bool present = false;
+
+  for (; (pos = history_read_next(pos, tail, &seq, &rec)) < tail; pos += rec.size) {
+    if (memcmp(rec.soc, soc, sizeof(rec.soc)) || (!started && rec.type != HISTORY_REC_KEYFRAME)) {
+      continue;
+    }
+    started = true;
+    payload = (const uint8_t *)history_rec_at(pos) + sizeof(rec);
+    history_apply(&rec, payload, state);
+
+    if (index >= state->entry_count || memcmp(state->entries[index].target, addr, 16U)) {
+      index = UINT32_MAX;
+      for (uint32_t i = 0U; i < rec.change_count && index == UINT32_MAX; ++i) {
+        if (rec.type == HISTORY_REC_DELTA) {
+          memcpy(&change, payload + i * sizeof(uint32_t), sizeof(change));
+        } else {
+          change = i;
+        }
+        if (change < state->entry_count && !memcmp(state->entries[change].target, addr, 16U)) {
+          index = change;
+        }
+      }
+    }
+    if (!history_intact(pos)) {
+      return HISTORY_READ_TORN;
+    }
+    entry = index != UINT32_MAX ? &state->entries[index] : NULL;
+
+    // Reported from its first appearance, then on presence or parent changes
+    if (!*reported && entry == NULL) {
+      continue;
+    }
+    if (*reported && present == (entry != NULL)
+        && (entry == NULL || !memcmp(last_parents, entry->preferred, sizeof(last_parents)))) {
+      continue;
+    }
+    *reported = true;
+    present = entry != NULL;
+    if (entry != NULL) {
+      memcpy(last_parents, entry->preferred, sizeof(last_parents));
+    }
+    if (cb(ctx, rec.time_us, entry) < 0) {
+      return HISTORY_READ_STOPPED;
+    }
+  }
+  return pos == HISTORY_TORN ? HISTORY_READ_TORN : HISTORY_READ_OK;
+}
+
+/// Validate the records of a history file, from the head to the tail, and get the last version times
+static bool history_check(uint64_t * const last_order_us, uint64_t * const last_time_us)
+{
+  const history_rec_t *rec = NULL;
+  size_t capacity = map_size - HISTORY_DATA_OFFSET;
+  uint64_t seq = 0U;
+  uint64_t pos = 0U;
+
+  if (hdr->magic != HISTORY_MAGIC || hdr->version != WS_BR_AGENT_HISTORY_VERSION
+      || hdr->rec_hdr_size != sizeof(history_rec_t) || hdr->entry_size != HISTORY_ENTRY_SIZE
+      || hdr->capacity != capacity || hdr->tail < hdr->head || hdr->tail - hdr->head > capacity) {
+    return false;
+  }
+  for (pos = hdr->head; pos < hdr->tail; pos = history_next(pos)) {
+    rec = history_rec_at(pos);
+    if (rec == NULL) {
+      continue;
+    }
+    if (!history_rec_valid(pos, rec)) {
+      return false;
+    }
+    if (rec->type == HISTORY_REC_PAD) {
+      continue;
+    }
+    // Versions in recording order: sequence numbers follow, the history clock does not go back
+    if ((seq && (rec->seq != seq || rec->order_us < *last_order_us)) || rec->seq >= hdr->next_seq) {
+      return false;
+    }
+    seq = rec->seq + 1U;
+    *last_order_us = rec->order_us;
+    *last_time_us = rec->time_us;
+  }
+  return pos == hdr->tail;
+}
+
+static void history_reset(void)
+{
+  *hdr = (history_hdr_t) {
+    .magic = HISTORY_MAGIC,
+    .version = WS_BR_AGENT_HISTORY_VERSION,
+    .rec_hdr_size = sizeof(history_rec_t),
+    .entry_size = HISTORY_ENTRY_SIZE,
+    .capacity = map_size - HISTORY_DATA_OFFSET,
+    .next_seq = 1U,
+  };
+}
+
+/// Make room for a record at the tail, evicting the oldest records and keeping the guard free.
+/// Returns its logical position.
+static uint64_t history_reserve(size_t size)
+{
+  uint64_t pos = hdr->tail;
+  size_t off = pos % hdr->capacity;
+  size_t room = hdr->capacity - HISTORY_GUARD(hdr->capacity);
+
+  // A record does not wrap: the end of the ring is skipped
+  if (hdr->capacity - off < size) {
+    pos += hdr->capacity - off;
+  }
+  while (pos + size - hdr->head > room) {
+    if (hdr->head >= hdr->tail) {
+      hdr->head = pos;
+      break;
+    }
+    hdr->head = history_next(hdr->head);
+  }
+  // Published before the ring is written, for the queries reading it
+  atomic_store_explicit(&history_frontier, pos + size, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  if (pos != hdr->tail && hdr->capacity - off >= sizeof(history_rec_t)) {
+    *history_rec_at(hdr->tail) = (history_rec_t) {
+      .size = (uint32_t)(hdr->capacity - off),
+      .type = HISTORY_REC_PAD,
+    };
+  }
+  if (hdr->head == hdr->tail) {
+    hdr->head = pos;
+  }
+  return pos;
+}
+
+/// Apply a record to a topology, the payload may be overwritten meanwhile: indexes are bounded
+static void history_apply(const history_rec_t * const rec, const uint8_t *payload,
+                          ws_br_agent_soc_host_topology_t * const topology)
+{
+  const uint8_t *entries = payload + rec->change_count * sizeof(uint32_t);
+  uint32_t index = 0U;
+
+  if (rec->type == HISTORY_REC_KEYFRAME) {
+    memcpy(topology->entries, payload, rec->entry_count * HISTORY_ENTRY_SIZE);
+  } else {
+    for (uint32_t i = 0U; i < rec->change_count; ++i) {
+      memcpy(&index, payload + i * sizeof(uint32_t), sizeof(index));
+      if (index < WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES) {
+        memcpy(&topology->entries[index], entries + i * HISTORY_ENTRY_SIZE, HISTORY_ENTRY_SIZE);
+      }
+    }
+  }
+  topology->entry_count = rec->entry_count;
+}
+
+/// Reconstruction buffer: a full topology, whatever the version
+static ws_br_agent_ret_t history_alloc_topology(ws_br_agent_soc_host_topology_t * const topology)
+{
+  if (topology->entries != NULL && ws_br_agent_mem_usable_size(topology->entries) < HISTORY_TOPOLOGY_SIZE) {
+    ws_br_agent_mem_free(topology->entries);
+    topology->entries = NULL;
+  }
+  if (topology->entries == NULL) {
+    topology->entries = (ws_br_agent_soc_host_topology_entry_t *)
+                        ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_TOPOLOGY, HISTORY_TOPOLOGY_SIZE);
+    if (topology->entries == NULL) {
+      topology->entry_count = 0U;
+      return WS_BR_AGENT_RET_ERR;
+    }
+  }
+  topology->entry_count = 0U;
+  return WS_BR_AGENT_RET_OK;
+}
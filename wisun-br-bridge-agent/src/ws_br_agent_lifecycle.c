@@ -0,0 +1,385 @@
+/***************************************************************************//**
+ * @file ws_br_agent_lifecycle.c
+ * @brief Per-node lifecycle tracking
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+
+#include <string.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "lifecycle"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_mem.h"
+#include "ws_br_agent_metrics.h"
+#include "ws_br_agent_lifecycle.h"
+
+/// No node
+#define LIFECYCLE_NONE UINT32_MAX
+
+/// Hash table slots: at most half full
+#define LIFECYCLE_SLOT_COUNT (2U * WS_BR_AGENT_LIFECYCLE_MAX_NODES)
+
+/// Table block: nodes, absent list links, marks, hash slots and changed entry indexes
+#define LIFECYCLE_BLOCK_SIZE \
+  ((size_t)WS_BR_AGENT_LIFECYCLE_MAX_NODES * (sizeof(ws_br_agent_lifecycle_node_t) + 3U * sizeof(uint32_t)) \
+   + (size_t)LIFECYCLE_SLOT_COUNT * sizeof(uint32_t) + WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES * sizeof(uint32_t))
+
+_Static_assert(!(WS_BR_AGENT_LIFECYCLE_MAX_NODES & (WS_BR_AGENT_LIFECYCLE_MAX_NODES - 1U)),
+               "WS_BR_AGENT_LIFECYCLE_MAX_NODES must be a power of two");
+_Static_assert(LIFECYCLE_BLOCK_SIZE <= WS_BR_AGENT_MEM_POOL_LIFECYCLE_SIZE,
+               "Lifecycle pool blocks too small for WS_BR_AGENT_LIFECYCLE_MAX_NODES");
+
+static ws_br_agent_ret_t lifecycle_alloc(ws_br_agent_lifecycle_t * const lc);
+static uint32_t lifecycle_insert(ws_br_agent_lifecycle_t * const lc, const uint8_t addr[16]);
+static void lifecycle_evict(ws_br_agent_lifecycle_t * const lc, uint32_t index);
+static void lifecycle_observe(ws_br_agent_lifecycle_t * const lc,
+                              const ws_br_agent_soc_host_topology_entry_t * const entry, uint64_t time_us);
+static void lifecycle_leave(ws_br_agent_lifecycle_t * const lc, const uint8_t addr[16]);
+
+static inline uint32_t lifecycle_hash(const uint8_t addr[16])
+{
+  uint64_t hi = 0U;
+  uint64_t lo = 0U;
+
+  memcpy(&hi, addr, sizeof(hi));
+  memcpy(&lo, addr + 8, sizeof(lo));
+  lo ^= hi * 0xC2B2AE3D27D4EB4FULL;
+  lo ^= lo >> 32;
+  return (uint32_t)((lo * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/// Slot holding a node, or the free slot ending its probe sequence
+static inline uint32_t lifecycle_slot(const ws_br_agent_lifecycle_t * const lc, const uint8_t addr[16])
+{
+  uint32_t slot = lifecycle_hash(addr) & (LIFECYCLE_SLOT_COUNT - 1U);
+
+  while (lc->slots[slot] && memcmp(lc->nodes[lc->slots[slot] - 1U].target, addr, 16U)) {
+    slot = (slot + 1U) & (LIFECYCLE_SLOT_COUNT - 1U);
+  }
+  return slot;
+}
+
+static inline uint32_t lifecycle_find(const ws_br_agent_lifecycle_t * const lc, const uint8_t addr[16])
+{
+  return lc->slots != NULL ? lc->slots[lifecycle_slot(lc, addr)] - 1U : LIFECYCLE_NONE;
+}
+
+/// Append a node that left to the absent list
+static void lifecycle_gone_push(ws_br_agent_lifecycle_t * const lc, uint32_t index)
+{
+  lc->prev_gone[index] = lc->last_gone;
+  lc->next_gone[index] = LIFECYCLE_NONE;
+  if (lc->last_gone != LIFECYCLE_NONE) {
+    lc->next_gone[lc->last_gone] = index;
+  } else {
+    lc->first_gone = index;
+  }
+  lc->last_gone = index;
+}
+
+/// Remove a node from the absent list
+static void lifecycle_gone_unlink(ws_br_agent_lifecycle_t * const lc, uint32_t index)
+{
+  if (lc->prev_gone[index] != LIFECYCLE_NONE) {
+    lc->next_gone[lc->prev_gone[index]] = lc->next_gone[index];
+  } else {
+    lc->first_gone = lc->next_gone[index];
+  }
+  if (lc->next_gone[index] != LIFECYCLE_NONE) {
+    lc->prev_gone[lc->next_gone[index]] = lc->prev_gone[index];
+  } else {
+    lc->last_gone = lc->prev_gone[index];
+  }
+}
+
+ws_br_agent_ret_t ws_br_agent_lifecycle_update(ws_br_agent_lifecycle_t * const lc,
+                                               const ws_br_agent_topo_t * const prev,
+                                               const ws_br_agent_soc_host_topology_t * const topology,
+                                               uint64_t time_us)
+{
+  uint32_t change_count = 0U;
+  uint32_t index = LIFECYCLE_NONE;
+  uint32_t next = LIFECYCLE_NONE;
+  uint8_t addr[16] = { 0U };
+
+  if (lc == NULL || prev == NULL || topology == NULL || topology->entries == NULL
+      || topology->entry_count > WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  // Sized once: an update never allocates afterwards
+  if (lc->nodes == NULL && lifecycle_alloc(lc) != WS_BR_AGENT_RET_OK) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Unchanged entries keep their target and parents: only the changed ones are visited
+  change_count = ws_br_agent_topo_diff(prev, topology, lc->changes);
+  if (!++lc->mark) {
+    memset(lc->marks, 0, WS_BR_AGENT_LIFECYCLE_MAX_NODES * sizeof(uint32_t));
+    lc->mark = 1U;
+  }
+  for (uint32_t i = 0U; i < change_count; ++i) {
+    index = lifecycle_find(lc, topology->entries[lc->changes[i]].target);
+    if (index != LIFECYCLE_NONE) {
+      lc->marks[index] = lc->mark;
+    }
+  }
+
+  // Targets replaced by a changed entry or past the new end, unless listed by another changed entry
+  // (a node moved to another index makes that entry change). Done first: the nodes that left
+  // make room for the new ones.
+  for (uint32_t i = 0U; i < change_count && lc->changes[i] < prev->node_count; ++i) {
+    ws_br_agent_topo_get_addr(prev, lc->changes[i], addr);
+    lifecycle_leave(lc, addr);
+  }
+  for (uint32_t i = topology->entry_count; i < prev->node_count; ++i) {
+    ws_br_agent_topo_get_addr(prev, i, addr);
+    lifecycle_leave(lc, addr);
+  }
+
+  // Forgotten after a long absence, from the longest gone, unless back in this update
+  for (index = lc->first_gone; index != LIFECYCLE_NONE
+       && lc->nodes[index].last_seen_us + WS_BR_AGENT_LIFECYCLE_MAX_ABSENCE_S * 1000000ULL < time_us;
+       index = next) {
+    next = lc->next_gone[index];
+    if (lc->marks[index] != lc->mark) {
+      // The last node takes the index of the evicted one
+      next = next == lc->count - 1U ? index : next;
+      lifecycle_evict(lc, index);
+    }
+  }
+
+  // New targets, returns and parent changes
+  for (uint32_t i = 0U; i < change_count; ++i) {
+    lifecycle_observe(lc, &topology->entries[lc->changes[i]], time_us);
+  }
+
+  lc->update_us = time_us;
+  return WS_BR_AGENT_RET_OK;
+}
+
+ws_br_agent_ret_t ws_br_agent_lifecycle_get(const ws_br_agent_lifecycle_t * const lc, const uint8_t addr[16],
+                                            ws_br_agent_lifecycle_node_t * const node)
+{
+  uint32_t index = LIFECYCLE_NONE;
+
+  if (lc == NULL || addr == NULL || node == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  index = lifecycle_find(lc, addr);
+  if (index == LIFECYCLE_NONE) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  *node = lc->nodes[index];
+  if (node->present) {
+    node->last_seen_us = lc->update_us;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+ws_br_agent_ret_t ws_br_agent_lifecycle_foreach(const ws_br_agent_lifecycle_t * const lc,
+                                                ws_br_agent_lifecycle_cb_t cb, void *ctx)
+{
+  ws_br_agent_lifecycle_node_t node = { 0 };
+
+  if (lc == NULL || cb == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  for (uint32_t i = 0U; i < lc->count; ++i) {
+    node = lc->nodes[i];
+    if (node.present) {
+      node.last_seen_us = lc->update_us;
+    }
+    if (cb(ctx, &node) < 0) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+void ws_br_agent_lifecycle_free(ws_br_agent_lifecycle_t * const lc)
+{
+  if (lc == NULL) {
+    return;
+  }
+  ws_br_agent_mem_free(lc->nodes);
+  *lc = (ws_br_agent_lifecycle_t) { 0 };
+}
+
+/// Carve the arrays from a single table block
+static ws_br_agent_ret_t lifecycle_alloc(ws_br_agent_lifecycle_t * const lc)
+{
+  uint8_t *block = ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_LIFECYCLE, LIFECYCLE_BLOCK_SIZE);
+
+  if (block == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  // Node records first, the 4-byte arrays stay aligned
+  lc->nodes = (ws_br_agent_lifecycle_node_t *)block;
+  block += WS_BR_AGENT_LIFECYCLE_MAX_NODES * sizeof(ws_br_agent_lifecycle_node_t);
+  lc->prev_gone = (uint32_t *)block;
+  lc->next_gone = lc->prev_gone + WS_BR_AGENT_LIFECYCLE_MAX_NODES;
+  lc->marks = lc->next_gone + WS_BR_AGENT_LIFECYCLE_MAX_NODES;
+  lc->slots = lc->marks + WS_BR_AGENT_LIFECYCLE_MAX_NODES;
+  lc->changes = lc->slots + LIFECYCLE_SLOT_COUNT;
+  memset(lc->slots, 0, LIFECYCLE_SLOT_COUNT * sizeof(uint32_t));
+  lc->count = 0U;
+  lc->first_gone = LIFECYCLE_NONE;
+  lc->last_gone = LIFECYCLE_NONE;
+  return WS_BR_AGENT_RET_OK;
+}
+
+/// Find or add a node, LIFECYCLE_NONE if the table is full of present nodes
+static uint32_t lifecycle_insert(ws_br_agent_lifecycle_t * const lc, const uint8_t addr[16])
+{
+  uint32_t index = lifecycle_find(lc, addr);
+  uint32_t victim = LIFECYCLE_NONE;
+
+  if (index != LIFECYCLE_NONE) {
+    return index;
+  }
+  if (lc->count == WS_BR_AGENT_LIFECYCLE_MAX_NODES) {
+    // Longest gone node, unless it comes back in this update
+    victim = lc->first_gone;
+    while (victim != LIFECYCLE_NONE && lc->marks[victim] == lc->mark) {
+      victim = lc->next_gone[victim];
+    }
+    if (victim == LIFECYCLE_NONE) {
+      if (!lc->full) {
+        lc->full = true;
+        ws_br_agent_log_warn("Lifecycle table full (%u nodes), new nodes are not tracked\n", lc->count);
+      }
+      return LIFECYCLE_NONE;
+    }
+    lifecycle_evict(lc, victim);
+  }
+  lc->full = false;
+  index = lc->count++;
+  lc->slots[lifecycle_slot(lc, addr)] = index + 1U;
+  lc->nodes[index] = (ws_br_agent_lifecycle_node_t) { 0 };
+  memcpy(lc->nodes[index].target, addr, 16U);
+  lc->marks[index] = 0U;
+  ws_br_agent_metrics_add_gauge(WS_BR_AGENT_METRIC_NODES_TRACKED, 1);
+  return index;
+}
+
+/// Forget a node that left: the last node takes its index
+static void lifecycle_evict(ws_br_agent_lifecycle_t * const lc, uint32_t index)
+{
+  const uint32_t mask = LIFECYCLE_SLOT_COUNT - 1U;
+  uint32_t last = lc->count - 1U;
+  uint32_t slot = lifecycle_slot(lc, lc->nodes[index].target);
+  uint32_t next = slot;
+  uint32_t home = 0U;
+
+  lifecycle_gone_unlink(lc, index);
+
+  // Backward shift deletion: the following slots of the probe sequence move up to the hole
+  lc->slots[slot] = 0U;
+  for (next = (slot + 1U) & mask; lc->slots[next]; next = (next + 1U) & mask) {
+    home = lifecycle_hash(lc->nodes[lc->slots[next] - 1U].target) & mask;
+    if (((next - home) & mask) >= ((next - slot) & mask)) {
+      lc->slots[slot] = lc->slots[next];
+      lc->slots[next] = 0U;
+      slot = next;
+    }
+  }
+
+  if (index != last) {
+    lc->slots[lifecycle_slot(lc, lc->nodes[last].target)] = index + 1U;
+    lc->nodes[index] = lc->nodes[last];
+    lc->marks[index] = lc->marks[last];
+    if (!lc->nodes[index].present) {
+      lc->prev_gone[index] = lc->prev_gone[last];
+      lc->next_gone[index] = lc->next_gone[last];
+      if (lc->prev_gone[index] != LIFECYCLE_NONE) {
+        lc->next_gone[lc->prev_gone[index]] = index;
+      } else {
+        lc->first_gone = index;
+      }
+      if (lc->next_gone[index] != LIFECYCLE_NONE) {
+        lc->prev_gone[lc->next_gone[index]] = index;
+      } else {
+        lc->last_gone = index;
+      }
+    }
+  }
+  lc->count = last;
+  ws_br_agent_metrics_add_gauge(WS_BR_AGENT_METRIC_NODES_TRACKED, -1);
+  ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_NODE_EVICTIONS, 1U);
+}
+
+/// A changed entry lists the node
+static void lifecycle_observe(ws_br_agent_lifecycle_t * const lc,
+                              const ws_br_agent_soc_host_topology_entry_t * const entry, uint64_t time_us)
+{
+  ws_br_agent_lifecycle_node_t *node = NULL;
+  uint32_t index = lifecycle_insert(lc, entry->target);
+
+  if (index == LIFECYCLE_NONE) {
+    return;
+  }
+  node = &lc->nodes[index];
+  lc->marks[index] = lc->mark;
+
+  if (!node->first_seen_us) {
+    node->first_seen_us = time_us;
+    memcpy(node->parent, entry->preferred, 16U);
+  } else if (!node->present) {
+    ++node->flaps;
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_NODE_FLAPS, 1U);
+    lifecycle_gone_unlink(lc, index);
+  }
+  if (!node->present) {
+    node->present = true;
+    ws_br_agent_metrics_add_gauge(WS_BR_AGENT_METRIC_NODES_PRESENT, 1);
+  }
+  if (memcmp(node->parent, entry->preferred, 16U)) {
+    memcpy(node->prev_parent, node->parent, 16U);
+    memcpy(node->parent, entry->preferred, 16U);
+    ++node->reparents;
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_NODE_REPARENTS, 1U);
+  }
+}
+
+/// A changed entry no longer lists the node
+static void lifecycle_leave(ws_br_agent_lifecycle_t * const lc, const uint8_t addr[16])
+{
+  uint32_t index = lifecycle_find(lc, addr);
+  ws_br_agent_lifecycle_node_t *node = NULL;
+
+  if (index == LIFECYCLE_NONE || lc->marks[index] == lc->mark || !lc->nodes[index].present) {
+    return;
+  }
+  node = &lc->nodes[index];
+  node->present = false;
+  // Listed by the previous topology only
+  node->last_seen_us = lc->update_us;
+  lifecycle_gone_push(lc, index);
+  ws_br_agent_metrics_add_gauge(WS_BR_AGENT_METRIC_NODES_PRESENT, -1);
+  ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_NODE_LEAVES, 1U);
+}
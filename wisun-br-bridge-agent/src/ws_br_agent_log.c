@@ -29,27 +29,58 @@
  ******************************************************************************/
 
 #include "ws_br_agent_log.h"
+#include "ws_br_agent_metrics.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
 #include <time.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#if WS_BR_AGENT_LOG_ENABLE_JOURNAL_LOG
+#include <systemd/sd-journal.h>
+#endif
+
+/// Maximum size of a journal message
+#define JOURNAL_MSG_MAX_SIZE 1024U
+
+/// Maximum size of a journal field
+#define JOURNAL_FIELD_MAX_SIZE 96U
+
+/// Maximum number of journal fields per entry
+#define JOURNAL_FIELD_MAX_COUNT 12U
 
 const char *ws_br_agent_log_file_path = WS_BR_AGENT_LOG_DEFAULT_FILE_PATH;
+uint32_t ws_br_agent_log_sinks = WS_BR_AGENT_LOG_SINK_AUTO;
 FILE *_log_file = NULL;
 pthread_mutex_t _log_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+static bool stdout_is_journal_stream(void);
+
 ws_br_agent_ret_t ws_br_agent_log_init(void) 
 {
-#if WS_BR_AGENT_LOG_ENABLE_FILE_LOG
+  if (ws_br_agent_log_sinks == WS_BR_AGENT_LOG_SINK_AUTO) {
+    // Avoid writing every message twice when journald already captures stdout
+    if (WS_BR_AGENT_LOG_ENABLE_JOURNAL_LOG && stdout_is_journal_stream()) {
+      ws_br_agent_log_sinks = WS_BR_AGENT_LOG_SINK_JOURNAL;
+    } else {
+      ws_br_agent_log_sinks = WS_BR_AGENT_LOG_SINK_CONSOLE | WS_BR_AGENT_LOG_SINK_FILE;
+    }
+  }
 
-  _log_file = fopen(ws_br_agent_log_file_path, "a");
-  if (_log_file == NULL) {
-    return WS_BR_AGENT_RET_ERR;
+#if WS_BR_AGENT_LOG_ENABLE_FILE_LOG
+  if (ws_br_agent_log_sinks & WS_BR_AGENT_LOG_SINK_FILE) {
+    _log_file = fopen(ws_br_agent_log_file_path, "a");
+    if (_log_file == NULL) {
+      return WS_BR_AGENT_RET_ERR;
+    }
   }
   if (pthread_mutex_init(&_log_mutex, NULL) != 0) {
     return WS_BR_AGENT_RET_ERR;
   }
-  ws_br_agent_log_info("Log file: %s\n", ws_br_agent_log_file_path);
+  if (_log_file != NULL) {
+    ws_br_agent_log_info("Log file: %s\n", ws_br_agent_log_file_path);
+  }
 #else
   (void) _log_file;
 #endif
@@ -70,6 +101,123 @@ void ws_br_agent_log_deinit(void)
 #endif
 }
 
+ws_br_agent_ret_t ws_br_agent_log_parse_sinks(const char *str, uint32_t * const sinks)
+{
+  char buf[64];
+  char *tok = NULL;
+  char *save_ptr = NULL;
+  uint32_t res = 0U;
+
+  if (str == NULL || sinks == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  snprintf(buf, sizeof(buf), "%s", str);
+  for (tok = strtok_r(buf, ",", &save_ptr); tok != NULL; tok = strtok_r(NULL, ",", &save_ptr)) {
+    if (!strcmp(tok, "console")) {
+      res |= WS_BR_AGENT_LOG_SINK_CONSOLE;
+    } else if (!strcmp(tok, "file")) {
+      res |= WS_BR_AGENT_LOG_SINK_FILE;
+    } else if (!strcmp(tok, "journal")) {
+      res |= WS_BR_AGENT_LOG_SINK_JOURNAL;
+    } else if (strcmp(tok, "none")) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+  }
+
+  *sinks = res;
+  return WS_BR_AGENT_RET_OK;
+}
+
+#if WS_BR_AGENT_LOG_ENABLE_JOURNAL_LOG
+void _log_print_to_journal(int priority, const char *subsystem,
+                           const char *file, int line, const char *func,
+                           const ws_br_agent_log_fields_t * const fields,
+                           const char *fmt, ...)
+{
+  char msg[JOURNAL_MSG_MAX_SIZE] = "MESSAGE=";
+  char buf[JOURNAL_FIELD_MAX_COUNT][JOURNAL_FIELD_MAX_SIZE];
+  struct iovec iov[JOURNAL_FIELD_MAX_COUNT + 1U];
+  size_t len = sizeof("MESSAGE=") - 1U;
+  int n = 0;
+  va_list ap;
+
+  va_start(ap, fmt);
+  vsnprintf(msg + len, sizeof(msg) - len, fmt, ap);
+  va_end(ap);
+
+  // Journal entries are single records, drop the console line ending
+  len = strlen(msg);
+  while (len > 0U && msg[len - 1U] == '\n') {
+    msg[--len] = '\0';
+  }
+  iov[n].iov_base = msg;
+  iov[n++].iov_len = len;
+
+#define __journal_add_field(fmt, ...)                                     \
+  do {                                                                    \
+    iov[n].iov_base = buf[n - 1];                                         \
+    iov[n].iov_len = (size_t)snprintf(buf[n - 1], JOURNAL_FIELD_MAX_SIZE, \
+                                      fmt, ##__VA_ARGS__);                \
+    if (iov[n].iov_len >= JOURNAL_FIELD_MAX_SIZE) {                       \
+      iov[n].iov_len = JOURNAL_FIELD_MAX_SIZE - 1U;                       \
+    }                                                                     \
+    n++;                                                                  \
+  } while (0)
+
+  __journal_add_field("PRIORITY=%d", priority);
+  __journal_add_field("SYSLOG_IDENTIFIER=wisun-br-bridge-agent");
+  __journal_add_field("CODE_FILE=%s", file);
+  __journal_add_field("CODE_LINE=%d", line);
+  __journal_add_field("CODE_FUNC=%s", func);
+  __journal_add_field("SUBSYSTEM=%s", subsystem);
+
+  if (fields != NULL) {
+    if (fields->msg_code != WS_BR_AGENT_LOG_FIELD_NONE) {
+      __journal_add_field("MSG_CODE=0x%08llx", (unsigned long long)fields->msg_code);
+    }
+    if (fields->peer_addr != NULL) {
+      __journal_add_field("PEER_ADDR=%s", fields->peer_addr);
+    }
+    if (fields->entry_count != WS_BR_AGENT_LOG_FIELD_NONE) {
+      __journal_add_field("ENTRY_COUNT=%lld", (long long)fields->entry_count);
+    }
+    if (fields->latency_us != WS_BR_AGENT_LOG_FIELD_NONE) {
+      __journal_add_field("LATENCY_USEC=%lld", (long long)fields->latency_us);
+    }
+    if (fields->trace_id != WS_BR_AGENT_LOG_FIELD_NONE) {
+      __journal_add_field("TRACE_ID=%lld", (long long)fields->trace_id);
+    }
+  }
+
+#undef __journal_add_field
+
+  (void) sd_journal_sendv(iov, n);
+}
+#endif
+
+static bool stdout_is_journal_stream(void)
+{
+  const char *env = getenv("JOURNAL_STREAM");
+  unsigned long long dev = 0ULL;
+  unsigned long long ino = 0ULL;
+  struct stat st;
+
+  // JOURNAL_STREAM is "<device>:<inode>" of the stream systemd connected to journald
+  if (env == NULL || sscanf(env, "%llu:%llu", &dev, &ino) != 2) {
+    return false;
+  }
+  if (fstat(fileno(stdout), &st) < 0) {
+    return false;
+  }
+  return (unsigned long long)st.st_dev == dev && (unsigned long long)st.st_ino == ino;
+}
+
+void _log_lock(void)
+{
+  (void) ws_br_agent_metrics_mutex_lock(&_log_mutex, WS_BR_AGENT_METRIC_HIST_LOG_MUTEX_WAIT);
+}
+
 const char *_log_get_timestr(void) {
   static char buf[24];
   time_t now = time(NULL);
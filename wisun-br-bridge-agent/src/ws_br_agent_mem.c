@@ -0,0 +1,465 @@
+/***************************************************************************//**
+ * @file ws_br_agent_mem.c
+ * @brief Wi-SUN SoC Border Router Agent memory accounting and pools
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "mem"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_mem.h"
+
+/// Pool index of heap allocations
+#define MEM_HEAP 0xFFU
+
+/// Header check value
+#define MEM_MAGIC 0xA6E5U
+
+/// Number of pools
+#define MEM_POOL_COUNT 5U
+
+/// Pools of the SoC shard tables, sized from the SoC count
+#define MEM_POOL_TABLE 3U
+#define MEM_POOL_LIFECYCLE 4U
+
+/// Owner of the pools shared by the subsystems without pools of their own
+#define MEM_SHARED WS_BR_AGENT_MEM_SUBSYS_COUNT
+
+/// Round a size up to the header alignment
+#define MEM_ALIGN(size) (((size) + sizeof(mem_hdr_t) - 1U) & ~(sizeof(mem_hdr_t) - 1U))
+
+/// @brief Allocation header, keeps the returned memory 16-byte aligned
+typedef struct mem_hdr {
+  /// Requested size, or next free block while in a pool free list
+  union {
+    uint64_t size;
+    struct mem_hdr *next;
+  } u;
+  /// Allocating subsystem
+  uint8_t subsys;
+  /// Pool index (#MEM_HEAP for heap allocations)
+  uint8_t pool;
+  /// Check value
+  uint16_t magic;
+  /// Reserved
+  uint32_t reserved;
+} mem_hdr_t;
+
+_Static_assert(sizeof(mem_hdr_t) == 16U, "Allocation header must keep 16-byte alignment");
+
+/// @brief Fixed block pool
+typedef struct mem_pool {
+  /// Usable block size
+  size_t block_size;
+  /// Only subsystem served (#MEM_SHARED: the subsystems without pools of their own)
+  uint8_t owner;
+  /// Maximum number of blocks
+  uint32_t block_count;
+  /// Block stride (header and usable size)
+  size_t stride;
+  /// Pool region (pool mode)
+  uint8_t *base;
+  /// Free blocks
+  mem_hdr_t *free_list;
+  /// Blocks held, in use or free
+  uint32_t allocated;
+  /// Blocks in use
+  uint32_t in_use;
+  /// Highest number of blocks in use
+  uint32_t high_water;
+  /// Allocations served by a free block
+  uint64_t hits;
+  /// Allocations that needed a new block, the heap or a larger pool
+  uint64_t misses;
+  /// Allocations that found the pool empty and full-sized
+  uint64_t exhausted;
+} mem_pool_t;
+
+/// Pool initializer
+#define __mem_pool(size, count, subsys) \
+  { .block_size = (size), .owner = (subsys), .block_count = (count), \
+    .stride = sizeof(mem_hdr_t) + MEM_ALIGN(size) }
+
+const char * const ws_br_agent_mem_subsys_strs[WS_BR_AGENT_MEM_SUBSYS_COUNT] = {
+  "msg", "topology", "soc_host", "srv", "tables", "lifecycle", "history"
+};
+
+static pthread_mutex_t mem_mutex = PTHREAD_MUTEX_INITIALIZER;
+static ws_br_agent_mem_stats_t mem_stats[WS_BR_AGENT_MEM_SUBSYS_COUNT] = { 0 };
+/// Bytes held: heap allocations in use and pool blocks
+static size_t mem_bytes = 0U;
+static size_t mem_budget = 0U;
+static bool mem_pool_mode = false;
+static mem_pool_t mem_pools[MEM_POOL_COUNT] = {
+  __mem_pool(WS_BR_AGENT_MEM_POOL_SMALL_SIZE, WS_BR_AGENT_MEM_POOL_SMALL_COUNT, MEM_SHARED),
+  __mem_pool(WS_BR_AGENT_MEM_POOL_MEDIUM_SIZE, WS_BR_AGENT_MEM_POOL_MEDIUM_COUNT, MEM_SHARED),
+  __mem_pool(WS_BR_AGENT_MEM_POOL_LARGE_SIZE, WS_BR_AGENT_MEM_POOL_LARGE_COUNT, MEM_SHARED),
+  // Tables live as long as their SoC: apart, so that transient buffers or other tables cannot starve them.
+  // Their block counts are set from the SoC count at initialization.
+  __mem_pool(WS_BR_AGENT_MEM_POOL_TABLE_SIZE, 0U, WS_BR_AGENT_MEM_SUBSYS_TABLES),
+  __mem_pool(WS_BR_AGENT_MEM_POOL_LIFECYCLE_SIZE, 0U, WS_BR_AGENT_MEM_SUBSYS_LIFECYCLE),
+};
+
+static mem_hdr_t *pool_alloc(size_t size, uint8_t owner);
+
+/// The subsystem has pools of its own
+static inline bool mem_pool_owner(ws_br_agent_mem_subsys_t subsys)
+{
+  return subsys == WS_BR_AGENT_MEM_SUBSYS_TABLES || subsys == WS_BR_AGENT_MEM_SUBSYS_LIFECYCLE;
+}
+
+static void pool_release_free(mem_pool_t * const pool);
+static void account_alloc(ws_br_agent_mem_subsys_t subsys, size_t bytes);
+
+ws_br_agent_ret_t ws_br_agent_mem_init(size_t budget, bool pool_mode, size_t soc_count)
+{
+  size_t total = 0U;
+  mem_pool_t *pool = NULL;
+  mem_hdr_t *hdr = NULL;
+
+  if (!soc_count || soc_count > WS_BR_AGENT_SOC_HOST_MAX_COUNT) {
+    ws_br_agent_log_error("Invalid SoC count: %zu (1 to %u)\n", soc_count, WS_BR_AGENT_SOC_HOST_MAX_COUNT);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  mem_pools[MEM_POOL_TABLE].block_count = (uint32_t)(WS_BR_AGENT_MEM_POOL_TABLE_PER_SOC * soc_count);
+  mem_pools[MEM_POOL_LIFECYCLE].block_count = (uint32_t)(WS_BR_AGENT_MEM_POOL_LIFECYCLE_PER_SOC * soc_count);
+  mem_budget = budget;
+  if (!pool_mode) {
+    ws_br_agent_log_info("Memory budget: %zu bytes%s\n", budget, budget ? "" : " (no limit)");
+    return WS_BR_AGENT_RET_OK;
+  }
+
+  for (size_t i = 0U; i < MEM_POOL_COUNT; ++i) {
+    total += mem_pools[i].stride * mem_pools[i].block_count;
+  }
+  if (budget && total > budget) {
+    ws_br_agent_log_error("Memory pools (%zu bytes) exceed the budget (%zu bytes)\n", total, budget);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Populated up front: steady state does not fault pages in nor allocate
+  for (size_t i = 0U; i < MEM_POOL_COUNT; ++i) {
+    pool = &mem_pools[i];
+    pool->base = mmap(NULL, pool->stride * pool->block_count, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (pool->base == MAP_FAILED) {
+      pool->base = NULL;
+      ws_br_agent_log_error("Memory pool mapping failed (%zu bytes)\n",
+                            pool->stride * pool->block_count);
+      ws_br_agent_mem_deinit();
+      return WS_BR_AGENT_RET_ERR;
+    }
+    pool->free_list = NULL;
+    for (uint32_t b = pool->block_count; b > 0U; --b) {
+      hdr = (mem_hdr_t *)(pool->base + (b - 1U) * pool->stride);
+      hdr->u.next = pool->free_list;
+      pool->free_list = hdr;
+    }
+    pool->allocated = pool->block_count;
+    mem_bytes += pool->stride * pool->block_count;
+    ws_br_agent_log_info("Memory pool: %u blocks of %zu bytes\n", pool->block_count, pool->block_size);
+  }
+  mem_pool_mode = true;
+  ws_br_agent_log_info("Memory pools: %zu bytes, budget: %zu bytes%s\n",
+                       total, budget, budget ? "" : " (no limit)");
+  return WS_BR_AGENT_RET_OK;
+}
+
+void ws_br_agent_mem_deinit(void)
+{
+  mem_pool_t *pool = NULL;
+
+  pthread_mutex_lock(&mem_mutex);
+  for (size_t i = 0U; i < MEM_POOL_COUNT; ++i) {
+    pool = &mem_pools[i];
+    if (pool->base == NULL) {
+      pool_release_free(pool);
+      continue;
+    }
+    if (pool->in_use) {
+      ws_br_agent_log_warn("Memory pool of %zu bytes blocks released with %u blocks in use\n",
+                           pool->block_size, pool->in_use);
+    }
+    munmap(pool->base, pool->stride * pool->block_count);
+    mem_bytes -= pool->stride * pool->block_count;
+    pool->base = NULL;
+    pool->free_list = NULL;
+    pool->allocated = 0U;
+    pool->in_use = 0U;
+  }
+  mem_pool_mode = false;
+  pthread_mutex_unlock(&mem_mutex);
+}
+
+void *ws_br_agent_mem_alloc(ws_br_agent_mem_subsys_t subsys, size_t size)
+{
+  mem_hdr_t *hdr = NULL;
+  size_t bytes = 0U;
+
+  if (subsys >= WS_BR_AGENT_MEM_SUBSYS_COUNT) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&mem_mutex);
+  // Heap mode sizes the tables to their content: a pool block would waste most of it on small networks
+  if (!mem_pool_owner(subsys)) {
+    hdr = pool_alloc(size, MEM_SHARED);
+  } else if (mem_pool_mode) {
+    hdr = pool_alloc(size, (uint8_t)subsys);
+  }
+  if (hdr != NULL) {
+    bytes = mem_pools[hdr->pool].stride;
+  } else if (!mem_pool_mode && (!mem_budget || mem_bytes + sizeof(mem_hdr_t) + size <= mem_budget)) {
+    hdr = (mem_hdr_t *)malloc(sizeof(mem_hdr_t) + size);
+    if (hdr != NULL) {
+      hdr->pool = MEM_HEAP;
+      bytes = sizeof(mem_hdr_t) + size;
+      mem_bytes += bytes;
+    }
+  }
+  if (hdr == NULL) {
+    mem_stats[subsys].failures++;
+    pthread_mutex_unlock(&mem_mutex);
+    ws_br_agent_log_debug("Allocation of %zu bytes failed (%s)\n", size,
+                          ws_br_agent_mem_subsys_strs[subsys]);
+    return NULL;
+  }
+  hdr->u.size = size;
+  hdr->subsys = (uint8_t)subsys;
+  hdr->magic = MEM_MAGIC;
+  account_alloc(subsys, bytes);
+  pthread_mutex_unlock(&mem_mutex);
+
+  return hdr + 1;
+}
+
+void ws_br_agent_mem_free(void *ptr)
+{
+  mem_hdr_t *hdr = NULL;
+  mem_pool_t *pool = NULL;
+  ws_br_agent_mem_stats_t *stats = NULL;
+
+  if (ptr == NULL) {
+    return;
+  }
+
+  hdr = (mem_hdr_t *)ptr - 1;
+  if (hdr->magic != MEM_MAGIC || hdr->subsys >= WS_BR_AGENT_MEM_SUBSYS_COUNT) {
+    ws_br_agent_log_error("Invalid free of %p\n", ptr);
+    return;
+  }
+  hdr->magic = 0U;
+
+  pthread_mutex_lock(&mem_mutex);
+  stats = &mem_stats[hdr->subsys];
+  stats->frees++;
+  if (hdr->pool == MEM_HEAP) {
+    stats->bytes -= sizeof(mem_hdr_t) + hdr->u.size;
+    mem_bytes -= sizeof(mem_hdr_t) + hdr->u.size;
+    free(hdr);
+  } else {
+    // Recycled, pool blocks stay held
+    pool = &mem_pools[hdr->pool];
+    stats->bytes -= pool->stride;
+    pool->in_use--;
+    hdr->u.next = pool->free_list;
+    pool->free_list = hdr;
+  }
+  pthread_mutex_unlock(&mem_mutex);
+}
+ws_br_agent_ret_t ws_br_agent_mem_reserve(ws_br_agent_mem_subsys_t subsys, size_t size)
+{
+  if (subsys >= WS_BR_AGENT_MEM_SUBSYS_COUNT) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  pthread_mutex_lock(&mem_mutex);
+  if (mem_budget && mem_bytes + size > mem_budget) {
+    mem_stats[subsys].failures++;
+    pthread_mutex_unlock(&mem_mutex);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  mem_bytes += size;
+  account_alloc(subsys, size);
+  pthread_mutex_unlock(&mem_mutex);
+  return WS_BR_AGENT_RET_OK;
+}
+
+void ws_br_agent_mem_release(ws_br_agent_mem_subsys_t subsys, size_t size)
+{
+  if (subsys >= WS_BR_AGENT_MEM_SUBSYS_COUNT) {
+    return;
+  }
+  pthread_mutex_lock(&mem_mutex);
+  mem_stats[subsys].frees++;
+  mem_stats[subsys].bytes -= size;
+  mem_bytes -= size;
+  pthread_mutex_unlock(&mem_mutex);
+}
+
+size_t ws_br_agent_mem_usable_size(const void *ptr)
+{
+  const mem_hdr_t *hdr = NULL;
+
+  if (ptr == NULL) {
+    return 0U;
+  }
+  hdr = (const mem_hdr_t *)ptr - 1;
+  return hdr->pool == MEM_HEAP ? (size_t)hdr->u.size : mem_pools[hdr->pool].block_size;
+}
+
+ws_br_agent_ret_t ws_br_agent_mem_get_stats(ws_br_agent_mem_subsys_t subsys,
+                                            ws_br_agent_mem_stats_t * const stats)
+{
+  if (subsys >= WS_BR_AGENT_MEM_SUBSYS_COUNT || stats == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  pthread_mutex_lock(&mem_mutex);
+  *stats = mem_stats[subsys];
+  pthread_mutex_unlock(&mem_mutex);
+  return WS_BR_AGENT_RET_OK;
+}
+
+ws_br_agent_ret_t ws_br_agent_mem_get_pool_stats(size_t index,
+                                                 ws_br_agent_mem_pool_stats_t * const stats)
+{
+  if (index >= MEM_POOL_COUNT || stats == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  pthread_mutex_lock(&mem_mutex);
+  stats->block_size = mem_pools[index].block_size;
+  stats->block_count = mem_pools[index].block_count;
+  stats->allocated = mem_pools[index].allocated;
+  stats->in_use = mem_pools[index].in_use;
+  stats->high_water = mem_pools[index].high_water;
+  stats->hits = mem_pools[index].hits;
+  stats->misses = mem_pools[index].misses;
+  stats->exhausted = mem_pools[index].exhausted;
+  pthread_mutex_unlock(&mem_mutex);
+  return WS_BR_AGENT_RET_OK;
+}
+
+size_t ws_br_agent_mem_get_budget(void)
+{
+  return mem_budget;
+}
+
+ws_br_agent_ret_t ws_br_agent_mem_parse_size(const char *str, size_t * const size)
+{
+  unsigned long long val = 0ULL;
+  char *end = NULL;
+
+  if (str == NULL || size == NULL || *str < '0' || *str > '9') {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  val = strtoull(str, &end, 10);
+  switch (*end) {
+    case 'g': case 'G': val <<= 10; // fall through
+    case 'm': case 'M': val <<= 10; // fall through
+    case 'k': case 'K': val <<= 10; end++; break;
+    default: break;
+  }
+  if (*end != '\0') {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  *size = (size_t)val;
+  return WS_BR_AGENT_RET_OK;
+}
+
+// Smallest fitting pool of the owner with a free block, or a new block in heap mode (mem_mutex held)
+static mem_hdr_t *pool_alloc(size_t size, uint8_t owner)
+{
+  mem_pool_t *pool = NULL;
+  mem_hdr_t *hdr = NULL;
+  bool first = true;
+
+  for (size_t i = 0U; i < MEM_POOL_COUNT && hdr == NULL; ++i) {
+    pool = &mem_pools[i];
+    if (pool->owner != owner || size > pool->block_size) {
+      continue;
+    }
+    if (pool->free_list != NULL) {
+      hdr = pool->free_list;
+      pool->free_list = hdr->u.next;
+      pool->hits += first ? 1U : 0U;
+    } else if (!mem_pool_mode && pool->allocated < pool->block_count
+               && (!mem_budget || mem_bytes + pool->stride <= mem_budget)) {
+      hdr = (mem_hdr_t *)malloc(pool->stride);
+      if (hdr == NULL) {
+        return NULL;
+      }
+      pool->allocated++;
+      pool->misses++;
+      mem_bytes += pool->stride;
+    } else {
+      pool->exhausted++;
+      pool->misses += first ? 1U : 0U;
+      // Heap mode falls back to the heap, pool mode spills to a larger pool
+      if (!mem_pool_mode) {
+        return NULL;
+      }
+      first = false;
+      continue;
+    }
+    hdr->pool = (uint8_t)i;
+    pool->in_use++;
+    if (pool->in_use > pool->high_water) {
+      pool->high_water = pool->in_use;
+    }
+  }
+  return hdr;
+}
+
+// Release the free blocks of a heap mode pool (mem_mutex held)
+static void pool_release_free(mem_pool_t * const pool)
+{
+  mem_hdr_t *hdr = NULL;
+
+  while (pool->free_list != NULL) {
+    hdr = pool->free_list;
+    pool->free_list = hdr->u.next;
+    free(hdr);
+    pool->allocated--;
+    mem_bytes -= pool->stride;
+  }
+}
+
+// Account an allocation (mem_mutex held)
+static void account_alloc(ws_br_agent_mem_subsys_t subsys, size_t bytes)
+{
+  ws_br_agent_mem_stats_t *stats = &mem_stats[subsys];
+
+  stats->allocs++;
+  stats->bytes += bytes;
+  if (stats->bytes > stats->peak_bytes) {
+    stats->peak_bytes = stats->bytes;
+  }
+}
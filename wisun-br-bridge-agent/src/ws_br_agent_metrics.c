@@ -0,0 +1,629 @@
+/***************************************************************************//**
+ * @file ws_br_agent_metrics.c
+ * @brief Metrics registry for Wi-SUN SoC Border Router Agent
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "metrics"
+#include "ws_br_agent_defs.h"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_utils.h"
+#include "ws_br_agent_metrics.h"
+#include "ws_br_agent_mem.h"
+#include "ws_br_agent_event.h"
+#include "ws_br_agent_service.h"
+
+/// Metric name prefix
+#define METRIC_PREFIX "wisun_br_agent_"
+
+/// Size of the HTTP request buffer (only the request line matters)
+#define HTTP_REQ_BUF_SIZE 1024U
+
+/// Receive timeout for scrape requests in ms
+#define HTTP_REQ_TIMEOUT_MS 1000
+
+/// Latency bucket upper bounds in microseconds
+#define LATENCY_BUCKETS_US \
+  { 10U, 25U, 50U, 100U, 250U, 500U, 1000U, 2500U, 5000U, 10000U, 25000U, 100000U, 250000U, 1000000U }
+
+/// Lock wait bucket upper bounds in microseconds (0 is the uncontended case)
+#define LOCK_WAIT_BUCKETS_US \
+  { 0U, 1U, 5U, 10U, 50U, 100U, 500U, 1000U, 5000U, 10000U, 100000U, 1000000U }
+
+/// @brief Counter descriptor
+typedef struct metric_counter_desc {
+  /// Name (without prefix and _total suffix)
+  const char *name;
+  /// Help text
+  const char *help;
+} metric_counter_desc_t;
+
+/// @brief Histogram descriptor (consecutive descriptors with the same name form a family)
+typedef struct metric_hist_desc {
+  /// Name (without prefix)
+  const char *name;
+  /// Label set without braces, NULL if none
+  const char *labels;
+  /// Help text
+  const char *help;
+  /// Divider applied to observed values when rendering (1e6 for us to seconds)
+  double scale;
+  /// Bucket upper bounds (in observed unit)
+  uint64_t bounds[WS_BR_AGENT_METRICS_MAX_BUCKETS];
+  /// Number of bucket bounds
+  size_t bound_count;
+} metric_hist_desc_t;
+
+/// @brief Histogram storage (non cumulative buckets, last one is +Inf)
+typedef struct metric_hist {
+  /// Bucket counts
+  atomic_uint_fast64_t buckets[WS_BR_AGENT_METRICS_MAX_BUCKETS + 1U];
+  /// Sum of observed values
+  atomic_uint_fast64_t sum;
+} metric_hist_t;
+
+#define __hist_desc_labels(_name, _labels, _help, _scale, ...)          \
+  {                                                                   \
+    .name = _name, .labels = _labels, .help = _help, .scale = _scale, \
+    .bounds = __VA_ARGS__,                                            \
+    .bound_count = sizeof((uint64_t[])__VA_ARGS__) / sizeof(uint64_t) \
+  }
+
+#define __hist_desc(_name, _help, _scale, ...) \
+  __hist_desc_labels(_name, NULL, _help, _scale, __VA_ARGS__)
+
+#define __stage_hist_desc(_msg, _stage)                                           \
+  __hist_desc_labels("update_stage_latency_seconds", "msg=\"" _msg "\",stage=\"" _stage "\"", \
+                     "Update latency per stage, from receive to D-Bus emission", 1e6,         \
+                     LATENCY_BUCKETS_US)
+
+static const metric_counter_desc_t counter_descs[WS_BR_AGENT_METRIC_COUNTER_COUNT] = {
+  [WS_BR_AGENT_METRIC_RX_BYTES] = { "rx_bytes", "Bytes received, on the service port and in SoC request responses" },
+  [WS_BR_AGENT_METRIC_TX_BYTES] = { "tx_bytes", "Bytes sent, on the service port and in SoC requests" },
+  [WS_BR_AGENT_METRIC_PARSE_FAILURES] = { "parse_failures", "Messages that failed to parse" },
+  [WS_BR_AGENT_METRIC_SOC_REQUESTS] = { "soc_requests", "Requests sent to the SoC" },
+  [WS_BR_AGENT_METRIC_SOC_CONNECT_FAILURES] = { "soc_connect_failures", "SoC connection failures" },
+  [WS_BR_AGENT_METRIC_STATE_SAVES] = { "state_saves", "State file saves" },
+  [WS_BR_AGENT_METRIC_STATE_SAVE_FAILURES] = { "state_save_failures", "State file save failures" },
+  [WS_BR_AGENT_METRIC_CONFIG_RELOADS] = { "config_reloads", "Configuration file reloads" },
+  [WS_BR_AGENT_METRIC_CONFIG_RELOAD_FAILURES] = { "config_reload_failures", "Configuration file reloads rejected" },
+  [WS_BR_AGENT_METRIC_CRC_FAILURES] = { "crc_failures", "Received frames with a bad CRC32C trailer" },
+  [WS_BR_AGENT_METRIC_HISTORY_KEYFRAMES] = { "history_keyframes", "Topology versions recorded as keyframes" },
+  [WS_BR_AGENT_METRIC_HISTORY_DELTAS] = { "history_deltas", "Topology versions recorded as deltas" },
+  [WS_BR_AGENT_METRIC_NODE_REPARENTS] = { "node_reparents", "Preferred parent changes of the nodes" },
+  [WS_BR_AGENT_METRIC_NODE_FLAPS] = { "node_flaps", "Nodes back in the topology after leaving it" },
+  [WS_BR_AGENT_METRIC_NODE_LEAVES] = { "node_leaves", "Nodes that left the topology" },
+  [WS_BR_AGENT_METRIC_NODE_EVICTIONS] = { "node_evictions", "Lifecycle records dropped, absent for too long or making room" },
+  [WS_BR_AGENT_METRIC_NODE_STATS_ENTRIES] = { "node_stats_entries", "NODE_STATS entries stored" },
+  [WS_BR_AGENT_METRIC_NODE_STATS_UNKNOWN] = { "node_stats_unknown", "NODE_STATS entries for targets not in the topology" },
+};
+
+static const metric_counter_desc_t gauge_descs[WS_BR_AGENT_METRIC_GAUGE_COUNT] = {
+  [WS_BR_AGENT_METRIC_TOPOLOGY_ENTRIES] = { "topology_entries", "Entry count of the last received topology" },
+  [WS_BR_AGENT_METRIC_STATE_STALE] = { "state_stale", "SoCs served with data restored from the state file" },
+  [WS_BR_AGENT_METRIC_SOC_HOSTS] = { "soc_hosts", "SoC shards in use" },
+  [WS_BR_AGENT_METRIC_HISTORY_BYTES] = { "history_bytes", "Bytes of topology history held in the ring" },
+  [WS_BR_AGENT_METRIC_NODES_TRACKED] = { "nodes_tracked", "Nodes with a lifecycle record" },
+  [WS_BR_AGENT_METRIC_NODES_PRESENT] = { "nodes_present", "Nodes listed by the last topology of their SoC" },
+};
+
+static const metric_hist_desc_t hist_descs[WS_BR_AGENT_METRIC_HIST_COUNT] = {
+  [WS_BR_AGENT_METRIC_HIST_TOPOLOGY_ENTRIES] =
+    __hist_desc("topology_message_entries", "Entry count of received TOPOLOGY messages", 1.0,
+                { 1U, 10U, 50U, 100U, 250U, 500U, 1000U, 2500U, 5000U, 10000U, 50000U }),
+  [WS_BR_AGENT_METRIC_HIST_HANDLER_LATENCY] =
+    __hist_desc("handler_latency_seconds", "Agent service request handling latency", 1e6,
+                LATENCY_BUCKETS_US),
+  [WS_BR_AGENT_METRIC_HIST_DBUS_ROUTING_GRAPH_LATENCY] =
+    __hist_desc("dbus_routing_graph_get_latency_seconds", "D-Bus RoutingGraph getter latency", 1e6,
+                LATENCY_BUCKETS_US),
+  [WS_BR_AGENT_METRIC_HIST_DBUS_SETTINGS_LATENCY] =
+    __hist_desc("dbus_settings_get_latency_seconds", "D-Bus settings getters latency", 1e6,
+                LATENCY_BUCKETS_US),
+  [WS_BR_AGENT_METRIC_HIST_SOC_RTT] =
+    __hist_desc("soc_request_rtt_seconds", "SoC request round trip time", 1e6,
+                LATENCY_BUCKETS_US),
+  [WS_BR_AGENT_METRIC_HIST_HOST_MUTEX_WAIT] =
+    __hist_desc("host_mutex_wait_seconds", "Host mutex wait time", 1e6,
+                LOCK_WAIT_BUCKETS_US),
+  [WS_BR_AGENT_METRIC_HIST_LOG_MUTEX_WAIT] =
+    __hist_desc("log_mutex_wait_seconds", "Log mutex wait time", 1e6,
+                LOCK_WAIT_BUCKETS_US),
+  [WS_BR_AGENT_METRIC_HIST_TOPOLOGY_RECV] = __stage_hist_desc("TOPOLOGY", "recv"),
+  [WS_BR_AGENT_METRIC_HIST_TOPOLOGY_PARSE] = __stage_hist_desc("TOPOLOGY", "parse"),
+  [WS_BR_AGENT_METRIC_HIST_TOPOLOGY_STORE] = __stage_hist_desc("TOPOLOGY", "store"),
+  [WS_BR_AGENT_METRIC_HIST_TOPOLOGY_DIFF] = __stage_hist_desc("TOPOLOGY", "diff"),
+  [WS_BR_AGENT_METRIC_HIST_TOPOLOGY_EMIT] = __stage_hist_desc("TOPOLOGY", "emit"),
+  [WS_BR_AGENT_METRIC_HIST_TOPOLOGY_TOTAL] = __stage_hist_desc("TOPOLOGY", "total"),
+  [WS_BR_AGENT_METRIC_HIST_SETTINGS_RECV] = __stage_hist_desc("SET_CONFIG_PARAMS", "recv"),
+  [WS_BR_AGENT_METRIC_HIST_SETTINGS_PARSE] = __stage_hist_desc("SET_CONFIG_PARAMS", "parse"),
+  [WS_BR_AGENT_METRIC_HIST_SETTINGS_STORE] = __stage_hist_desc("SET_CONFIG_PARAMS", "store"),
+  [WS_BR_AGENT_METRIC_HIST_SETTINGS_DIFF] = __stage_hist_desc("SET_CONFIG_PARAMS", "diff"),
+  [WS_BR_AGENT_METRIC_HIST_SETTINGS_EMIT] = __stage_hist_desc("SET_CONFIG_PARAMS", "emit"),
+  [WS_BR_AGENT_METRIC_HIST_SETTINGS_TOTAL] = __stage_hist_desc("SET_CONFIG_PARAMS", "total"),
+};
+
+static atomic_uint_fast64_t counters[WS_BR_AGENT_METRIC_COUNTER_COUNT];
+static atomic_int_fast64_t gauges[WS_BR_AGENT_METRIC_GAUGE_COUNT];
+static atomic_uint_fast64_t rx_msgs[WS_BR_AGENT_METRICS_MAX_MSG_CODE + 1U];
+static metric_hist_t hists[WS_BR_AGENT_METRIC_HIST_COUNT];
+
+static pthread_t metrics_thr;
+static volatile sig_atomic_t metrics_thread_stop = 0;
+/// Wakes the metrics thread up to stop (eventfd)
+static int metrics_stop_fd = -1;
+static int metrics_listen_fd = -1;
+static sd_event_source *metrics_source = NULL;
+static char metrics_unix_path[sizeof(((struct sockaddr_un *)0)->sun_path)] = { 0 };
+
+static void metrics_thr_fnc(void *arg);
+static int metrics_listen_hnd(sd_event_source *s, int fd, uint32_t revents, void *userdata);
+static int open_endpoint(const char *endpoint);
+static void serve_scrape(int conn_fd);
+static void render_mem(FILE *out);
+
+ws_br_agent_ret_t ws_br_agent_metrics_init(const char *endpoint)
+{
+  if (endpoint == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  metrics_listen_fd = open_endpoint(endpoint);
+  if (metrics_listen_fd < 0) {
+    ws_br_agent_log_error("Failed to open metrics endpoint: %s\n", endpoint);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Event loop mode: scrapes are served from the loop
+  if (ws_br_agent_event_get() != NULL) {
+    if (sd_event_add_io(ws_br_agent_event_get(), &metrics_source, metrics_listen_fd, EPOLLIN,
+                        metrics_listen_hnd, NULL) < 0) {
+      ws_br_agent_log_error("Failed to add the metrics event source\n");
+      close(metrics_listen_fd);
+      metrics_listen_fd = -1;
+      return WS_BR_AGENT_RET_ERR;
+    }
+    ws_br_agent_log_info("Metrics endpoint: %s\n", endpoint);
+    return WS_BR_AGENT_RET_OK;
+  }
+
+  metrics_thread_stop = 0;
+  metrics_stop_fd = eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (metrics_stop_fd < 0
+      || pthread_create(&metrics_thr, NULL, (void *)metrics_thr_fnc, NULL) != 0) {
+    ws_br_agent_log_error("Failed to create metrics thread\n");
+    if (metrics_stop_fd >= 0) {
+      close(metrics_stop_fd);
+      metrics_stop_fd = -1;
+    }
+    close(metrics_listen_fd);
+    metrics_listen_fd = -1;
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  ws_br_agent_log_info("Metrics endpoint: %s\n", endpoint);
+  return WS_BR_AGENT_RET_OK;
+}
+
+void ws_br_agent_metrics_deinit(void)
+{
+  if (metrics_listen_fd < 0) {
+    return;
+  }
+  if (metrics_source != NULL) {
+    metrics_source = sd_event_source_disable_unref(metrics_source);
+  } else {
+    metrics_thread_stop = 1;
+    (void) eventfd_write(metrics_stop_fd, 1U);
+    pthread_join(metrics_thr, NULL);
+    close(metrics_stop_fd);
+    metrics_stop_fd = -1;
+  }
+  close(metrics_listen_fd);
+  metrics_listen_fd = -1;
+  if (metrics_unix_path[0]) {
+    unlink(metrics_unix_path);
+    metrics_unix_path[0] = '\0';
+  }
+}
+
+void ws_br_agent_metrics_add(ws_br_agent_metric_counter_t id, uint64_t val)
+{
+  atomic_fetch_add_explicit(&counters[id], val, memory_order_relaxed);
+}
+
+void ws_br_agent_metrics_inc_rx_msg(uint32_t msg_code)
+{
+  // Index 0 collects unknown codes
+  if (msg_code > WS_BR_AGENT_METRICS_MAX_MSG_CODE) {
+    msg_code = 0U;
+  }
+  atomic_fetch_add_explicit(&rx_msgs[msg_code], 1U, memory_order_relaxed);
+}
+
+void ws_br_agent_metrics_set(ws_br_agent_metric_gauge_t id, int64_t val)
+{
+  atomic_store_explicit(&gauges[id], val, memory_order_relaxed);
+}
+
+void ws_br_agent_metrics_add_gauge(ws_br_agent_metric_gauge_t id, int64_t delta)
+{
+  atomic_fetch_add_explicit(&gauges[id], delta, memory_order_relaxed);
+}
+
+void ws_br_agent_metrics_observe(ws_br_agent_metric_hist_t id, uint64_t val)
+{
+  const metric_hist_desc_t *desc = &hist_descs[id];
+  size_t i = 0U;
+
+  while (i < desc->bound_count && val > desc->bounds[i]) {
+    ++i;
+  }
+  atomic_fetch_add_explicit(&hists[id].buckets[i], 1U, memory_order_relaxed);
+  atomic_fetch_add_explicit(&hists[id].sum, val, memory_order_relaxed);
+}
+
+int ws_br_agent_metrics_mutex_lock(pthread_mutex_t *mutex, ws_br_agent_metric_hist_t id)
+{
+  uint64_t start_us = 0ULL;
+  int r = 0;
+
+  if (pthread_mutex_trylock(mutex) == 0) {
+    ws_br_agent_metrics_observe(id, 0U);
+    return 0;
+  }
+
+  start_us = ws_br_agent_utils_get_monotonic_us();
+  r = pthread_mutex_lock(mutex);
+  ws_br_agent_metrics_observe(id, ws_br_agent_utils_get_monotonic_us() - start_us);
+  return r;
+}
+
+char *ws_br_agent_metrics_render(size_t * const size)
+{
+  char *buf = NULL;
+  FILE *out = NULL;
+  const metric_hist_desc_t *desc = NULL;
+  const char *labels = NULL;
+  const char *sep = NULL;
+  uint64_t cumulative = 0U;
+
+  if (size == NULL) {
+    return NULL;
+  }
+
+  out = open_memstream(&buf, size);
+  if (out == NULL) {
+    return NULL;
+  }
+
+  fprintf(out, "# TYPE " METRIC_PREFIX "rx_messages counter\n"
+               "# HELP " METRIC_PREFIX "rx_messages Messages received by code\n");
+  for (size_t i = 0U; ws_br_agent_msg_code_strs[i].name != NULL; ++i) {
+    if ((uint32_t)ws_br_agent_msg_code_strs[i].val > WS_BR_AGENT_METRICS_MAX_MSG_CODE) {
+      continue;
+    }
+    fprintf(out, METRIC_PREFIX "rx_messages_total{code=\"%s\"} %llu\n",
+            ws_br_agent_msg_code_strs[i].name,
+            (unsigned long long)atomic_load_explicit(&rx_msgs[ws_br_agent_msg_code_strs[i].val],
+                                                     memory_order_relaxed));
+  }
+  fprintf(out, METRIC_PREFIX "rx_messages_total{code=\"UNKNOWN\"} %llu\n",
+          (unsigned long long)atomic_load_explicit(&rx_msgs[0], memory_order_relaxed));
+
+  for (size_t i = 0U; i < WS_BR_AGENT_METRIC_COUNTER_COUNT; ++i) {
+    fprintf(out, "# TYPE " METRIC_PREFIX "%s counter\n"
+                 "# HELP " METRIC_PREFIX "%s %s\n"
+                 METRIC_PREFIX "%s_total %llu\n",
+            counter_descs[i].name, counter_descs[i].name, counter_descs[i].help,
+            counter_descs[i].name,
+            (unsigned long long)atomic_load_explicit(&counters[i], memory_order_relaxed));
+  }
+
+  for (size_t i = 0U; i < WS_BR_AGENT_METRIC_GAUGE_COUNT; ++i) {
+    fprintf(out, "# TYPE " METRIC_PREFIX "%s gauge\n"
+                 "# HELP " METRIC_PREFIX "%s %s\n"
+                 METRIC_PREFIX "%s %lld\n",
+            gauge_descs[i].name, gauge_descs[i].name, gauge_descs[i].help,
+            gauge_descs[i].name,
+            (long long)atomic_load_explicit(&gauges[i], memory_order_relaxed));
+  }
+
+  for (size_t i = 0U; i < WS_BR_AGENT_METRIC_HIST_COUNT; ++i) {
+    desc = &hist_descs[i];
+    if (!i || strcmp(desc->name, hist_descs[i - 1U].name)) {
+      fprintf(out, "# TYPE " METRIC_PREFIX "%s histogram\n"
+                   "# HELP " METRIC_PREFIX "%s %s\n",
+              desc->name, desc->name, desc->help);
+    }
+    labels = desc->labels != NULL ? desc->labels : "";
+    sep = desc->labels != NULL ? "," : "";
+    cumulative = 0U;
+    for (size_t b = 0U; b < desc->bound_count; ++b) {
+      cumulative += atomic_load_explicit(&hists[i].buckets[b], memory_order_relaxed);
+      fprintf(out, METRIC_PREFIX "%s_bucket{%s%sle=\"%g\"} %llu\n",
+              desc->name, labels, sep, (double)desc->bounds[b] / desc->scale,
+              (unsigned long long)cumulative);
+    }
+    cumulative += atomic_load_explicit(&hists[i].buckets[desc->bound_count], memory_order_relaxed);
+    fprintf(out, METRIC_PREFIX "%s_bucket{%s%sle=\"+Inf\"} %llu\n"
+                 METRIC_PREFIX "%s_count%s%s%s %llu\n"
+                 METRIC_PREFIX "%s_sum%s%s%s %g\n",
+            desc->name, labels, sep, (unsigned long long)cumulative,
+            desc->name, *labels ? "{" : "", labels, *labels ? "}" : "",
+            (unsigned long long)cumulative,
+            desc->name, *labels ? "{" : "", labels, *labels ? "}" : "",
+            (double)atomic_load_explicit(&hists[i].sum, memory_order_relaxed) / desc->scale);
+  }
+
+  render_mem(out);
+
+  fprintf(out, "# EOF\n");
+
+  if (fclose(out) != 0) {
+    free(buf);
+    return NULL;
+  }
+  return buf;
+}
+
+static int open_endpoint(const char *endpoint)
+{
+  struct sockaddr_in6 addr6 = { .sin6_family = AF_INET6, .sin6_addr = IN6ADDR_LOOPBACK_INIT };
+  struct sockaddr_un addr_un = { .sun_family = AF_UNIX };
+  char addr_str[INET6_ADDRSTRLEN] = { 0 };
+  const char *port_str = endpoint;
+  const char *end = NULL;
+  int optval = 1;
+  int fd = -1;
+
+  if (!strncmp(endpoint, "unix:", 5)) {
+    if (strlen(endpoint + 5) >= sizeof(addr_un.sun_path)) {
+      return -1;
+    }
+    snprintf(addr_un.sun_path, sizeof(addr_un.sun_path), "%s", endpoint + 5);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      return -1;
+    }
+    unlink(addr_un.sun_path);
+    if (bind(fd, (struct sockaddr *)&addr_un, sizeof(addr_un)) < 0 || listen(fd, 4) < 0) {
+      close(fd);
+      return -1;
+    }
+    snprintf(metrics_unix_path, sizeof(metrics_unix_path), "%s", addr_un.sun_path);
+    return fd;
+  }
+
+  // "[addr]:port" form, plain port binds the loopback address
+  if (endpoint[0] == '[') {
+    end = strchr(endpoint, ']');
+    if (end == NULL || end[1] != ':' || (size_t)(end - endpoint - 1) >= sizeof(addr_str)) {
+      return -1;
+    }
+    memcpy(addr_str, endpoint + 1, (size_t)(end - endpoint - 1));
+    if (inet_pton(AF_INET6, addr_str, &addr6.sin6_addr) != 1) {
+      return -1;
+    }
+    port_str = end + 2;
+  }
+  addr6.sin6_port = htons((uint16_t)strtoul(port_str, NULL, 10));
+  if (!addr6.sin6_port) {
+    return -1;
+  }
+
+  fd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  (void) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+  if (bind(fd, (struct sockaddr *)&addr6, sizeof(addr6)) < 0 || listen(fd, 4) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static void metrics_thr_fnc(void *arg)
+{
+  struct pollfd pfd[2] = {
+    { .fd = metrics_listen_fd, .events = POLLIN },
+    { .fd = metrics_stop_fd, .events = POLLIN }
+  };
+  int conn_fd = -1;
+  int r = 0;
+
+  (void) arg;
+
+  ws_br_agent_service_watchdog_start(WS_BR_AGENT_SERVICE_LOOP_METRICS);
+  while (!metrics_thread_stop) {
+    ws_br_agent_service_watchdog_kick(WS_BR_AGENT_SERVICE_LOOP_METRICS);
+    // Sleep until a scrape, deinit wakes the thread up or the watchdog is due
+    r = poll(pfd, 2U, ws_br_agent_service_watchdog_interval_ms());
+    if (r <= 0 || (pfd[1].revents & POLLIN) || !(pfd[0].revents & POLLIN)) {
+      continue;
+    }
+    conn_fd = accept(metrics_listen_fd, NULL, NULL);
+    if (conn_fd < 0) {
+      continue;
+    }
+    serve_scrape(conn_fd);
+    close(conn_fd);
+  }
+  ws_br_agent_service_watchdog_stop(WS_BR_AGENT_SERVICE_LOOP_METRICS);
+}
+
+static int metrics_listen_hnd(sd_event_source *s, int fd, uint32_t revents, void *userdata)
+{
+  int conn_fd = -1;
+
+  (void) s;
+  (void) revents;
+  (void) userdata;
+
+  conn_fd = accept(fd, NULL, NULL);
+  if (conn_fd < 0) {
+    return 0;
+  }
+  serve_scrape(conn_fd);
+  close(conn_fd);
+  return 0;
+}
+
+static void serve_scrape(int conn_fd)
+{
+  char req[HTTP_REQ_BUF_SIZE];
+  char hdr[256];
+  // The stop event (none in event loop mode) aborts a pending request
+  struct pollfd pfd[2] = {
+    { .fd = conn_fd, .events = POLLIN },
+    { .fd = metrics_stop_fd, .events = POLLIN }
+  };
+  char *body = NULL;
+  size_t body_size = 0U;
+  size_t received = 0U;
+  size_t sent = 0U;
+  ssize_t r = 0;
+  int hdr_len = 0;
+
+  // Read until the end of the request headers
+  while (received < sizeof(req) - 1U) {
+    if (poll(pfd, 2U, HTTP_REQ_TIMEOUT_MS) <= 0 || (pfd[1].revents & POLLIN)) {
+      return;
+    }
+    r = recv(conn_fd, req + received, sizeof(req) - 1U - received, 0);
+    if (r <= 0) {
+      return;
+    }
+    received += (size_t)r;
+    req[received] = '\0';
+    if (strstr(req, "\r\n\r\n") != NULL || strstr(req, "\n\n") != NULL) {
+      break;
+    }
+  }
+
+  if (strncmp(req, "GET ", 4)) {
+    hdr_len = snprintf(hdr, sizeof(hdr), "HTTP/1.0 405 Method Not Allowed\r\n"
+                                         "Content-Length: 0\r\n\r\n");
+    (void) send(conn_fd, hdr, (size_t)hdr_len, MSG_NOSIGNAL);
+    return;
+  }
+
+  body = ws_br_agent_metrics_render(&body_size);
+  if (body == NULL) {
+    hdr_len = snprintf(hdr, sizeof(hdr), "HTTP/1.0 500 Internal Server Error\r\n"
+                                         "Content-Length: 0\r\n\r\n");
+    (void) send(conn_fd, hdr, (size_t)hdr_len, MSG_NOSIGNAL);
+    return;
+  }
+
+  hdr_len = snprintf(hdr, sizeof(hdr),
+                     "HTTP/1.0 200 OK\r\n"
+                     "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                     "Content-Length: %zu\r\n\r\n", body_size);
+  if (send(conn_fd, hdr, (size_t)hdr_len, MSG_NOSIGNAL) == hdr_len) {
+    while (sent < body_size) {
+      r = send(conn_fd, body + sent, body_size - sent, MSG_NOSIGNAL);
+      if (r <= 0) {
+        break;
+      }
+      sent += (size_t)r;
+    }
+  }
+  free(body);
+}
+
+static void render_mem(FILE *out)
+{
+  ws_br_agent_mem_stats_t stats[WS_BR_AGENT_MEM_SUBSYS_COUNT] = { 0 };
+  ws_br_agent_mem_pool_stats_t pool = { 0 };
+
+  for (size_t i = 0U; i < WS_BR_AGENT_MEM_SUBSYS_COUNT; ++i) {
+    (void) ws_br_agent_mem_get_stats((ws_br_agent_mem_subsys_t)i, &stats[i]);
+  }
+
+#define __render_mem_subsys(type, name, help, suffix, field)                              \
+  do {                                                                                    \
+    fprintf(out, "# TYPE " METRIC_PREFIX name " " type "\n"                              \
+                 "# HELP " METRIC_PREFIX name " " help "\n");                            \
+    for (size_t i = 0U; i < WS_BR_AGENT_MEM_SUBSYS_COUNT; ++i) {                          \
+      fprintf(out, METRIC_PREFIX name suffix "{subsystem=\"%s\"} %llu\n",                 \
+              ws_br_agent_mem_subsys_strs[i], (unsigned long long)stats[i].field);        \
+    }                                                                                     \
+  } while (0)
+
+  __render_mem_subsys("counter", "mem_allocations", "Accounted allocations", "_total", allocs);
+  __render_mem_subsys("counter", "mem_frees", "Accounted frees", "_total", frees);
+  __render_mem_subsys("counter", "mem_allocation_failures",
+                      "Allocations refused by the budget or the pools, or failed", "_total", failures);
+  __render_mem_subsys("gauge", "mem_bytes", "Bytes in use, headers and pool blocks included", "", bytes);
+  __render_mem_subsys("gauge", "mem_peak_bytes", "Highest bytes in use", "", peak_bytes);
+#undef __render_mem_subsys
+
+  fprintf(out, "# TYPE " METRIC_PREFIX "mem_budget_bytes gauge\n"
+               "# HELP " METRIC_PREFIX "mem_budget_bytes Memory budget, 0 for no limit\n"
+               METRIC_PREFIX "mem_budget_bytes %zu\n", ws_br_agent_mem_get_budget());
+
+  fprintf(out, "# TYPE " METRIC_PREFIX "mem_pool_blocks gauge\n"
+               "# HELP " METRIC_PREFIX "mem_pool_blocks Pool blocks in use, high water mark, held and maximum\n");
+  for (size_t i = 0U; ws_br_agent_mem_get_pool_stats(i, &pool) == WS_BR_AGENT_RET_OK; ++i) {
+    fprintf(out, METRIC_PREFIX "mem_pool_blocks{block_size=\"%zu\",state=\"in_use\"} %u\n"
+                 METRIC_PREFIX "mem_pool_blocks{block_size=\"%zu\",state=\"high_water\"} %u\n"
+                 METRIC_PREFIX "mem_pool_blocks{block_size=\"%zu\",state=\"allocated\"} %u\n"
+                 METRIC_PREFIX "mem_pool_blocks{block_size=\"%zu\",state=\"max\"} %u\n",
+            pool.block_size, pool.in_use, pool.block_size, pool.high_water,
+            pool.block_size, pool.allocated, pool.block_size, pool.block_count);
+  }
+  fprintf(out, "# TYPE " METRIC_PREFIX "mem_pool_requests counter\n"
+               "# HELP " METRIC_PREFIX "mem_pool_requests Pool requests served by a free block (hit) or not (miss)\n");
+  for (size_t i = 0U; ws_br_agent_mem_get_pool_stats(i, &pool) == WS_BR_AGENT_RET_OK; ++i) {
+    fprintf(out, METRIC_PREFIX "mem_pool_requests_total{block_size=\"%zu\",result=\"hit\"} %llu\n"
+                 METRIC_PREFIX "mem_pool_requests_total{block_size=\"%zu\",result=\"miss\"} %llu\n",
+            pool.block_size, (unsigned long long)pool.hits,
+            pool.block_size, (unsigned long long)pool.misses);
+  }
+  fprintf(out, "# TYPE " METRIC_PREFIX "mem_pool_exhausted counter\n"
+               "# HELP " METRIC_PREFIX "mem_pool_exhausted Allocations that found the pool empty and full-sized\n");
+  for (size_t i = 0U; ws_br_agent_mem_get_pool_stats(i, &pool) == WS_BR_AGENT_RET_OK; ++i) {
+    fprintf(out, METRIC_PREFIX "mem_pool_exhausted_total{block_size=\"%zu\"} %llu\n",
+            pool.block_size, (unsigned long long)pool.exhausted);
+  }
+}
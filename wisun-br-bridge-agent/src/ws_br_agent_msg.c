@@ -31,16 +31,22 @@
 
 #include <stdlib.h>
 #include <string.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "msg"
 #include "ws_br_agent_log.h"
 #include "ws_br_agent_defs.h"
 #include "ws_br_agent_soc_host.h"
 #include "ws_br_agent_msg.h"
+#include "ws_br_agent_mem.h"
+#include "ws_br_agent_probe.h"
+#include "ws_br_agent_metrics.h"
+#include "ws_br_agent_crc.h"
 
-#define __add_msg_code_and_len_to_buf(ptr, msg)       \
+#define __add_msg_code_and_len_to_buf(ptr, code, len)  \
   do {                                                \
-    *(uint32_t *)ptr = htonl(msg->msg_code);          \
+    ws_br_agent_put_be32(ptr, (code));                \
     ptr += sizeof(ws_br_agent_msg_raw_code_t);        \
-    *(uint32_t *)ptr = htonl(msg->payload_len);       \
+    ws_br_agent_put_be32(ptr, (len));                 \
     ptr += sizeof(ws_br_agent_msg_len_t);             \
   } while(0)
 
@@ -49,43 +55,86 @@ uint8_t *ws_br_agent_msg_build_buf(const ws_br_agent_msg_t * const msg, size_t *
   uint8_t *ptr = NULL;
   uint8_t *start_ptr = NULL;
   ws_br_agent_msg_settings_payload_t settings_payload = { 0U };
+  const uint8_t *payload = NULL;
+  ws_br_agent_msg_len_t payload_len = 0U;
+  ws_br_agent_msg_raw_code_t code = 0U;
+  size_t crc_size = 0U;
 
   if (msg == NULL || buf_size ==NULL) {
     return NULL;
   }
 
+  code = msg->crc ? (msg->msg_code | WS_BR_AGENT_MSG_FLAG_CRC32C) : msg->msg_code;
+  crc_size = msg->crc ? WS_BR_AGENT_MSG_CRC_SIZE : 0U;
+
   switch(msg->msg_code) {
+    /// Topology and node metrics entries
     case WS_BR_AGENT_MSG_CODE_TOPOLOGY:
+    case WS_BR_AGENT_MSG_CODE_NODE_STATS:
+      if (msg->payload_len && msg->payload == NULL) {
+        ws_br_agent_log_error("Build message error: Missing payload\n");
+        return NULL;
+      }
+      start_ptr = ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_MSG, WS_BR_AGENT_MSG_MIN_BUF_SIZE + msg->payload_len + crc_size);
+      if (start_ptr == NULL) {
+        ws_br_agent_log_error("Build message error: Memory allocation failed\n");
+        return NULL;
+      }
+      ptr = start_ptr;
+      __add_msg_code_and_len_to_buf(ptr, code, msg->payload_len);
+      if (msg->payload_len) {
+        memcpy(ptr, msg->payload, msg->payload_len);
+        ptr += msg->payload_len;
+      }
+      break;
+
     case WS_BR_AGENT_MSG_CODE_GET_CONFIG_PARAMS:
     case WS_BR_AGENT_MSG_CODE_RESTART_BR:
     case WS_BR_AGENT_MSG_CODE_STOP_BR:
-      start_ptr = malloc(WS_BR_AGENT_MSG_MIN_BUF_SIZE);
+      start_ptr = ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_MSG, WS_BR_AGENT_MSG_MIN_BUF_SIZE + crc_size);
       if (start_ptr == NULL) {
         ws_br_agent_log_error("Build message error: Memory allocation failed\n");
         return NULL;
       }
       ptr = start_ptr;
-      __add_msg_code_and_len_to_buf(ptr, msg);
+      __add_msg_code_and_len_to_buf(ptr, code, msg->payload_len);
       break;
 
     /// Parameter config
     case WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS:
-      start_ptr = malloc(WS_BR_AGENT_MSG_SET_PARAM_MSG_BUF_SIZE);
+      // Current host settings unless the payload (legacy or TLV encoded) is given
+      if (msg->payload != NULL) {
+        payload = msg->payload;
+        payload_len = msg->payload_len;
+      } else {
+        (void) ws_br_agent_soc_host_get_settings(&settings_payload);
+        payload = (const uint8_t *)&settings_payload;
+        payload_len = sizeof(ws_br_agent_msg_settings_payload_t);
+      }
+      if (payload_len > WS_BR_AGENT_SETTINGS_TLV_MAX_SIZE) {
+        ws_br_agent_log_error("Build message error: Invalid payload length\n");
+        return NULL;
+      }
+      start_ptr = ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_MSG, WS_BR_AGENT_MSG_MIN_BUF_SIZE + payload_len + crc_size);
       if (start_ptr == NULL) {
         ws_br_agent_log_error("Build message error: Memory allocation failed\n");
         return NULL;
       }
       ptr = start_ptr;
-      __add_msg_code_and_len_to_buf(ptr, msg);
-      (void) ws_br_agent_soc_host_get_settings(&settings_payload);
-      memcpy((uint8_t *)ptr, &settings_payload, sizeof(ws_br_agent_msg_settings_payload_t));
-      ptr += sizeof(ws_br_agent_msg_settings_payload_t);
+      __add_msg_code_and_len_to_buf(ptr, code, payload_len);
+      memcpy(ptr, payload, payload_len);
+      ptr += payload_len;
       break;
 
     default:
       ws_br_agent_log_error("Build message error: Unsupported request code (0x%2x)\n", msg->msg_code);
       return NULL;
   }
+
+  if (msg->crc) {
+    ws_br_agent_put_be32(ptr, ws_br_agent_crc32c(0U, start_ptr, (size_t)(ptr - start_ptr)));
+    ptr += WS_BR_AGENT_MSG_CRC_SIZE;
+  }
   
   *buf_size = (size_t)(ptr - start_ptr);
   return start_ptr;
@@ -94,37 +143,45 @@ uint8_t *ws_br_agent_msg_build_buf(const ws_br_agent_msg_t * const msg, size_t *
 ws_br_agent_msg_t *ws_br_agent_msg_parse_buf(const uint8_t * const buf, const size_t buf_size)
 {
   ws_br_agent_msg_t *msg = NULL;
-  uint32_t *ptr = (uint32_t *)buf;
+  const uint8_t *ptr = buf;
+  ws_br_agent_msg_raw_code_t code = 0U;
+
+  ws_br_agent_probe1(parse_start, buf_size);
 
   if (buf == NULL || buf_size < (WS_BR_AGENT_MSG_MIN_BUF_SIZE)) {
     return NULL;
   }
 
-  switch(ntohl(*ptr)) {
+  code = ws_br_agent_get_be32(ptr) & ~WS_BR_AGENT_MSG_FLAG_CRC32C;
+  switch(code) {
     case WS_BR_AGENT_MSG_CODE_TOPOLOGY:
     case WS_BR_AGENT_MSG_CODE_GET_CONFIG_PARAMS:
     case WS_BR_AGENT_MSG_CODE_RESTART_BR:
     case WS_BR_AGENT_MSG_CODE_STOP_BR:
     case WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS:
-      msg = (ws_br_agent_msg_t *)malloc(sizeof(ws_br_agent_msg_t));
+    case WS_BR_AGENT_MSG_CODE_NODE_STATS:
+      msg = (ws_br_agent_msg_t *)ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_MSG,
+                                                    sizeof(ws_br_agent_msg_t));
       if (msg == NULL) {
         ws_br_agent_log_error("Parse message error: Memory allocation failed\n");
         return NULL;
       }
-      msg->msg_code = ntohl(*ptr);
-      ptr++;
-      msg->payload_len = ntohl(*ptr);
-      ptr++;
+      msg->msg_code = code;
+      msg->crc = (ws_br_agent_get_be32(ptr) & WS_BR_AGENT_MSG_FLAG_CRC32C) != 0U;
+      ptr += sizeof(ws_br_agent_msg_raw_code_t);
+      msg->payload_len = ws_br_agent_get_be32(ptr);
+      ptr += sizeof(ws_br_agent_msg_len_t);
       if (msg->payload_len > 0) {
-        if (buf_size < (WS_BR_AGENT_MSG_MIN_BUF_SIZE + msg->payload_len)) {
+        if (buf_size < ws_br_agent_msg_frame_size(buf)) {
           ws_br_agent_log_error("Parse message error: Invalid payload length\n");
-          free(msg);
+          ws_br_agent_mem_free(msg);
           return NULL;
         }
-        msg->payload = (uint8_t *)malloc(msg->payload_len);
+        msg->payload = (uint8_t *)ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_MSG,
+                                                        msg->payload_len);
         if (msg->payload == NULL) {
           ws_br_agent_log_error("Parse message error: Memory allocation failed\n");
-          free(msg);
+          ws_br_agent_mem_free(msg);
           return NULL;
         }
         memcpy(msg->payload, ptr, msg->payload_len);
@@ -133,13 +190,60 @@ ws_br_agent_msg_t *ws_br_agent_msg_parse_buf(const uint8_t * const buf, const si
       }
       break;
     default:
-      ws_br_agent_log_error("Build message error: Unsupported request code (0x%2x)\n", ntohl(*ptr));
+      ws_br_agent_log_error("Build message error: Unsupported request code (0x%2x)\n",
+                            ws_br_agent_get_be32(ptr));
       return NULL;
   }
 
+  ws_br_agent_probe2(parse_done, msg->msg_code, msg->payload_len);
   return msg;
 }
 
+size_t ws_br_agent_msg_frame_size(const uint8_t * const hdr)
+{
+  // The length comes from the peer: computed on 64 bits, so that it cannot wrap on 32-bit targets
+  uint64_t size = (uint64_t)WS_BR_AGENT_MSG_MIN_BUF_SIZE
+                  + ws_br_agent_get_be32(hdr + sizeof(ws_br_agent_msg_raw_code_t));
+
+  if (ws_br_agent_get_be32(hdr) & WS_BR_AGENT_MSG_FLAG_CRC32C) {
+    size += WS_BR_AGENT_MSG_CRC_SIZE;
+  }
+  return size > SIZE_MAX ? SIZE_MAX : (size_t)size;
+}
+
+ws_br_agent_ret_t ws_br_agent_msg_check_crc(const uint8_t * const buf, const size_t buf_size)
+{
+  size_t frame_size = 0U;
+  uint32_t crc = 0U;
+
+  if (buf == NULL || buf_size < WS_BR_AGENT_MSG_MIN_BUF_SIZE) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  if (!(ws_br_agent_get_be32(buf) & WS_BR_AGENT_MSG_FLAG_CRC32C)) {
+    return WS_BR_AGENT_RET_OK;
+  }
+  frame_size = ws_br_agent_msg_frame_size(buf);
+  if (buf_size < frame_size) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  crc = ws_br_agent_crc32c(0U, buf, frame_size - WS_BR_AGENT_MSG_CRC_SIZE);
+  if (crc != ws_br_agent_get_be32(buf + frame_size - WS_BR_AGENT_MSG_CRC_SIZE)) {
+    ws_br_agent_log_warn("Frame CRC32C mismatch (0x%08x, expected 0x%08x)\n",
+                         ws_br_agent_get_be32(buf + frame_size - WS_BR_AGENT_MSG_CRC_SIZE), crc);
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_CRC_FAILURES, 1U);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+ws_br_agent_msg_settings_enc_t ws_br_agent_msg_get_settings_enc(const ws_br_agent_msg_t * const msg)
+{
+  if (msg != NULL && ws_br_agent_settings_tlv_detect(msg->payload, msg->payload_len)) {
+    return WS_BR_AGENT_MSG_SETTINGS_ENC_TLV;
+  }
+  return WS_BR_AGENT_MSG_SETTINGS_ENC_LEGACY;
+}
+
 void ws_br_agent_msg_free(ws_br_agent_msg_t *msg)
 {
   if (msg == NULL) {
@@ -147,8 +251,13 @@ void ws_br_agent_msg_free(ws_br_agent_msg_t *msg)
   }
   // Free payload if allocated
   if (msg->payload != NULL) {
-    free(msg->payload);
+    ws_br_agent_mem_free(msg->payload);
   }
   // Free message structure
-  free(msg);
+  ws_br_agent_mem_free(msg);
+}
+
+void ws_br_agent_msg_free_buf(uint8_t *buf)
+{
+  ws_br_agent_mem_free(buf);
 }
\ No newline at end of file
@@ -0,0 +1,301 @@
+/***************************************************************************//**
+ * @file ws_br_agent_node_stats.c
+ * @brief Per-node link metrics pushed by the SoC
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+
+#include <string.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "node_stats"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_mem.h"
+#include "ws_br_agent_node_stats.h"
+
+/// No row
+#define NODE_STATS_NONE UINT32_MAX
+
+/// Smallest row capacity
+#define NODE_STATS_MIN_ROWS 64U
+
+/// Block bytes per row: last heard, 2 index slots, ETX, RSL in and out, PHY mode ID, valid flag
+#define NODE_STATS_ROW_SIZE (sizeof(uint64_t) + 2U * sizeof(uint32_t) + sizeof(uint16_t) + 4U)
+
+static inline uint32_t node_stats_hash(const uint8_t addr[16])
+{
+  uint64_t hi = 0U;
+  uint64_t lo = 0U;
+
+  memcpy(&hi, addr, sizeof(hi));
+  memcpy(&lo, addr + 8, sizeof(lo));
+  lo ^= hi * 0xC2B2AE3D27D4EB4FULL;
+  lo ^= lo >> 32;
+  return (uint32_t)((lo * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/// Carve the columns and the index from a block of cap rows (power of two)
+static void node_stats_carve(ws_br_agent_node_stats_t * const stats, void *block, uint32_t cap)
+{
+  uint8_t *ptr = (uint8_t *)block;
+
+  stats->block = block;
+  stats->cap = cap;
+  stats->last_heard_us = (uint64_t *)ptr;
+  ptr += cap * sizeof(uint64_t);
+  stats->slots = (uint32_t *)ptr;
+  ptr += 2U * cap * sizeof(uint32_t);
+  stats->etx = (uint16_t *)ptr;
+  ptr += cap * sizeof(uint16_t);
+  stats->rsl_in = ptr;
+  ptr += cap;
+  stats->rsl_out = ptr;
+  ptr += cap;
+  stats->phy_mode_id = ptr;
+  ptr += cap;
+  stats->valid = ptr;
+  stats->slot_mask = 2U * cap - 1U;
+  stats->indexed = false;
+}
+
+/// Block for at least rows rows, the spare one when large enough. NULL on failure.
+/// The capacity covers the whole block: a table pool block fits a full topology and never grows.
+static void *node_stats_alloc(ws_br_agent_node_stats_t * const stats, uint32_t rows, uint32_t * const cap)
+{
+  size_t size = 0U;
+  void *block = NULL;
+
+  *cap = NODE_STATS_MIN_ROWS;
+  while (*cap < rows) {
+    *cap <<= 1;
+  }
+  size = *cap * NODE_STATS_ROW_SIZE;
+  if (stats->spare != NULL && ws_br_agent_mem_usable_size(stats->spare) >= size) {
+    block = stats->spare;
+    stats->spare = NULL;
+  } else {
+    ws_br_agent_mem_free(stats->spare);
+    stats->spare = NULL;
+    block = ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_TABLES, size);
+  }
+  while (block != NULL && 2U * *cap * NODE_STATS_ROW_SIZE <= ws_br_agent_mem_usable_size(block)) {
+    *cap <<= 1;
+  }
+  return block;
+}
+
+/// Index the topology targets, the first entry of a duplicate target wins
+static void node_stats_index(ws_br_agent_node_stats_t * const stats, const ws_br_agent_topo_t * const topo)
+{
+  uint8_t addr[16] = { 0U };
+  uint32_t slot = 0U;
+
+  memset(stats->slots, 0, (stats->slot_mask + 1U) * sizeof(uint32_t));
+  for (uint32_t i = 0U; i < topo->node_count; ++i) {
+    if (topo->flags[i] & WS_BR_AGENT_TOPO_FLAG_DUPLICATE) {
+      continue;
+    }
+    ws_br_agent_topo_get_addr(topo, i, addr);
+    slot = node_stats_hash(addr) & stats->slot_mask;
+    while (stats->slots[slot]) {
+      slot = (slot + 1U) & stats->slot_mask;
+    }
+    stats->slots[slot] = i + 1U;
+  }
+  stats->indexed = true;
+}
+
+/// Row of a target: the hinted one when it matches, else from the index (first entry of a duplicate target)
+static uint32_t node_stats_row(ws_br_agent_node_stats_t * const stats, const ws_br_agent_topo_t * const topo,
+                               uint32_t hint, const uint8_t target[16])
+{
+  uint8_t addr[16] = { 0U };
+  uint32_t slot = 0U;
+  uint32_t row = 0U;
+
+  if (hint < topo->node_count && !(topo->flags[hint] & WS_BR_AGENT_TOPO_FLAG_DUPLICATE)) {
+    ws_br_agent_topo_get_addr(topo, hint, addr);
+    if (!memcmp(addr, target, 16U)) {
+      return hint;
+    }
+  }
+  if (!stats->indexed) {
+    node_stats_index(stats, topo);
+  }
+  for (slot = node_stats_hash(target) & stats->slot_mask; stats->slots[slot];
+       slot = (slot + 1U) & stats->slot_mask) {
+    row = stats->slots[slot] - 1U;
+    ws_br_agent_topo_get_addr(topo, row, addr);
+    if (!memcmp(addr, target, 16U)) {
+      return row;
+    }
+  }
+  return NODE_STATS_NONE;
+}
+
+ws_br_agent_ret_t ws_br_agent_node_stats_update(ws_br_agent_node_stats_t * const stats,
+                                                const ws_br_agent_topo_t * const topo,
+                                                const ws_br_agent_node_stats_entry_t * const entries,
+                                                uint32_t count, uint64_t time_us, uint32_t * const unknown)
+{
+  const ws_br_agent_node_stats_entry_t *entry = NULL;
+  uint64_t age_us = 0U;
+  uint32_t row = NODE_STATS_NONE;
+  uint32_t cap = 0U;
+  void *block = NULL;
+
+  if (stats == NULL || topo == NULL || (entries == NULL && count) || unknown == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  *unknown = 0U;
+
+  // First metrics: rows for the current topology, later moved along with it
+  if (stats->block == NULL || stats->row_count != topo->node_count) {
+    if (stats->block == NULL || stats->cap < topo->node_count) {
+      block = node_stats_alloc(stats, topo->node_count, &cap);
+      if (block == NULL) {
+        return WS_BR_AGENT_RET_ERR;
+      }
+      ws_br_agent_mem_free(stats->block);
+      node_stats_carve(stats, block, cap);
+    }
+    memset(stats->valid, 0, stats->cap);
+    stats->row_count = topo->node_count;
+    stats->indexed = false;
+  }
+
+  // Entries in topology order hit the row following the previous one
+  for (uint32_t i = 0U; i < count; ++i) {
+    entry = &entries[i];
+    row = node_stats_row(stats, topo, row + 1U, entry->target);
+    if (row == NODE_STATS_NONE) {
+      ++*unknown;
+      continue;
+    }
+    age_us = (uint64_t)ws_br_agent_get_be32(entry->last_heard_s) * 1000000ULL;
+    stats->rsl_in[row] = entry->rsl_in;
+    stats->rsl_out[row] = entry->rsl_out;
+    stats->etx[row] = ws_br_agent_get_be16(entry->etx);
+    stats->phy_mode_id[row] = entry->phy_mode_id;
+    stats->last_heard_us[row] = age_us < time_us ? time_us - age_us : 0U;
+    stats->valid[row] = 1U;
+  }
+  stats->update_us = time_us;
+
+  return WS_BR_AGENT_RET_OK;
+}
+
+void ws_br_agent_node_stats_remap(ws_br_agent_node_stats_t * const stats,
+                                  const ws_br_agent_topo_t * const prev,
+                                  const ws_br_agent_topo_t * const topo)
+{
+  ws_br_agent_node_stats_t next = { 0 };
+  uint8_t addr[16] = { 0U };
+  uint32_t row = NODE_STATS_NONE;
+  uint32_t cap = 0U;
+  void *block = NULL;
+
+  if (stats == NULL || stats->block == NULL) {
+    return;
+  }
+
+  block = node_stats_alloc(stats, topo->node_count, &cap);
+  if (block == NULL) {
+    ws_br_agent_log_warn("Node metrics dropped: out of memory\n");
+    ws_br_agent_node_stats_free(stats);
+    return;
+  }
+  next = *stats;
+  node_stats_carve(&next, block, cap);
+  memset(next.valid, 0, cap);
+  next.row_count = topo->node_count;
+
+  // Unchanged entries keep their row, moved nodes are found through the new index
+  for (uint32_t i = 0U; i < stats->row_count && i < prev->node_count; ++i) {
+    if (!stats->valid[i]) {
+      continue;
+    }
+    ws_br_agent_topo_get_addr(prev, i, addr);
+    row = node_stats_row(&next, topo, i, addr);
+    if (row == NODE_STATS_NONE) {
+      continue;
+    }
+    next.last_heard_us[row] = stats->last_heard_us[i];
+    next.etx[row] = stats->etx[i];
+    next.rsl_in[row] = stats->rsl_in[i];
+    next.rsl_out[row] = stats->rsl_out[i];
+    next.phy_mode_id[row] = stats->phy_mode_id[i];
+    next.valid[row] = 1U;
+  }
+
+  next.spare = stats->block;
+  *stats = next;
+}
+
+ws_br_agent_ret_t ws_br_agent_node_stats_foreach(const ws_br_agent_node_stats_t * const stats,
+                                                 const ws_br_agent_topo_t * const topo,
+                                                 uint32_t first, uint32_t count,
+                                                 ws_br_agent_node_stats_cb_t cb, void *ctx)
+{
+  ws_br_agent_node_stats_row_t row = { 0 };
+  uint32_t end = 0U;
+
+  if (stats == NULL || topo == NULL || cb == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  if (stats->block == NULL || stats->row_count != topo->node_count || first >= stats->row_count) {
+    return WS_BR_AGENT_RET_OK;
+  }
+
+  end = count && count < stats->row_count - first ? first + count : stats->row_count;
+  for (uint32_t i = first; i < end; ++i) {
+    if (!stats->valid[i]) {
+      continue;
+    }
+    ws_br_agent_topo_get_addr(topo, i, row.target);
+    row.index = i;
+    row.rsl_in_dbm = (int16_t)(stats->rsl_in[i] - WS_BR_AGENT_NODE_STATS_RSL_OFFSET);
+    row.rsl_out_dbm = (int16_t)(stats->rsl_out[i] - WS_BR_AGENT_NODE_STATS_RSL_OFFSET);
+    row.etx = stats->etx[i];
+    row.phy_mode_id = stats->phy_mode_id[i];
+    row.last_heard_us = stats->last_heard_us[i];
+    if (cb(ctx, &row) < 0) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+void ws_br_agent_node_stats_free(ws_br_agent_node_stats_t * const stats)
+{
+  if (stats == NULL) {
+    return;
+  }
+  ws_br_agent_mem_free(stats->block);
+  ws_br_agent_mem_free(stats->spare);
+  *stats = (ws_br_agent_node_stats_t) { 0 };
+}
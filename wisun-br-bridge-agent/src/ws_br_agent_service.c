@@ -0,0 +1,145 @@
+/***************************************************************************//**
+ * @file ws_br_agent_service.c
+ * @brief Wi-SUN SoC Border Router Agent systemd service integration
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#include <stdatomic.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <systemd/sd-daemon.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "service"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_service.h"
+
+/// Loops report progress 4 times per watchdog timeout, so that a late loop skips
+/// at most one of the pings systemd expects every half timeout
+#define WATCHDOG_INTERVAL_DIV 4ULL
+
+static const char *loop_strs[WS_BR_AGENT_SERVICE_LOOP_COUNT] = {
+  [WS_BR_AGENT_SERVICE_LOOP_SRV] = "srv",
+  [WS_BR_AGENT_SERVICE_LOOP_DBUS] = "dbus",
+  [WS_BR_AGENT_SERVICE_LOOP_METRICS] = "metrics",
+  [WS_BR_AGENT_SERVICE_LOOP_STATE] = "state",
+  [WS_BR_AGENT_SERVICE_LOOP_CONFIG] = "config",
+};
+
+static int watchdog_interval_ms = -1;
+static atomic_bool loop_active[WS_BR_AGENT_SERVICE_LOOP_COUNT];
+static atomic_bool loop_kicked[WS_BR_AGENT_SERVICE_LOOP_COUNT];
+static bool loop_stalled[WS_BR_AGENT_SERVICE_LOOP_COUNT];
+
+ws_br_agent_ret_t ws_br_agent_service_init(void)
+{
+  uint64_t usec = 0ULL;
+
+  if (sd_watchdog_enabled(0, &usec) > 0 && usec >= WATCHDOG_INTERVAL_DIV * 1000ULL) {
+    watchdog_interval_ms = (int)(usec / WATCHDOG_INTERVAL_DIV / 1000ULL);
+    ws_br_agent_log_info("Watchdog enabled: %llu ms\n", (unsigned long long)(usec / 1000ULL));
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+int ws_br_agent_service_get_listen_fd(uint16_t port)
+{
+  int n = 0;
+  int fd = -1;
+
+  n = sd_listen_fds(0);
+  for (int i = 0; i < n; ++i) {
+    fd = SD_LISTEN_FDS_START + i;
+    if (sd_is_socket_inet(fd, AF_UNSPEC, SOCK_STREAM, 1, port) > 0) {
+      (void) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      (void) fcntl(fd, F_SETFD, FD_CLOEXEC);
+      ws_br_agent_log_info("Using socket activation listen socket for port %u\n", port);
+      return fd;
+    }
+  }
+  return -1;
+}
+
+void ws_br_agent_service_notify_ready(void)
+{
+  (void) sd_notify(0, "READY=1");
+}
+
+void ws_br_agent_service_notify_stopping(void)
+{
+  (void) sd_notify(0, "STOPPING=1");
+}
+
+int ws_br_agent_service_watchdog_interval_ms(void)
+{
+  return watchdog_interval_ms;
+}
+
+void ws_br_agent_service_watchdog_start(ws_br_agent_service_loop_t loop)
+{
+  atomic_store(&loop_kicked[loop], true);
+  atomic_store(&loop_active[loop], true);
+}
+
+void ws_br_agent_service_watchdog_stop(ws_br_agent_service_loop_t loop)
+{
+  atomic_store(&loop_active[loop], false);
+}
+
+void ws_br_agent_service_watchdog_kick(ws_br_agent_service_loop_t loop)
+{
+  atomic_store_explicit(&loop_kicked[loop], true, memory_order_relaxed);
+}
+
+void ws_br_agent_service_watchdog_check(void)
+{
+  bool alive = true;
+
+  if (watchdog_interval_ms < 0) {
+    return;
+  }
+
+  for (int i = 0; i < WS_BR_AGENT_SERVICE_LOOP_COUNT; ++i) {
+    if (!atomic_load(&loop_active[i])) {
+      continue;
+    }
+    if (!atomic_exchange(&loop_kicked[i], false)) {
+      if (!loop_stalled[i]) {
+        ws_br_agent_log_warn("Watchdog: %s loop did not report progress\n", loop_strs[i]);
+      }
+      loop_stalled[i] = true;
+      alive = false;
+    } else {
+      loop_stalled[i] = false;
+    }
+  }
+
+  if (alive) {
+    (void) sd_notify(0, "WATCHDOG=1");
+  }
+}
@@ -30,20 +30,661 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <errno.h>
+#include <pthread.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "settings"
 #include "ws_br_agent_settings.h"
 #include "ws_br_agent_log.h"
 #include "ws_br_agent_utils.h"
 
+/// Field lookup hash table size (power of 2, at least twice the field count)
+#define SETTINGS_HASH_SIZE 128U
+
+/// TLV tag lookup table size, all tags are below it
+#define SETTINGS_TAG_TABLE_SIZE 256U
+
+/// PHY configuration type mask shorthand
+#define PHY(type) WS_BR_AGENT_SETTINGS_PHY(WS_BR_AGENT_PHY_CONFIG_##type)
+
+/// Settings field: TLV tag, key, member, type, PHY types, name table, range, D-Bus type and property
+#define FIELD(tag, key, member, type, phy_types, table, min, max, dbus_type, dbus_name)   \
+  { (key), (dbus_name), (dbus_type), WS_BR_AGENT_SETTINGS_FIELD_##type, (phy_types),     \
+    (uint16_t)offsetof(ws_br_agent_settings_t, member),                                 \
+    (uint16_t)sizeof(((ws_br_agent_settings_t *)NULL)->member), (tag), (table), (min), (max) }
+
+const char *soc_host_addr = NULL;
+
+/// Settings fields, a new field only needs a line here.
+/// TLV tags are part of the SoC protocol: never reuse or renumber one, aliases have none (0).
+static const ws_br_agent_settings_field_t settings_fields[] = {
+  FIELD(1, "network_name", network_name, STR, 0U, NULL, 0, 0, 's', "WisunNetworkName"),
+  FIELD(2, "size", network_size, ENUM, 0U, ws_br_agent_nw_size_strs, 0, 0, 's', "WisunSize"),
+  FIELD(3, "tx_power_ddbm", tx_power_ddbm, INT, 0U, NULL, 0, 0, 'n', NULL),
+  FIELD(4, "uc_dwell_interval_ms", uc_dwell_interval_ms, UINT, 0U, NULL, 15, 255, 'y', NULL),
+  FIELD(5, "bc_interval_ms", bc_interval_ms, UINT, 0U, NULL, 0, 0xFFFFFF, 'u', NULL),
+  FIELD(6, "bc_dwell_interval_ms", bc_dwell_interval_ms, UINT, 0U, NULL, 100, 255, 'y', NULL),
+  FIELD(7, "state", state, UINT, 0U, NULL, 0, 0, 'y', NULL),
+  FIELD(8, "allowed_channels", allowed_channels, STR, 0U, NULL, 0, 0, 's', NULL),
+  FIELD(9, "ipv6_prefix", ipv6_prefix, STR, 0U, NULL, 0, 0, 's', NULL),
+  FIELD(10, "regulation", regulation, UINT, 0U, NULL, 0, 0, 'y', NULL),
+  FIELD(11, "fec", fec, UINT, 0U, NULL, 0, 1, 'y', NULL),
+  FIELD(12, "rx_phy_mode_ids", rx_phy_mode_ids, BYTES, 0U, NULL, 0, 0, 'a', NULL),
+  FIELD(13, "rx_phy_mode_ids_count", rx_phy_mode_ids_count, UINT, 0U, NULL,
+        0, WS_BR_AGENT_MAX_PHY_MODE_ID_COUNT, 'y', NULL),
+  FIELD(14, "lfn_profile", lfn_profile, UINT, 0U, NULL, 0, 0, 'y', NULL),
+  FIELD(15, "max_neighbor_count", max_neighbor_count, UINT, 0U, NULL, 0, 0, 'y', NULL),
+  FIELD(16, "max_child_count", max_child_count, UINT, 0U, NULL, 0, 0, 'y', NULL),
+  FIELD(17, "max_security_neighbor_count", max_security_neighbor_count, UINT, 0U, NULL, 0, 0, 'q', NULL),
+  FIELD(18, "keychain", keychain, ENUM, 0U, ws_br_agent_keychain_strs, 0, 0, 's', NULL),
+  FIELD(19, "keychain_index", keychain_index, UINT, 0U, NULL, 0, 0, 'y', NULL),
+  FIELD(20, "socket_rx_buffer_size", socket_rx_buffer_size, UINT, 0U, NULL, 0, 0, 'q', NULL),
+  FIELD(21, "phy_config", phy.type, ENUM, 0U, ws_br_agent_phy_config_strs,
+        WS_BR_AGENT_PHY_CONFIG_FAN10, WS_BR_AGENT_PHY_CONFIG_CUSTOM_OQPSK, 'u', NULL),
+  FIELD(0, "fan_version", phy.type, ENUM, 0U, ws_br_agent_fan_version_strs,
+        WS_BR_AGENT_PHY_CONFIG_FAN10, WS_BR_AGENT_PHY_CONFIG_FAN11, 'u', NULL),
+  // FAN1.0 and FAN1.1 share the regulatory domain offset
+  FIELD(22, "domain", phy.config.fan11.reg_domain, ENUM, PHY(FAN10) | PHY(FAN11),
+        ws_br_agent_domains_strs, 0, 0, 's', "WisunDomain"),
+  FIELD(23, "class", phy.config.fan10.op_class, UINT, PHY(FAN10), NULL, 1, 4, 'u', "WisunClass"),
+  FIELD(24, "mode", phy.config.fan10.op_mode, ENUM, PHY(FAN10), ws_br_agent_op_mode_strs,
+        0, 0, 'u', "WisunMode"),
+  FIELD(25, "fan10_fec", phy.config.fan10.fec, UINT, PHY(FAN10), NULL, 0, 1, 'y', NULL),
+  FIELD(26, "chan_plan_id", phy.config.fan11.chan_plan_id, UINT, PHY(FAN11), NULL,
+        0, 0, 'u', "WisunChanPlanId"),
+  FIELD(27, "phy_mode_id", phy.config.fan11.phy_mode_id, UINT, PHY(FAN11), NULL,
+        0, 0, 'u', "WisunPhyModeId"),
+  FIELD(28, "explicit_ch0_frequency_khz", phy.config.explicit_plan.ch0_frequency_khz, UINT,
+        PHY(EXPLICIT), NULL, 0, 0, 'u', NULL),
+  FIELD(29, "explicit_number_of_channels", phy.config.explicit_plan.number_of_channels, UINT,
+        PHY(EXPLICIT), NULL, 0, 0, 'q', NULL),
+  FIELD(30, "explicit_channel_spacing", phy.config.explicit_plan.channel_spacing, UINT,
+        PHY(EXPLICIT), NULL, 0, 0, 'y', NULL),
+  FIELD(31, "explicit_phy_mode_id", phy.config.explicit_plan.phy_mode_id, UINT,
+        PHY(EXPLICIT), NULL, 0, 0, 'y', NULL),
+  FIELD(32, "explicit_channel_mask", phy.config.explicit_plan.channel_mask, BYTES,
+        PHY(EXPLICIT), NULL, 0, 0, 'a', NULL),
+  FIELD(33, "ids_protocol_id", phy.config.ids.protocol_id, UINT, PHY(IDS), NULL, 0, 0, 'q', NULL),
+  FIELD(34, "ids_channel_id", phy.config.ids.channel_id, UINT, PHY(IDS), NULL, 0, 0, 'q', NULL),
+  FIELD(35, "ids_phy_mode_id", phy.config.ids.phy_mode_id, UINT, PHY(IDS), NULL, 0, 0, 'y', NULL),
+  FIELD(36, "custom_fsk_ch0_frequency_khz", phy.config.custom_fsk.ch0_frequency_khz, UINT,
+        PHY(CUSTOM_FSK), NULL, 0, 0, 'u', NULL),
+  FIELD(37, "custom_fsk_channel_spacing_khz", phy.config.custom_fsk.channel_spacing_khz, UINT,
+        PHY(CUSTOM_FSK), NULL, 0, 0, 'q', NULL),
+  FIELD(38, "custom_fsk_number_of_channels", phy.config.custom_fsk.number_of_channels, UINT,
+        PHY(CUSTOM_FSK), NULL, 0, 0, 'q', NULL),
+  FIELD(39, "custom_fsk_phy_mode_id", phy.config.custom_fsk.phy_mode_id, UINT,
+        PHY(CUSTOM_FSK), NULL, 0, 0, 'y', NULL),
+  FIELD(40, "custom_fsk_crc_type", phy.config.custom_fsk.crc_type, UINT,
+        PHY(CUSTOM_FSK), NULL, 0, 0, 'y', NULL),
+  FIELD(41, "custom_fsk_preamble_length", phy.config.custom_fsk.preamble_length, UINT,
+        PHY(CUSTOM_FSK), NULL, 0, 0, 'y', NULL),
+  FIELD(42, "custom_ofdm_ch0_frequency_khz", phy.config.custom_ofdm.ch0_frequency_khz, UINT,
+        PHY(CUSTOM_OFDM), NULL, 0, 0, 'u', NULL),
+  FIELD(43, "custom_ofdm_channel_spacing_khz", phy.config.custom_ofdm.channel_spacing_khz, UINT,
+        PHY(CUSTOM_OFDM), NULL, 0, 0, 'q', NULL),
+  FIELD(44, "custom_ofdm_number_of_channels", phy.config.custom_ofdm.number_of_channels, UINT,
+        PHY(CUSTOM_OFDM), NULL, 0, 0, 'q', NULL),
+  FIELD(45, "custom_ofdm_phy_mode_id", phy.config.custom_ofdm.phy_mode_id, UINT,
+        PHY(CUSTOM_OFDM), NULL, 0, 0, 'y', NULL),
+  FIELD(46, "custom_ofdm_crc_type", phy.config.custom_ofdm.crc_type, UINT,
+        PHY(CUSTOM_OFDM), NULL, 0, 0, 'y', NULL),
+  FIELD(47, "custom_ofdm_stf_length", phy.config.custom_ofdm.stf_length, UINT,
+        PHY(CUSTOM_OFDM), NULL, 0, 0, 'y', NULL),
+  FIELD(48, "custom_oqpsk_ch0_frequency_khz", phy.config.custom_oqpsk.ch0_frequency_khz, UINT,
+        PHY(CUSTOM_OQPSK), NULL, 0, 0, 'u', NULL),
+  FIELD(49, "custom_oqpsk_channel_spacing_khz", phy.config.custom_oqpsk.channel_spacing_khz, UINT,
+        PHY(CUSTOM_OQPSK), NULL, 0, 0, 'q', NULL),
+  FIELD(50, "custom_oqpsk_number_of_channels", phy.config.custom_oqpsk.number_of_channels, UINT,
+        PHY(CUSTOM_OQPSK), NULL, 0, 0, 'q', NULL),
+  FIELD(51, "custom_oqpsk_phy_mode_id", phy.config.custom_oqpsk.phy_mode_id, UINT,
+        PHY(CUSTOM_OQPSK), NULL, 0, 0, 'y', NULL),
+  FIELD(52, "custom_oqpsk_crc_type", phy.config.custom_oqpsk.crc_type, UINT,
+        PHY(CUSTOM_OQPSK), NULL, 0, 0, 'y', NULL),
+  FIELD(53, "custom_oqpsk_preamble_length", phy.config.custom_oqpsk.preamble_length, UINT,
+        PHY(CUSTOM_OQPSK), NULL, 0, 0, 'y', NULL),
+  FIELD(54, "is_default_phy", is_default_phy, BOOL, 0U, NULL, 0, 0, 'b', NULL),
+  FIELD(55, "pan_id", pan_id, UINT, 0U, NULL, 0, 0, 'q', "WisunPanId"),
+};
+
+#define SETTINGS_FIELD_COUNT (sizeof(settings_fields) / sizeof(settings_fields[0]))
+
+_Static_assert(SETTINGS_FIELD_COUNT <= WS_BR_AGENT_SETTINGS_FIELD_MAX, "too many settings fields");
+_Static_assert(2U * WS_BR_AGENT_SETTINGS_FIELD_MAX <= SETTINGS_HASH_SIZE, "settings hash table too small");
+
+/// Open addressing hash tables of field indexes + 1 (0: empty slot), by key and by D-Bus name
+static uint8_t key_hash[SETTINGS_HASH_SIZE] = { 0U };
+static uint8_t dbus_hash[SETTINGS_HASH_SIZE] = { 0U };
+/// Field indexes + 1 by TLV tag (0: unknown tag)
+static uint8_t tag_index[SETTINGS_TAG_TABLE_SIZE] = { 0U };
+static pthread_once_t hash_once = PTHREAD_ONCE_INIT;
+
 static int parse_escape_sequences(char *out, const char *in, size_t max_len);
-static ws_br_agent_ret_t parse_config_line(const char *line, ws_br_agent_settings_t *settings);
+
+/// FNV-1a hash
+static inline uint32_t settings_hash(const char *str, size_t len)
+{
+  uint32_t hash = 2166136261U;
+
+  for (size_t i = 0U; i < len; ++i) {
+    hash = (hash ^ (uint8_t)str[i]) * 16777619U;
+  }
+  return hash;
+}
+
+static void settings_hash_insert(uint8_t table[SETTINGS_HASH_SIZE], const char *name, size_t index)
+{
+  uint32_t slot = settings_hash(name, strlen(name)) & (SETTINGS_HASH_SIZE - 1U);
+
+  while (table[slot]) {
+    slot = (slot + 1U) & (SETTINGS_HASH_SIZE - 1U);
+  }
+  table[slot] = (uint8_t)(index + 1U);
+}
+
+static void settings_hash_init(void)
+{
+  for (size_t i = 0U; i < SETTINGS_FIELD_COUNT; ++i) {
+    settings_hash_insert(key_hash, settings_fields[i].key, i);
+    if (settings_fields[i].dbus_name != NULL) {
+      settings_hash_insert(dbus_hash, settings_fields[i].dbus_name, i);
+    }
+    if (settings_fields[i].tag && settings_fields[i].tag < SETTINGS_TAG_TABLE_SIZE) {
+      tag_index[settings_fields[i].tag] = (uint8_t)(i + 1U);
+    }
+  }
+}
+
+static const ws_br_agent_settings_field_t *settings_hash_find(const uint8_t table[SETTINGS_HASH_SIZE],
+                                                              bool by_key, const char *name,
+                                                              size_t len)
+{
+  const ws_br_agent_settings_field_t *field = NULL;
+  const char *field_name = NULL;
+  uint32_t slot = 0U;
+
+  (void) pthread_once(&hash_once, settings_hash_init);
+  slot = settings_hash(name, len) & (SETTINGS_HASH_SIZE - 1U);
+  while (table[slot]) {
+    field = &settings_fields[table[slot] - 1U];
+    field_name = by_key ? field->key : field->dbus_name;
+    if (!strncmp(field_name, name, len) && field_name[len] == '\0') {
+      return field;
+    }
+    slot = (slot + 1U) & (SETTINGS_HASH_SIZE - 1U);
+  }
+  return NULL;
+}
+
+const ws_br_agent_settings_field_t *ws_br_agent_settings_fields(size_t * const count)
+{
+  if (count != NULL) {
+    *count = SETTINGS_FIELD_COUNT;
+  }
+  return settings_fields;
+}
+
+const ws_br_agent_settings_field_t *ws_br_agent_settings_find_field(const char *key, size_t key_len)
+{
+  if (key == NULL) {
+    return NULL;
+  }
+  return settings_hash_find(key_hash, true, key, key_len);
+}
+
+const ws_br_agent_settings_field_t *ws_br_agent_settings_find_dbus_field(const char *name)
+{
+  if (name == NULL) {
+    return NULL;
+  }
+  return settings_hash_find(dbus_hash, false, name, strlen(name));
+}
+
+bool ws_br_agent_settings_field_applies(const ws_br_agent_settings_field_t * const field,
+                                        const ws_br_agent_settings_t * const settings)
+{
+  uint32_t phy_type = 0U;
+
+  if (!field->phy_types) {
+    return true;
+  }
+  memcpy(&phy_type, &settings->phy.type, sizeof(phy_type));
+  return phy_type < 8U && (field->phy_types & WS_BR_AGENT_SETTINGS_PHY(phy_type));
+}
+
+/// Integer range of a field
+static void field_range(const ws_br_agent_settings_field_t * const field,
+                        int64_t * const min, int64_t * const max)
+{
+  if (field->min || field->max) {
+    *min = field->min;
+    *max = field->max;
+  } else if (field->type == WS_BR_AGENT_SETTINGS_FIELD_BOOL) {
+    *min = 0;
+    *max = 1;
+  } else if (field->type == WS_BR_AGENT_SETTINGS_FIELD_INT) {
+    *max = (int64_t)((1ULL << (8U * field->size - 1U)) - 1U);
+    *min = -*max - 1;
+  } else {
+    *min = 0;
+    *max = (int64_t)((1ULL << (8U * field->size)) - 1U);
+  }
+}
+
+static inline bool field_is_int(const ws_br_agent_settings_field_t * const field)
+{
+  return field->type != WS_BR_AGENT_SETTINGS_FIELD_STR
+         && field->type != WS_BR_AGENT_SETTINGS_FIELD_BYTES
+         && (field->size == 1U || field->size == 2U || field->size == 4U);
+}
+
+ws_br_agent_ret_t ws_br_agent_settings_get_int(const ws_br_agent_settings_field_t * const field,
+                                               const ws_br_agent_settings_t * const settings,
+                                               int64_t * const value)
+{
+  const uint8_t *ptr = (const uint8_t *)settings + field->offset;
+  bool is_signed = field->type == WS_BR_AGENT_SETTINGS_FIELD_INT;
+  uint16_t u16 = 0U;
+  uint32_t u32 = 0U;
+
+  if (!field_is_int(field)) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Settings are packed: fields are copied out rather than dereferenced
+  switch (field->size) {
+    case 1U:
+      *value = is_signed ? (int64_t)(int8_t)*ptr : (int64_t)*ptr;
+      break;
+    case 2U:
+      memcpy(&u16, ptr, sizeof(u16));
+      *value = is_signed ? (int64_t)(int16_t)u16 : (int64_t)u16;
+      break;
+    default:
+      memcpy(&u32, ptr, sizeof(u32));
+      *value = is_signed ? (int64_t)(int32_t)u32 : (int64_t)u32;
+      break;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+ws_br_agent_ret_t ws_br_agent_settings_set_int(const ws_br_agent_settings_field_t * const field,
+                                               ws_br_agent_settings_t * const settings,
+                                               int64_t value)
+{
+  uint8_t *ptr = (uint8_t *)settings + field->offset;
+  int64_t min = 0;
+  int64_t max = 0;
+  uint16_t u16 = (uint16_t)value;
+  uint32_t u32 = (uint32_t)value;
+
+  if (!field_is_int(field)) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  field_range(field, &min, &max);
+  if (value < min || value > max) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  switch (field->size) {
+    case 1U:
+      *ptr = (uint8_t)value;
+      break;
+    case 2U:
+      memcpy(ptr, &u16, sizeof(u16));
+      break;
+    default:
+      memcpy(ptr, &u32, sizeof(u32));
+      break;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+static ws_br_agent_ret_t parse_int(const char *str, int64_t * const value)
+{
+  char *end = NULL;
+
+  errno = 0;
+  *value = strtoll(str, &end, 0);
+  if (end == str || *end != '\0' || errno) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+static ws_br_agent_ret_t parse_bool(const char *str, int64_t * const value)
+{
+  if (!strcasecmp(str, "true") || !strcasecmp(str, "yes") || !strcmp(str, "1")) {
+    *value = 1;
+  } else if (!strcasecmp(str, "false") || !strcasecmp(str, "no") || !strcmp(str, "0")) {
+    *value = 0;
+  } else {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+static inline int hex_digit(char c)
+{
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+static ws_br_agent_ret_t parse_hex(uint8_t *out, size_t size, const char *str)
+{
+  size_t len = strlen(str);
+  int hi = 0;
+  int lo = 0;
+
+  if (len % 2U || len / 2U > size) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  for (size_t i = 0U; i < len / 2U; ++i) {
+    hi = hex_digit(str[2U * i]);
+    lo = hex_digit(str[2U * i + 1U]);
+    if (hi < 0 || lo < 0) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+    out[i] = (uint8_t)((hi << 4) | lo);
+  }
+  memset(out + len / 2U, 0, size - len / 2U);
+  return WS_BR_AGENT_RET_OK;
+}
+
+ws_br_agent_ret_t ws_br_agent_settings_set_str(const ws_br_agent_settings_field_t * const field,
+                                               ws_br_agent_settings_t * const settings,
+                                               const char *value)
+{
+  uint8_t buf[WS_BR_AGENT_SETTINGS_LINE_MAX_SIZE];
+  int64_t num = 0;
+  int tmp_val = 0;
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_ERR;
+
+  if (field == NULL || settings == NULL || value == NULL || field->size > sizeof(buf)) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  switch (field->type) {
+    case WS_BR_AGENT_SETTINGS_FIELD_STR:
+      if (parse_escape_sequences((char *)buf, value, field->size)) {
+        return WS_BR_AGENT_RET_ERR;
+      }
+      memset((uint8_t *)settings + field->offset, 0, field->size);
+      memcpy((uint8_t *)settings + field->offset, buf, strlen((const char *)buf));
+      return WS_BR_AGENT_RET_OK;
+
+    case WS_BR_AGENT_SETTINGS_FIELD_BYTES:
+      if (parse_hex(buf, field->size, value) != WS_BR_AGENT_RET_OK) {
+        return WS_BR_AGENT_RET_ERR;
+      }
+      memcpy((uint8_t *)settings + field->offset, buf, field->size);
+      return WS_BR_AGENT_RET_OK;
+
+    case WS_BR_AGENT_SETTINGS_FIELD_BOOL:
+      ret = parse_bool(value, &num);
+      break;
+
+    case WS_BR_AGENT_SETTINGS_FIELD_ENUM:
+      if (ws_br_agent_utils_str_to_val(value, field->table, &tmp_val) == WS_BR_AGENT_RET_OK) {
+        num = tmp_val;
+        ret = WS_BR_AGENT_RET_OK;
+      } else {
+        ret = parse_int(value, &num);
+      }
+      break;
+
+    default:
+      ret = parse_int(value, &num);
+      break;
+  }
+  if (ret != WS_BR_AGENT_RET_OK) {
+    return ret;
+  }
+
+  return ws_br_agent_settings_set_int(field, settings, num);
+}
+
+/// Name of an enumeration value (NULL if not in the table)
+static const char *enum_name(const ws_br_agent_name_value_t *table, int64_t value)
+{
+  for (size_t i = 0U; table[i].name != NULL; ++i) {
+    if (table[i].val == value) {
+      return table[i].name;
+    }
+  }
+  return NULL;
+}
+
+const char *ws_br_agent_settings_format(const ws_br_agent_settings_field_t * const field,
+                                        const ws_br_agent_settings_t * const settings,
+                                        char * const buf, size_t size)
+{
+  const uint8_t *ptr = (const uint8_t *)settings + field->offset;
+  const char *name = NULL;
+  int64_t value = 0;
+  size_t len = 0U;
+
+  if (!size) {
+    return buf;
+  }
+  buf[0] = '\0';
+
+  switch (field->type) {
+    case WS_BR_AGENT_SETTINGS_FIELD_STR:
+      snprintf(buf, size, "%.*s", (int)strnlen((const char *)ptr, field->size), (const char *)ptr);
+      break;
+
+    case WS_BR_AGENT_SETTINGS_FIELD_BYTES:
+      for (size_t i = 0U; i < field->size && len + 3U <= size; ++i) {
+        len += (size_t)snprintf(buf + len, size - len, "%02x", ptr[i]);
+      }
+      break;
+
+    default:
+      (void) ws_br_agent_settings_get_int(field, settings, &value);
+      if (field->type == WS_BR_AGENT_SETTINGS_FIELD_BOOL) {
+        snprintf(buf, size, "%s", value ? "true" : "false");
+      } else if (field->type == WS_BR_AGENT_SETTINGS_FIELD_ENUM
+                 && (name = enum_name(field->table, value)) != NULL) {
+        snprintf(buf, size, "%s", name);
+      } else {
+        snprintf(buf, size, "%lld", (long long)value);
+      }
+      break;
+  }
+  return buf;
+}
+
+bool ws_br_agent_settings_tlv_detect(const uint8_t * const buf, size_t len)
+{
+  return buf != NULL && len >= WS_BR_AGENT_SETTINGS_TLV_HDR_SIZE
+         && ws_br_agent_get_be32(buf) == WS_BR_AGENT_SETTINGS_TLV_MAGIC;
+}
+
+/// Encode a TLV value: integers big endian in the field size, strings without their NUL
+static uint16_t tlv_encode_value(const ws_br_agent_settings_field_t * const field,
+                                 const ws_br_agent_settings_t * const settings, uint8_t *out)
+{
+  const uint8_t *ptr = (const uint8_t *)settings + field->offset;
+  int64_t value = 0;
+  size_t len = 0U;
+
+  switch (field->type) {
+    case WS_BR_AGENT_SETTINGS_FIELD_STR:
+      len = strnlen((const char *)ptr, field->size - 1U);
+      memcpy(out, ptr, len);
+      return (uint16_t)len;
+
+    case WS_BR_AGENT_SETTINGS_FIELD_BYTES:
+      memcpy(out, ptr, field->size);
+      return field->size;
+
+    default:
+      (void) ws_br_agent_settings_get_int(field, settings, &value);
+      for (size_t i = 0U; i < field->size; ++i) {
+        out[i] = (uint8_t)((uint64_t)value >> (8U * (field->size - 1U - i)));
+      }
+      return field->size;
+  }
+}
+
+/// Decode a TLV value, integers of any width up to 8 bytes are range checked against the field
+static ws_br_agent_ret_t tlv_decode_value(const ws_br_agent_settings_field_t * const field,
+                                          const uint8_t *val, uint16_t len,
+                                          ws_br_agent_settings_t * const settings)
+{
+  uint8_t *ptr = (uint8_t *)settings + field->offset;
+  uint64_t value = 0U;
+
+  switch (field->type) {
+    case WS_BR_AGENT_SETTINGS_FIELD_STR:
+      if (len >= field->size || memchr(val, '\0', len) != NULL) {
+        return WS_BR_AGENT_RET_ERR;
+      }
+      memset(ptr, 0, field->size);
+      memcpy(ptr, val, len);
+      return WS_BR_AGENT_RET_OK;
+
+    case WS_BR_AGENT_SETTINGS_FIELD_BYTES:
+      if (len > field->size) {
+        return WS_BR_AGENT_RET_ERR;
+      }
+      memset(ptr, 0, field->size);
+      memcpy(ptr, val, len);
+      return WS_BR_AGENT_RET_OK;
+
+    default:
+      if (!len || len > sizeof(value)) {
+        return WS_BR_AGENT_RET_ERR;
+      }
+      for (uint16_t i = 0U; i < len; ++i) {
+        value = (value << 8) | val[i];
+      }
+      // Sign extension of the narrower signed values
+      if (field->type == WS_BR_AGENT_SETTINGS_FIELD_INT && len < sizeof(value)
+          && (val[0] & 0x80U)) {
+        value |= ~0ULL << (8U * len);
+      }
+      return ws_br_agent_settings_set_int(field, settings, (int64_t)value);
+  }
+}
+
+ws_br_agent_ret_t ws_br_agent_settings_tlv_encode(const ws_br_agent_settings_t * const settings,
+                                                  const ws_br_agent_settings_field_t * const fields[],
+                                                  size_t count, uint8_t * const buf, size_t size,
+                                                  size_t * const len)
+{
+  const ws_br_agent_settings_field_t *field = NULL;
+  size_t pos = WS_BR_AGENT_SETTINGS_TLV_HDR_SIZE;
+  uint16_t encoded = 0U;
+  uint16_t value_len = 0U;
+
+  if (settings == NULL || buf == NULL || len == NULL || size < WS_BR_AGENT_SETTINGS_TLV_HDR_SIZE) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  if (fields == NULL) {
+    count = SETTINGS_FIELD_COUNT;
+  }
+
+  for (size_t i = 0U; i < count; ++i) {
+    field = fields != NULL ? fields[i] : &settings_fields[i];
+    if (!field->tag || (fields == NULL && !ws_br_agent_settings_field_applies(field, settings))) {
+      continue;
+    }
+    if (pos + WS_BR_AGENT_SETTINGS_TLV_FIELD_HDR_SIZE + field->size > size) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+    value_len = tlv_encode_value(field, settings, buf + pos + WS_BR_AGENT_SETTINGS_TLV_FIELD_HDR_SIZE);
+    ws_br_agent_put_be16(buf + pos, field->tag);
+    ws_br_agent_put_be16(buf + pos + 2U, value_len);
+    pos += WS_BR_AGENT_SETTINGS_TLV_FIELD_HDR_SIZE + value_len;
+    ++encoded;
+  }
+
+  ws_br_agent_put_be32(buf, WS_BR_AGENT_SETTINGS_TLV_MAGIC);
+  buf[4] = WS_BR_AGENT_SETTINGS_TLV_VERSION;
+  buf[5] = 0U;
+  ws_br_agent_put_be16(buf + 6U, encoded);
+  *len = pos;
+  return WS_BR_AGENT_RET_OK;
+}
+
+ws_br_agent_ret_t ws_br_agent_settings_tlv_decode(const uint8_t * const buf, size_t len,
+                                                  ws_br_agent_settings_t * const settings,
+                                                  size_t * const field_count)
+{
+  ws_br_agent_settings_t new_settings;
+  const ws_br_agent_settings_field_t *field = NULL;
+  size_t pos = WS_BR_AGENT_SETTINGS_TLV_HDR_SIZE;
+  size_t applied = 0U;
+  uint16_t count = 0U;
+  uint16_t tag = 0U;
+  uint16_t value_len = 0U;
+
+  if (settings == NULL || !ws_br_agent_settings_tlv_detect(buf, len)) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  if (buf[4] != WS_BR_AGENT_SETTINGS_TLV_VERSION) {
+    ws_br_agent_log_warn("Unsupported TLV settings version: %u\n", buf[4]);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  (void) pthread_once(&hash_once, settings_hash_init);
+  memcpy(&new_settings, settings, sizeof(ws_br_agent_settings_t));
+  count = ws_br_agent_get_be16(buf + 6U);
+  for (uint16_t i = 0U; i < count; ++i) {
+    if (len - pos < WS_BR_AGENT_SETTINGS_TLV_FIELD_HDR_SIZE) {
+      ws_br_agent_log_warn("Truncated TLV settings (%u/%u fields)\n", i, count);
+      return WS_BR_AGENT_RET_ERR;
+    }
+    tag = ws_br_agent_get_be16(buf + pos);
+    value_len = ws_br_agent_get_be16(buf + pos + 2U);
+    pos += WS_BR_AGENT_SETTINGS_TLV_FIELD_HDR_SIZE;
+    if (len - pos < value_len) {
+      ws_br_agent_log_warn("Truncated TLV settings (%u/%u fields)\n", i, count);
+      return WS_BR_AGENT_RET_ERR;
+    }
+
+    field = tag < SETTINGS_TAG_TABLE_SIZE && tag_index[tag] ? &settings_fields[tag_index[tag] - 1U] : NULL;
+    if (field == NULL) {
+      ws_br_agent_log_debug("Unknown TLV settings tag %u skipped\n", tag);
+    } else if (tlv_decode_value(field, buf + pos, value_len, &new_settings) != WS_BR_AGENT_RET_OK) {
+      ws_br_agent_log_warn("Invalid TLV %s (%u bytes)\n", field->key, value_len);
+      return WS_BR_AGENT_RET_ERR;
+    } else {
+      ++applied;
+    }
+    pos += value_len;
+  }
+  if (pos != len) {
+    ws_br_agent_log_warn("Trailing bytes after TLV settings: %zu\n", len - pos);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  memcpy(settings, &new_settings, sizeof(ws_br_agent_settings_t));
+  if (field_count != NULL) {
+    *field_count = applied;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
 
 ws_br_agent_ret_t ws_br_agent_settings_load_config(const char * conf_file, 
-                                                   ws_br_agent_settings_t *settings)
+                                                   ws_br_agent_settings_t *settings,
+                                                   size_t * const invalid_lines)
 {
   FILE *file = NULL;
-  char line[512];
+  char line[WS_BR_AGENT_SETTINGS_LINE_MAX_SIZE];
   int line_number = 0;
+  size_t invalid_count = 0U;
 
   if (conf_file == NULL || settings == NULL) {
     return WS_BR_AGENT_RET_ERR;
@@ -62,8 +703,9 @@ ws_br_agent_ret_t ws_br_agent_settings_load_config(const char * conf_file,
   while (fgets(line, sizeof(line), file) != NULL) {
     line_number++;
 
-    if (parse_config_line(line, settings) != WS_BR_AGENT_RET_OK) {
+    if (ws_br_agent_settings_parse_line(line, settings) != WS_BR_AGENT_RET_OK) {
       ws_br_agent_log_warn("Failed to parse line %d: %s\n", line_number, line);
+      invalid_count++;
     }
   }
   
@@ -75,6 +717,9 @@ ws_br_agent_ret_t ws_br_agent_settings_load_config(const char * conf_file,
   }
   
   fclose(file);
+  if (invalid_lines != NULL) {
+    *invalid_lines = invalid_count;
+  }
 
   ws_br_agent_log_info("Configuration loaded successfully (%d lines processed)\n", line_number);
   return WS_BR_AGENT_RET_OK;
@@ -83,7 +728,7 @@ ws_br_agent_ret_t ws_br_agent_settings_load_config(const char * conf_file,
 static int parse_escape_sequences(char *out, const char *in, size_t max_len)
 {
   char tmp[3], conv, *end_ptr;
-  int i, j;
+  size_t i, j;
 
   if (!max_len) {
     return -EINVAL;
@@ -117,190 +762,73 @@ static int parse_escape_sequences(char *out, const char *in, size_t max_len)
   return 0;
 }
 
-static ws_br_agent_ret_t parse_config_line(const char *line, ws_br_agent_settings_t *settings)
+ws_br_agent_ret_t ws_br_agent_settings_parse_line(const char *line, ws_br_agent_settings_t *settings)
 {
-  char key[256], value[256];
-  char *trimmed_line;
-  char *comment_pos;
-  int tmp_val;
-  extern const char *soc_host_addr;
+  char buf[WS_BR_AGENT_SETTINGS_LINE_MAX_SIZE];
+  const ws_br_agent_settings_field_t *field = NULL;
+  char *key = NULL;
+  char *key_end = NULL;
+  char *value = NULL;
 
   if (line == NULL || settings == NULL) {
     return WS_BR_AGENT_RET_ERR;
   }
-  
-  // Create a mutable copy of the line
-  trimmed_line = strdup(line);
-  if (trimmed_line == NULL) {
-    return WS_BR_AGENT_RET_ERR;
-  }
-  
-  // Remove trailing newline and carriage return
-  size_t len = strlen(trimmed_line);
-  while (len > 0 && (trimmed_line[len-1] == '\n' || trimmed_line[len-1] == '\r')) {
-    trimmed_line[--len] = '\0';
-  }
-  
-  // Skip empty lines and comments
-  if (len == 0 || trimmed_line[0] == '#' || trimmed_line[0] == ';') {
-    free(trimmed_line);
+
+  // Mutable copy of the line, tokenized in place
+  strncpy(buf, line, sizeof(buf) - 1U);
+  buf[sizeof(buf) - 1U] = '\0';
+
+  // Remove comments
+  buf[strcspn(buf, "#;")] = '\0';
+
+  // Split "key = value", skip blank and malformed lines
+  key = buf + strspn(buf, " \t");
+  key_end = strchr(key, '=');
+  if (key_end == NULL || key_end == key) {
     return WS_BR_AGENT_RET_OK;
   }
-  
-  // Remove inline comments
-  comment_pos = strchr(trimmed_line, '#');
-  if (comment_pos != NULL) {
-    *comment_pos = '\0';
-  }
-  comment_pos = strchr(trimmed_line, ';');
-  if (comment_pos != NULL) {
-    *comment_pos = '\0';
-  }
-  
-  // Parse key=value pair
-  if (sscanf(trimmed_line, "%255[^=]=%255s", key, value) != 2) {
-    free(trimmed_line);
-    return WS_BR_AGENT_RET_OK; // Skip malformed lines
+  value = key_end + 1;
+  while (key_end > key && (key_end[-1] == ' ' || key_end[-1] == '\t')) {
+    key_end--;
   }
-  
-  // Trim whitespace from key
-  char *key_start = key;
-  while (*key_start == ' ' || *key_start == '\t') key_start++;
-  char *key_end = key_start + strlen(key_start) - 1;
-  while (key_end > key_start && (*key_end == ' ' || *key_end == '\t')) {
-    *key_end-- = '\0';
+  value += strspn(value, " \t");
+  value[strcspn(value, " \t\r\n")] = '\0';
+  if (*value == '\0') {
+    return WS_BR_AGENT_RET_OK;
   }
-  
-  // Parse configuration values
-  if (strcmp(key_start, "soc_wifi_address") == 0) {
+
+  // The SoC address is not part of the settings sent to the SoC
+  if ((size_t)(key_end - key) == sizeof("soc_wifi_address") - 1U
+      && !strncmp(key, "soc_wifi_address", sizeof("soc_wifi_address") - 1U)) {
     if (soc_host_addr == NULL) {
       soc_host_addr = strdup(value);
       ws_br_agent_log_debug("Configure SoC IPv6 Wi-Fi address: %s\n", soc_host_addr);
     }
-  } else if (strcmp(key_start, "network_name") == 0) {
-    if (parse_escape_sequences(settings->network_name, value, 
-                           WS_BR_AGENT_NETWORK_NAME_SIZE + 1) == 0) {
-      ws_br_agent_log_debug("Configure network name: %s\n", settings->network_name);
-    } else {
-      ws_br_agent_log_warn("Invalid network name");
-    }
-
-  } else if (strcmp(key_start, "size") == 0) {
-    if (ws_br_agent_utils_str_to_val(value, ws_br_agent_nw_size_strs, 
-                                     &tmp_val) == WS_BR_AGENT_RET_OK) {
-      settings->network_size = (uint8_t)tmp_val;
-      ws_br_agent_log_debug("Configure network size: %s (%u)\n", value, settings->network_size);
-    } else {
-      ws_br_agent_log_warn("Unknown network size: %s\n", value);
-    }
-
-  } else if (strcmp(key_start, "tx_power_ddbm") == 0) {
-    settings->tx_power_ddbm = (int16_t)strtol(value, NULL, 0);
-    ws_br_agent_log_debug("Configure tx power (ddBm): %d\n", settings->tx_power_ddbm);
-
-  } else if (strcmp(key_start, "uc_dwell_interval_ms") == 0) {
-    settings->uc_dwell_interval_ms = (uint8_t)strtol(value, NULL, 0);
-    ws_br_agent_log_debug("Configure uc dwell interval (ms): %u\n", settings->uc_dwell_interval_ms);
-
-  } else if (strcmp(key_start, "bc_interval_ms") == 0) {
-    settings->bc_interval_ms = (uint32_t)strtol(value, NULL, 0);
-    ws_br_agent_log_debug("Configure bc interval (ms): %u\n", settings->bc_interval_ms);
-
-  } else if (strcmp(key_start, "bc_dwell_interval_ms") == 0) {
-    settings->bc_dwell_interval_ms = (uint8_t)strtol(value, NULL, 0);
-    ws_br_agent_log_debug("Configure bc dwell interval (ms): %u\n", settings->bc_dwell_interval_ms);
-
-  } else if (strcmp(key_start, "allowed_channels") == 0) {
-    if (parse_escape_sequences(settings->allowed_channels, value, 
-                           WS_BR_AGENT_SETTINGS_STR_DATA_MAX_LENGTH + 1) == 0) {
-      ws_br_agent_log_debug("Configure allowed channels: %s\n", settings->allowed_channels);
-    } else {
-      ws_br_agent_log_warn("Invalid allowed channels string");
-    }
-
-  } else if (strcmp(key_start, "ipv6_prefix") == 0) {
-    strncpy(settings->ipv6_prefix, value, WS_BR_AGENT_IPV6_PREFIX_SIZE);
-    settings->ipv6_prefix[WS_BR_AGENT_IPV6_PREFIX_SIZE - 1] = '\0';
-    ws_br_agent_log_debug("Configure IPv6 prefix: %s\n", settings->ipv6_prefix);
-    
-  } else if (strcmp(key_start, "max_neighbor_count") == 0) {
-    settings->max_neighbor_count = (uint8_t)strtol(value, NULL, 0);
-    ws_br_agent_log_debug("Configure max neighbor count: %u\n", settings->max_neighbor_count);
-
-  } else if (strcmp(key_start, "max_child_count") == 0) {
-    settings->max_child_count = (uint8_t)strtol(value, NULL, 0);
-    ws_br_agent_log_debug("Configure max child count: %u\n", settings->max_child_count);
-
-  } else if (strcmp(key_start, "max_security_neighbor_count") == 0) {
-    settings->max_security_neighbor_count = (uint16_t)strtol(value, NULL, 0);
-    ws_br_agent_log_debug("Configure max security neighbor count: %u\n", settings->max_security_neighbor_count);
-
-  } else if (strcmp(key_start, "keychain") == 0) {
-    if (ws_br_agent_utils_str_to_val(value, ws_br_agent_keychain_strs, 
-                                     &tmp_val) == WS_BR_AGENT_RET_OK) {
-      settings->keychain = (uint8_t)tmp_val;
-      ws_br_agent_log_debug("Configure keychain: %s (%u)\n", value, settings->keychain);
-    } else {
-      ws_br_agent_log_warn("Unknown keychain: %s\n", value);
-    }
+    return WS_BR_AGENT_RET_OK;
+  }
 
-  } else if (strcmp(key_start, "keychain_index") == 0) {
-    settings->keychain_index = (uint8_t)strtol(value, NULL, 0);
-    ws_br_agent_log_debug("Configure keychain index: %u\n", settings->keychain_index);
-
-  } else if (strcmp(key_start, "socket_rx_buffer_size") == 0) {
-    settings->socket_rx_buffer_size = (uint16_t)strtol(value, NULL, 0);
-    ws_br_agent_log_debug("Configure socket RX buffer size: %u\n", settings->socket_rx_buffer_size);
-
-  } else if (strcmp(key_start, "domain") == 0) {
-    // Only FAN 1.1 supported currently
-    if (settings->phy.type == WS_BR_AGENT_PHY_CONFIG_FAN11 && 
-        ws_br_agent_utils_str_to_val(value, ws_br_agent_domains_strs, 
-                                     &tmp_val) == WS_BR_AGENT_RET_OK) {
-      settings->phy.config.fan11.reg_domain = (uint8_t)tmp_val;
-      ws_br_agent_log_debug("Configure regulatory domain: %s (%u)\n", value, settings->phy.config.fan11.reg_domain);
-    }
-  
-  } else if (strcmp(key_start, "chan_plan_id") == 0) {
-    if (settings->phy.type == WS_BR_AGENT_PHY_CONFIG_FAN11) {
-      settings->phy.config.fan11.chan_plan_id = (uint8_t)strtol(value, NULL, 0);
-      ws_br_agent_log_debug("Configure channel plan ID: %u\n", settings->phy.config.fan11.chan_plan_id);
-    }
-  
-  } else if (strcmp(key_start, "phy_mode_id") == 0) {
-    if (settings->phy.type == WS_BR_AGENT_PHY_CONFIG_FAN11) {
-      settings->phy.config.fan11.phy_mode_id = (uint8_t)strtol(value, NULL, 0);
-      ws_br_agent_log_debug("Configure PHY mode ID: %u\n", settings->phy.config.fan11.phy_mode_id);
-    }
-  
-  } else if (strcmp(key_start, "fan_version") == 0) {
-    if (strcmp(value, "1.0") == 0) {
-      settings->phy.type = WS_BR_AGENT_PHY_CONFIG_FAN10;
-      ws_br_agent_log_debug("Configure PHY config type: FAN 1.0\n");
-    } else if (strcmp(value, "1.1") == 0) {
-      settings->phy.type = WS_BR_AGENT_PHY_CONFIG_FAN11;
-      ws_br_agent_log_debug("Configure PHY config type: FAN 1.1\n");
-    } else {
-      ws_br_agent_log_warn("Unknown or not supported FAN version: %s\n", value);
-    }
-  } else if (strcmp(key_start, "class") == 0) {
-    if (settings->phy.type == WS_BR_AGENT_PHY_CONFIG_FAN10) {
-      settings->phy.config.fan10.op_class = (uint8_t)strtol(value, NULL, 0);
-      ws_br_agent_log_debug("Configure Operating Class: %u\n", settings->phy.config.fan10.op_class);
-    }
-  } else if (strcmp(key_start, "mode") == 0) {
-    if (settings->phy.type == WS_BR_AGENT_PHY_CONFIG_FAN10) {
-      settings->phy.config.fan10.op_mode = (uint8_t)strtol(value, NULL, 0);
-      ws_br_agent_log_debug("Configure Operating Mode: %u\n", settings->phy.config.fan10.op_mode);
-    }
-  } else if (strcmp(key_start, "pan_id") == 0) {
-    settings->pan_id = (uint16_t)strtol(value, NULL, 0);
-    ws_br_agent_log_debug("Configure PAN ID: %u\n", settings->pan_id);
+  field = ws_br_agent_settings_find_field(key, (size_t)(key_end - key));
+  if (field == NULL) {
+    *key_end = '\0';
+    ws_br_agent_log_warn("Unknown config parameter: %s\n", key);
+    return WS_BR_AGENT_RET_OK;
+  }
+  if (!ws_br_agent_settings_field_applies(field, settings)) {
+    ws_br_agent_log_debug("Ignore %s, not used by the PHY configuration type\n", field->key);
+    return WS_BR_AGENT_RET_OK;
+  }
+  if (ws_br_agent_settings_set_str(field, settings, value) != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_warn("Invalid %s: %s\n", field->key, value);
+    return WS_BR_AGENT_RET_ERR;
+  }
+#if WS_BR_AGENT_LOG_ENABLE_DEBUG
+  {
+    char text[WS_BR_AGENT_SETTINGS_FIELD_TEXT_MAX_SIZE];
 
-  } else {
-    ws_br_agent_log_warn("Unknown config parameter: %s\n", key_start);
+    ws_br_agent_log_debug("Configure %s: %s\n", field->key,
+                          ws_br_agent_settings_format(field, settings, text, sizeof(text)));
   }
-  
-  free(trimmed_line);
+#endif
+
   return WS_BR_AGENT_RET_OK;
-}
\ No newline at end of file
+}
@@ -37,18 +37,71 @@
 #include <pthread.h>
 #include <stdio.h>
 #include <errno.h>
-
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <sys/epoll.h>
+#include <sys/time.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "soc_host"
 #include "ws_br_agent_log.h"
 #include "ws_br_agent_defs.h"
 #include "ws_br_agent_msg.h"
 #include "ws_br_agent_soc_host.h"
+#include "ws_br_agent_topo.h"
+#include "ws_br_agent_history.h"
+#include "ws_br_agent_lifecycle.h"
+#include "ws_br_agent_node_stats.h"
 #include "ws_br_agent_utils.h"
+#include "ws_br_agent_capture.h"
+#include "ws_br_agent_metrics.h"
+#include "ws_br_agent_mem.h"
+#include "ws_br_agent_probe.h"
+#include "ws_br_agent_event.h"
 
 
 #define DEFAULT_SOC_HOST_ADDR_STR "::1"
 
-static ws_br_agent_ret_t copy_topology(ws_br_agent_soc_host_topology_t * const dst_topology,
-                                       const ws_br_agent_soc_host_topology_t * const src_topology);
+/// Connect, send and receive timeout of a SoC request
+#define SOC_REQ_TIMEOUT_US 5000000ULL
+
+/// @brief Pending SoC request (event loop mode)
+typedef struct soc_req {
+  /// Request socket
+  int fd;
+  /// Request message code
+  ws_br_agent_msg_raw_code_t msg_code;
+  /// Response process callback, NULL if no response is expected
+  ws_br_agent_soc_host_process_resp_cb_t resp_cb;
+  /// SoC address
+  struct sockaddr_in6 remote_addr;
+  /// SoC address string, referenced by the log fields
+  char remote_addr_str[WS_BR_AGENT_IPV6_ADDR_STR_SIZE];
+  /// Socket event source
+  sd_event_source *io;
+  /// Timeout event source
+  sd_event_source *timer;
+  /// Monotonic request start time in us
+  uint64_t start_us;
+  /// Request buffer, then response buffer
+  uint8_t *buf;
+  /// Request size
+  size_t size;
+  /// Sent bytes
+  size_t sent;
+  /// Connection established
+  bool connected;
+} soc_req_t;
+
+static ws_br_agent_ret_t soc_req_start(const ws_br_agent_soc_host_t * const host,
+                                       const ws_br_agent_msg_t * const req_msg,
+                                       ws_br_agent_soc_host_process_resp_cb_t resp_cb,
+                                       uint64_t start_us);
+static int soc_req_io_hnd(sd_event_source *s, int fd, uint32_t revents, void *userdata);
+static int soc_req_timeout_hnd(sd_event_source *s, uint64_t usec, void *userdata);
+static void soc_req_finish(soc_req_t *req, ws_br_agent_ret_t ret);
+static int soc_req_connect(int fd, const struct sockaddr_in6 * const addr);
 
 static const ws_br_agent_settings_t default_host_settings = {
   .network_name = "Wi-SUN Network",
@@ -72,18 +125,84 @@ static const ws_br_agent_settings_t default_host_settings = {
   .pan_id = 0xffff
 };
 
-static ws_br_agent_soc_host_t host = { 0U };
+/// @brief SoC host shard, one per SoC
+/// @details Shards are locked separately and cache line aligned, so that updates
+///          from different SoCs do not contend.
+typedef struct __attribute__((aligned(64))) soc_shard {
+  /// Shard lock (recursive)
+  pthread_mutex_t mutex;
+  /// Host information
+  ws_br_agent_soc_host_t host;
+  /// Current topology
+  ws_br_agent_topo_t topo;
+  /// Previous topology, its block is reused by the next update
+  ws_br_agent_topo_t spare_topo;
+  /// Lifecycle of the nodes seen in the topologies
+  ws_br_agent_lifecycle_t lifecycle;
+  /// Link metrics of the topology nodes
+  ws_br_agent_node_stats_t node_stats;
+  /// Data restored from a previous run, not refreshed by the SoC yet
+  bool stale;
+  /// Settings encoding used by the SoC
+  ws_br_agent_msg_settings_enc_t settings_enc;
+  /// The SoC frames carry a CRC32C trailer, requests to it do the same
+  bool crc;
+} soc_shard_t;
+
+static soc_shard_t shards[WS_BR_AGENT_SOC_HOST_MAX_COUNT];
+
+/// Shard keys (SoC addresses), packed apart from the shards for the lookups
+static struct in6_addr shard_keys[WS_BR_AGENT_SOC_HOST_MAX_COUNT];
+
+/// Number of shards in use, the primary shard always is
+static atomic_size_t shard_count = 1U;
+
+/// Maximum number of shards, set at initialization
+static size_t shard_max = WS_BR_AGENT_SOC_HOST_MAX_COUNT;
+
+/// Primary shard bound to a SoC, its default address is a placeholder until then
+static atomic_bool primary_registered = false;
+
+/// Guards the shard keys, count and primary binding. Lookups share it, new SoCs take it.
+static pthread_rwlock_t shard_rwlock = PTHREAD_RWLOCK_INITIALIZER;
+
+/// Get a shard in use, NULL if the index is out of range
+static inline soc_shard_t *shard_get(size_t shard)
+{
+  return shard < atomic_load(&shard_count) ? &shards[shard] : NULL;
+}
 
-static pthread_mutex_t host_mutex;
+/// Lock a shard mutex and account the wait time
+static inline void shard_lock(soc_shard_t *shd)
+{
+  (void) ws_br_agent_metrics_mutex_lock(&shd->mutex, WS_BR_AGENT_METRIC_HIST_HOST_MUTEX_WAIT);
+}
 
-static ws_br_agent_soc_host_topology_t host_topology = { 
-  .entry_count = 0U, 
-  .entries = NULL 
-};
+/// Set the SoC address of a shard, the shard keys must be locked for writing
+static void shard_bind(size_t shard, const struct in6_addr * const addr)
+{
+  soc_shard_t *shd = &shards[shard];
+
+  shard_keys[shard] = *addr;
+  shard_lock(shd);
+  memset(&shd->host.remote_addr, 0, sizeof(shd->host.remote_addr));
+  shd->host.remote_addr.sin6_family = AF_INET6;
+  shd->host.remote_addr.sin6_addr = *addr;
+  shd->host.remote_addr.sin6_port = htons(WS_BR_AGENT_SOC_PORT);
+  inet_ntop(AF_INET6, addr, shd->host.remote_addr_str, sizeof(shd->host.remote_addr_str));
+  pthread_mutex_unlock(&shd->mutex);
+}
 
-ws_br_agent_ret_t ws_br_agent_soc_host_init(void) 
+ws_br_agent_ret_t ws_br_agent_soc_host_init(size_t max_count) 
 {
   pthread_mutexattr_t attr;
+  size_t i = 0U;
+
+  if (!max_count || max_count > WS_BR_AGENT_SOC_HOST_MAX_COUNT) {
+    ws_br_agent_log_error("Invalid SoC count: %zu (1 to %u)\n", max_count, WS_BR_AGENT_SOC_HOST_MAX_COUNT);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  shard_max = max_count;
 
   // Initialize mutex attributes
   if (pthread_mutexattr_init(&attr) != 0) {
@@ -98,11 +217,13 @@ ws_br_agent_ret_t ws_br_agent_soc_host_init(void)
     return WS_BR_AGENT_RET_ERR;
   }
   
-  // Initialize mutex with recursive attributes
-  if (pthread_mutex_init(&host_mutex, &attr) != 0) {
-    ws_br_agent_log_error("Mutex init failed\n");
-    pthread_mutexattr_destroy(&attr);
-    return WS_BR_AGENT_RET_ERR;
+  // Initialize the shard mutexes with recursive attributes
+  for (i = 0U; i < WS_BR_AGENT_SOC_HOST_MAX_COUNT; ++i) {
+    if (pthread_mutex_init(&shards[i].mutex, &attr) != 0) {
+      ws_br_agent_log_error("Mutex init failed\n");
+      pthread_mutexattr_destroy(&attr);
+      return WS_BR_AGENT_RET_ERR;
+    }
   }
   
   // Clean up attributes (no longer needed after mutex init)
@@ -110,50 +231,181 @@ ws_br_agent_ret_t ws_br_agent_soc_host_init(void)
   
   // Set local host with default settings for init
   ws_br_agent_soc_host_set(DEFAULT_SOC_HOST_ADDR_STR, NULL);
+  ws_br_agent_metrics_set(WS_BR_AGENT_METRIC_SOC_HOSTS, 1);
   ws_br_agent_log_debug("Default host settings loaded (%lu bytes).\n", 
                         sizeof(ws_br_agent_settings_t));
   return WS_BR_AGENT_RET_OK;
 }
 
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_lookup(const struct in6_addr * const addr,
+                                                    bool create,
+                                                    size_t * const shard,
+                                                    bool * const created)
+{
+  size_t count = 0U;
+  size_t i = 0U;
+
+  if (addr == NULL || shard == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  if (created != NULL) {
+    *created = false;
+  }
+
+  // Known SoC: shared lock only, updates of other SoCs are not held
+  pthread_rwlock_rdlock(&shard_rwlock);
+  count = atomic_load(&shard_count);
+  for (i = 0U; i < count; ++i) {
+    if (!memcmp(&shard_keys[i], addr, sizeof(*addr))) {
+      // A SoC at the placeholder address owns the primary shard from now on
+      if (i == WS_BR_AGENT_SOC_HOST_PRIMARY) {
+        atomic_store(&primary_registered, true);
+      }
+      *shard = i;
+      pthread_rwlock_unlock(&shard_rwlock);
+      return WS_BR_AGENT_RET_OK;
+    }
+  }
+  pthread_rwlock_unlock(&shard_rwlock);
+  if (!create) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // New SoC: check again under the exclusive lock, another thread may have added it
+  pthread_rwlock_wrlock(&shard_rwlock);
+  count = atomic_load(&shard_count);
+  for (i = 0U; i < count; ++i) {
+    if (!memcmp(&shard_keys[i], addr, sizeof(*addr))) {
+      *shard = i;
+      pthread_rwlock_unlock(&shard_rwlock);
+      return WS_BR_AGENT_RET_OK;
+    }
+  }
+
+  // The first SoC takes the primary shard over
+  if (!atomic_load(&primary_registered)) {
+    shard_bind(WS_BR_AGENT_SOC_HOST_PRIMARY, addr);
+    atomic_store(&primary_registered, true);
+    *shard = WS_BR_AGENT_SOC_HOST_PRIMARY;
+    pthread_rwlock_unlock(&shard_rwlock);
+    return WS_BR_AGENT_RET_OK;
+  }
+
+  if (count >= shard_max) {
+    pthread_rwlock_unlock(&shard_rwlock);
+    ws_br_agent_log_error("Too many SoCs (%zu), ignoring new SoC\n", shard_max);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // The shard is set up before it is published by the count
+  shard_lock(&shards[count]);
+  memcpy(&shards[count].host.settings, &default_host_settings, sizeof(ws_br_agent_settings_t));
+  shards[count].stale = false;
+  shards[count].settings_enc = WS_BR_AGENT_MSG_SETTINGS_ENC_LEGACY;
+  shards[count].crc = false;
+  pthread_mutex_unlock(&shards[count].mutex);
+  shard_bind(count, addr);
+  atomic_store(&shard_count, count + 1U);
+  pthread_rwlock_unlock(&shard_rwlock);
+
+  ws_br_agent_metrics_set(WS_BR_AGENT_METRIC_SOC_HOSTS, (int64_t)(count + 1U));
+  ws_br_agent_log_info("New SoC %s (shard %zu)\n", shards[count].host.remote_addr_str, count);
+  *shard = count;
+  if (created != NULL) {
+    *created = true;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+size_t ws_br_agent_soc_host_shard_count(void)
+{
+  return atomic_load(&shard_count);
+}
+
 ws_br_agent_ret_t ws_br_agent_soc_host_send_req(const ws_br_agent_msg_t * const req_msg, 
                                                 ws_br_agent_soc_host_process_resp_cb_t resp_cb)
 {
+  return ws_br_agent_soc_host_shard_send_req(WS_BR_AGENT_SOC_HOST_PRIMARY, req_msg, resp_cb);
+}
+
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_send_req(size_t shard,
+                                                      const ws_br_agent_msg_t *req_msg, 
+                                                      ws_br_agent_soc_host_process_resp_cb_t resp_cb)
+{
+  soc_shard_t *shd = shard_get(shard);
   int sockfd = -1;
   ssize_t r = 0;
   size_t buf_size = 0;
   uint8_t *rxtx_buf = NULL;
   ws_br_agent_msg_t *msg = NULL;
-
-  if (req_msg == NULL) {
+  ws_br_agent_msg_t shard_msg;
+  uint8_t settings_buf[WS_BR_AGENT_SETTINGS_TLV_MAX_SIZE];
+  size_t settings_len = 0U;
+  ws_br_agent_log_fields_t fields = WS_BR_AGENT_LOG_FIELDS_INIT;
+  uint64_t start_us = 0ULL;
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_OK;
+
+  if (req_msg == NULL || shd == NULL) {
     return WS_BR_AGENT_RET_ERR;
   }
 
-  pthread_mutex_lock(&host_mutex);
+  shard_lock(shd);
 
-  if (!strcmp(DEFAULT_SOC_HOST_ADDR_STR, host.remote_addr_str)) {
+  if (!strcmp(DEFAULT_SOC_HOST_ADDR_STR, shd->host.remote_addr_str)) {
     ws_br_agent_log_warn("SoC host not registered yet\n");
-    pthread_mutex_unlock(&host_mutex);
+    pthread_mutex_unlock(&shd->mutex);
     return WS_BR_AGENT_RET_OK;
   }
 
-  ws_br_agent_log_info("Send '%s' request (0x%08x)...\n", 
+  // Settings sent without payload are the current settings of this SoC, in its encoding
+  shard_msg = *req_msg;
+  shard_msg.crc = shd->crc;
+  if (req_msg->msg_code == WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS && req_msg->payload == NULL) {
+    if (ws_br_agent_soc_host_shard_encode_settings(shard, shd->settings_enc, NULL, 0U, settings_buf,
+                                                   sizeof(settings_buf), &settings_len)
+        != WS_BR_AGENT_RET_OK) {
+      ws_br_agent_log_error("Failed: Encoding settings\n");
+      pthread_mutex_unlock(&shd->mutex);
+      return WS_BR_AGENT_RET_ERR;
+    }
+    shard_msg.payload = settings_buf;
+    shard_msg.payload_len = (ws_br_agent_msg_len_t)settings_len;
+  }
+  req_msg = &shard_msg;
+
+  start_us = ws_br_agent_utils_get_monotonic_us();
+  fields.msg_code = req_msg->msg_code;
+  fields.peer_addr = shd->host.remote_addr_str;
+  ws_br_agent_log_info_fields(&fields, "Send '%s' request (0x%08x)...\n", 
                        ws_br_agent_utils_val_to_str(req_msg->msg_code, 
                                                     ws_br_agent_msg_code_strs, 
                                                     "Unknown"), 
                        req_msg->msg_code);
 
+  // The event loop must not block: the request completes from its sources
+  if (ws_br_agent_event_get() != NULL) {
+    ret = soc_req_start(&shd->host, req_msg, resp_cb, start_us);
+    pthread_mutex_unlock(&shd->mutex);
+    return ret;
+  }
+
   sockfd = socket(AF_INET6, SOCK_STREAM, 0);
 
   if (sockfd < 0) {
     ws_br_agent_log_error("Failed: Socket creation\n");
-    pthread_mutex_unlock(&host_mutex);
+    pthread_mutex_unlock(&shd->mutex);
     return WS_BR_AGENT_RET_ERR;
   }
 
-  if (connect(sockfd, (struct sockaddr *)&host.remote_addr, sizeof(host.remote_addr)) < 0) {
-    ws_br_agent_log_error("Failed: Connection to %s:%u\n", host.remote_addr_str, WS_BR_AGENT_SOC_PORT);
+  ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_SOC_REQUESTS, 1U);
+  r = soc_req_connect(sockfd, &shd->host.remote_addr);
+  ws_br_agent_probe2(soc_connect, req_msg->msg_code, r);
+  if (r < 0) {
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_SOC_CONNECT_FAILURES, 1U);
+    ws_br_agent_log_error_fields(&fields, "Failed: Connection to %s:%u\n", 
+                                 shd->host.remote_addr_str, WS_BR_AGENT_SOC_PORT);
     close(sockfd);
-    pthread_mutex_unlock(&host_mutex);
+    pthread_mutex_unlock(&shd->mutex);
     return WS_BR_AGENT_RET_ERR;
   }
 
@@ -161,61 +413,73 @@ ws_br_agent_ret_t ws_br_agent_soc_host_send_req(const ws_br_agent_msg_t * const
   if (rxtx_buf == NULL || buf_size < WS_BR_AGENT_MSG_MIN_BUF_SIZE) {
     ws_br_agent_log_error("Failed: Building request\n");
     close(sockfd);
-    pthread_mutex_unlock(&host_mutex);
+    pthread_mutex_unlock(&shd->mutex);
     return WS_BR_AGENT_RET_ERR;
   }
 
-  if (send(sockfd, rxtx_buf, buf_size, 0) < 0) { 
+  r = send(sockfd, rxtx_buf, buf_size, 0);
+  ws_br_agent_probe2(soc_send, req_msg->msg_code, r);
+  if (r < 0) { 
     ws_br_agent_log_error("Failed: Sending request\n");
-    free(rxtx_buf);
+    ws_br_agent_msg_free_buf(rxtx_buf);
     close(sockfd);
-    pthread_mutex_unlock(&host_mutex);
+    pthread_mutex_unlock(&shd->mutex);
     return WS_BR_AGENT_RET_ERR;
   }
-  free(rxtx_buf);
+  ws_br_agent_capture_record(WS_BR_AGENT_CAPTURE_DIR_OUT, WS_BR_AGENT_CAPTURE_CHANNEL_SOC,
+                             &shd->host.remote_addr, rxtx_buf, buf_size);
+  ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_TX_BYTES, buf_size);
+  ws_br_agent_msg_free_buf(rxtx_buf);
 
   // No response expected
   if (resp_cb == NULL) {
     close(sockfd);
-    ws_br_agent_log_info("OK\n");
-    pthread_mutex_unlock(&host_mutex);
+    fields.latency_us = (int64_t)(ws_br_agent_utils_get_monotonic_us() - start_us);
+    ws_br_agent_metrics_observe(WS_BR_AGENT_METRIC_HIST_SOC_RTT, (uint64_t)fields.latency_us);
+    ws_br_agent_log_info_fields(&fields, "OK\n");
+    pthread_mutex_unlock(&shd->mutex);
     return WS_BR_AGENT_RET_OK;
   }
 
   // Receive data
-  rxtx_buf = malloc(WS_BR_AGENT_MAX_BUF_SIZE);
+  rxtx_buf = ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_SOC_HOST, WS_BR_AGENT_MAX_BUF_SIZE);
   if (rxtx_buf == NULL) {
     ws_br_agent_log_error("Failed: Memory allocation\n");
     close(sockfd);
-    pthread_mutex_unlock(&host_mutex);
+    pthread_mutex_unlock(&shd->mutex);
     return WS_BR_AGENT_RET_ERR;
   }
 
   r = recv(sockfd, rxtx_buf, WS_BR_AGENT_MAX_BUF_SIZE, 0);
+  ws_br_agent_probe2(soc_recv, req_msg->msg_code, r);
 
   // No response or error
   if (!r) {
     close(sockfd);
-    free(rxtx_buf);
-    pthread_mutex_unlock(&host_mutex);
+    ws_br_agent_mem_free(rxtx_buf);
+    pthread_mutex_unlock(&shd->mutex);
     return WS_BR_AGENT_RET_OK;
   
-  } else if (r < WS_BR_AGENT_MSG_MIN_BUF_SIZE) {
+  } else if (r < (ssize_t)WS_BR_AGENT_MSG_MIN_BUF_SIZE) {
     ws_br_agent_log_error("Failed: Receiving response\n");
-    free(rxtx_buf);
+    ws_br_agent_mem_free(rxtx_buf);
     close(sockfd);
-    pthread_mutex_unlock(&host_mutex);
+    pthread_mutex_unlock(&shd->mutex);
     return WS_BR_AGENT_RET_ERR;
   }
 
   ws_br_agent_log_info("Received response (%ld bytes)\n", r);
-  msg = ws_br_agent_msg_parse_buf(rxtx_buf, (size_t)r);
-  free(rxtx_buf);
+  ws_br_agent_capture_record(WS_BR_AGENT_CAPTURE_DIR_IN, WS_BR_AGENT_CAPTURE_CHANNEL_SOC,
+                             &shd->host.remote_addr, rxtx_buf, (size_t)r);
+  ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_RX_BYTES, (uint64_t)r);
+  msg = ws_br_agent_msg_check_crc(rxtx_buf, (size_t)r) == WS_BR_AGENT_RET_OK
+        ? ws_br_agent_msg_parse_buf(rxtx_buf, (size_t)r) : NULL;
+  ws_br_agent_mem_free(rxtx_buf);
 
   if (msg == NULL) {
     ws_br_agent_log_error("Failed: Parsing response\n");
     close(sockfd);
-    pthread_mutex_unlock(&host_mutex);
+    pthread_mutex_unlock(&shd->mutex);
     return WS_BR_AGENT_RET_ERR;
   }
 
@@ -223,52 +487,296 @@ ws_br_agent_ret_t ws_br_agent_soc_host_send_req(const ws_br_agent_msg_t * const
     if (resp_cb(msg) != WS_BR_AGENT_RET_OK) {
       ws_br_agent_log_warn("Response process callback failed\n");
       close(sockfd);
-      pthread_mutex_unlock(&host_mutex);
+      pthread_mutex_unlock(&shd->mutex);
       return WS_BR_AGENT_RET_ERR;
     }
   }
   close(sockfd);
-  ws_br_agent_log_info("OK\n");
-  pthread_mutex_unlock(&host_mutex);
+  fields.latency_us = (int64_t)(ws_br_agent_utils_get_monotonic_us() - start_us);
+  ws_br_agent_metrics_observe(WS_BR_AGENT_METRIC_HIST_SOC_RTT, (uint64_t)fields.latency_us);
+  ws_br_agent_log_info_fields(&fields, "OK\n");
+  pthread_mutex_unlock(&shd->mutex);
   
   return WS_BR_AGENT_RET_OK;
 }
 
+/// Connect within SOC_REQ_TIMEOUT_US and bound the send and receive calls to it:
+/// the shard stays locked for the whole request, a dead SoC must not stall its callers
+static int soc_req_connect(int fd, const struct sockaddr_in6 * const addr)
+{
+  struct timeval tv = {
+    .tv_sec = (time_t)(SOC_REQ_TIMEOUT_US / 1000000ULL),
+    .tv_usec = (suseconds_t)(SOC_REQ_TIMEOUT_US % 1000000ULL)
+  };
+  struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+  socklen_t err_len = sizeof(int);
+  int flags = 0;
+  int err = 0;
+  int r = 0;
+
+  flags = fcntl(fd, F_GETFL);
+  if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+    return -1;
+  }
+
+  r = connect(fd, (const struct sockaddr *)addr, sizeof(*addr));
+  if (r < 0 && errno == EINPROGRESS) {
+    do {
+      r = poll(&pfd, 1U, (int)(SOC_REQ_TIMEOUT_US / 1000ULL));
+    } while (r < 0 && errno == EINTR);
+    if (r <= 0 || getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len) < 0 || err != 0) {
+      return -1;
+    }
+    r = 0;
+  }
+  if (r < 0
+      || fcntl(fd, F_SETFL, flags) < 0
+      || setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) < 0
+      || setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+static ws_br_agent_ret_t soc_req_start(const ws_br_agent_soc_host_t * const host,
+                                       const ws_br_agent_msg_t * const req_msg,
+                                       ws_br_agent_soc_host_process_resp_cb_t resp_cb,
+                                       uint64_t start_us)
+{
+  soc_req_t *req = NULL;
+  int r = 0;
+
+  req = (soc_req_t *)ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_SOC_HOST, sizeof(soc_req_t));
+  if (req == NULL) {
+    ws_br_agent_log_error("Failed: Memory allocation\n");
+    return WS_BR_AGENT_RET_ERR;
+  }
+  memset(req, 0, sizeof(soc_req_t));
+  req->msg_code = req_msg->msg_code;
+  req->resp_cb = resp_cb;
+  req->remote_addr = host->remote_addr;
+  memcpy(req->remote_addr_str, host->remote_addr_str, sizeof(req->remote_addr_str));
+  req->start_us = start_us;
+
+  req->buf = ws_br_agent_msg_build_buf(req_msg, &req->size);
+  if (req->buf == NULL || req->size < WS_BR_AGENT_MSG_MIN_BUF_SIZE) {
+    ws_br_agent_log_error("Failed: Building request\n");
+    ws_br_agent_msg_free_buf(req->buf);
+    ws_br_agent_mem_free(req);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  req->fd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (req->fd < 0) {
+    ws_br_agent_log_error("Failed: Socket creation\n");
+    ws_br_agent_msg_free_buf(req->buf);
+    ws_br_agent_mem_free(req);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_SOC_REQUESTS, 1U);
+  r = connect(req->fd, (struct sockaddr *)&req->remote_addr, sizeof(req->remote_addr));
+  if (r < 0 && errno != EINPROGRESS) {
+    ws_br_agent_probe2(soc_connect, req->msg_code, r);
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_SOC_CONNECT_FAILURES, 1U);
+    soc_req_finish(req, WS_BR_AGENT_RET_ERR);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Writable once connected: the connection result is checked from the handler
+  if (sd_event_add_io(ws_br_agent_event_get(), &req->io, req->fd, EPOLLOUT,
+                      soc_req_io_hnd, req) < 0
+      || sd_event_add_time_relative(ws_br_agent_event_get(), &req->timer, CLOCK_MONOTONIC,
+                                    SOC_REQ_TIMEOUT_US, 0, soc_req_timeout_hnd, req) < 0) {
+    ws_br_agent_log_error("Failed: Event source creation\n");
+    soc_req_finish(req, WS_BR_AGENT_RET_ERR);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+static int soc_req_io_hnd(sd_event_source *s, int fd, uint32_t revents, void *userdata)
+{
+  soc_req_t *req = (soc_req_t *)userdata;
+  ws_br_agent_msg_t *msg = NULL;
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_OK;
+  socklen_t err_len = sizeof(int);
+  int err = 0;
+  ssize_t r = 0;
+
+  (void) s;
+  (void) revents;
+
+  // Connection in progress
+  if (!req->connected) {
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len) < 0 || err != 0) {
+      ws_br_agent_probe2(soc_connect, req->msg_code, -1);
+      ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_SOC_CONNECT_FAILURES, 1U);
+      soc_req_finish(req, WS_BR_AGENT_RET_ERR);
+      return 0;
+    }
+    ws_br_agent_probe2(soc_connect, req->msg_code, 0);
+    req->connected = true;
+  }
+
+  // Send the request
+  if (req->sent < req->size) {
+    r = send(fd, req->buf + req->sent, req->size - req->sent, MSG_NOSIGNAL);
+    if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      return 0;
+    }
+    if (r < 0) {
+      ws_br_agent_probe2(soc_send, req->msg_code, r);
+      ws_br_agent_log_error("Failed: Sending request\n");
+      soc_req_finish(req, WS_BR_AGENT_RET_ERR);
+      return 0;
+    }
+    req->sent += (size_t)r;
+    if (req->sent < req->size) {
+      return 0;
+    }
+    ws_br_agent_probe2(soc_send, req->msg_code, (ssize_t)req->size);
+    ws_br_agent_capture_record(WS_BR_AGENT_CAPTURE_DIR_OUT, WS_BR_AGENT_CAPTURE_CHANNEL_SOC,
+                               &req->remote_addr, req->buf, req->size);
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_TX_BYTES, req->size);
+    ws_br_agent_msg_free_buf(req->buf);
+    req->buf = NULL;
+    req->size = 0U;
+
+    // No response expected
+    if (req->resp_cb == NULL) {
+      soc_req_finish(req, WS_BR_AGENT_RET_OK);
+      return 0;
+    }
+
+    req->buf = ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_SOC_HOST, WS_BR_AGENT_MAX_BUF_SIZE);
+    if (req->buf == NULL || sd_event_source_set_io_events(req->io, EPOLLIN) < 0) {
+      ws_br_agent_log_error("Failed: Memory allocation\n");
+      soc_req_finish(req, WS_BR_AGENT_RET_ERR);
+    }
+    return 0;
+  }
+
+  // Receive the response, as a single read like the threaded path
+  r = recv(fd, req->buf, WS_BR_AGENT_MAX_BUF_SIZE, 0);
+  if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+    return 0;
+  }
+  ws_br_agent_probe2(soc_recv, req->msg_code, r);
+  if (r == 0) {
+    soc_req_finish(req, WS_BR_AGENT_RET_OK);
+    return 0;
+  } else if (r < (ssize_t)WS_BR_AGENT_MSG_MIN_BUF_SIZE) {
+    ws_br_agent_log_error("Failed: Receiving response\n");
+    soc_req_finish(req, WS_BR_AGENT_RET_ERR);
+    return 0;
+  }
+
+  ws_br_agent_log_info("Received response (%ld bytes)\n", r);
+  ws_br_agent_capture_record(WS_BR_AGENT_CAPTURE_DIR_IN, WS_BR_AGENT_CAPTURE_CHANNEL_SOC,
+                             &req->remote_addr, req->buf, (size_t)r);
+  ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_RX_BYTES, (uint64_t)r);
+  msg = ws_br_agent_msg_check_crc(req->buf, (size_t)r) == WS_BR_AGENT_RET_OK
+        ? ws_br_agent_msg_parse_buf(req->buf, (size_t)r) : NULL;
+  if (msg == NULL) {
+    ws_br_agent_log_error("Failed: Parsing response\n");
+    ret = WS_BR_AGENT_RET_ERR;
+  } else if (req->resp_cb(msg) != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_warn("Response process callback failed\n");
+    ret = WS_BR_AGENT_RET_ERR;
+  }
+  ws_br_agent_msg_free(msg);
+  soc_req_finish(req, ret);
+  return 0;
+}
+
+static int soc_req_timeout_hnd(sd_event_source *s, uint64_t usec, void *userdata)
+{
+  soc_req_t *req = (soc_req_t *)userdata;
+
+  (void) s;
+  (void) usec;
+
+  ws_br_agent_log_error("Failed: Request timeout (%s)\n", strerror(ETIMEDOUT));
+  if (!req->connected) {
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_SOC_CONNECT_FAILURES, 1U);
+  }
+  soc_req_finish(req, WS_BR_AGENT_RET_ERR);
+  return 0;
+}
+
+static void soc_req_finish(soc_req_t *req, ws_br_agent_ret_t ret)
+{
+  ws_br_agent_log_fields_t fields = WS_BR_AGENT_LOG_FIELDS_INIT;
+
+  fields.msg_code = req->msg_code;
+  fields.peer_addr = req->remote_addr_str;
+  if (ret == WS_BR_AGENT_RET_OK) {
+    fields.latency_us = (int64_t)(ws_br_agent_utils_get_monotonic_us() - req->start_us);
+    ws_br_agent_metrics_observe(WS_BR_AGENT_METRIC_HIST_SOC_RTT, (uint64_t)fields.latency_us);
+    ws_br_agent_log_info_fields(&fields, "OK\n");
+  } else if (!req->connected) {
+    ws_br_agent_log_error_fields(&fields, "Failed: Connection to %s:%u\n",
+                                 req->remote_addr_str, WS_BR_AGENT_SOC_PORT);
+  }
+
+  (void) sd_event_source_disable_unref(req->io);
+  (void) sd_event_source_disable_unref(req->timer);
+  close(req->fd);
+  if (req->size != 0U) {
+    ws_br_agent_msg_free_buf(req->buf);
+  } else {
+    ws_br_agent_mem_free(req->buf);
+  }
+  ws_br_agent_mem_free(req);
+}
+
 ws_br_agent_ret_t ws_br_agent_soc_host_set(const char *addr,
                                            const ws_br_agent_settings_t *const settings)
 {
+  soc_shard_t *shd = &shards[WS_BR_AGENT_SOC_HOST_PRIMARY];
+  struct in6_addr in6 = { 0 };
+
   if (addr == NULL) {
     return WS_BR_AGENT_RET_ERR;
   }
   
-  pthread_mutex_lock(&host_mutex);
-  if (inet_pton(AF_INET6, addr, &host.remote_addr.sin6_addr) != 1) {
+  if (inet_pton(AF_INET6, addr, &in6) != 1) {
     ws_br_agent_log_error("Invalid IPv6 address: %s\n", addr);
-    pthread_mutex_unlock(&host_mutex);
     return WS_BR_AGENT_RET_ERR;
   }
 
-  snprintf(host.remote_addr_str, sizeof(host.remote_addr_str), "%s", addr);
-  host.remote_addr_str[WS_BR_AGENT_IPV6_ADDR_STR_SIZE - 1] = '\0';
+  pthread_rwlock_wrlock(&shard_rwlock);
+  shard_bind(WS_BR_AGENT_SOC_HOST_PRIMARY, &in6);
+  pthread_rwlock_unlock(&shard_rwlock);
 
+  shard_lock(shd);
   if (settings != NULL) {
-    memcpy(&host.settings, settings, sizeof(ws_br_agent_settings_t));
+    memcpy(&shd->host.settings, settings, sizeof(ws_br_agent_settings_t));
   } else {
-    memcpy(&host.settings, &default_host_settings, sizeof(ws_br_agent_settings_t));
+    memcpy(&shd->host.settings, &default_host_settings, sizeof(ws_br_agent_settings_t));
   }
-  pthread_mutex_unlock(&host_mutex);
+  pthread_mutex_unlock(&shd->mutex);
   return WS_BR_AGENT_RET_OK;
 }
 
 ws_br_agent_ret_t ws_br_agent_soc_host_get(ws_br_agent_soc_host_t * const dst_host)
 {
-  if (dst_host == NULL) {
+  return ws_br_agent_soc_host_shard_get(WS_BR_AGENT_SOC_HOST_PRIMARY, dst_host);
+}
+
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_get(size_t shard,
+                                                 ws_br_agent_soc_host_t * const dst_host)
+{
+  soc_shard_t *shd = shard_get(shard);
+
+  if (dst_host == NULL || shd == NULL) {
     return WS_BR_AGENT_RET_ERR;
   }
 
-  pthread_mutex_lock(&host_mutex);
-  memcpy(dst_host, &host, sizeof(ws_br_agent_soc_host_t));
-  pthread_mutex_unlock(&host_mutex);
+  shard_lock(shd);
+  memcpy(dst_host, &shd->host, sizeof(ws_br_agent_soc_host_t));
+  pthread_mutex_unlock(&shd->mutex);
 
   return WS_BR_AGENT_RET_OK;
 }
@@ -279,23 +787,25 @@ ws_br_agent_ret_t ws_br_agent_soc_host_set_remote_addr(const struct sockaddr_in6
     return WS_BR_AGENT_RET_ERR;
   }
 
-  pthread_mutex_lock(&host_mutex);
-  memcpy(&host.remote_addr, addr, sizeof(struct sockaddr_in6));
-  host.remote_addr.sin6_port = htons(WS_BR_AGENT_SOC_PORT);
-  inet_ntop(AF_INET6, &addr->sin6_addr, host.remote_addr_str, sizeof(host.remote_addr_str));
-  pthread_mutex_unlock(&host_mutex);
+  pthread_rwlock_wrlock(&shard_rwlock);
+  shard_bind(WS_BR_AGENT_SOC_HOST_PRIMARY, &addr->sin6_addr);
+  atomic_store(&primary_registered, true);
+  pthread_rwlock_unlock(&shard_rwlock);
 
   return WS_BR_AGENT_RET_OK;
 }
+
 ws_br_agent_ret_t ws_br_agent_soc_host_get_remote_addr(struct sockaddr_in6 * const addr)
 {
+  soc_shard_t *shd = &shards[WS_BR_AGENT_SOC_HOST_PRIMARY];
+
   if (addr == NULL) {
     return WS_BR_AGENT_RET_ERR;
   }
 
-  pthread_mutex_lock(&host_mutex);
-  memcpy(addr, &host.remote_addr, sizeof(struct sockaddr_in6));
-  pthread_mutex_unlock(&host_mutex);
+  shard_lock(shd);
+  memcpy(addr, &shd->host.remote_addr, sizeof(struct sockaddr_in6));
+  pthread_mutex_unlock(&shd->mutex);
 
   return WS_BR_AGENT_RET_OK;
 }
@@ -306,80 +816,414 @@ const ws_br_agent_settings_t *ws_br_agent_soc_host_get_default_settings(void)
   return ret;
 }
 
-ws_br_agent_ret_t ws_br_agent_soc_host_set_settings(const ws_br_agent_settings_t * const settings)
+ws_br_agent_ret_t ws_br_agent_soc_host_set_settings(const ws_br_agent_settings_t * const settings,
+                                                    ws_br_agent_trace_t * const trace)
 {
-  if (settings == NULL) {
+  return ws_br_agent_soc_host_shard_set_settings(WS_BR_AGENT_SOC_HOST_PRIMARY, settings, trace);
+}
+
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_set_settings(size_t shard,
+                                                          const ws_br_agent_settings_t * const settings,
+                                                          ws_br_agent_trace_t * const trace)
+{
+  soc_shard_t *shd = shard_get(shard);
+  ws_br_agent_settings_t prev_settings;
+
+  if (settings == NULL || shd == NULL) {
     return WS_BR_AGENT_RET_ERR;
   }
 
-  pthread_mutex_lock(&host_mutex);
-  memcpy(&host.settings, settings, sizeof(ws_br_agent_settings_t));
-  pthread_mutex_unlock(&host_mutex);
+  shard_lock(shd);
+  memcpy(&prev_settings, &shd->host.settings, sizeof(ws_br_agent_settings_t));
+  memcpy(&shd->host.settings, settings, sizeof(ws_br_agent_settings_t));
+  ws_br_agent_trace_stamp(trace, WS_BR_AGENT_TRACE_STAGE_STORE);
+  if (trace != NULL) {
+    trace->changed = memcmp(&prev_settings, &shd->host.settings,
+                            sizeof(ws_br_agent_settings_t)) != 0;
+  }
+  ws_br_agent_trace_stamp(trace, WS_BR_AGENT_TRACE_STAGE_DIFF);
+  pthread_mutex_unlock(&shd->mutex);
 
   return WS_BR_AGENT_RET_OK;
 }
 
 ws_br_agent_ret_t ws_br_agent_soc_host_get_settings(ws_br_agent_settings_t * const settings)
 {
-  if (settings == NULL) {
+  return ws_br_agent_soc_host_shard_get_settings(WS_BR_AGENT_SOC_HOST_PRIMARY, settings);
+}
+
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_get_settings(size_t shard,
+                                                          ws_br_agent_settings_t * const settings)
+{
+  soc_shard_t *shd = shard_get(shard);
+
+  if (settings == NULL || shd == NULL) {
     return WS_BR_AGENT_RET_ERR;
   }
 
-  pthread_mutex_lock(&host_mutex);
-  memcpy(settings, &host.settings, sizeof(ws_br_agent_settings_t));
-  pthread_mutex_unlock(&host_mutex);
+  shard_lock(shd);
+  memcpy(settings, &shd->host.settings, sizeof(ws_br_agent_settings_t));
+  pthread_mutex_unlock(&shd->mutex);
 
   return WS_BR_AGENT_RET_OK;
 }
 
-static ws_br_agent_ret_t copy_topology(ws_br_agent_soc_host_topology_t * const dst_topology,
-                                       const ws_br_agent_soc_host_topology_t * const src_topology)
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_get_setting(size_t shard,
+                                                         const ws_br_agent_settings_field_t * const field,
+                                                         ws_br_agent_settings_t * const settings)
 {
-  size_t storage_size = 0U;
+  soc_shard_t *shd = shard_get(shard);
 
-  if (src_topology == NULL
-     || dst_topology == NULL
-     || src_topology->entries == NULL 
-     || !src_topology->entry_count) {
+  if (settings == NULL || field == NULL || shd == NULL) {
     return WS_BR_AGENT_RET_ERR;
   }
 
-  if (dst_topology->entries != NULL) {
-    free(dst_topology->entries);
-  }
+  shard_lock(shd);
+  settings->phy.type = shd->host.settings.phy.type;
+  memcpy((uint8_t *)settings + field->offset,
+         (const uint8_t *)&shd->host.settings + field->offset, field->size);
+  pthread_mutex_unlock(&shd->mutex);
+
+  return WS_BR_AGENT_RET_OK;
+}
 
-  dst_topology->entry_count = src_topology->entry_count;
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_set_setting(size_t shard,
+                                                         const ws_br_agent_settings_field_t * const field,
+                                                         const ws_br_agent_settings_t * const settings,
+                                                         bool * const changed)
+{
+  soc_shard_t *shd = shard_get(shard);
+  uint8_t *dst = NULL;
+  const uint8_t *src = NULL;
 
-  // Allocate dest topology
-  storage_size = src_topology->entry_count * sizeof(ws_br_agent_soc_host_topology_entry_t);
-  dst_topology->entries = (ws_br_agent_soc_host_topology_entry_t *) malloc(storage_size);
-  if (dst_topology->entries == NULL) {
+  if (settings == NULL || field == NULL || shd == NULL) {
     return WS_BR_AGENT_RET_ERR;
   }
 
-  memcpy(dst_topology->entries, src_topology->entries, storage_size);
+  dst = (uint8_t *)&shd->host.settings + field->offset;
+  src = (const uint8_t *)settings + field->offset;
+  shard_lock(shd);
+  if (changed != NULL) {
+    *changed = memcmp(dst, src, field->size) != 0;
+  }
+  memcpy(dst, src, field->size);
+  pthread_mutex_unlock(&shd->mutex);
 
   return WS_BR_AGENT_RET_OK;
 }
 
-ws_br_agent_ret_t ws_br_agent_soc_host_set_topology(const ws_br_agent_soc_host_topology_t *topology)
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_update_settings_tlv(size_t shard,
+                                                                 const uint8_t * const buf, size_t len,
+                                                                 ws_br_agent_trace_t * const trace)
 {
+  soc_shard_t *shd = shard_get(shard);
+  ws_br_agent_settings_t settings;
   ws_br_agent_ret_t ret = WS_BR_AGENT_RET_ERR;
 
-  pthread_mutex_lock(&host_mutex);
-  ret = copy_topology(&host_topology, topology);
-  pthread_mutex_unlock(&host_mutex);
+  if (buf == NULL || shd == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Decoded onto the current settings under the lock, concurrent field updates are kept
+  shard_lock(shd);
+  memcpy(&settings, &shd->host.settings, sizeof(ws_br_agent_settings_t));
+  if (ws_br_agent_settings_tlv_decode(buf, len, &settings, NULL) == WS_BR_AGENT_RET_OK) {
+    ret = ws_br_agent_soc_host_shard_set_settings(shard, &settings, trace);
+  }
+  pthread_mutex_unlock(&shd->mutex);
+
+  return ret;
+}
+
+void ws_br_agent_soc_host_shard_set_settings_enc(size_t shard, ws_br_agent_msg_settings_enc_t enc)
+{
+  soc_shard_t *shd = shard_get(shard);
+
+  if (shd == NULL) {
+    return;
+  }
+
+  shard_lock(shd);
+  if (shd->settings_enc != enc) {
+    ws_br_agent_log_info("SoC %s uses the %s settings encoding\n", shd->host.remote_addr_str,
+                         enc == WS_BR_AGENT_MSG_SETTINGS_ENC_TLV ? "TLV" : "legacy");
+    shd->settings_enc = enc;
+  }
+  pthread_mutex_unlock(&shd->mutex);
+}
+
+ws_br_agent_msg_settings_enc_t ws_br_agent_soc_host_shard_get_settings_enc(size_t shard)
+{
+  soc_shard_t *shd = shard_get(shard);
+  ws_br_agent_msg_settings_enc_t enc = WS_BR_AGENT_MSG_SETTINGS_ENC_LEGACY;
+
+  if (shd == NULL) {
+    return enc;
+  }
+
+  shard_lock(shd);
+  enc = shd->settings_enc;
+  pthread_mutex_unlock(&shd->mutex);
+
+  return enc;
+}
+
+void ws_br_agent_soc_host_shard_set_crc(size_t shard, bool crc)
+{
+  soc_shard_t *shd = shard_get(shard);
+
+  if (shd == NULL) {
+    return;
+  }
+
+  shard_lock(shd);
+  if (shd->crc != crc) {
+    ws_br_agent_log_info("SoC %s %s CRC32C frame trailers\n", shd->host.remote_addr_str,
+                         crc ? "uses" : "does not use");
+    shd->crc = crc;
+  }
+  pthread_mutex_unlock(&shd->mutex);
+}
+
+bool ws_br_agent_soc_host_shard_get_crc(size_t shard)
+{
+  soc_shard_t *shd = shard_get(shard);
+  bool crc = false;
+
+  if (shd == NULL) {
+    return crc;
+  }
+
+  shard_lock(shd);
+  crc = shd->crc;
+  pthread_mutex_unlock(&shd->mutex);
+
+  return crc;
+}
+
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_encode_settings(size_t shard,
+                                                             ws_br_agent_msg_settings_enc_t enc,
+                                                             const ws_br_agent_settings_field_t * const fields[],
+                                                             size_t count, uint8_t * const buf,
+                                                             size_t size, size_t * const len)
+{
+  soc_shard_t *shd = shard_get(shard);
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_OK;
+
+  if (buf == NULL || len == NULL || shd == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  shard_lock(shd);
+  if (enc == WS_BR_AGENT_MSG_SETTINGS_ENC_TLV) {
+    ret = ws_br_agent_settings_tlv_encode(&shd->host.settings, fields, count, buf, size, len);
+  } else if (size >= sizeof(ws_br_agent_settings_t)) {
+    memcpy(buf, &shd->host.settings, sizeof(ws_br_agent_settings_t));
+    *len = sizeof(ws_br_agent_settings_t);
+  } else {
+    ret = WS_BR_AGENT_RET_ERR;
+  }
+  pthread_mutex_unlock(&shd->mutex);
 
   return ret;
 }
 
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_push_settings(size_t shard,
+                                                           const ws_br_agent_settings_field_t * const fields[],
+                                                           size_t count)
+{
+  uint8_t buf[WS_BR_AGENT_SETTINGS_TLV_MAX_SIZE];
+  size_t len = 0U;
+  ws_br_agent_msg_t msg = {
+    .msg_code = WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS,
+    .payload_len = 0U,
+    .payload = buf
+  };
+
+  if (fields == NULL || !count) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  if (ws_br_agent_soc_host_shard_encode_settings(shard, ws_br_agent_soc_host_shard_get_settings_enc(shard),
+                                                 fields, count, buf, sizeof(buf), &len)
+      != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_error("Failed: Encoding settings\n");
+    return WS_BR_AGENT_RET_ERR;
+  }
+  msg.payload_len = (ws_br_agent_msg_len_t)len;
+  return ws_br_agent_soc_host_shard_send_req(shard, &msg, NULL);
+}
+
+ws_br_agent_ret_t ws_br_agent_soc_host_set_topology(const ws_br_agent_soc_host_topology_t *topology,
+                                                    ws_br_agent_trace_t * const trace)
+{
+  return ws_br_agent_soc_host_shard_set_topology(WS_BR_AGENT_SOC_HOST_PRIMARY, topology, trace);
+}
+
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_set_topology(size_t shard,
+                                                          const ws_br_agent_soc_host_topology_t *topology,
+                                                          ws_br_agent_trace_t * const trace)
+{
+  soc_shard_t *shd = shard_get(shard);
+  ws_br_agent_topo_t new_topo = { 0 };
+  bool changed = false;
+
+  if (shd == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Periodic refreshes are mostly unchanged: checked against the columns, nothing built
+  shard_lock(shd);
+  if (ws_br_agent_topo_match(&shd->topo, topology)) {
+    ws_br_agent_lifecycle_touch(&shd->lifecycle, ws_br_agent_utils_get_realtime_us());
+    pthread_mutex_unlock(&shd->mutex);
+    ws_br_agent_trace_stamp(trace, WS_BR_AGENT_TRACE_STAGE_STORE);
+    if (trace != NULL) {
+      trace->changed = false;
+    }
+    ws_br_agent_trace_stamp(trace, WS_BR_AGENT_TRACE_STAGE_DIFF);
+    return WS_BR_AGENT_RET_OK;
+  }
+
+  // Build into the previous shard topology outside of the lock, then swap
+  new_topo = shd->spare_topo;
+  shd->spare_topo = (ws_br_agent_topo_t) { 0 };
+  pthread_mutex_unlock(&shd->mutex);
+
+  if (ws_br_agent_topo_build(&new_topo, topology) != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_topo_free(&new_topo);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  ws_br_agent_trace_stamp(trace, WS_BR_AGENT_TRACE_STAGE_STORE);
+
+  shard_lock(shd);
+  changed = !ws_br_agent_topo_equal(&new_topo, &shd->topo);
+  if (changed) {
+    // Recorded against the version it replaces, in update order
+    ws_br_agent_history_record(shard, &shd->host.remote_addr.sin6_addr, &shd->topo, topology);
+    if (ws_br_agent_lifecycle_update(&shd->lifecycle, &shd->topo, topology,
+                                     ws_br_agent_utils_get_realtime_us()) != WS_BR_AGENT_RET_OK) {
+      ws_br_agent_log_warn("Failed to update the node lifecycles\n");
+    }
+    ws_br_agent_node_stats_remap(&shd->node_stats, &shd->topo, &new_topo);
+  }
+  // Keep the replaced topology block for the next update
+  if (shd->spare_topo.block == NULL) {
+    shd->spare_topo = shd->topo;
+  } else {
+    ws_br_agent_topo_free(&shd->topo);
+  }
+  shd->topo = new_topo;
+  pthread_mutex_unlock(&shd->mutex);
+
+  if (trace != NULL) {
+    trace->changed = changed;
+  }
+  ws_br_agent_trace_stamp(trace, WS_BR_AGENT_TRACE_STAGE_DIFF);
+
+  return WS_BR_AGENT_RET_OK;
+}
+
 ws_br_agent_ret_t ws_br_agent_soc_host_get_topology(ws_br_agent_soc_host_topology_t * const topology)
 {
+  return ws_br_agent_soc_host_shard_get_topology(WS_BR_AGENT_SOC_HOST_PRIMARY, topology);
+}
+
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_get_topology(size_t shard,
+                                                          ws_br_agent_soc_host_topology_t * const topology)
+{
+  soc_shard_t *shd = shard_get(shard);
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_ERR;
+
+  if (shd == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Wire form rebuilt on demand, the shard only keeps the columns
+  shard_lock(shd);
+  ret = ws_br_agent_topo_to_wire(&shd->topo, topology);
+  pthread_mutex_unlock(&shd->mutex);
+  if (ret == WS_BR_AGENT_RET_OK) {
+    ws_br_agent_probe2(copy_topology, topology->entry_count,
+                       topology->entry_count * sizeof(ws_br_agent_soc_host_topology_entry_t));
+  }
+
+  return ret;
+}
+
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_get_lifecycle(size_t shard, const uint8_t addr[16],
+                                                           struct ws_br_agent_lifecycle_node * const node)
+{
+  soc_shard_t *shd = shard_get(shard);
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_ERR;
+
+  if (shd == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  shard_lock(shd);
+  ret = ws_br_agent_lifecycle_get(&shd->lifecycle, addr, node);
+  pthread_mutex_unlock(&shd->mutex);
+
+  return ret;
+}
+
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_foreach_lifecycle(size_t shard,
+                                                               int (*cb)(void *ctx,
+                                                                         const struct ws_br_agent_lifecycle_node *node),
+                                                               void *ctx)
+{
+  soc_shard_t *shd = shard_get(shard);
   ws_br_agent_ret_t ret = WS_BR_AGENT_RET_ERR;
 
-  pthread_mutex_lock(&host_mutex);
-  ret = copy_topology(topology, &host_topology);
-  pthread_mutex_unlock(&host_mutex);
+  if (shd == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  shard_lock(shd);
+  ret = ws_br_agent_lifecycle_foreach(&shd->lifecycle, cb, ctx);
+  pthread_mutex_unlock(&shd->mutex);
+
+  return ret;
+}
+
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_set_node_stats(size_t shard,
+                                                            const struct ws_br_agent_node_stats_entry *entries,
+                                                            uint32_t count, uint32_t * const unknown)
+{
+  soc_shard_t *shd = shard_get(shard);
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_ERR;
+
+  if (shd == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Stored in place in the columns, matched against the current topology
+  shard_lock(shd);
+  ret = ws_br_agent_node_stats_update(&shd->node_stats, &shd->topo, entries, count,
+                                      ws_br_agent_utils_get_realtime_us(), unknown);
+  pthread_mutex_unlock(&shd->mutex);
+
+  return ret;
+}
+
+ws_br_agent_ret_t ws_br_agent_soc_host_shard_foreach_node_stats(size_t shard, uint32_t first, uint32_t count,
+                                                                int (*cb)(void *ctx,
+                                                                          const struct ws_br_agent_node_stats_row *row),
+                                                                void *ctx, uint32_t * const node_count)
+{
+  soc_shard_t *shd = shard_get(shard);
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_ERR;
+
+  if (shd == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  shard_lock(shd);
+  if (node_count != NULL) {
+    *node_count = shd->topo.node_count;
+  }
+  ret = ws_br_agent_node_stats_foreach(&shd->node_stats, &shd->topo, first, count, cb, ctx);
+  pthread_mutex_unlock(&shd->mutex);
 
   return ret;
 }
@@ -391,7 +1235,7 @@ ws_br_agent_ret_t ws_br_agent_soc_host_free_topology(ws_br_agent_soc_host_topolo
   }
 
   if (topology->entries != NULL) {
-    free(topology->entries);
+    ws_br_agent_mem_free(topology->entries);
     topology->entries = NULL;
   }
 
@@ -400,26 +1244,70 @@ ws_br_agent_ret_t ws_br_agent_soc_host_free_topology(ws_br_agent_soc_host_topolo
   return WS_BR_AGENT_RET_OK;
 }
 
+bool ws_br_agent_soc_host_set_stale(bool stale)
+{
+  return ws_br_agent_soc_host_shard_set_stale(WS_BR_AGENT_SOC_HOST_PRIMARY, stale);
+}
+
+bool ws_br_agent_soc_host_shard_set_stale(size_t shard, bool stale)
+{
+  soc_shard_t *shd = shard_get(shard);
+  bool prev = false;
+
+  if (shd == NULL) {
+    return false;
+  }
+
+  shard_lock(shd);
+  prev = shd->stale;
+  shd->stale = stale;
+  pthread_mutex_unlock(&shd->mutex);
+
+  return prev;
+}
+
+bool ws_br_agent_soc_host_is_stale(void)
+{
+  return ws_br_agent_soc_host_shard_is_stale(WS_BR_AGENT_SOC_HOST_PRIMARY);
+}
+
+bool ws_br_agent_soc_host_shard_is_stale(size_t shard)
+{
+  soc_shard_t *shd = shard_get(shard);
+  bool stale = false;
+
+  if (shd == NULL) {
+    return false;
+  }
+
+  shard_lock(shd);
+  stale = shd->stale;
+  pthread_mutex_unlock(&shd->mutex);
+
+  return stale;
+}
+
 ws_br_agent_ret_t ws_br_agent_soc_host_update_settings(const char *config_file)
 {
+  soc_shard_t *shd = &shards[WS_BR_AGENT_SOC_HOST_PRIMARY];
   ws_br_agent_settings_t new_settings = { 0U };
 
   if (config_file == NULL) {
     return WS_BR_AGENT_RET_ERR;
   }
   // Init settings with default values
-  pthread_mutex_lock(&host_mutex);
+  shard_lock(shd);
   memcpy(&new_settings, &default_host_settings, sizeof(ws_br_agent_settings_t));
 
-  if (ws_br_agent_settings_load_config(config_file, &new_settings) != WS_BR_AGENT_RET_OK) {
+  if (ws_br_agent_settings_load_config(config_file, &new_settings, NULL) != WS_BR_AGENT_RET_OK) {
     ws_br_agent_log_error("Failed: Loading config file\n");
-    pthread_mutex_unlock(&host_mutex);
+    pthread_mutex_unlock(&shd->mutex);
     return WS_BR_AGENT_RET_ERR;
   }
 
   // Update host settings
-  memcpy(&host.settings, &new_settings, sizeof(ws_br_agent_settings_t));
-  pthread_mutex_unlock(&host_mutex);
+  memcpy(&shd->host.settings, &new_settings, sizeof(ws_br_agent_settings_t));
+  pthread_mutex_unlock(&shd->mutex);
 
   return WS_BR_AGENT_RET_OK;
-}
\ No newline at end of file
+}
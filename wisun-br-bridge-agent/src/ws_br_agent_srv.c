@@ -39,31 +39,130 @@
 #include <poll.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
+#define WS_BR_AGENT_LOG_SUBSYSTEM "srv"
 #include "ws_br_agent_defs.h"
 #include "ws_br_agent_log.h"
 #include "ws_br_agent_utils.h"
 #include "ws_br_agent_msg.h"
 #include "ws_br_agent_soc_host.h"
 #include "ws_br_agent_dbus.h"
+#include "ws_br_agent_capture.h"
+#include "ws_br_agent_metrics.h"
+#include "ws_br_agent_trace.h"
+#include "ws_br_agent_probe.h"
+#include "ws_br_agent_mem.h"
+#include "ws_br_agent_event.h"
+#include "ws_br_agent_service.h"
+#include "ws_br_agent_state.h"
+#include "ws_br_agent_node_stats.h"
 #include "ws_br_agent_srv.h"
 
 #define DISPACH_DELAY_US 1000UL
-#define SRV_MAX_BUF_SIZE 102400
+#define SRV_MAX_BUF_SIZE \
+  (WS_BR_AGENT_MSG_MIN_BUF_SIZE \
+   + WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES * sizeof(ws_br_agent_soc_host_topology_entry_t) \
+   + WS_BR_AGENT_MSG_CRC_SIZE)
+
+/// Receive timeout of a client connection
+#define SRV_CONN_TIMEOUT_US 5000000ULL
+
+/// @brief Client connection (event loop mode)
+typedef struct srv_conn {
+  /// Connection socket
+  int fd;
+  /// Client address
+  struct sockaddr_in6 addr;
+  /// Socket event source
+  sd_event_source *io;
+  /// Receive timeout event source
+  sd_event_source *timer;
+  /// Monotonic accept time in us
+  uint64_t start_us;
+  /// Update trace
+  ws_br_agent_trace_t trace;
+  /// Message header, received first
+  uint8_t hdr[WS_BR_AGENT_MSG_MIN_BUF_SIZE];
+  /// Whole message, allocated once the header is received
+  uint8_t *buf;
+  /// Received bytes
+  size_t received;
+  /// Expected bytes
+  size_t expected;
+} srv_conn_t;
 
 static pthread_t srv_thr;
 static volatile sig_atomic_t srv_thread_stop = 0;
+/// Wakes the server thread up to stop (eventfd)
+static int srv_stop_fd = -1;
 static int listen_fd = -1L;
+static sd_event_source *listen_source = NULL;
 static void srv_thr_fnc(void *arg);
+static int srv_open_listen(void);
+static uint64_t srv_conn_accepted(int conn_fd, const struct sockaddr_in6 * const client_addr,
+                                  ws_br_agent_trace_t * const trace);
+static void srv_process_msg(int conn_fd, const struct sockaddr_in6 * const client_addr,
+                            const uint8_t * const buf, size_t len, uint64_t start_us,
+                            ws_br_agent_trace_t * const trace);
+static int srv_listen_hnd(sd_event_source *s, int fd, uint32_t revents, void *userdata);
+static int srv_conn_io_hnd(sd_event_source *s, int fd, uint32_t revents, void *userdata);
+static int srv_conn_timeout_hnd(sd_event_source *s, uint64_t usec, void *userdata);
+static void srv_conn_close(srv_conn_t *conn);
+static void srv_data_received(size_t shard, bool changed);
+static ws_br_agent_ret_t srv_lookup_shard(const struct sockaddr_in6 * const clnt_addr,
+                                          size_t * const shard);
 static ws_br_agent_ret_t handle_topology_req(const ws_br_agent_msg_t *const req_msg,
-                                             const struct sockaddr_in6 * const clnt_addr);
+                                             const struct sockaddr_in6 * const clnt_addr,
+                                             ws_br_agent_trace_t * const trace,
+                                             size_t * const shard);
+static ws_br_agent_ret_t handle_node_stats_req(const ws_br_agent_msg_t *const req_msg,
+                                               const struct sockaddr_in6 * const clnt_addr,
+                                               size_t * const shard);
 static ws_br_agent_ret_t handle_set_config_params_req(const ws_br_agent_msg_t *const req_msg,
+                                                      const struct sockaddr_in6 * const clnt_addr,
+                                                      ws_br_agent_trace_t * const trace,
+                                                      size_t * const shard);
+static ws_br_agent_ret_t handle_get_config_params_req(const ws_br_agent_msg_t *const req_msg,
+                                                      int conn_fd,
                                                       const struct sockaddr_in6 * const clnt_addr);
-static ws_br_agent_ret_t handle_get_config_params_req(int conn_fd);
 
 ws_br_agent_ret_t ws_br_agent_srv_init(void)
 {
+  sd_event *event = ws_br_agent_event_get();
+
+  srv_thread_stop = 0;
+  listen_fd = srv_open_listen();
+  if (listen_fd < 0) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Event loop mode: the listen socket and client connections are loop sources
+  if (event != NULL) {
+    if (sd_event_add_io(event, &listen_source, listen_fd, EPOLLIN, srv_listen_hnd, NULL) < 0) {
+      ws_br_agent_log_error("Failed to add the server event source\n");
+      close(listen_fd);
+      listen_fd = -1;
+      return WS_BR_AGENT_RET_ERR;
+    }
+    return WS_BR_AGENT_RET_OK;
+  }
+
+  srv_stop_fd = eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (srv_stop_fd < 0) {
+    ws_br_agent_log_error("Failed to create the server stop event: %s\n", strerror(errno));
+    close(listen_fd);
+    listen_fd = -1;
+    return WS_BR_AGENT_RET_ERR;
+  }
+
   if (pthread_create(&srv_thr, NULL, (void *)srv_thr_fnc, NULL) != 0) {
+    close(srv_stop_fd);
+    srv_stop_fd = -1;
+    close(listen_fd);
+    listen_fd = -1;
     return WS_BR_AGENT_RET_ERR;
   }
   return WS_BR_AGENT_RET_OK;
@@ -71,19 +170,22 @@ ws_br_agent_ret_t ws_br_agent_srv_init(void)
 
 void ws_br_agent_srv_deinit(void)
 {
-  srv_thread_stop = 1;
-  // Connect to the listening socket to unblock accept()
-  struct sockaddr_in6 addr = {0};
-  int sock = socket(AF_INET6, SOCK_STREAM, 0);
-  if (sock >= 0) {
-    addr.sin6_family = AF_INET6;
-    addr.sin6_addr = in6addr_loopback;
-    addr.sin6_port = htons(WS_BR_AGENT_SERVICE_PORT);
-    connect(sock, (struct sockaddr *)&addr, sizeof(addr));
-    close(sock);
+  if (listen_source != NULL) {
+    listen_source = sd_event_source_disable_unref(listen_source);
+    close(listen_fd);
+    listen_fd = -1;
+    return;
   }
-  close(listen_fd);
+
+  if (srv_stop_fd < 0) {
+    return;
+  }
+  // Wake the thread up from its poll, whether it waits for a client or a message
+  srv_thread_stop = 1;
+  (void) eventfd_write(srv_stop_fd, 1U);
   pthread_join(srv_thr, NULL);
+  close(srv_stop_fd);
+  srv_stop_fd = -1;
 }
 
 static ssize_t recv_full_message(int fd, uint8_t *buf, size_t buf_capacity)
@@ -91,7 +193,7 @@ static ssize_t recv_full_message(int fd, uint8_t *buf, size_t buf_capacity)
   ssize_t received = 0;
   size_t expected_size = WS_BR_AGENT_MSG_MIN_BUF_SIZE;
   size_t required;
-  ws_br_agent_msg_len_t payload_len;
+  struct pollfd pfd[2];
   ssize_t r;
 
   if (buf_capacity < WS_BR_AGENT_MSG_MIN_BUF_SIZE) {
@@ -99,10 +201,23 @@ static ssize_t recv_full_message(int fd, uint8_t *buf, size_t buf_capacity)
     return -1;
   }
 
-  memset(buf, 0, buf_capacity);
-
+  // Only the received bytes are parsed, no need to clear the buffer
   while (received < (ssize_t)expected_size) {
-    // socket is non-blocking, so recv() will return immediately with r = -1 if no data is available
+    pfd[0].fd = fd;
+    pfd[0].events = POLLIN;
+    pfd[1].fd = srv_stop_fd;
+    pfd[1].events = POLLIN;
+    r = poll(pfd, 2U, (int)(SRV_CONN_TIMEOUT_US / 1000ULL));
+    if (r < 0) {
+      return -1;
+    } else if (!r) {
+      errno = ETIMEDOUT;
+      return -1;
+    } else if (pfd[1].revents & POLLIN) {
+      // Server stopping
+      errno = ECANCELED;
+      return -1;
+    }
     r = recv(fd, buf + received, buf_capacity - (size_t)received, 0);
     if (r <= 0) {
       return r;
@@ -110,8 +225,7 @@ static ssize_t recv_full_message(int fd, uint8_t *buf, size_t buf_capacity)
     received += r;
 
     if (received >= (ssize_t)WS_BR_AGENT_MSG_MIN_BUF_SIZE) {
-      payload_len = ntohl(*(uint32_t *)(buf + sizeof(ws_br_agent_msg_raw_code_t)));
-      required = WS_BR_AGENT_MSG_MIN_BUF_SIZE + (size_t)payload_len;
+      required = ws_br_agent_msg_frame_size(buf);
       if (required > buf_capacity) {
         errno = EMSGSIZE;
         return -1;
@@ -120,35 +234,35 @@ static ssize_t recv_full_message(int fd, uint8_t *buf, size_t buf_capacity)
     }
   }
 
+  // A corrupted frame is dropped before parsing
+  if (ws_br_agent_msg_check_crc(buf, (size_t)received) != WS_BR_AGENT_RET_OK) {
+    errno = EBADMSG;
+    return -1;
+  }
+
   return received;
 }
 
-static void srv_thr_fnc(void *arg)
+static int srv_open_listen(void)
 {
-
-  int conn_fd = -1L;
   struct sockaddr_in6 serv_addr = {0U};
-  struct sockaddr_in6 client_addr = {0U};
-  socklen_t client_len = sizeof(client_addr);
-  char client_ip[INET6_ADDRSTRLEN] = {0U};
-  static uint8_t buf[SRV_MAX_BUF_SIZE] = {0U};
-  ssize_t r = 0L;
-  ws_br_agent_msg_t *msg = NULL;
-  ws_br_agent_soc_host_topology_t topology = {0U, NULL};
-  struct pollfd pfd = {0};
+  int optval = 1;
+  int fd = -1;
 
-  (void)arg;
-  ws_br_agent_log_warn("Server thread started\n");
+  // Socket activation: the kernel already queues the connections received during start-up
+  fd = ws_br_agent_service_get_listen_fd(WS_BR_AGENT_SERVICE_PORT);
+  if (fd >= 0) {
+    return fd;
+  }
 
-  listen_fd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK, 0);
-  if (listen_fd < 0)
+  fd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0)
   {
     ws_br_agent_log_error("Server socket creation failed\n");
-    return;
+    return -1;
   }
 
-  int optval = 1;
-  if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) < 0) {
+  if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) < 0) {
     ws_br_agent_log_warn("Failed to set SO_REUSEADDR\n");
   }
 
@@ -156,46 +270,203 @@ static void srv_thr_fnc(void *arg)
   serv_addr.sin6_addr = in6addr_any;
   serv_addr.sin6_port = htons(WS_BR_AGENT_SERVICE_PORT);
 
-  if (bind(listen_fd, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0)
+  if (bind(fd, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0)
   {
     ws_br_agent_log_error("Server bind failed\n");
-    close(listen_fd);
-    return;
+    close(fd);
+    return -1;
   }
 
-  if (listen(listen_fd, 5) < 0)
+  if (listen(fd, 5) < 0)
   {
     ws_br_agent_log_error("Server listen failed\n");
-    close(listen_fd);
-    return;
+    close(fd);
+    return -1;
   }
   
   ws_br_agent_log_info("Server listening on port %u\n", WS_BR_AGENT_SERVICE_PORT);
+  return fd;
+}
+
+static uint64_t srv_conn_accepted(int conn_fd, const struct sockaddr_in6 * const client_addr,
+                                  ws_br_agent_trace_t * const trace)
+{
+  char client_ip[INET6_ADDRSTRLEN] = {0U};
+  ws_br_agent_log_fields_t fields = WS_BR_AGENT_LOG_FIELDS_INIT;
+  uint64_t start_us = ws_br_agent_utils_get_monotonic_us();
+
+  ws_br_agent_trace_start(trace, start_us);
+  ws_br_agent_probe2(accept, conn_fd, trace->id);
+  inet_ntop(AF_INET6, &client_addr->sin6_addr, client_ip, sizeof(client_ip));
+  fields.peer_addr = client_ip;
+  ws_br_agent_log_info_fields(&fields, "Accepted connection from %s:%d\n", 
+                              client_ip, ntohs(client_addr->sin6_port));
+  return start_us;
+}
+
+static void srv_process_msg(int conn_fd, const struct sockaddr_in6 * const client_addr,
+                            const uint8_t * const buf, size_t len, uint64_t start_us,
+                            ws_br_agent_trace_t * const trace)
+{
+  char client_ip[INET6_ADDRSTRLEN] = {0U};
+  ws_br_agent_msg_t *msg = NULL;
+  ws_br_agent_log_fields_t fields = WS_BR_AGENT_LOG_FIELDS_INIT;
+  size_t shard = WS_BR_AGENT_SOC_HOST_PRIMARY;
+
+  inet_ntop(AF_INET6, &client_addr->sin6_addr, client_ip, sizeof(client_ip));
+  fields.peer_addr = client_ip;
+
+  ws_br_agent_trace_stamp(trace, WS_BR_AGENT_TRACE_STAGE_RECV);
+  ws_br_agent_probe2(recv_done, conn_fd, len);
+  ws_br_agent_capture_record(WS_BR_AGENT_CAPTURE_DIR_IN, WS_BR_AGENT_CAPTURE_CHANNEL_SRV,
+                             client_addr, buf, len);
+  ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_RX_BYTES, (uint64_t)len);
+
+  msg = ws_br_agent_msg_parse_buf(buf, len);
+  if (msg == NULL) {
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_PARSE_FAILURES, 1U);
+    ws_br_agent_log_warn("Failed to parse received message\n");
+    return;
+  }
+
+  trace->msg_code = msg->msg_code;
+  ws_br_agent_trace_stamp(trace, WS_BR_AGENT_TRACE_STAGE_PARSE);
+  ws_br_agent_metrics_inc_rx_msg(msg->msg_code);
+
+  // Print message
+  ws_br_agent_utils_print_msg(msg);
+
+  // Handle requests
+  ws_br_agent_probe2(dispatch, msg->msg_code, msg->payload_len);
+  switch (msg->msg_code) {
+  // Handle topology request
+  case WS_BR_AGENT_MSG_CODE_TOPOLOGY:
+    if (handle_topology_req(msg, client_addr, trace, &shard) != WS_BR_AGENT_RET_OK) {
+      break;
+    }
+    srv_data_received(shard, trace->changed);
+    if (!trace->changed) {
+      ws_br_agent_log_debug("Topology unchanged, nothing to notify\n");
+      break;
+    }
+    if (ws_br_agent_dbus_notify_topology_changed(shard, trace) != WS_BR_AGENT_RET_OK) {
+      ws_br_agent_log_error("Failed to notify topology changed via D-Bus\n");
+    }
+    ws_br_agent_trace_stamp(trace, WS_BR_AGENT_TRACE_STAGE_EMIT);
+    break;
+
+  // Handle set config request: Used for subscription
+  case WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS:
+    if (handle_set_config_params_req(msg, client_addr, trace, &shard) != WS_BR_AGENT_RET_OK) {
+      break;
+    }
+    srv_data_received(shard, trace->changed);
+    if (!trace->changed) {
+      ws_br_agent_log_debug("Settings unchanged, nothing to notify\n");
+      break;
+    }
+    if (ws_br_agent_dbus_notify_settings_changed(shard, trace) != WS_BR_AGENT_RET_OK) {
+      ws_br_agent_log_error("Failed to notify settings changed via D-Bus\n");
+    }
+    ws_br_agent_trace_stamp(trace, WS_BR_AGENT_TRACE_STAGE_EMIT);
+    break;
+
+  // Handle node metrics: polled over D-Bus, not signaled
+  case WS_BR_AGENT_MSG_CODE_NODE_STATS:
+    if (handle_node_stats_req(msg, client_addr, &shard) == WS_BR_AGENT_RET_OK) {
+      srv_data_received(shard, false);
+    }
+    break;
+
+  // Not handled requests
+  case WS_BR_AGENT_MSG_CODE_GET_CONFIG_PARAMS:
+    (void) handle_get_config_params_req(msg, conn_fd, client_addr);
+    break;
+  
+  case WS_BR_AGENT_MSG_CODE_RESTART_BR:
+  case WS_BR_AGENT_MSG_CODE_STOP_BR:
+    ws_br_agent_log_warn("Not handled request: '%s' (0x%08x)\n",
+                          ws_br_agent_utils_val_to_str(msg->msg_code, 
+                                                       ws_br_agent_msg_code_strs, 
+                                                       "Unknown"), msg->msg_code);
+    break;
+  default:
+    ws_br_agent_log_warn("Unknown request: (0x%08x)\n", msg->msg_code);
+    break;
+  }
+
+  ws_br_agent_trace_finish(trace);
+
+  fields.msg_code = msg->msg_code;
+  if (msg->msg_code == WS_BR_AGENT_MSG_CODE_TOPOLOGY) {
+    fields.entry_count = msg->payload_len / sizeof(ws_br_agent_soc_host_topology_entry_t);
+  }
+  if (msg->msg_code == WS_BR_AGENT_MSG_CODE_NODE_STATS) {
+    fields.entry_count = msg->payload_len / sizeof(ws_br_agent_node_stats_entry_t);
+  }
+  if (msg->msg_code == WS_BR_AGENT_MSG_CODE_TOPOLOGY
+      || msg->msg_code == WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS) {
+    fields.trace_id = (int64_t)trace->id;
+  }
+  fields.latency_us = (int64_t)(ws_br_agent_utils_get_monotonic_us() - start_us);
+  ws_br_agent_metrics_observe(WS_BR_AGENT_METRIC_HIST_HANDLER_LATENCY, (uint64_t)fields.latency_us);
+  ws_br_agent_probe3(dispatch_done, msg->msg_code, trace->id, fields.latency_us);
+  ws_br_agent_log_info_fields(&fields, "Handled '%s' request from %s in %lld us\n",
+                              ws_br_agent_utils_val_to_str(msg->msg_code, 
+                                                           ws_br_agent_msg_code_strs, 
+                                                           "Unknown"),
+                              client_ip, (long long)fields.latency_us);
+
+  // Free message
+  ws_br_agent_msg_free(msg);
+}
+
+static void srv_thr_fnc(void *arg)
+{
+  int conn_fd = -1L;
+  struct sockaddr_in6 client_addr = {0U};
+  socklen_t client_len = sizeof(client_addr);
+  static uint8_t buf[SRV_MAX_BUF_SIZE] = {0U};
+  ssize_t r = 0L;
+  struct pollfd pfd[2] = {0};
+  uint64_t start_us = 0ULL;
+  ws_br_agent_trace_t trace = { 0U };
+
+  (void)arg;
+  ws_br_agent_log_warn("Server thread started\n");
+  ws_br_agent_service_watchdog_start(WS_BR_AGENT_SERVICE_LOOP_SRV);
 
   while (!srv_thread_stop) {
+    ws_br_agent_service_watchdog_kick(WS_BR_AGENT_SERVICE_LOOP_SRV);
     
-    pfd.fd = listen_fd;
-    pfd.events = POLLIN;
+    pfd[0].fd = listen_fd;
+    pfd[0].events = POLLIN;
+    pfd[1].fd = srv_stop_fd;
+    pfd[1].events = POLLIN;
     
-    // Poll with timeout to check srv_thread_stop
-    r = poll(&pfd, 1, 100);
+    // Sleep until a client connects, deinit wakes the thread up or the watchdog is due
+    r = poll(pfd, 2U, ws_br_agent_service_watchdog_interval_ms());
     
     if (r < 0) {
-      if (errno == EINTR && srv_thread_stop) {
-        break;
+      if (errno == EINTR) {
+        continue;
       }
       ws_br_agent_log_error("Poll failed: %s\n", strerror(errno));
       continue;
     }
     
     if (!r) {
-      // Timeout - continue to check srv_thread_stop
       continue;
     }
     
-    if (!(pfd.revents & POLLIN)) {
+    if (pfd[1].revents & POLLIN) {
+      break;
+    }
+    
+    if (!(pfd[0].revents & POLLIN)) {
       continue;
     }
+    client_len = sizeof(client_addr);
     conn_fd = accept(listen_fd, (struct sockaddr *)&client_addr, &client_len);
     if (conn_fd < 0) {
       if (errno == EAGAIN || errno == EWOULDBLOCK) {
@@ -208,8 +479,7 @@ static void srv_thr_fnc(void *arg)
       continue;
     }
     
-    inet_ntop(AF_INET6, &client_addr.sin6_addr, client_ip, sizeof(client_ip));
-    ws_br_agent_log_info("Accepted connection from %s:%d\n", client_ip, ntohs(client_addr.sin6_port));
+    start_us = srv_conn_accepted(conn_fd, &client_addr, &trace);
 
     r = recv_full_message(conn_fd, buf, SRV_MAX_BUF_SIZE);
     if (r < 0) {
@@ -223,66 +493,167 @@ static void srv_thr_fnc(void *arg)
       continue;
     }
 
-    msg = ws_br_agent_msg_parse_buf(buf, (size_t)r);
-    if (msg == NULL) {
-      ws_br_agent_log_warn("Failed to parse received message\n");
-      close(conn_fd);
-      continue;
+    srv_process_msg(conn_fd, &client_addr, buf, (size_t)r, start_us, &trace);
+    close(conn_fd);
+  }
+  ws_br_agent_service_watchdog_stop(WS_BR_AGENT_SERVICE_LOOP_SRV);
+  close(listen_fd);
+  ws_br_agent_log_warn("Server thread stopped\n");
+}
+
+static int srv_listen_hnd(sd_event_source *s, int fd, uint32_t revents, void *userdata)
+{
+  struct sockaddr_in6 client_addr = {0U};
+  socklen_t client_len = sizeof(client_addr);
+  srv_conn_t *conn = NULL;
+  int conn_fd = -1;
+
+  (void) s;
+  (void) revents;
+  (void) userdata;
+
+  conn_fd = accept(fd, (struct sockaddr *)&client_addr, &client_len);
+  if (conn_fd < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      ws_br_agent_log_warn("Accept failed: %s\n", strerror(errno));
     }
+    return 0;
+  }
+  (void) fcntl(conn_fd, F_SETFL, fcntl(conn_fd, F_GETFL) | O_NONBLOCK);
 
-    // Print message
-    ws_br_agent_utils_print_msg(msg);
+  conn = (srv_conn_t *)ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_SRV, sizeof(srv_conn_t));
+  if (conn == NULL) {
+    ws_br_agent_log_warn("Connection dropped: Memory allocation failed\n");
+    close(conn_fd);
+    return 0;
+  }
+  memset(conn, 0, sizeof(srv_conn_t));
+  conn->fd = conn_fd;
+  conn->addr = client_addr;
+  conn->expected = WS_BR_AGENT_MSG_MIN_BUF_SIZE;
+  conn->start_us = srv_conn_accepted(conn_fd, &client_addr, &conn->trace);
+
+  if (sd_event_add_io(ws_br_agent_event_get(), &conn->io, conn_fd, EPOLLIN,
+                      srv_conn_io_hnd, conn) < 0
+      || sd_event_add_time_relative(ws_br_agent_event_get(), &conn->timer, CLOCK_MONOTONIC,
+                                    SRV_CONN_TIMEOUT_US, 0, srv_conn_timeout_hnd, conn) < 0) {
+    ws_br_agent_log_warn("Connection dropped: Event source creation failed\n");
+    srv_conn_close(conn);
+  }
+  return 0;
+}
 
-    // Handle requests
-    switch (msg->msg_code) {
-    // Handle topology request
-    case WS_BR_AGENT_MSG_CODE_TOPOLOGY:
-      if (handle_topology_req(msg, &client_addr) != WS_BR_AGENT_RET_OK) {
-        break;
-      }
-      if (ws_br_agent_dbus_notify_topology_changed() != WS_BR_AGENT_RET_OK) {
-        ws_br_agent_log_error("Failed to notify topology changed via D-Bus\n");
+static int srv_conn_io_hnd(sd_event_source *s, int fd, uint32_t revents, void *userdata)
+{
+  srv_conn_t *conn = (srv_conn_t *)userdata;
+  uint8_t *dst = NULL;
+  ssize_t r = 0;
+
+  (void) s;
+  (void) revents;
+
+  // Header first, then the whole message in a buffer sized from the header
+  while (conn->received < conn->expected) {
+    dst = conn->buf != NULL ? conn->buf : conn->hdr;
+    r = recv(fd, dst + conn->received, conn->expected - conn->received, 0);
+    if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      return 0;
+    }
+    if (r <= 0) {
+      if (r < 0) {
+        ws_br_agent_log_warn("Receive failed: %s\n", strerror(errno));
+      } else {
+        ws_br_agent_log_warn("Connection closed by client\n");
       }
-      break;
-
-    // Handle set config request: Used for subscription
-    case WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS:
-      if (handle_set_config_params_req(msg, &client_addr) != WS_BR_AGENT_RET_OK) {
-        break;
+      srv_conn_close(conn);
+      return 0;
+    }
+    conn->received += (size_t)r;
+
+    if (conn->buf == NULL && conn->received == WS_BR_AGENT_MSG_MIN_BUF_SIZE) {
+      conn->expected = ws_br_agent_msg_frame_size(conn->hdr);
+      if (conn->expected > SRV_MAX_BUF_SIZE) {
+        ws_br_agent_log_warn("Receive failed: %s\n", strerror(EMSGSIZE));
+        srv_conn_close(conn);
+        return 0;
       }
-      if (ws_br_agent_dbus_notify_settings_changed() != WS_BR_AGENT_RET_OK) {
-        ws_br_agent_log_error("Failed to notify settings changed via D-Bus\n");
+      conn->buf = (uint8_t *)ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_SRV, conn->expected);
+      if (conn->buf == NULL) {
+        ws_br_agent_log_warn("Connection dropped: Memory allocation failed\n");
+        srv_conn_close(conn);
+        return 0;
       }
-      break;
+      memcpy(conn->buf, conn->hdr, WS_BR_AGENT_MSG_MIN_BUF_SIZE);
+    }
+  }
 
-    // Not handled requests
-    case WS_BR_AGENT_MSG_CODE_GET_CONFIG_PARAMS:
-      (void) handle_get_config_params_req(conn_fd);
-      break;
-    
-    case WS_BR_AGENT_MSG_CODE_RESTART_BR:
-    case WS_BR_AGENT_MSG_CODE_STOP_BR:
-      ws_br_agent_log_warn("Not handled request: '%s' (0x%08x)\n",
-                            ws_br_agent_utils_val_to_str(msg->msg_code, 
-                                                         ws_br_agent_msg_code_strs, 
-                                                         "Unknown"), msg->msg_code);
-      break;
-    default:
-      ws_br_agent_log_warn("Unknown request: (0x%08x)\n", msg->msg_code);
-      break;
+  // A corrupted frame is dropped before parsing
+  if (ws_br_agent_msg_check_crc(conn->buf, conn->received) != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_warn("Receive failed: %s\n", strerror(EBADMSG));
+    srv_conn_close(conn);
+    return 0;
+  }
+
+  srv_process_msg(fd, &conn->addr, conn->buf, conn->received, conn->start_us, &conn->trace);
+  srv_conn_close(conn);
+  return 0;
+}
+
+static int srv_conn_timeout_hnd(sd_event_source *s, uint64_t usec, void *userdata)
+{
+  (void) s;
+  (void) usec;
+
+  ws_br_agent_log_warn("Receive failed: %s\n", strerror(ETIMEDOUT));
+  srv_conn_close((srv_conn_t *)userdata);
+  return 0;
+}
+
+static void srv_conn_close(srv_conn_t *conn)
+{
+  (void) sd_event_source_disable_unref(conn->io);
+  (void) sd_event_source_disable_unref(conn->timer);
+  close(conn->fd);
+  ws_br_agent_mem_free(conn->buf);
+  ws_br_agent_mem_free(conn);
+}
+
+/// Fresh data from a SoC: ends its warm-start stale period and schedules a state save
+static void srv_data_received(size_t shard, bool changed)
+{
+  bool was_stale = ws_br_agent_soc_host_shard_set_stale(shard, false);
+
+  if (was_stale) {
+    ws_br_agent_metrics_add_gauge(WS_BR_AGENT_METRIC_STATE_STALE, -1);
+    if (ws_br_agent_dbus_notify_stale_changed(shard) != WS_BR_AGENT_RET_OK) {
+      ws_br_agent_log_error("Failed to notify stale changed via D-Bus\n");
     }
+  }
+  if (changed || was_stale) {
+    ws_br_agent_state_save_later();
+  }
+}
 
-    // Free message
-    ws_br_agent_msg_free(msg);
+/// Find the shard of the sending SoC, adding it on first contact
+static ws_br_agent_ret_t srv_lookup_shard(const struct sockaddr_in6 * const clnt_addr,
+                                          size_t * const shard)
+{
+  bool created = false;
 
-    close(conn_fd);
+  if (ws_br_agent_soc_host_shard_lookup(&clnt_addr->sin6_addr, true, shard, &created)
+      != WS_BR_AGENT_RET_OK) {
+    return WS_BR_AGENT_RET_ERR;
   }
-  close(listen_fd);
-  ws_br_agent_log_warn("Server thread stopped\n");
+  if (created && ws_br_agent_dbus_notify_soc_added(*shard) != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_error("Failed to notify new SoC via D-Bus\n");
+  }
+  return WS_BR_AGENT_RET_OK;
 }
 
 static ws_br_agent_ret_t handle_topology_req(const ws_br_agent_msg_t *const req_msg,
-                                             const struct sockaddr_in6 * const clnt_addr)
+                                             const struct sockaddr_in6 * const clnt_addr,
+                                             ws_br_agent_trace_t * const trace,
+                                             size_t * const shard)
 {
   ws_br_agent_soc_host_topology_t topology = {0U, NULL};
 
@@ -292,40 +663,91 @@ static ws_br_agent_ret_t handle_topology_req(const ws_br_agent_msg_t *const req_
     return WS_BR_AGENT_RET_ERR;
   }
 
-  if (ws_br_agent_soc_host_set_remote_addr(clnt_addr) != WS_BR_AGENT_RET_OK) {
+  if (srv_lookup_shard(clnt_addr, shard) != WS_BR_AGENT_RET_OK) {
     ws_br_agent_log_error("Failed to set remote address\n");
     return WS_BR_AGENT_RET_ERR;
   }
+  ws_br_agent_soc_host_shard_set_crc(*shard, req_msg->crc);
 
   topology.entry_count = req_msg->payload_len / sizeof(ws_br_agent_soc_host_topology_entry_t);
   topology.entries = (ws_br_agent_soc_host_topology_entry_t *)req_msg->payload;
   ws_br_agent_log_info("Topology updated, total %u entries\n", topology.entry_count);
-  return ws_br_agent_soc_host_set_topology(&topology);
+  ws_br_agent_metrics_observe(WS_BR_AGENT_METRIC_HIST_TOPOLOGY_ENTRIES, topology.entry_count);
+  ws_br_agent_metrics_set(WS_BR_AGENT_METRIC_TOPOLOGY_ENTRIES, topology.entry_count);
+  return ws_br_agent_soc_host_shard_set_topology(*shard, &topology, trace);
+}
+
+static ws_br_agent_ret_t handle_node_stats_req(const ws_br_agent_msg_t *const req_msg,
+                                               const struct sockaddr_in6 * const clnt_addr,
+                                               size_t * const shard)
+{
+  uint32_t count = 0U;
+  uint32_t unknown = 0U;
+
+  if (clnt_addr == NULL || req_msg == NULL || req_msg->payload == NULL
+      || !req_msg->payload_len || req_msg->payload_len % sizeof(ws_br_agent_node_stats_entry_t)) {
+    ws_br_agent_log_error("Failed to handle NODE_STATS request\n");
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  if (srv_lookup_shard(clnt_addr, shard) != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_error("Failed to set remote address\n");
+    return WS_BR_AGENT_RET_ERR;
+  }
+  ws_br_agent_soc_host_shard_set_crc(*shard, req_msg->crc);
+
+  count = req_msg->payload_len / sizeof(ws_br_agent_node_stats_entry_t);
+  if (ws_br_agent_soc_host_shard_set_node_stats(*shard, (const ws_br_agent_node_stats_entry_t *)req_msg->payload,
+                                                count, &unknown) != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_error("Failed to store the node metrics\n");
+    return WS_BR_AGENT_RET_ERR;
+  }
+  ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_NODE_STATS_ENTRIES, count - unknown);
+  if (unknown) {
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_NODE_STATS_UNKNOWN, unknown);
+    ws_br_agent_log_debug("%u node metrics entries not in the topology\n", unknown);
+  }
+  ws_br_agent_log_info("Node metrics updated, %u entries\n", count);
+  return WS_BR_AGENT_RET_OK;
 }
 
 static ws_br_agent_ret_t handle_set_config_params_req(const ws_br_agent_msg_t *const req_msg,
-                                                      const struct sockaddr_in6 * const clnt_addr)
+                                                      const struct sockaddr_in6 * const clnt_addr,
+                                                      ws_br_agent_trace_t * const trace,
+                                                      size_t * const shard)
 {
   ws_br_agent_settings_t settings = { 0U };
+  ws_br_agent_msg_settings_enc_t enc = ws_br_agent_msg_get_settings_enc(req_msg);
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_ERR;
 
   if (clnt_addr == NULL || req_msg == NULL || req_msg->payload == NULL 
-      || req_msg->payload_len != sizeof(ws_br_agent_settings_t)) {
+      || (enc == WS_BR_AGENT_MSG_SETTINGS_ENC_LEGACY
+          && req_msg->payload_len != sizeof(ws_br_agent_settings_t))) {
     ws_br_agent_log_error("Bad SET_CONFIG_PARAMS request\n");
     return WS_BR_AGENT_RET_ERR;
   }
 
   
-  if (ws_br_agent_soc_host_set_remote_addr(clnt_addr) != WS_BR_AGENT_RET_OK) {
+  if (srv_lookup_shard(clnt_addr, shard) != WS_BR_AGENT_RET_OK) {
     ws_br_agent_log_error("Failed to set remote address\n");
     return WS_BR_AGENT_RET_ERR;
   }
+  ws_br_agent_soc_host_shard_set_crc(*shard, req_msg->crc);
   
-  if (ws_br_agent_soc_host_set_settings((ws_br_agent_settings_t *)req_msg->payload) 
-      != WS_BR_AGENT_RET_OK) {
+  // TLV settings only carry the fields to update
+  if (enc == WS_BR_AGENT_MSG_SETTINGS_ENC_TLV) {
+    ret = ws_br_agent_soc_host_shard_update_settings_tlv(*shard, req_msg->payload,
+                                                         req_msg->payload_len, trace);
+  } else {
+    memcpy(&settings, req_msg->payload, sizeof(ws_br_agent_settings_t));
+    ret = ws_br_agent_soc_host_shard_set_settings(*shard, &settings, trace);
+  }
+  if (ret != WS_BR_AGENT_RET_OK) {
     ws_br_agent_log_error("Failed to set host settings\n");
     return WS_BR_AGENT_RET_ERR;
   }
-  if (ws_br_agent_soc_host_get_settings(&settings) != WS_BR_AGENT_RET_OK) {
+  ws_br_agent_soc_host_shard_set_settings_enc(*shard, enc);
+  if (ws_br_agent_soc_host_shard_get_settings(*shard, &settings) != WS_BR_AGENT_RET_OK) {
     ws_br_agent_log_error("Failed to check host settings\n");
     return WS_BR_AGENT_RET_ERR;
   }
@@ -337,30 +759,53 @@ static ws_br_agent_ret_t handle_set_config_params_req(const ws_br_agent_msg_t *c
   return WS_BR_AGENT_RET_OK;
 }
 
-static ws_br_agent_ret_t handle_get_config_params_req(int conn_fd)
+static ws_br_agent_ret_t handle_get_config_params_req(const ws_br_agent_msg_t *const req_msg,
+                                                      int conn_fd,
+                                                      const struct sockaddr_in6 * const clnt_addr)
 {
   uint8_t *buf = NULL;
   size_t buf_size = 0U;
+  size_t shard = WS_BR_AGENT_SOC_HOST_PRIMARY;
+  uint8_t payload[WS_BR_AGENT_SETTINGS_TLV_MAX_SIZE];
+  size_t payload_len = 0U;
+  ws_br_agent_msg_settings_enc_t enc = ws_br_agent_msg_get_settings_enc(req_msg);
   ws_br_agent_msg_t msg = { 
     .msg_code = WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS,
     .payload_len = 0U,
-    .payload = NULL
+    .payload = NULL,
+    .crc = req_msg->crc
   };
 
+  // Settings of the requesting SoC, the primary ones for an unknown SoC.
+  // A TLV header as request payload selects the TLV encoding, the response mirrors the CRC32C trailer.
+  if (ws_br_agent_soc_host_shard_lookup(&clnt_addr->sin6_addr, false, &shard, NULL)
+      == WS_BR_AGENT_RET_OK) {
+    ws_br_agent_soc_host_shard_set_settings_enc(shard, enc);
+    ws_br_agent_soc_host_shard_set_crc(shard, req_msg->crc);
+  }
+  if (ws_br_agent_soc_host_shard_encode_settings(shard, enc, NULL, 0U, payload, sizeof(payload),
+                                                 &payload_len) == WS_BR_AGENT_RET_OK) {
+    msg.payload = payload;
+    msg.payload_len = (ws_br_agent_msg_len_t)payload_len;
+  }
+
   buf = ws_br_agent_msg_build_buf(&msg, &buf_size);
 
-  if (buf == NULL || buf_size != WS_BR_AGENT_MSG_SET_PARAM_MSG_BUF_SIZE) {
+  if (buf == NULL || buf_size < WS_BR_AGENT_MSG_MIN_BUF_SIZE) {
     ws_br_agent_log_error("Failed to build SET_CONFIG_PARAMS as response\n");
     return WS_BR_AGENT_RET_ERR;
   }
 
   if (send(conn_fd, buf, buf_size, 0) < 0) {
     ws_br_agent_log_error("Failed to send SET_CONFIG_PARAMS as response\n");
-    free(buf);
+    ws_br_agent_msg_free_buf(buf);
     return WS_BR_AGENT_RET_ERR;
   }
 
-  free(buf);
+  ws_br_agent_capture_record(WS_BR_AGENT_CAPTURE_DIR_OUT, WS_BR_AGENT_CAPTURE_CHANNEL_SRV,
+                             clnt_addr, buf, buf_size);
+  ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_TX_BYTES, buf_size);
+  ws_br_agent_msg_free_buf(buf);
 
   return WS_BR_AGENT_RET_OK;
 }
@@ -0,0 +1,443 @@
+/***************************************************************************//**
+ * @file ws_br_agent_state.c
+ * @brief Wi-SUN SoC Border Router Agent warm-start state persistence
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "state"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_utils.h"
+#include "ws_br_agent_soc_host.h"
+#include "ws_br_agent_metrics.h"
+#include "ws_br_agent_event.h"
+#include "ws_br_agent_service.h"
+#include "ws_br_agent_state.h"
+
+/// State file magic ("WSBS")
+#define STATE_MAGIC 0x57534253UL
+/// Temporary file suffix, renamed over the state file once complete
+#define STATE_TMP_SUFFIX ".tmp"
+
+/// @brief State file header, followed by one record per SoC, primary SoC first
+typedef struct __attribute__((packed)) state_hdr {
+  /// STATE_MAGIC
+  uint32_t magic;
+  /// WS_BR_AGENT_STATE_VERSION
+  uint16_t version;
+  /// Header size
+  uint16_t hdr_size;
+  /// Settings size, sizeof(ws_br_agent_settings_t) when written
+  uint32_t settings_size;
+  /// Topology entry size
+  uint32_t entry_size;
+  /// SoC record count
+  uint32_t soc_count;
+  /// Reserved, 0
+  uint32_t reserved;
+  /// Save time (seconds since the Epoch)
+  uint64_t saved_time;
+} state_hdr_t;
+
+/// @brief SoC record header, followed by the settings and the topology entries
+typedef struct __attribute__((packed)) state_soc_hdr {
+  /// SoC IPv6 address
+  uint8_t soc_addr[16];
+  /// Topology entry count
+  uint32_t entry_count;
+  /// Reserved, 0
+  uint32_t reserved;
+} state_soc_hdr_t;
+
+static char state_path[256] = { 0 };
+static char state_tmp_path[sizeof(state_path) + sizeof(STATE_TMP_SUFFIX)] = { 0 };
+static atomic_bool state_dirty = false;
+static uint64_t last_save_us = 0ULL;
+/// Topology snapshots of each SoC, their capacity is reused by the next save
+static ws_br_agent_soc_host_topology_t snapshots[WS_BR_AGENT_SOC_HOST_MAX_COUNT];
+
+static pthread_t state_thr;
+static volatile sig_atomic_t state_thread_stop = 0;
+/// Wakes the writer thread up to save or to stop (eventfd)
+static int state_wakeup_fd = -1;
+/// Pending save timer (event loop mode)
+static sd_event_source *save_source = NULL;
+
+static void state_restore(void);
+static ws_br_agent_ret_t state_save(void);
+static uint64_t state_save_delay_us(void);
+static void state_thr_fnc(void *arg);
+static int state_save_hnd(sd_event_source *s, uint64_t usec, void *userdata);
+
+ws_br_agent_ret_t ws_br_agent_state_init(const char *path)
+{
+  char dir[sizeof(state_path)];
+  char *sep = NULL;
+
+  if (path == NULL) {
+    ws_br_agent_log_info("State persistence disabled\n");
+    return WS_BR_AGENT_RET_OK;
+  }
+  if (strlen(path) >= sizeof(state_path)) {
+    ws_br_agent_log_error("State file path too long: %s\n", path);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  snprintf(state_path, sizeof(state_path), "%s", path);
+  snprintf(state_tmp_path, sizeof(state_tmp_path), "%s" STATE_TMP_SUFFIX, path);
+
+  // Create the state directory if needed (systemd creates it with StateDirectory=)
+  snprintf(dir, sizeof(dir), "%s", path);
+  sep = strrchr(dir, '/');
+  if (sep != NULL && sep != dir) {
+    *sep = '\0';
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+      ws_br_agent_log_warn("Failed to create %s: %s\n", dir, strerror(errno));
+    }
+  }
+
+  state_restore();
+
+  // Event loop mode: saves are timer sources of the loop
+  if (ws_br_agent_event_get() != NULL) {
+    return WS_BR_AGENT_RET_OK;
+  }
+
+  state_wakeup_fd = eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (state_wakeup_fd < 0) {
+    ws_br_agent_log_error("Failed to create the state wakeup event: %s\n", strerror(errno));
+    return WS_BR_AGENT_RET_ERR;
+  }
+  state_thread_stop = 0;
+  if (pthread_create(&state_thr, NULL, (void *)state_thr_fnc, NULL) != 0) {
+    ws_br_agent_log_error("Failed to create state thread\n");
+    close(state_wakeup_fd);
+    state_wakeup_fd = -1;
+    return WS_BR_AGENT_RET_ERR;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+void ws_br_agent_state_deinit(void)
+{
+  if (!state_path[0]) {
+    return;
+  }
+
+  if (state_wakeup_fd >= 0) {
+    state_thread_stop = 1;
+    (void) eventfd_write(state_wakeup_fd, 1U);
+    pthread_join(state_thr, NULL);
+    close(state_wakeup_fd);
+    state_wakeup_fd = -1;
+  }
+  save_source = sd_event_source_disable_unref(save_source);
+
+  // Do not lose the updates received during the last save interval
+  if (atomic_exchange(&state_dirty, false)) {
+    (void) state_save();
+  }
+  for (size_t i = 0U; i < WS_BR_AGENT_SOC_HOST_MAX_COUNT; ++i) {
+    (void) ws_br_agent_soc_host_free_topology(&snapshots[i]);
+  }
+  state_path[0] = '\0';
+}
+
+void ws_br_agent_state_save_later(void)
+{
+  sd_event *event = ws_br_agent_event_get();
+
+  if (!state_path[0] || atomic_exchange(&state_dirty, true)) {
+    // Disabled, or a save is already pending
+    return;
+  }
+
+  if (event == NULL) {
+    (void) eventfd_write(state_wakeup_fd, 1U);
+    return;
+  }
+  if (sd_event_add_time_relative(event, &save_source, CLOCK_MONOTONIC, state_save_delay_us(),
+                                 0, state_save_hnd, NULL) < 0) {
+    ws_br_agent_log_warn("Failed to schedule the state save\n");
+    atomic_store(&state_dirty, false);
+  }
+}
+
+static void state_restore(void)
+{
+  struct stat st = { 0 };
+  const uint8_t *map = NULL;
+  const uint8_t *rec = NULL;
+  state_hdr_t hdr = { 0 };
+  state_soc_hdr_t soc_hdr = { 0 };
+  ws_br_agent_settings_t settings = { 0 };
+  ws_br_agent_soc_host_topology_t topology = { 0U, NULL };
+  struct sockaddr_in6 addr = { .sin6_family = AF_INET6 };
+  char addr_str[INET6_ADDRSTRLEN] = { 0 };
+  size_t rec_size = 0U;
+  size_t left = 0U;
+  size_t shard = 0U;
+  uint32_t restored = 0U;
+  uint32_t i = 0U;
+  time_t now = time(NULL);
+  int fd = -1;
+
+  fd = open(state_path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      ws_br_agent_log_info("No saved state in %s\n", state_path);
+    } else {
+      ws_br_agent_log_warn("Failed to open %s: %s\n", state_path, strerror(errno));
+    }
+    return;
+  }
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(state_hdr_t)) {
+    ws_br_agent_log_warn("Ignoring truncated state file %s\n", state_path);
+    close(fd);
+    return;
+  }
+  map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    ws_br_agent_log_warn("Failed to map %s: %s\n", state_path, strerror(errno));
+    return;
+  }
+
+  // Fields are copied out of the mapping, nothing relies on its alignment
+  memcpy(&hdr, map, sizeof(hdr));
+  if (hdr.magic != STATE_MAGIC
+      || hdr.version != WS_BR_AGENT_STATE_VERSION
+      || hdr.hdr_size != sizeof(state_hdr_t)
+      || hdr.settings_size != sizeof(ws_br_agent_settings_t)
+      || hdr.entry_size != sizeof(ws_br_agent_soc_host_topology_entry_t)
+      || hdr.soc_count > WS_BR_AGENT_SOC_HOST_MAX_COUNT) {
+    ws_br_agent_log_warn("Ignoring incompatible state file %s (version %u)\n",
+                         state_path, hdr.version);
+    (void) munmap((void *)map, (size_t)st.st_size);
+    return;
+  }
+
+  // Check every record fits before restoring anything
+  rec = map + sizeof(state_hdr_t);
+  left = (size_t)st.st_size - sizeof(state_hdr_t);
+  for (i = 0U; i < hdr.soc_count; ++i) {
+    if (left < sizeof(state_soc_hdr_t) + sizeof(ws_br_agent_settings_t)) {
+      break;
+    }
+    memcpy(&soc_hdr, rec, sizeof(soc_hdr));
+    rec_size = sizeof(state_soc_hdr_t) + sizeof(ws_br_agent_settings_t)
+               + (size_t)soc_hdr.entry_count * sizeof(ws_br_agent_soc_host_topology_entry_t);
+    if (soc_hdr.entry_count > WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES || rec_size > left) {
+      break;
+    }
+    rec += rec_size;
+    left -= rec_size;
+  }
+  if (i != hdr.soc_count || left) {
+    ws_br_agent_log_warn("Ignoring corrupted state file %s\n", state_path);
+    (void) munmap((void *)map, (size_t)st.st_size);
+    return;
+  }
+
+  rec = map + sizeof(state_hdr_t);
+  for (i = 0U; i < hdr.soc_count; ++i) {
+    memcpy(&soc_hdr, rec, sizeof(soc_hdr));
+    memcpy(&settings, rec + sizeof(state_soc_hdr_t), sizeof(settings));
+    memcpy(&addr.sin6_addr, soc_hdr.soc_addr, sizeof(soc_hdr.soc_addr));
+    // Topology entries are byte aligned and copied by the SoC host module
+    topology.entry_count = soc_hdr.entry_count;
+    topology.entries = (ws_br_agent_soc_host_topology_entry_t *)(rec + sizeof(state_soc_hdr_t)
+                                                                + sizeof(ws_br_agent_settings_t));
+    rec += sizeof(state_soc_hdr_t) + sizeof(ws_br_agent_settings_t)
+           + (size_t)soc_hdr.entry_count * sizeof(ws_br_agent_soc_host_topology_entry_t);
+
+    // Records are in shard order: the first one takes the primary shard over
+    if (ws_br_agent_soc_host_shard_lookup(&addr.sin6_addr, true, &shard, NULL)
+        != WS_BR_AGENT_RET_OK) {
+      continue;
+    }
+    (void) ws_br_agent_soc_host_shard_set_settings(shard, &settings, NULL);
+    if (topology.entry_count) {
+      (void) ws_br_agent_soc_host_shard_set_topology(shard, &topology, NULL);
+    }
+    (void) ws_br_agent_soc_host_shard_set_stale(shard, true);
+    ++restored;
+
+    inet_ntop(AF_INET6, &addr.sin6_addr, addr_str, sizeof(addr_str));
+    ws_br_agent_log_info("Restored stale state saved %llds ago: SoC %s, %u topology entries\n",
+                         (long long)(now - (time_t)hdr.saved_time), addr_str,
+                         topology.entry_count);
+  }
+  (void) munmap((void *)map, (size_t)st.st_size);
+
+  ws_br_agent_metrics_set(WS_BR_AGENT_METRIC_TOPOLOGY_ENTRIES, topology.entry_count);
+  ws_br_agent_metrics_set(WS_BR_AGENT_METRIC_STATE_STALE, restored);
+}
+
+static ws_br_agent_ret_t state_save(void)
+{
+  ws_br_agent_soc_host_t hosts[WS_BR_AGENT_SOC_HOST_MAX_COUNT];
+  state_soc_hdr_t soc_hdrs[WS_BR_AGENT_SOC_HOST_MAX_COUNT];
+  struct iovec iov[1U + 3U * WS_BR_AGENT_SOC_HOST_MAX_COUNT];
+  state_hdr_t hdr = { 0 };
+  size_t count = ws_br_agent_soc_host_shard_count();
+  size_t expected_size = 0U;
+  size_t iov_count = 0U;
+  size_t i = 0U;
+  ssize_t r = 0;
+  int fd = -1;
+
+  last_save_us = ws_br_agent_utils_get_monotonic_us();
+
+  hdr.magic = STATE_MAGIC;
+  hdr.version = WS_BR_AGENT_STATE_VERSION;
+  hdr.hdr_size = sizeof(state_hdr_t);
+  hdr.settings_size = sizeof(ws_br_agent_settings_t);
+  hdr.entry_size = sizeof(ws_br_agent_soc_host_topology_entry_t);
+  hdr.soc_count = (uint32_t)count;
+  hdr.saved_time = (uint64_t)time(NULL);
+  iov[iov_count++] = (struct iovec) { .iov_base = &hdr, .iov_len = sizeof(hdr) };
+
+  // Each SoC is snapshotted under its own shard lock only
+  for (i = 0U; i < count; ++i) {
+    (void) ws_br_agent_soc_host_shard_get(i, &hosts[i]);
+    if (ws_br_agent_soc_host_shard_get_topology(i, &snapshots[i]) != WS_BR_AGENT_RET_OK) {
+      snapshots[i].entry_count = 0U;
+    }
+    memset(&soc_hdrs[i], 0, sizeof(soc_hdrs[i]));
+    memcpy(soc_hdrs[i].soc_addr, &hosts[i].remote_addr.sin6_addr, sizeof(soc_hdrs[i].soc_addr));
+    soc_hdrs[i].entry_count = snapshots[i].entry_count;
+
+    iov[iov_count++] = (struct iovec) { .iov_base = &soc_hdrs[i], .iov_len = sizeof(soc_hdrs[i]) };
+    iov[iov_count++] = (struct iovec) { .iov_base = &hosts[i].settings,
+                                        .iov_len = sizeof(hosts[i].settings) };
+    if (snapshots[i].entry_count) {
+      iov[iov_count++] = (struct iovec) { .iov_base = snapshots[i].entries,
+                                          .iov_len = snapshots[i].entry_count
+                                                     * sizeof(ws_br_agent_soc_host_topology_entry_t) };
+    }
+  }
+  for (i = 0U; i < iov_count; ++i) {
+    expected_size += iov[i].iov_len;
+  }
+
+  // Write a temporary file and rename it: readers see the old or the new state, never a mix
+  fd = open(state_tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    ws_br_agent_log_warn("Failed to save state: %s: %s\n", state_tmp_path, strerror(errno));
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_STATE_SAVE_FAILURES, 1U);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  r = writev(fd, iov, (int)iov_count);
+  if (r != (ssize_t)expected_size || fsync(fd) < 0) {
+    ws_br_agent_log_warn("Failed to save state: %s\n", r < 0 ? strerror(errno) : "short write");
+    close(fd);
+    (void) unlink(state_tmp_path);
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_STATE_SAVE_FAILURES, 1U);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  close(fd);
+  if (rename(state_tmp_path, state_path) < 0) {
+    ws_br_agent_log_warn("Failed to save state: %s: %s\n", state_path, strerror(errno));
+    (void) unlink(state_tmp_path);
+    ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_STATE_SAVE_FAILURES, 1U);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  ws_br_agent_metrics_add(WS_BR_AGENT_METRIC_STATE_SAVES, 1U);
+  ws_br_agent_log_debug("State saved (%zu SoCs)\n", count);
+  return WS_BR_AGENT_RET_OK;
+}
+
+/// Delay before the next save is allowed
+static uint64_t state_save_delay_us(void)
+{
+  uint64_t due_us = last_save_us + WS_BR_AGENT_STATE_SAVE_INTERVAL_MS * 1000ULL;
+  uint64_t now_us = ws_br_agent_utils_get_monotonic_us();
+
+  return last_save_us && due_us > now_us ? due_us - now_us : 0ULL;
+}
+
+static void state_thr_fnc(void *arg)
+{
+  struct pollfd pfd = { .fd = state_wakeup_fd, .events = POLLIN };
+  eventfd_t val = 0U;
+  uint64_t delay_us = 0ULL;
+  int timeout_ms = -1;
+
+  (void) arg;
+
+  ws_br_agent_service_watchdog_start(WS_BR_AGENT_SERVICE_LOOP_STATE);
+  while (!state_thread_stop) {
+    ws_br_agent_service_watchdog_kick(WS_BR_AGENT_SERVICE_LOOP_STATE);
+
+    // Sleep until an update, the end of the save interval, deinit or the watchdog
+    timeout_ms = ws_br_agent_service_watchdog_interval_ms();
+    if (atomic_load(&state_dirty)) {
+      delay_us = state_save_delay_us();
+      if (!delay_us) {
+        atomic_store(&state_dirty, false);
+        (void) state_save();
+        continue;
+      }
+      if (timeout_ms < 0 || (uint64_t)timeout_ms * 1000ULL > delay_us) {
+        timeout_ms = (int)((delay_us + 999ULL) / 1000ULL);
+      }
+    }
+    if (poll(&pfd, 1U, timeout_ms) > 0) {
+      (void) eventfd_read(state_wakeup_fd, &val);
+    }
+  }
+  ws_br_agent_service_watchdog_stop(WS_BR_AGENT_SERVICE_LOOP_STATE);
+}
+
+static int state_save_hnd(sd_event_source *s, uint64_t usec, void *userdata)
+{
+  (void) s;
+  (void) usec;
+  (void) userdata;
+
+  save_source = sd_event_source_disable_unref(save_source);
+  atomic_store(&state_dirty, false);
+  (void) state_save();
+  return 0;
+}
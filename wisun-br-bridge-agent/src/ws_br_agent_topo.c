@@ -0,0 +1,536 @@
+/***************************************************************************//**
+ * @file ws_br_agent_topo.c
+ * @brief Struct-of-arrays topology store with interned prefixes
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+
+#include <string.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "topo"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_mem.h"
+#include "ws_br_agent_addr.h"
+#include "ws_br_agent_topo.h"
+
+/// Initial room for the external parents
+#define TOPO_ADDR_SLACK(node_count) ((node_count) / 8U + 8U)
+
+/// Initial prefix capacity
+#define TOPO_PREFIX_CAP_MIN 8U
+
+static inline uint64_t load_u64(const uint8_t *buf)
+{
+  uint64_t val = 0U;
+
+  memcpy(&val, buf, sizeof(val));
+  return val;
+}
+
+static inline uint32_t prefix_hash(uint64_t prefix)
+{
+  prefix ^= prefix >> 32;
+  return (uint32_t)((prefix * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/// Address hash on the split form: both halves of the interface ID reach the low bits
+static inline uint32_t addr_hash(uint64_t iid, uint32_t prefix_idx)
+{
+  iid += prefix_idx;
+  iid ^= iid >> 32;
+  return (uint32_t)((iid * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/// Zero if the address is the given one (WS_BR_AGENT_TOPO_NONE: ::), branchless
+static inline uint64_t topo_addr_diff(const ws_br_agent_topo_t * const topo, uint32_t index,
+                                      const uint8_t *addr)
+{
+  uint64_t prefix = 0U;
+  uint64_t iid = 0U;
+
+  if (index != WS_BR_AGENT_TOPO_NONE) {
+    prefix = topo->prefixes[topo->prefix_idx[index]];
+    iid = topo->iids[index];
+  }
+  return (prefix ^ load_u64(addr)) | (iid ^ load_u64(addr + WS_BR_AGENT_ADDR_PREFIX_SIZE));
+}
+
+/// Set the address of the given index (WS_BR_AGENT_TOPO_NONE: ::)
+static inline void topo_addr_set(const ws_br_agent_topo_t * const topo, uint32_t index, uint8_t *addr)
+{
+  uint64_t prefix = 0U;
+  uint64_t iid = 0U;
+
+  if (index != WS_BR_AGENT_TOPO_NONE) {
+    prefix = topo->prefixes[topo->prefix_idx[index]];
+    iid = topo->iids[index];
+  }
+  memcpy(addr, &prefix, sizeof(prefix));
+  memcpy(addr + WS_BR_AGENT_ADDR_PREFIX_SIZE, &iid, sizeof(iid));
+}
+
+/// Hash table size (power of two) for the given capacity: at most 2/3 full
+static inline uint32_t topo_slot_count(uint32_t cap)
+{
+  uint32_t slots = 1U;
+
+  while (slots < cap + cap / 2U) {
+    slots <<= 1;
+  }
+  return slots;
+}
+
+static inline size_t topo_block_size(uint32_t node_cap, uint32_t addr_cap, uint32_t prefix_cap)
+{
+  // 8-byte columns first, every column stays aligned
+  return (size_t)prefix_cap * sizeof(uint64_t) + (size_t)addr_cap * sizeof(uint64_t)
+         + (size_t)node_cap * 2U * sizeof(uint32_t)
+         + ((size_t)topo_slot_count(addr_cap) + topo_slot_count(prefix_cap)) * sizeof(uint32_t)
+         + (size_t)addr_cap * sizeof(uint16_t) + (size_t)node_cap * 2U * sizeof(uint8_t);
+}
+
+/// Widen the node and address capacities to the most nodes a block of the given size holds
+static void topo_fit(size_t size, uint32_t * const node_cap, uint32_t * const addr_cap, uint32_t prefix_cap)
+{
+  uint32_t fit_addr_cap = 0U;
+
+  for (uint32_t fit_node_cap = WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES; fit_node_cap > *node_cap; fit_node_cap /= 2U) {
+    fit_addr_cap = fit_node_cap + TOPO_ADDR_SLACK(fit_node_cap);
+    fit_addr_cap = fit_addr_cap > *addr_cap ? fit_addr_cap : *addr_cap;
+    if (topo_block_size(fit_node_cap, fit_addr_cap, prefix_cap) <= size) {
+      *node_cap = fit_node_cap;
+      *addr_cap = fit_addr_cap;
+      return;
+    }
+  }
+}
+
+static void topo_layout(ws_br_agent_topo_t * const topo, uint8_t *block,
+                        uint32_t node_cap, uint32_t addr_cap, uint32_t prefix_cap)
+{
+  topo->block = block;
+  topo->prefixes = (uint64_t *)block;
+  block += (size_t)prefix_cap * sizeof(uint64_t);
+  topo->iids = (uint64_t *)block;
+  block += (size_t)addr_cap * sizeof(uint64_t);
+  topo->parent = (uint32_t *)block;
+  block += (size_t)node_cap * sizeof(uint32_t);
+  topo->backup = (uint32_t *)block;
+  block += (size_t)node_cap * sizeof(uint32_t);
+  topo->addr_slots = (uint32_t *)block;
+  topo->addr_mask = topo_slot_count(addr_cap) - 1U;
+  block += ((size_t)topo->addr_mask + 1U) * sizeof(uint32_t);
+  topo->prefix_slots = (uint32_t *)block;
+  topo->prefix_mask = topo_slot_count(prefix_cap) - 1U;
+  block += ((size_t)topo->prefix_mask + 1U) * sizeof(uint32_t);
+  topo->prefix_idx = (uint16_t *)block;
+  block += (size_t)addr_cap * sizeof(uint16_t);
+  topo->role = block;
+  block += node_cap;
+  topo->flags = block;
+  topo->node_cap = node_cap;
+  topo->addr_cap = addr_cap;
+  topo->prefix_cap = prefix_cap;
+}
+
+/// Prefix hash table slot of a prefix: its entry if present, else the empty slot to insert it
+static inline uint32_t topo_prefix_slot(const ws_br_agent_topo_t * const topo, uint64_t prefix)
+{
+  uint32_t slot = prefix_hash(prefix) & topo->prefix_mask;
+
+  for (; topo->prefix_slots[slot]; slot = (slot + 1U) & topo->prefix_mask) {
+    if (topo->prefixes[topo->prefix_slots[slot] - 1U] == prefix) {
+      break;
+    }
+  }
+  return slot;
+}
+
+/// Address hash table slot of an address: its entry if present, else the empty slot to insert it
+static inline uint32_t topo_addr_slot(const ws_br_agent_topo_t * const topo, uint32_t prefix_idx,
+                                      uint64_t iid)
+{
+  const uint32_t *slots = topo->addr_slots;
+  uint32_t mask = topo->addr_mask;
+  uint32_t slot = addr_hash(iid, prefix_idx) & mask;
+
+  for (; slots[slot]; slot = (slot + 1U) & mask) {
+    if (topo->iids[slots[slot] - 1U] == iid && topo->prefix_idx[slots[slot] - 1U] == prefix_idx) {
+      break;
+    }
+  }
+  return slot;
+}
+
+/// Fill the hash tables from the columns. Duplicate targets stay out: the first entry wins.
+static void topo_index(ws_br_agent_topo_t * const topo)
+{
+  memset(topo->addr_slots, 0, ((size_t)topo->addr_mask + 1U) * sizeof(uint32_t));
+  memset(topo->prefix_slots, 0, ((size_t)topo->prefix_mask + 1U) * sizeof(uint32_t));
+  for (uint32_t i = 0U; i < topo->prefix_count; ++i) {
+    topo->prefix_slots[topo_prefix_slot(topo, topo->prefixes[i])] = i + 1U;
+  }
+  for (uint32_t i = 0U; i < topo->addr_count; ++i) {
+    if (i < topo->node_count && (topo->flags[i] & WS_BR_AGENT_TOPO_FLAG_DUPLICATE)) {
+      continue;
+    }
+    topo->addr_slots[topo_addr_slot(topo, topo->prefix_idx[i], topo->iids[i])] = i + 1U;
+  }
+}
+
+/// Grow the block to the given capacities, keeping the columns content and their index
+static ws_br_agent_ret_t topo_reserve(ws_br_agent_topo_t * const topo, uint32_t node_cap,
+                                      uint32_t addr_cap, uint32_t prefix_cap)
+{
+  ws_br_agent_topo_t old = *topo;
+  uint8_t *block = NULL;
+
+  if (topo->block != NULL && node_cap <= topo->node_cap && addr_cap <= topo->addr_cap
+      && prefix_cap <= topo->prefix_cap) {
+    return WS_BR_AGENT_RET_OK;
+  }
+  node_cap = node_cap > old.node_cap ? node_cap : old.node_cap;
+  addr_cap = addr_cap > old.addr_cap ? addr_cap : old.addr_cap;
+  prefix_cap = prefix_cap > old.prefix_cap ? prefix_cap : old.prefix_cap;
+
+  block = ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_TABLES,
+                                topo_block_size(node_cap, addr_cap, prefix_cap));
+  if (block == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  // A table pool block fits a full topology: laid out for it, it never grows again
+  topo_fit(ws_br_agent_mem_usable_size(block), &node_cap, &addr_cap, prefix_cap);
+  topo_layout(topo, block, node_cap, addr_cap, prefix_cap);
+  if (old.block != NULL) {
+    memcpy(topo->prefixes, old.prefixes, old.prefix_count * sizeof(uint64_t));
+    memcpy(topo->iids, old.iids, old.addr_count * sizeof(uint64_t));
+    memcpy(topo->prefix_idx, old.prefix_idx, old.addr_count * sizeof(uint16_t));
+    memcpy(topo->parent, old.parent, old.node_count * sizeof(uint32_t));
+    memcpy(topo->backup, old.backup, old.node_count * sizeof(uint32_t));
+    memcpy(topo->role, old.role, old.node_count);
+    memcpy(topo->flags, old.flags, old.node_count);
+    ws_br_agent_mem_free(old.block);
+  }
+  // The slot counts follow the capacities: rehashed
+  topo_index(topo);
+  return WS_BR_AGENT_RET_OK;
+}
+
+/// Index of a prefix, interned on first use. WS_BR_AGENT_TOPO_NONE on failure.
+static uint32_t topo_intern_prefix(ws_br_agent_topo_t * const topo, uint64_t prefix)
+{
+  uint32_t slot = 0U;
+
+  // Most addresses share the prefix of the first entry
+  if (topo->prefix_count && topo->prefixes[0] == prefix) {
+    return 0U;
+  }
+  slot = topo_prefix_slot(topo, prefix);
+  if (topo->prefix_slots[slot]) {
+    return topo->prefix_slots[slot] - 1U;
+  }
+  if (topo->prefix_count >= WS_BR_AGENT_TOPO_MAX_PREFIXES) {
+    return WS_BR_AGENT_TOPO_NONE;
+  }
+  if (topo->prefix_count == topo->prefix_cap) {
+    if (topo_reserve(topo, topo->node_cap, topo->addr_cap, 2U * topo->prefix_cap) != WS_BR_AGENT_RET_OK) {
+      return WS_BR_AGENT_TOPO_NONE;
+    }
+    slot = topo_prefix_slot(topo, prefix);
+  }
+  topo->prefixes[topo->prefix_count] = prefix;
+  topo->prefix_slots[slot] = ++topo->prefix_count;
+  return topo->prefix_count - 1U;
+}
+
+/// Address index of a parent, added as external address if not a target
+static ws_br_agent_ret_t topo_resolve_parent(ws_br_agent_topo_t * const topo, const uint8_t *addr,
+                                             uint32_t * const index, bool * const external)
+{
+  uint64_t prefix = load_u64(addr);
+  uint64_t iid = load_u64(addr + WS_BR_AGENT_ADDR_PREFIX_SIZE);
+  uint32_t prefix_idx = 0U;
+  uint32_t slot = 0U;
+
+  *external = false;
+  if (!prefix && !iid) {
+    *index = WS_BR_AGENT_TOPO_NONE;
+    return WS_BR_AGENT_RET_OK;
+  }
+  prefix_idx = topo_intern_prefix(topo, prefix);
+  if (prefix_idx == WS_BR_AGENT_TOPO_NONE) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  slot = topo_addr_slot(topo, prefix_idx, iid);
+  if (topo->addr_slots[slot]) {
+    *index = topo->addr_slots[slot] - 1U;
+    return WS_BR_AGENT_RET_OK;
+  }
+
+  if (topo->addr_count == topo->addr_cap) {
+    if (topo_reserve(topo, topo->node_cap, 2U * topo->addr_cap, topo->prefix_cap) != WS_BR_AGENT_RET_OK) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+    slot = topo_addr_slot(topo, prefix_idx, iid);
+  }
+  topo->iids[topo->addr_count] = iid;
+  topo->prefix_idx[topo->addr_count] = (uint16_t)prefix_idx;
+  topo->addr_slots[slot] = topo->addr_count + 1U;
+  *index = topo->addr_count++;
+  *external = true;
+  return WS_BR_AGENT_RET_OK;
+}
+
+static ws_br_agent_ret_t topo_build_columns(ws_br_agent_topo_t * const topo,
+                                           const ws_br_agent_soc_host_topology_t * const topology,
+                                           size_t * const duplicates, size_t * const foreign)
+{
+  const ws_br_agent_soc_host_topology_entry_t *entries = topology->entries;
+  uint32_t count = topology->entry_count;
+  uint32_t prefix_idx = 0U;
+  uint32_t slot = 0U;
+  uint64_t iid = 0U;
+  uint32_t index = 0U;
+  bool external = false;
+
+  if (topo_reserve(topo, count, count + TOPO_ADDR_SLACK(count), TOPO_PREFIX_CAP_MIN)
+      != WS_BR_AGENT_RET_OK) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  // Empty columns: clears the index of the previous build
+  topo_index(topo);
+
+  // Targets first: address i is the target of node i. The first entry prefix gets index 0.
+  for (uint32_t i = 0U; i < count; ++i) {
+    prefix_idx = topo_intern_prefix(topo, load_u64(entries[i].target));
+    if (prefix_idx == WS_BR_AGENT_TOPO_NONE) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+    iid = load_u64(entries[i].target + WS_BR_AGENT_ADDR_PREFIX_SIZE);
+    topo->iids[i] = iid;
+    topo->prefix_idx[i] = (uint16_t)prefix_idx;
+    slot = topo_addr_slot(topo, prefix_idx, iid);
+    if (topo->addr_slots[slot]) {
+      topo->flags[i] = WS_BR_AGENT_TOPO_FLAG_DUPLICATE;
+      ++*duplicates;
+    } else {
+      topo->flags[i] = 0U;
+      topo->addr_slots[slot] = i + 1U;
+    }
+    *foreign += prefix_idx != 0U;
+    // Counted as they go: a prefix table growth copies the columns
+    topo->addr_count = i + 1U;
+    topo->node_count = i + 1U;
+  }
+
+  // Parents, resolved to node indexes or added after the targets (the block may move)
+  for (uint32_t i = 0U; i < count; ++i) {
+    if (topo_resolve_parent(topo, entries[i].preferred, &index, &external) != WS_BR_AGENT_RET_OK) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+    topo->parent[i] = index;
+    topo->flags[i] |= external ? WS_BR_AGENT_TOPO_FLAG_PARENT_EXT : 0U;
+    if (topo_resolve_parent(topo, entries[i].backup, &index, &external) != WS_BR_AGENT_RET_OK) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+    topo->backup[i] = index;
+    topo->flags[i] |= external ? WS_BR_AGENT_TOPO_FLAG_BACKUP_EXT : 0U;
+    topo->role[i] = topo->parent[i] == WS_BR_AGENT_TOPO_NONE ? WS_BR_AGENT_TOPO_ROLE_BR
+                                                              : WS_BR_AGENT_TOPO_ROLE_LEAF;
+  }
+  for (uint32_t i = 0U; i < count; ++i) {
+    if (topo->parent[i] < count && topo->role[topo->parent[i]] == WS_BR_AGENT_TOPO_ROLE_LEAF) {
+      topo->role[topo->parent[i]] = WS_BR_AGENT_TOPO_ROLE_ROUTER;
+    }
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+ws_br_agent_ret_t ws_br_agent_topo_build(ws_br_agent_topo_t * const topo,
+                                         const ws_br_agent_soc_host_topology_t * const topology)
+{
+  size_t duplicates = 0U;
+  size_t foreign = 0U;
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_ERR;
+
+  if (topo == NULL || topology == NULL || topology->entries == NULL || !topology->entry_count) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  topo->node_count = 0U;
+  topo->addr_count = 0U;
+  topo->prefix_count = 0U;
+  ret = topo_build_columns(topo, topology, &duplicates, &foreign);
+  if (ret != WS_BR_AGENT_RET_OK) {
+    topo->node_count = 0U;
+    topo->addr_count = 0U;
+    topo->prefix_count = 0U;
+    ws_br_agent_log_error("Failed to build the topology (%u entries)\n", topology->entry_count);
+    return ret;
+  }
+
+  if (duplicates) {
+    ws_br_agent_log_warn("Topology has %zu duplicate targets\n", duplicates);
+  }
+  if (foreign) {
+    ws_br_agent_log_debug("Topology has %zu targets outside the Border Router /64\n", foreign);
+  }
+  ws_br_agent_log_debug("Topology: %u nodes, %u external parents, %u prefixes, %zu bytes (%zu on the wire)\n",
+                        topo->node_count, topo->addr_count - topo->node_count, topo->prefix_count,
+                        ws_br_agent_topo_size(topo),
+                        topo->node_count * sizeof(ws_br_agent_soc_host_topology_entry_t));
+  return WS_BR_AGENT_RET_OK;
+}
+
+ws_br_agent_ret_t ws_br_agent_topo_to_wire(const ws_br_agent_topo_t * const topo,
+                                           ws_br_agent_soc_host_topology_t * const topology)
+{
+  ws_br_agent_soc_host_topology_entry_t *entry = NULL;
+  size_t storage_size = 0U;
+
+  if (topo == NULL || topology == NULL || !topo->node_count) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  storage_size = topo->node_count * sizeof(ws_br_agent_soc_host_topology_entry_t);
+
+  // Reuse the dest capacity when it fits
+  if (topology->entries != NULL
+      && ws_br_agent_mem_usable_size(topology->entries) < storage_size) {
+    ws_br_agent_mem_free(topology->entries);
+    topology->entries = NULL;
+  }
+  if (topology->entries == NULL) {
+    topology->entries = (ws_br_agent_soc_host_topology_entry_t *)
+                        ws_br_agent_mem_alloc(WS_BR_AGENT_MEM_SUBSYS_TOPOLOGY, storage_size);
+    if (topology->entries == NULL) {
+      topology->entry_count = 0U;
+      return WS_BR_AGENT_RET_ERR;
+    }
+  }
+  topology->entry_count = topo->node_count;
+
+  for (uint32_t i = 0U; i < topo->node_count; ++i) {
+    entry = &topology->entries[i];
+    topo_addr_set(topo, i, entry->target);
+    topo_addr_set(topo, topo->parent[i], entry->preferred);
+    topo_addr_set(topo, topo->backup[i], entry->backup);
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+bool ws_br_agent_topo_equal(const ws_br_agent_topo_t * const a, const ws_br_agent_topo_t * const b)
+{
+  return a->node_count == b->node_count && a->addr_count == b->addr_count
+         && a->prefix_count == b->prefix_count
+         && !memcmp(a->prefixes, b->prefixes, a->prefix_count * sizeof(uint64_t))
+         && !memcmp(a->iids, b->iids, a->addr_count * sizeof(uint64_t))
+         && !memcmp(a->prefix_idx, b->prefix_idx, a->addr_count * sizeof(uint16_t))
+         && !memcmp(a->parent, b->parent, a->node_count * sizeof(uint32_t))
+         && !memcmp(a->backup, b->backup, a->node_count * sizeof(uint32_t));
+}
+
+bool ws_br_agent_topo_match(const ws_br_agent_topo_t * const topo,
+                            const ws_br_agent_soc_host_topology_t * const topology)
+{
+  const ws_br_agent_soc_host_topology_entry_t *entry = NULL;
+
+  if (topology->entries == NULL || topo->node_count != topology->entry_count) {
+    return false;
+  }
+  for (uint32_t i = 0U; i < topo->node_count; ++i) {
+    entry = &topology->entries[i];
+    if (topo_addr_diff(topo, i, entry->target) | topo_addr_diff(topo, topo->parent[i], entry->preferred)
+        | topo_addr_diff(topo, topo->backup[i], entry->backup)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t ws_br_agent_topo_diff(const ws_br_agent_topo_t * const topo,
+                               const ws_br_agent_soc_host_topology_t * const topology,
+                               uint32_t * const indexes)
+{
+  const ws_br_agent_soc_host_topology_entry_t *entry = NULL;
+  uint32_t common = topo->node_count < topology->entry_count ? topo->node_count
+                                                              : topology->entry_count;
+  uint32_t count = 0U;
+
+  for (uint32_t i = 0U; i < common; ++i) {
+    entry = &topology->entries[i];
+    indexes[count] = i;
+    count += (topo_addr_diff(topo, i, entry->target)
+              | topo_addr_diff(topo, topo->parent[i], entry->preferred)
+              | topo_addr_diff(topo, topo->backup[i], entry->backup)) != 0U;
+  }
+  for (uint32_t i = common; i < topology->entry_count; ++i) {
+    indexes[count++] = i;
+  }
+  return count;
+}
+
+uint32_t ws_br_agent_topo_find(const ws_br_agent_topo_t * const topo, const uint8_t addr[16])
+{
+  uint32_t slot = 0U;
+
+  if (!topo->node_count) {
+    return WS_BR_AGENT_TOPO_NONE;
+  }
+  slot = topo_prefix_slot(topo, load_u64(addr));
+  if (!topo->prefix_slots[slot]) {
+    return WS_BR_AGENT_TOPO_NONE;
+  }
+  slot = topo_addr_slot(topo, topo->prefix_slots[slot] - 1U, load_u64(addr + WS_BR_AGENT_ADDR_PREFIX_SIZE));
+  // External parents are indexed too, they are not nodes
+  if (!topo->addr_slots[slot] || topo->addr_slots[slot] > topo->node_count) {
+    return WS_BR_AGENT_TOPO_NONE;
+  }
+  return topo->addr_slots[slot] - 1U;
+}
+
+void ws_br_agent_topo_get_addr(const ws_br_agent_topo_t * const topo, uint32_t index, uint8_t addr[16])
+{
+  topo_addr_set(topo, index < topo->addr_count ? index : WS_BR_AGENT_TOPO_NONE, addr);
+}
+
+size_t ws_br_agent_topo_size(const ws_br_agent_topo_t * const topo)
+{
+  return (size_t)topo->node_count * (2U * sizeof(uint32_t) + 2U * sizeof(uint8_t))
+         + (size_t)topo->addr_count * (sizeof(uint64_t) + sizeof(uint16_t))
+         + (size_t)topo->prefix_count * sizeof(uint64_t);
+}
+
+void ws_br_agent_topo_free(ws_br_agent_topo_t * const topo)
+{
+  if (topo == NULL) {
+    return;
+  }
+  ws_br_agent_mem_free(topo->block);
+  memset(topo, 0, sizeof(*topo));
+}
@@ -0,0 +1,103 @@
+/***************************************************************************//**
+ * @file ws_br_agent_trace.c
+ * @brief Update latency tracing for Wi-SUN SoC Border Router Agent
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include <stdatomic.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "trace"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_utils.h"
+#include "ws_br_agent_msg.h"
+#include "ws_br_agent_metrics.h"
+#include "ws_br_agent_trace.h"
+
+static atomic_uint_fast64_t trace_id_cnt = 0U;
+
+void ws_br_agent_trace_start(ws_br_agent_trace_t * const trace, uint64_t recv_us)
+{
+  if (trace == NULL) {
+    return;
+  }
+  memset(trace, 0, sizeof(ws_br_agent_trace_t));
+  trace->id = atomic_fetch_add_explicit(&trace_id_cnt, 1U, memory_order_relaxed) + 1U;
+  trace->recv_us = recv_us;
+}
+
+void ws_br_agent_trace_stamp(ws_br_agent_trace_t * const trace, ws_br_agent_trace_stage_t stage)
+{
+  if (trace == NULL || stage >= WS_BR_AGENT_TRACE_STAGE_COUNT) {
+    return;
+  }
+  trace->stage_end_us[stage] = ws_br_agent_utils_get_monotonic_us();
+}
+
+void ws_br_agent_trace_finish(const ws_br_agent_trace_t * const trace)
+{
+  ws_br_agent_metric_hist_t base = WS_BR_AGENT_METRIC_HIST_COUNT;
+  uint64_t prev_us = 0U;
+  uint64_t stage_us[WS_BR_AGENT_TRACE_STAGE_COUNT] = { 0U };
+
+  if (trace == NULL) {
+    return;
+  }
+
+  switch (trace->msg_code) {
+  case WS_BR_AGENT_MSG_CODE_TOPOLOGY:
+    base = WS_BR_AGENT_METRIC_HIST_TOPOLOGY_RECV;
+    break;
+  case WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS:
+    base = WS_BR_AGENT_METRIC_HIST_SETTINGS_RECV;
+    break;
+  default:
+    return;
+  }
+
+  // Each stage lasts from the end of the previous stamped stage
+  prev_us = trace->recv_us;
+  for (size_t i = 0U; i < WS_BR_AGENT_TRACE_STAGE_COUNT; ++i) {
+    if (!trace->stage_end_us[i]) {
+      continue;
+    }
+    stage_us[i] = trace->stage_end_us[i] - prev_us;
+    ws_br_agent_metrics_observe(base + i, stage_us[i]);
+    prev_us = trace->stage_end_us[i];
+  }
+  ws_br_agent_metrics_observe(base + WS_BR_AGENT_TRACE_STAGE_COUNT, prev_us - trace->recv_us);
+
+  ws_br_agent_log_debug("Trace %llu: recv %llu us, parse %llu us, store %llu us, "
+                        "diff %llu us, emit %llu us%s\n",
+                        (unsigned long long)trace->id,
+                        (unsigned long long)stage_us[WS_BR_AGENT_TRACE_STAGE_RECV],
+                        (unsigned long long)stage_us[WS_BR_AGENT_TRACE_STAGE_PARSE],
+                        (unsigned long long)stage_us[WS_BR_AGENT_TRACE_STAGE_STORE],
+                        (unsigned long long)stage_us[WS_BR_AGENT_TRACE_STAGE_DIFF],
+                        (unsigned long long)stage_us[WS_BR_AGENT_TRACE_STAGE_EMIT],
+                        trace->changed ? "" : " (unchanged)");
+}
@@ -31,7 +31,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
+#define WS_BR_AGENT_LOG_SUBSYSTEM "utils"
 #include "ws_br_agent_defs.h"
 #include "ws_br_agent_log.h"
 #include "ws_br_agent_msg.h"
@@ -42,6 +44,16 @@
 
 #define HELP_STR \
 "Usage: wisun-br-bridge-agent [--log <log file path>] \
+[--log-sinks <console,file,journal>] \
+[--capture <pcapng file path>] \
+[--metrics <port|[addr]:port|unix:path>] \
+[--mem-budget <bytes[k|M|G]>] \
+[--mem-pool] \
+[--max-socs <count>] \
+[--event-loop] \
+[--state <state file path|none>] \
+[--history <bytes[k|M|G]>] \
+[--history-file <history file path>] \
 [--config <config file path>] \
 [--soc <SoC host address>] \
 [--help] \
@@ -98,6 +110,7 @@ const ws_br_agent_name_value_t ws_br_agent_msg_code_strs[] = {
   { "SET_CONFIG_PARAMS",   WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS },
   { "RESTART_BR",          WS_BR_AGENT_MSG_CODE_RESTART_BR },
   { "STOP_BR",             WS_BR_AGENT_MSG_CODE_STOP_BR },
+  { "NODE_STATS",          WS_BR_AGENT_MSG_CODE_NODE_STATS },
   { NULL, 0L }
 };
 
@@ -112,6 +125,36 @@ const ws_br_agent_name_value_t ws_br_agent_phy_type_strs[] = {
   { NULL, 0L }
 };
 
+const ws_br_agent_name_value_t ws_br_agent_phy_config_strs[] = {
+  { "FAN11",        WS_BR_AGENT_PHY_CONFIG_FAN11 },
+  { "FAN10",        WS_BR_AGENT_PHY_CONFIG_FAN10 },
+  { "EXPLICIT",     WS_BR_AGENT_PHY_CONFIG_EXPLICIT },
+  { "IDS",          WS_BR_AGENT_PHY_CONFIG_IDS },
+  { "CUSTOM_FSK",   WS_BR_AGENT_PHY_CONFIG_CUSTOM_FSK },
+  { "CUSTOM_OFDM",  WS_BR_AGENT_PHY_CONFIG_CUSTOM_OFDM },
+  { "CUSTOM_OQPSK", WS_BR_AGENT_PHY_CONFIG_CUSTOM_OQPSK },
+  { NULL, 0L }
+};
+
+const ws_br_agent_name_value_t ws_br_agent_fan_version_strs[] = {
+  { "1.1", WS_BR_AGENT_PHY_CONFIG_FAN11 },
+  { "1.0", WS_BR_AGENT_PHY_CONFIG_FAN10 },
+  { NULL, 0L }
+};
+
+// Values of sl_wisun_operating_mode_t
+const ws_br_agent_name_value_t ws_br_agent_op_mode_strs[] = {
+  { "1a", 0x1a },
+  { "1b", 0x1b },
+  { "2a", 0x2a },
+  { "2b", 0x2b },
+  { "3",  0x03 },
+  { "4a", 0x4a },
+  { "4b", 0x4b },
+  { "5",  0x05 },
+  { NULL, 0L }
+};
+
 void ws_br_agent_utils_print_app_banner(void)
 {
   const int banner_width = 60;
@@ -148,7 +191,7 @@ void ws_br_agent_utils_print_version(void)
 
 int32_t ws_br_agent_utils_print_msg(const ws_br_agent_msg_t * const msg)
 {
-  char *line_buf = NULL;
+  char line_buf[MAX_LINE_BUF_SIZE];
 
   if (msg == NULL) {
     return WS_BR_AGENT_RET_ERR;
@@ -165,8 +208,6 @@ int32_t ws_br_agent_utils_print_msg(const ws_br_agent_msg_t * const msg)
     return WS_BR_AGENT_RET_OK;
   }
 
-  line_buf = (char *)malloc(MAX_LINE_BUF_SIZE);
-
   ws_br_agent_log_debug("Payload data:\n");
   for (size_t i = 0, cnt = 0; i < msg->payload_len; i++) {
     snprintf(&line_buf[cnt], MAX_LINE_BUF_SIZE - cnt, " 0x%02x", msg->payload[i]);
@@ -178,29 +219,25 @@ int32_t ws_br_agent_utils_print_msg(const ws_br_agent_msg_t * const msg)
     }
   }
 
-  free(line_buf);
-
   return WS_BR_AGENT_RET_OK;
 }
 
 
 void ws_br_agent_utils_print_host_settings(const ws_br_agent_settings_t * const settings)
 {
-  
-  ws_br_agent_log_info("Network name: %s\n", settings->network_name);
-  ws_br_agent_log_info("Network size: 0x%02x\n", settings->network_size);
-  ws_br_agent_log_info("TX power: %d ddBm\n", settings->tx_power_ddbm);
-
-  // Only prints FAN 1.1 (almost always we use that)
-  ws_br_agent_log_info("PHY: %s\n", ws_br_agent_utils_val_to_str(settings->phy.type, 
-                                                                 ws_br_agent_phy_type_strs, 
-                                                                 "Unknown"));
-  if (settings->phy.type == WS_BR_AGENT_PHY_CONFIG_FAN11) {
-    ws_br_agent_log_info(" (Regulatory domain: 0x%02x, Channel plan ID: 0x%02x, PHY mode ID: 0x%02x)\n",
-                         settings->phy.config.fan11.reg_domain,
-                         settings->phy.config.fan11.chan_plan_id,
-                         settings->phy.config.fan11.phy_mode_id);
-
+  char text[WS_BR_AGENT_SETTINGS_FIELD_TEXT_MAX_SIZE];
+  const ws_br_agent_settings_field_t *fields = NULL;
+  size_t count = 0U;
+
+  fields = ws_br_agent_settings_fields(&count);
+  for (size_t i = 0U; i < count; ++i) {
+    // Skip aliases (same member, other keywords) and fields of other PHY configuration types
+    if ((i && fields[i].offset == fields[i - 1U].offset && fields[i].size == fields[i - 1U].size)
+        || !ws_br_agent_settings_field_applies(&fields[i], settings)) {
+      continue;
+    }
+    ws_br_agent_log_info("%s: %s\n", fields[i].key,
+                         ws_br_agent_settings_format(&fields[i], settings, text, sizeof(text)));
   }
 #if WS_BR_AGENT_SETTINGS_HAVE_KEYS
   ws_br_agent_log_info("GAKs:\n");
@@ -213,15 +250,9 @@ void ws_br_agent_utils_print_host_settings(const ws_br_agent_settings_t * const
 #if WS_BR_AGENT_SETTINGS_HAVE_KEYS
 static void print_4x16_keys(const uint8_t keys[4][16])
 {
-  char *line_buf = NULL;
+  char line_buf[MAX_LINE_BUF_SIZE];
   
   for (uint8_t i = 0; i < 4; ++i) {
-    if (line_buf != NULL) {
-      free(line_buf);
-      line_buf = NULL;
-    }
-    line_buf = (char *) malloc(MAX_LINE_BUF_SIZE);
-
     for (uint8_t j = 0; j < 16; ++j) {
       snprintf(&line_buf[j * 5], MAX_LINE_BUF_SIZE - j * 5, 
                " 0x%02x", keys[i][j]);
@@ -231,8 +262,6 @@ static void print_4x16_keys(const uint8_t keys[4][16])
     
     ws_br_agent_log_info("%s\n", line_buf);
   }
-
-  free(line_buf);
 }
 #endif
 
@@ -266,3 +295,19 @@ ws_br_agent_ret_t ws_br_agent_utils_str_to_val(const char *str,
 
   return WS_BR_AGENT_RET_ERR;
 }
+
+uint64_t ws_br_agent_utils_get_monotonic_us(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+uint64_t ws_br_agent_utils_get_realtime_us(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+# Wi-SUN SoC Border Router Agent performance regression gate
+#
+# Runs a fixed workload and compares the results against a baseline file:
+#   loadgen: agent on a private dbus-daemon, driven by wisun-br-bridge-agent-loadgen
+#            (TOPOLOGY throughput and latency, TOPOLOGY -> PropertiesChanged latency,
+#            D-Bus Get latency, agent peak RSS)
+#   bench:   wisun-br-bridge-agent-bench (time and heap allocations per operation)
+#
+# Baseline file:
+#   { "workload": { <tool options> },
+#     "checks": { "<metric path>": { "baseline": <value>, "tolerance": <ratio>,
+#                                    "better": "lower" | "higher" } } }
+# A "lower" metric fails above baseline * (1 + tolerance), a "higher" metric fails below
+# baseline * (1 - tolerance). --update rewrites the baselines from the current run.
+
+import argparse
+import json
+import os
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+AGENT_DBUS_NAME = "com.silabs.Wisun.SocBorderRouterAgent"
+READY_TIMEOUT_S = 10.0
+
+
+def wait_agent_ready(bus_address, agent):
+    deadline = time.monotonic() + READY_TIMEOUT_S
+    while time.monotonic() < deadline:
+        if agent.poll() is not None:
+            raise RuntimeError("agent exited during start-up (%d)" % agent.returncode)
+        reply = subprocess.run(["dbus-send", "--bus=" + bus_address, "--print-reply",
+                                "--dest=org.freedesktop.DBus", "/org/freedesktop/DBus",
+                                "org.freedesktop.DBus.NameHasOwner", "string:" + AGENT_DBUS_NAME],
+                               capture_output=True, text=True)
+        if "boolean true" in reply.stdout:
+            return
+        time.sleep(0.05)
+    raise RuntimeError("agent did not acquire %s" % AGENT_DBUS_NAME)
+
+
+def stop(proc):
+    if proc is None or proc.poll() is not None:
+        return
+    proc.send_signal(signal.SIGTERM)
+    try:
+        proc.wait(timeout=2)
+    except subprocess.TimeoutExpired:
+        proc.kill()
+        proc.wait()
+
+
+def run_loadgen(args, workload, workdir):
+    dbus = None
+    agent = None
+    try:
+        dbus = subprocess.Popen(["dbus-daemon", "--session", "--nofork", "--print-address"],
+                                stdout=subprocess.PIPE, text=True)
+        bus_address = dbus.stdout.readline().strip()
+        if not bus_address:
+            raise RuntimeError("dbus-daemon did not start")
+
+        env = dict(os.environ, DBUS_SYSTEM_BUS_ADDRESS=bus_address)
+        agent = subprocess.Popen([args.agent, "--log", os.path.join(workdir, "agent.log"),
+                                  "--log-sinks", "file",
+                                  "--state", os.path.join(workdir, "state")],
+                                 env=env, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        wait_agent_ready(bus_address, agent)
+
+        output = os.path.join(workdir, "loadgen.json")
+        cmd = [args.loadgen, "--dbus-address", bus_address, "--pid", str(agent.pid),
+               "--watch", "--output", output]
+        for key, value in workload.items():
+            cmd += ["--" + key] if value is True else ["--" + key, str(value)]
+        result = subprocess.run(cmd, env=env)
+        if result.returncode != 0:
+            raise RuntimeError("load generator failed (%d)" % result.returncode)
+        with open(output) as f:
+            return json.load(f)
+    finally:
+        stop(agent)
+        stop(dbus)
+
+
+def run_bench(args, workload, workdir):
+    output = os.path.join(workdir, "bench.json")
+    cmd = [args.bench, "--output", output]
+    for key, value in workload.items():
+        cmd += ["--" + key, str(value)]
+    result = subprocess.run(cmd)
+    if result.returncode != 0:
+        raise RuntimeError("benchmark failed (%d)" % result.returncode)
+    with open(output) as f:
+        report = json.load(f)
+    # Index the results as "<name>@<entries>"
+    return {"%s@%d" % (r["name"], r["entries"]): r for r in report["results"]}
+
+
+def lookup(report, path):
+    value = report
+    for key in path.split("."):
+        if not isinstance(value, dict) or key not in value:
+            raise KeyError(path)
+        value = value[key]
+    return value
+
+
+def check(baseline, report):
+    failures = 0
+    for path, spec in baseline["checks"].items():
+        measured = lookup(report, path)
+        limit = spec["baseline"]
+        if spec["better"] == "lower":
+            limit *= 1.0 + spec["tolerance"]
+            ok = measured <= limit
+        else:
+            limit *= 1.0 - spec["tolerance"]
+            ok = measured >= limit
+        print("%-4s %-45s %12.2f (baseline %.2f, limit %.2f)"
+              % ("ok" if ok else "FAIL", path, measured, spec["baseline"], limit))
+        failures += 0 if ok else 1
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Performance regression gate")
+    parser.add_argument("mode", choices=["loadgen", "bench"])
+    parser.add_argument("--baseline", required=True)
+    parser.add_argument("--agent")
+    parser.add_argument("--loadgen")
+    parser.add_argument("--bench")
+    parser.add_argument("--update", action="store_true",
+                        help="rewrite the baseline values from this run")
+    args = parser.parse_args()
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+
+    workdir = tempfile.mkdtemp(prefix="ws-br-agent-perf-")
+    try:
+        if args.mode == "loadgen":
+            report = run_loadgen(args, baseline["workload"], workdir)
+        else:
+            report = run_bench(args, baseline["workload"], workdir)
+
+        if args.update:
+            for path, spec in baseline["checks"].items():
+                spec["baseline"] = round(lookup(report, path), 2)
+            with open(args.baseline, "w") as f:
+                json.dump(baseline, f, indent=2)
+                f.write("\n")
+            print("Baseline updated: %s" % args.baseline)
+            return 0
+
+        failures = check(baseline, report)
+    except (RuntimeError, KeyError, OSError, ValueError) as e:
+        print("error: %s (logs in %s)" % (e, workdir), file=sys.stderr)
+        return 1
+
+    if failures:
+        print("%d regression(s), logs in %s" % (failures, workdir))
+        return 1
+    shutil.rmtree(workdir, ignore_errors=True)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
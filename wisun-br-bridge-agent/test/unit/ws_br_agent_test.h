@@ -0,0 +1,203 @@
+/***************************************************************************//**
+ * @file ws_br_agent_test.h
+ * @brief Minimal unit test helpers for the Wi-SUN SoC Border Router Agent
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+
+#ifndef WS_BR_AGENT_TEST_H
+#define WS_BR_AGENT_TEST_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ws_br_agent_defs.h"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_mem.h"
+#include "ws_br_agent_node_stats.h"
+#include "ws_br_agent_soc_host.h"
+
+/// Number of failed checks
+static unsigned int test_failures = 0U;
+
+/// Count and report a failed check, the test goes on
+#define TEST_CHECK(cond)                                                        \
+  do {                                                                          \
+    if (!(cond)) {                                                              \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      test_failures++;                                                          \
+    }                                                                           \
+  } while (0)
+
+/**
+ * @brief Set up the agent core for a test.
+ * @details Logs go to /dev/null. With --mem-pool, the memory pools are mapped
+ *          and nothing is allocated from the heap afterwards, as with the agent option.
+ * @param[in] argc Argument count.
+ * @param[in] argv Arguments.
+ * @return True on success.
+ */
+static inline bool test_init(int argc, char **argv)
+{
+  bool pool_mode = argc > 1 && !strcmp(argv[1], "--mem-pool");
+
+  ws_br_agent_log_file_path = "/dev/null";
+  ws_br_agent_log_sinks = WS_BR_AGENT_LOG_SINK_FILE;
+  if (ws_br_agent_mem_init(0U, pool_mode, WS_BR_AGENT_SOC_HOST_MAX_COUNT) != WS_BR_AGENT_RET_OK
+      || ws_br_agent_log_init() != WS_BR_AGENT_RET_OK) {
+    fprintf(stderr, "Init failed\n");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Test exit status.
+ * @return EXIT_SUCCESS if every check passed.
+ */
+static inline int test_result(void)
+{
+  if (test_failures) {
+    fprintf(stderr, "%u check(s) failed\n", test_failures);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Check that a subsystem released all its memory.
+ * @param[in] subsys Subsystem.
+ * @return True if nothing is left allocated and no allocation failed.
+ */
+static inline bool test_mem_released(ws_br_agent_mem_subsys_t subsys)
+{
+  ws_br_agent_mem_stats_t stats = { 0 };
+
+  return ws_br_agent_mem_get_stats(subsys, &stats) == WS_BR_AGENT_RET_OK
+         && !stats.bytes && stats.allocs == stats.frees && !stats.failures;
+}
+
+/// No preferred parent: the Border Router
+#define TEST_NO_PARENT UINT32_MAX
+
+/**
+ * @brief Address of a test node: fd00:0:0:<net>::<id>.
+ * @param[out] addr Address.
+ * @param[in] net Network (SoC) number.
+ * @param[in] id Node id.
+ */
+static inline void test_addr(uint8_t addr[16], uint8_t net, uint32_t id)
+{
+  memset(addr, 0, 16U);
+  addr[0] = 0xFDU;
+  addr[7] = net;
+  ws_br_agent_put_be32(addr + 12U, id);
+}
+
+/**
+ * @brief Node id of a test node address.
+ * @param[in] addr Address.
+ * @return Node id.
+ */
+static inline uint32_t test_addr_id(const uint8_t addr[16])
+{
+  return ws_br_agent_get_be32(addr + 12U);
+}
+
+/**
+ * @brief Topology entry of a test node.
+ * @param[out] entry Entry.
+ * @param[in] net Network (SoC) number.
+ * @param[in] id Node id.
+ * @param[in] parent Preferred parent id, TEST_NO_PARENT for the Border Router.
+ */
+static inline void test_entry(ws_br_agent_soc_host_topology_entry_t *entry, uint8_t net, uint32_t id,
+                              uint32_t parent)
+{
+  memset(entry, 0, sizeof(*entry));
+  test_addr(entry->target, net, id);
+  if (parent != TEST_NO_PARENT) {
+    test_addr(entry->preferred, net, parent);
+  }
+}
+
+/**
+ * @brief Tree topology: entry i is node ids[i] under the node of entry (i - 1) / arity.
+ * @param[out] entries Entries.
+ * @param[in] net Network (SoC) number.
+ * @param[in] ids Node ids, NULL for 0 to count - 1.
+ * @param[in] count Number of entries.
+ * @param[in] arity Children of a node, UINT32_MAX for all under the Border Router.
+ */
+static inline void test_tree(ws_br_agent_soc_host_topology_entry_t *entries, uint8_t net,
+                             const uint32_t *ids, uint32_t count, uint32_t arity)
+{
+  for (uint32_t i = 0U; i < count; ++i) {
+    test_entry(&entries[i], net, ids != NULL ? ids[i] : i,
+               !i ? TEST_NO_PARENT : ids != NULL ? ids[(i - 1U) / arity] : (i - 1U) / arity);
+  }
+}
+
+/**
+ * @brief NODE_STATS entry of a test node, the metrics derived from its id.
+ * @param[out] entry Entry.
+ * @param[in] target Node target address.
+ */
+static inline void test_node_stats_entry(ws_br_agent_node_stats_entry_t *entry, const uint8_t target[16])
+{
+  uint32_t id = test_addr_id(target);
+
+  memset(entry, 0, sizeof(*entry));
+  memcpy(entry->target, target, sizeof(entry->target));
+  entry->rsl_in = (uint8_t)(80U + id % 64U);
+  entry->rsl_out = (uint8_t)(90U + id % 32U);
+  ws_br_agent_put_be16(entry->etx, (uint16_t)(WS_BR_AGENT_NODE_STATS_ETX_UNIT + id % 1024U));
+  entry->phy_mode_id = (uint8_t)(id % 8U);
+  ws_br_agent_put_be32(entry->last_heard_s, id % 60U);
+}
+
+/**
+ * @brief Check the metrics of a test node, as built by test_node_stats_entry().
+ * @param[in] row Node metrics.
+ * @param[in] time_us Reception time of the metrics.
+ * @return True if they match.
+ */
+static inline bool test_node_stats_row_ok(const ws_br_agent_node_stats_row_t *row, uint64_t time_us)
+{
+  uint32_t id = test_addr_id(row->target);
+
+  return row->rsl_in_dbm == (int)(80U + id % 64U) - WS_BR_AGENT_NODE_STATS_RSL_OFFSET
+         && row->rsl_out_dbm == (int)(90U + id % 32U) - WS_BR_AGENT_NODE_STATS_RSL_OFFSET
+         && row->etx == WS_BR_AGENT_NODE_STATS_ETX_UNIT + id % 1024U
+         && row->phy_mode_id == id % 8U
+         && row->last_heard_us == time_us - (id % 60U) * 1000000ULL;
+}
+
+#endif // WS_BR_AGENT_TEST_H
@@ -0,0 +1,223 @@
+/***************************************************************************//**
+ * @file ws_br_agent_test_history.c
+ * @brief Unit tests of the topology history: lookups by time and by node, keyed by SoC, kept in the history file
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "ws_br_agent_history.h"
+#include "ws_br_agent_test.h"
+
+/// History ring size
+#define TEST_HISTORY_SIZE (256U * 1024U)
+/// Number of SoCs recorded
+#define TEST_SOC_COUNT 2U
+/// Topology versions recorded per SoC
+#define TEST_VERSIONS 20U
+/// Nodes of a topology, the last one leaves then comes back
+#define TEST_NODES 50U
+/// Versions the last node is absent from
+#define TEST_LEAVE_VERSION 10U
+#define TEST_REJOIN_VERSION 15U
+
+typedef struct test_soc {
+  struct in6_addr addr;
+  ws_br_agent_topo_t prev;
+  ws_br_agent_soc_host_topology_entry_t entries[TEST_VERSIONS][TEST_NODES];
+  uint32_t counts[TEST_VERSIONS];
+  uint64_t times_us[TEST_VERSIONS];
+} test_soc_t;
+
+static test_soc_t test_socs[TEST_SOC_COUNT];
+
+static uint64_t test_now_us(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+/// Node i of every SoC has the same target, its parent differs from a SoC to another
+static void test_fill(test_soc_t *soc, size_t index, uint32_t version)
+{
+  ws_br_agent_soc_host_topology_entry_t *entries = soc->entries[version];
+  uint32_t node = 0U;
+
+  test_tree(entries, 0U, NULL, TEST_NODES, (uint32_t)index + 2U);
+  // Two parent changes a version, the last node aside
+  if (version) {
+    node = 1U + version % (TEST_NODES - 2U);
+    test_entry(&entries[node], 0U, node, 0U);
+    node = 1U + (version + 7U) % (TEST_NODES - 2U);
+    test_entry(&entries[node], 0U, node, node > 1U ? 1U : 0U);
+  }
+  soc->counts[version] = version >= TEST_LEAVE_VERSION && version < TEST_REJOIN_VERSION
+                         ? TEST_NODES - 1U : TEST_NODES;
+}
+
+static void test_record(size_t shard, test_soc_t *soc, uint32_t version)
+{
+  ws_br_agent_soc_host_topology_t topology = {
+    .entry_count = soc->counts[version],
+    .entries = soc->entries[version],
+  };
+
+  ws_br_agent_history_record(shard, &soc->addr, &soc->prev, &topology);
+  TEST_CHECK(ws_br_agent_topo_build(&soc->prev, &topology) == WS_BR_AGENT_RET_OK);
+  // Versions a few hundred microseconds apart, the query time of each one is taken in between
+  usleep(200U);
+  soc->times_us[version] = test_now_us();
+  usleep(200U);
+}
+
+static bool test_same(const ws_br_agent_soc_host_topology_t *topology, const test_soc_t *soc, uint32_t version)
+{
+  return topology->entry_count == soc->counts[version]
+         && !memcmp(topology->entries, soc->entries[version],
+                    soc->counts[version] * sizeof(ws_br_agent_soc_host_topology_entry_t));
+}
+
+typedef struct test_node_ctx {
+  uint32_t calls;
+  bool present[4];
+} test_node_ctx_t;
+
+static int test_node_cb(void *ctx, uint64_t time_us, const ws_br_agent_soc_host_topology_entry_t *entry)
+{
+  test_node_ctx_t *node = (test_node_ctx_t *)ctx;
+
+  (void)time_us;
+  if (node->calls < sizeof(node->present)) {
+    node->present[node->calls] = entry != NULL;
+  }
+  node->calls++;
+  return 0;
+}
+
+/// Every version of every SoC is found at its time, the node history follows its presence
+static void test_lookups(void)
+{
+  ws_br_agent_soc_host_topology_t topology = { 0 };
+  struct in6_addr unknown = { .s6_addr = { 0xFDU, 0x99U } };
+  test_node_ctx_t node = { 0 };
+  uint64_t version_us = 0U;
+
+  for (size_t s = 0U; s < TEST_SOC_COUNT; ++s) {
+    for (uint32_t v = 0U; v < TEST_VERSIONS; ++v) {
+      TEST_CHECK(ws_br_agent_history_get_topology(&test_socs[s].addr, test_socs[s].times_us[v],
+                                                  &topology, &version_us) == WS_BR_AGENT_RET_OK);
+      TEST_CHECK(test_same(&topology, &test_socs[s], v));
+      TEST_CHECK(version_us <= test_socs[s].times_us[v]);
+    }
+    TEST_CHECK(ws_br_agent_history_get_topology(&test_socs[s].addr, UINT64_MAX, &topology, &version_us)
+               == WS_BR_AGENT_RET_OK);
+    TEST_CHECK(test_same(&topology, &test_socs[s], TEST_VERSIONS - 1U));
+    // Before the first version
+    TEST_CHECK(ws_br_agent_history_get_topology(&test_socs[s].addr, 1U, &topology, &version_us) != WS_BR_AGENT_RET_OK);
+
+    // Joined, left, came back
+    memset(&node, 0, sizeof(node));
+    TEST_CHECK(ws_br_agent_history_get_node(&test_socs[s].addr, test_socs[s].entries[0][TEST_NODES - 1U].target,
+                                            test_node_cb, &node) == WS_BR_AGENT_RET_OK);
+    TEST_CHECK(node.calls == 3U);
+    TEST_CHECK(node.present[0] && !node.present[1] && node.present[2]);
+  }
+  TEST_CHECK(ws_br_agent_history_get_topology(&unknown, UINT64_MAX, &topology, &version_us) != WS_BR_AGENT_RET_OK);
+  ws_br_agent_soc_host_free_topology(&topology);
+}
+
+int main(int argc, char **argv)
+{
+  char dir[] = "/tmp/ws_br_agent_test_history.XXXXXX";
+  char path[sizeof(dir) + 16U];
+  ws_br_agent_soc_host_topology_t topology = { 0 };
+  ws_br_agent_mem_stats_t stats = { 0 };
+  test_soc_t *soc = NULL;
+  uint64_t version_us = 0U;
+
+  if (!test_init(argc, argv) || mkdtemp(dir) == NULL) {
+    return EXIT_FAILURE;
+  }
+  snprintf(path, sizeof(path), "%s/history", dir);
+
+  TEST_CHECK(ws_br_agent_history_init(WS_BR_AGENT_HISTORY_MIN_SIZE - 1U, NULL) != WS_BR_AGENT_RET_OK);
+  TEST_CHECK(ws_br_agent_history_init(TEST_HISTORY_SIZE, path) == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(ws_br_agent_mem_get_stats(WS_BR_AGENT_MEM_SUBSYS_HISTORY, &stats) == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(stats.bytes >= TEST_HISTORY_SIZE);
+
+  // Both SoCs recorded in turn
+  for (size_t s = 0U; s < TEST_SOC_COUNT; ++s) {
+    test_socs[s].addr.s6_addr[0] = 0xFDU;
+    test_socs[s].addr.s6_addr[15] = (uint8_t)(s + 1U);
+  }
+  for (uint32_t v = 0U; v < TEST_VERSIONS; ++v) {
+    for (size_t s = 0U; s < TEST_SOC_COUNT; ++s) {
+      test_fill(&test_socs[s], s, v);
+      test_record(s, &test_socs[s], v);
+    }
+  }
+  test_lookups();
+
+  // Restored from the history file, the SoCs now on the other shards
+  ws_br_agent_history_deinit();
+  TEST_CHECK(test_mem_released(WS_BR_AGENT_MEM_SUBSYS_HISTORY));
+  TEST_CHECK(ws_br_agent_history_init(TEST_HISTORY_SIZE, path) == WS_BR_AGENT_RET_OK);
+  test_lookups();
+
+  // A new version is ordered after the restored ones, a new SoC on a shard starts its own chain
+  soc = &test_socs[0];
+  memcpy(soc->entries[0], soc->entries[TEST_VERSIONS - 1U], sizeof(soc->entries[0]));
+  soc->counts[0] = soc->counts[TEST_VERSIONS - 1U];
+  memset(soc->entries[0][0].backup, 0xAB, sizeof(soc->entries[0][0].backup));
+  test_record(1U, soc, 0U);
+  TEST_CHECK(ws_br_agent_history_get_topology(&soc->addr, UINT64_MAX, &topology, &version_us) == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(test_same(&topology, soc, 0U));
+  TEST_CHECK(ws_br_agent_history_get_topology(&soc->addr, soc->times_us[TEST_VERSIONS - 1U], &topology, &version_us)
+             == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(test_same(&topology, soc, TEST_VERSIONS - 1U));
+  soc = &test_socs[1];
+  TEST_CHECK(ws_br_agent_history_get_topology(&soc->addr, UINT64_MAX, &topology, &version_us) == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(test_same(&topology, soc, TEST_VERSIONS - 1U));
+  ws_br_agent_soc_host_free_topology(&topology);
+
+  ws_br_agent_history_deinit();
+  for (size_t s = 0U; s < TEST_SOC_COUNT; ++s) {
+    ws_br_agent_topo_free(&test_socs[s].prev);
+  }
+  unlink(path);
+  rmdir(dir);
+  return test_result();
+}
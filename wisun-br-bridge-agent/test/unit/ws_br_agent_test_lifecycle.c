@@ -0,0 +1,213 @@
+/***************************************************************************//**
+ * @file ws_br_agent_test_lifecycle.c
+ * @brief Unit tests of the node lifecycles: joins, departures, returns, parent changes and eviction
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ws_br_agent_lifecycle.h"
+#include "ws_br_agent_test.h"
+
+/// Seconds to the update time
+#define TEST_S(s) ((uint64_t)(s) * 1000000ULL)
+
+static ws_br_agent_soc_host_topology_entry_t test_entries[WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES];
+static ws_br_agent_topo_t test_prev;
+static ws_br_agent_topo_t test_cur;
+
+/// Node id under node parent, id 0 is the Border Router
+static void test_set(uint32_t i, uint32_t id, uint32_t parent)
+{
+  test_entry(&test_entries[i], 0U, id, id ? parent : TEST_NO_PARENT);
+}
+
+/// Account a topology as the SoC host does: unchanged topologies only touch the table
+static void test_update(ws_br_agent_lifecycle_t *lc, uint32_t count, uint64_t time_us)
+{
+  ws_br_agent_soc_host_topology_t topology = { .entry_count = count, .entries = test_entries };
+  ws_br_agent_topo_t swap;
+
+  TEST_CHECK(ws_br_agent_topo_build(&test_cur, &topology) == WS_BR_AGENT_RET_OK);
+  if (test_prev.node_count && ws_br_agent_topo_equal(&test_cur, &test_prev)) {
+    ws_br_agent_lifecycle_touch(lc, time_us);
+  } else {
+    TEST_CHECK(ws_br_agent_lifecycle_update(lc, &test_prev, &topology, time_us) == WS_BR_AGENT_RET_OK);
+  }
+  swap = test_prev;
+  test_prev = test_cur;
+  test_cur = swap;
+}
+
+static ws_br_agent_lifecycle_node_t test_get(const ws_br_agent_lifecycle_t *lc, uint32_t id, bool *found)
+{
+  ws_br_agent_lifecycle_node_t node = { 0 };
+  uint8_t addr[16];
+
+  test_addr(addr, 0U, id);
+  *found = ws_br_agent_lifecycle_get(lc, addr, &node) == WS_BR_AGENT_RET_OK;
+  return node;
+}
+
+static int test_count_present(void *ctx, const ws_br_agent_lifecycle_node_t *node)
+{
+  if (node->present) {
+    (*(uint32_t *)ctx)++;
+  }
+  return 0;
+}
+
+/// A small network through each transition
+static void test_transitions(void)
+{
+  ws_br_agent_lifecycle_t lc = { 0 };
+  ws_br_agent_lifecycle_node_t node = { 0 };
+  uint8_t addr[16];
+  uint32_t present = 0U;
+  bool found = false;
+
+  // Border Router, 1 and 2 under it, 3 under 1, 4 under 2
+  test_set(0U, 0U, 0U);
+  test_set(1U, 1U, 0U);
+  test_set(2U, 2U, 0U);
+  test_set(3U, 3U, 1U);
+  test_set(4U, 4U, 2U);
+  test_update(&lc, 5U, TEST_S(1));
+  TEST_CHECK(lc.count == 5U);
+  node = test_get(&lc, 3U, &found);
+  TEST_CHECK(found && node.present && node.first_seen_us == TEST_S(1) && node.last_seen_us == TEST_S(1));
+  test_addr(addr, 0U, 1U);
+  TEST_CHECK(!memcmp(node.parent, addr, 16U));
+  TEST_CHECK(!node.reparents && !node.flaps);
+
+  // Same topology: seen again
+  test_update(&lc, 5U, TEST_S(2));
+  node = test_get(&lc, 4U, &found);
+  TEST_CHECK(found && node.present && node.first_seen_us == TEST_S(1) && node.last_seen_us == TEST_S(2));
+
+  // 4 leaves, last seen by the previous topology
+  test_update(&lc, 4U, TEST_S(3));
+  node = test_get(&lc, 4U, &found);
+  TEST_CHECK(found && !node.present && node.last_seen_us == TEST_S(2));
+  node = test_get(&lc, 3U, &found);
+  TEST_CHECK(found && node.present && node.last_seen_us == TEST_S(3));
+
+  // 3 moves under 2
+  test_set(3U, 3U, 2U);
+  test_update(&lc, 4U, TEST_S(4));
+  node = test_get(&lc, 3U, &found);
+  TEST_CHECK(found && node.reparents == 1U && !node.flaps);
+  test_addr(addr, 0U, 2U);
+  TEST_CHECK(!memcmp(node.parent, addr, 16U));
+  test_addr(addr, 0U, 1U);
+  TEST_CHECK(!memcmp(node.prev_parent, addr, 16U));
+
+  // 4 comes back, a flap
+  test_update(&lc, 5U, TEST_S(5));
+  node = test_get(&lc, 4U, &found);
+  TEST_CHECK(found && node.present && node.flaps == 1U && !node.reparents && node.first_seen_us == TEST_S(1));
+  TEST_CHECK(lc.count == 5U);
+  TEST_CHECK(ws_br_agent_lifecycle_foreach(&lc, test_count_present, &present) == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(present == 5U);
+
+  // 4 leaves again and is forgotten after the longest absence, at the next change
+  test_update(&lc, 4U, TEST_S(6));
+  test_update(&lc, 4U, TEST_S(6 + WS_BR_AGENT_LIFECYCLE_MAX_ABSENCE_S));
+  node = test_get(&lc, 4U, &found);
+  TEST_CHECK(found);
+  test_set(3U, 3U, 1U);
+  test_update(&lc, 4U, TEST_S(6 + WS_BR_AGENT_LIFECYCLE_MAX_ABSENCE_S + 1U));
+  node = test_get(&lc, 4U, &found);
+  TEST_CHECK(!found);
+  TEST_CHECK(lc.count == 4U);
+  node = test_get(&lc, 3U, &found);
+  TEST_CHECK(found && node.present && node.reparents == 2U && node.first_seen_us == TEST_S(1));
+
+  ws_br_agent_lifecycle_free(&lc);
+  TEST_CHECK(lc.count == 0U && lc.nodes == NULL);
+  ws_br_agent_topo_free(&test_prev);
+  ws_br_agent_topo_free(&test_cur);
+}
+
+/// A full table makes room for new nodes by evicting the ones gone for the longest time
+static void test_eviction(void)
+{
+  ws_br_agent_lifecycle_t lc = { 0 };
+  ws_br_agent_lifecycle_node_t node = { 0 };
+  uint32_t count = WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES < WS_BR_AGENT_LIFECYCLE_MAX_NODES
+                   ? WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES : WS_BR_AGENT_LIFECYCLE_MAX_NODES;
+  uint32_t present = 0U;
+  bool found = false;
+
+  // Full table
+  test_tree(test_entries, 0U, NULL, count, 2U);
+  test_update(&lc, count, TEST_S(1));
+  TEST_CHECK(lc.count == count);
+
+  // The first half leaves, the second half moves under the Border Router
+  for (uint32_t i = 1U; i <= count / 2U; ++i) {
+    test_set(i, count / 2U + i - 1U, 0U);
+  }
+  test_update(&lc, count / 2U + 1U, TEST_S(2));
+  TEST_CHECK(lc.count == count);
+
+  // Then new nodes take their place, the longest gone first
+  for (uint32_t i = 1U; i < count / 2U; ++i) {
+    test_set(count / 2U + i, count + i, 0U);
+  }
+  test_update(&lc, count, TEST_S(3));
+  TEST_CHECK(lc.count == count && !lc.full);
+  TEST_CHECK(ws_br_agent_lifecycle_foreach(&lc, test_count_present, &present) == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(present == count);
+  node = test_get(&lc, count + 1U, &found);
+  TEST_CHECK(found && node.present && node.first_seen_us == TEST_S(3));
+  node = test_get(&lc, 0U, &found);
+  TEST_CHECK(found && node.present && node.first_seen_us == TEST_S(1));
+  node = test_get(&lc, 1U, &found);
+  TEST_CHECK(!found);
+  node = test_get(&lc, count / 2U - 1U, &found);
+  TEST_CHECK(!found);
+
+  ws_br_agent_lifecycle_free(&lc);
+  ws_br_agent_topo_free(&test_prev);
+  ws_br_agent_topo_free(&test_cur);
+}
+
+int main(int argc, char **argv)
+{
+  if (!test_init(argc, argv)) {
+    return EXIT_FAILURE;
+  }
+  test_transitions();
+  test_eviction();
+  TEST_CHECK(test_mem_released(WS_BR_AGENT_MEM_SUBSYS_LIFECYCLE));
+  TEST_CHECK(test_mem_released(WS_BR_AGENT_MEM_SUBSYS_TABLES));
+  return test_result();
+}
@@ -0,0 +1,172 @@
+/***************************************************************************//**
+ * @file ws_br_agent_test_msg_crc.c
+ * @brief Unit tests of the CRC32C frame trailer: checksum, framing and corruption detection
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ws_br_agent_crc.h"
+#include "ws_br_agent_msg.h"
+#include "ws_br_agent_test.h"
+
+/// Payload size, an odd number of bytes
+#define TEST_PAYLOAD_SIZE 1021U
+
+static uint8_t test_payload[TEST_PAYLOAD_SIZE + 16U];
+
+/// Bitwise CRC32C (reflected polynomial 0x82F63B78)
+static uint32_t test_crc32c_ref(const uint8_t *buf, size_t len)
+{
+  uint32_t crc = 0xFFFFFFFFU;
+
+  for (size_t i = 0U; i < len; ++i) {
+    crc ^= buf[i];
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (0x82F63B78U & (0U - (crc & 1U)));
+    }
+  }
+  return ~crc;
+}
+
+/// Known vector, reference CRC, then any split of unaligned data gives the CRC of the whole
+static void test_crc32c(void)
+{
+  uint32_t crc = 0U;
+  uint32_t whole = 0U;
+
+  TEST_CHECK(ws_br_agent_crc32c(0U, "123456789", 9U) == 0xE3069283U);
+  TEST_CHECK(ws_br_agent_crc32c(0U, test_payload, 0U) == 0U);
+  for (size_t len = 1U; len <= 64U; ++len) {
+    TEST_CHECK(ws_br_agent_crc32c(0U, test_payload, len) == test_crc32c_ref(test_payload, len));
+  }
+  TEST_CHECK(ws_br_agent_crc32c(0U, test_payload, TEST_PAYLOAD_SIZE)
+             == test_crc32c_ref(test_payload, TEST_PAYLOAD_SIZE));
+  for (size_t offset = 0U; offset < 8U; ++offset) {
+    whole = ws_br_agent_crc32c(0U, test_payload + offset, TEST_PAYLOAD_SIZE);
+    for (size_t split = 0U; split <= 17U; ++split) {
+      crc = ws_br_agent_crc32c(0U, test_payload + offset, split);
+      crc = ws_br_agent_crc32c(crc, test_payload + offset + split, TEST_PAYLOAD_SIZE - split);
+      TEST_CHECK(crc == whole);
+    }
+  }
+}
+
+/// Build a TOPOLOGY frame, then parse it back
+static void test_frame(bool with_crc)
+{
+  ws_br_agent_msg_t msg = {
+    .msg_code = WS_BR_AGENT_MSG_CODE_TOPOLOGY,
+    .payload_len = TEST_PAYLOAD_SIZE,
+    .payload = test_payload,
+    .crc = with_crc,
+  };
+  ws_br_agent_msg_t *parsed = NULL;
+  uint8_t *buf = NULL;
+  size_t size = 0U;
+
+  buf = ws_br_agent_msg_build_buf(&msg, &size);
+  TEST_CHECK(buf != NULL);
+  if (buf == NULL) {
+    return;
+  }
+  TEST_CHECK(size == WS_BR_AGENT_MSG_MIN_BUF_SIZE + TEST_PAYLOAD_SIZE
+                     + (with_crc ? WS_BR_AGENT_MSG_CRC_SIZE : 0U));
+  TEST_CHECK(ws_br_agent_msg_frame_size(buf) == size);
+  TEST_CHECK(!(ws_br_agent_get_be32(buf) & WS_BR_AGENT_MSG_FLAG_CRC32C) == !with_crc);
+  TEST_CHECK(ws_br_agent_msg_check_crc(buf, size) == WS_BR_AGENT_RET_OK);
+
+  parsed = ws_br_agent_msg_parse_buf(buf, size);
+  TEST_CHECK(parsed != NULL);
+  if (parsed != NULL) {
+    TEST_CHECK(parsed->msg_code == WS_BR_AGENT_MSG_CODE_TOPOLOGY);
+    TEST_CHECK(parsed->crc == with_crc);
+    TEST_CHECK(parsed->payload_len == TEST_PAYLOAD_SIZE);
+    TEST_CHECK(parsed->payload != NULL && !memcmp(parsed->payload, test_payload, TEST_PAYLOAD_SIZE));
+    ws_br_agent_msg_free(parsed);
+  }
+
+  if (with_crc) {
+    // Truncated trailer
+    TEST_CHECK(ws_br_agent_msg_check_crc(buf, size - 1U) != WS_BR_AGENT_RET_OK);
+    // Any single bit error, the CRC flag aside (a frame without a trailer is not checked)
+    for (size_t i = 0U; i < size; ++i) {
+      for (uint8_t bit = 1U; bit; bit <<= 1) {
+        if (!i && bit == 0x80U) {
+          continue;
+        }
+        buf[i] ^= bit;
+        if (ws_br_agent_msg_check_crc(buf, size) == WS_BR_AGENT_RET_OK) {
+          fprintf(stderr, "Bit error at byte %zu (0x%02x) not detected\n", i, bit);
+          test_failures++;
+        }
+        buf[i] ^= bit;
+      }
+    }
+    TEST_CHECK(ws_br_agent_msg_check_crc(buf, size) == WS_BR_AGENT_RET_OK);
+  }
+  ws_br_agent_msg_free_buf(buf);
+}
+
+/// Frame sizes announced by a header
+static void test_frame_size(void)
+{
+  uint8_t hdr[WS_BR_AGENT_MSG_MIN_BUF_SIZE];
+  uint64_t max_size = (uint64_t)WS_BR_AGENT_MSG_MIN_BUF_SIZE + UINT32_MAX + WS_BR_AGENT_MSG_CRC_SIZE;
+
+  ws_br_agent_put_be32(hdr, WS_BR_AGENT_MSG_CODE_TOPOLOGY);
+  ws_br_agent_put_be32(hdr + 4U, 0U);
+  TEST_CHECK(ws_br_agent_msg_frame_size(hdr) == WS_BR_AGENT_MSG_MIN_BUF_SIZE);
+  ws_br_agent_put_be32(hdr, WS_BR_AGENT_MSG_CODE_TOPOLOGY | WS_BR_AGENT_MSG_FLAG_CRC32C);
+  TEST_CHECK(ws_br_agent_msg_frame_size(hdr) == WS_BR_AGENT_MSG_MIN_BUF_SIZE + WS_BR_AGENT_MSG_CRC_SIZE);
+  // The largest length does not wrap around
+  ws_br_agent_put_be32(hdr + 4U, UINT32_MAX);
+  TEST_CHECK(ws_br_agent_msg_frame_size(hdr) == (max_size > SIZE_MAX ? SIZE_MAX : (size_t)max_size));
+  // A header announcing more than the buffer holds is neither checked nor parsed
+  TEST_CHECK(ws_br_agent_msg_check_crc(hdr, sizeof(hdr)) != WS_BR_AGENT_RET_OK);
+  TEST_CHECK(ws_br_agent_msg_parse_buf(hdr, sizeof(hdr)) == NULL);
+}
+
+int main(int argc, char **argv)
+{
+  if (!test_init(argc, argv)) {
+    return EXIT_FAILURE;
+  }
+  for (size_t i = 0U; i < sizeof(test_payload); ++i) {
+    test_payload[i] = (uint8_t)(i * 131U + 7U);
+  }
+  printf("CRC32C implementation: %s\n", ws_br_agent_crc32c_impl());
+  test_crc32c();
+  test_frame(false);
+  test_frame(true);
+  test_frame_size();
+  return test_result();
+}
@@ -0,0 +1,190 @@
+/***************************************************************************//**
+ * @file ws_br_agent_test_node_stats.c
+ * @brief Unit tests of the node metrics table: updates, moves along topology changes and walks
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ws_br_agent_node_stats.h"
+#include "ws_br_agent_test.h"
+
+/// Nodes of the first topology
+#define TEST_NODES 500U
+/// Topology changes the metrics follow
+#define TEST_ROUNDS 4U
+/// Metrics reception time
+#define TEST_TIME_US 1000000000ULL
+
+static ws_br_agent_soc_host_topology_entry_t test_entries[TEST_NODES * 2U];
+static ws_br_agent_node_stats_entry_t test_stats[TEST_NODES * 2U];
+
+/// Every node under the Border Router
+static void test_build(ws_br_agent_topo_t *topo, const uint32_t *ids, uint32_t count)
+{
+  ws_br_agent_soc_host_topology_t topology = { .entry_count = count, .entries = test_entries };
+
+  test_tree(test_entries, 0U, ids, count, UINT32_MAX);
+  TEST_CHECK(ws_br_agent_topo_build(topo, &topology) == WS_BR_AGENT_RET_OK);
+}
+
+typedef struct test_walk {
+  const ws_br_agent_topo_t *topo;
+  uint32_t rows;
+  uint32_t stop_after;
+  bool has_metrics[TEST_NODES * 4U];
+} test_walk_t;
+
+static test_walk_t test_walk_ctx;
+
+static int test_check_row(void *ctx, const ws_br_agent_node_stats_row_t *row)
+{
+  test_walk_t *walk = (test_walk_t *)ctx;
+  uint32_t id = test_addr_id(row->target);
+  uint8_t addr[16];
+
+  ws_br_agent_topo_get_addr(walk->topo, row->index, addr);
+  TEST_CHECK(!memcmp(addr, row->target, 16U));
+  TEST_CHECK(id < TEST_NODES * 4U && walk->has_metrics[id]);
+  TEST_CHECK(test_node_stats_row_ok(row, TEST_TIME_US));
+  walk->rows++;
+  return walk->stop_after && walk->rows == walk->stop_after ? -1 : 0;
+}
+
+/// Walk all the rows, they must be the nodes with metrics of the topology
+static void test_walk(const ws_br_agent_node_stats_t *stats, const ws_br_agent_topo_t *topo,
+                      const uint32_t *ids, uint32_t count)
+{
+  uint32_t expected = 0U;
+
+  for (uint32_t i = 0U; i < count; ++i) {
+    expected += test_walk_ctx.has_metrics[ids[i]] ? 1U : 0U;
+  }
+  test_walk_ctx.topo = topo;
+  test_walk_ctx.rows = 0U;
+  test_walk_ctx.stop_after = 0U;
+  TEST_CHECK(ws_br_agent_node_stats_foreach(stats, topo, 0U, 0U, test_check_row, &test_walk_ctx)
+             == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(test_walk_ctx.rows == expected);
+}
+
+/// Metrics of a node, its target address given by its id
+static void test_stats_entry(ws_br_agent_node_stats_entry_t *entry, uint32_t id)
+{
+  uint8_t target[16];
+
+  test_addr(target, 0U, id);
+  test_node_stats_entry(entry, target);
+}
+
+int main(int argc, char **argv)
+{
+  static uint32_t ids[TEST_NODES * 2U];
+  static uint32_t prev_ids[TEST_NODES * 2U];
+  ws_br_agent_node_stats_t stats = { 0 };
+  ws_br_agent_topo_t prev = { 0 };
+  ws_br_agent_topo_t topo = { 0 };
+  ws_br_agent_topo_t swap;
+  uint32_t count = TEST_NODES;
+  uint32_t prev_count = 0U;
+  uint32_t unknown = 0U;
+  uint32_t n = 0U;
+
+  if (!test_init(argc, argv)) {
+    return EXIT_FAILURE;
+  }
+
+  for (uint32_t i = 0U; i < count; ++i) {
+    ids[i] = i;
+  }
+  test_build(&topo, ids, count);
+  // No metrics yet: nothing to move
+  ws_br_agent_node_stats_remap(&stats, &topo, &topo);
+  TEST_CHECK(stats.block == NULL);
+
+  // Metrics of every node but the odd ones, in topology order, then an unknown target
+  for (uint32_t i = 0U; i < count; i += 2U) {
+    test_stats_entry(&test_stats[n++], ids[i]);
+    test_walk_ctx.has_metrics[ids[i]] = true;
+  }
+  test_stats_entry(&test_stats[n++], TEST_NODES * 3U);
+  TEST_CHECK(ws_br_agent_node_stats_update(&stats, &topo, test_stats, n, TEST_TIME_US, &unknown)
+             == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(unknown == 1U);
+  // Then the odd ones, in reverse order
+  n = 0U;
+  for (uint32_t i = count - 1U; i < count; i -= 2U) {
+    test_stats_entry(&test_stats[n++], ids[i]);
+    test_walk_ctx.has_metrics[ids[i]] = true;
+  }
+  TEST_CHECK(ws_br_agent_node_stats_update(&stats, &topo, test_stats, n, TEST_TIME_US, &unknown)
+             == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(unknown == 0U);
+  test_walk(&stats, &topo, ids, count);
+
+  // A window of the topology, and a walk stopped by its callback
+  test_walk_ctx.rows = 0U;
+  TEST_CHECK(ws_br_agent_node_stats_foreach(&stats, &topo, 100U, 50U, test_check_row, &test_walk_ctx)
+             == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(test_walk_ctx.rows == 50U);
+  test_walk_ctx.rows = 0U;
+  test_walk_ctx.stop_after = 10U;
+  TEST_CHECK(ws_br_agent_node_stats_foreach(&stats, &topo, 0U, 0U, test_check_row, &test_walk_ctx)
+             != WS_BR_AGENT_RET_OK);
+  TEST_CHECK(test_walk_ctx.rows == 10U);
+
+  // Each round: the order is reversed, a tenth of the nodes leave, new nodes without metrics join
+  for (uint32_t round = 0U; round < TEST_ROUNDS; ++round) {
+    memcpy(prev_ids, ids, count * sizeof(ids[0]));
+    prev_count = count;
+    count = 1U;
+    for (uint32_t i = prev_count - 1U; i > 0U; --i) {
+      if (prev_ids[i] % 10U != round) {
+        ids[count++] = prev_ids[i];
+      }
+    }
+    for (uint32_t i = 0U; i < TEST_NODES / 20U; ++i) {
+      ids[count++] = TEST_NODES + round * (TEST_NODES / 20U) + i;
+    }
+    swap = prev;
+    prev = topo;
+    topo = swap;
+    test_build(&topo, ids, count);
+    ws_br_agent_node_stats_remap(&stats, &prev, &topo);
+    TEST_CHECK(stats.row_count == count);
+    test_walk(&stats, &topo, ids, count);
+  }
+
+  ws_br_agent_node_stats_free(&stats);
+  ws_br_agent_topo_free(&prev);
+  ws_br_agent_topo_free(&topo);
+  TEST_CHECK(test_mem_released(WS_BR_AGENT_MEM_SUBSYS_TABLES));
+  return test_result();
+}
@@ -0,0 +1,201 @@
+/***************************************************************************//**
+ * @file ws_br_agent_test_settings_tlv.c
+ * @brief Unit tests of the TLV settings encoding: round trip, partial update and rejected payloads
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ws_br_agent_settings.h"
+#include "ws_br_agent_soc_host.h"
+#include "ws_br_agent_test.h"
+
+static uint8_t test_buf[WS_BR_AGENT_SETTINGS_TLV_MAX_SIZE + 64U];
+
+static const ws_br_agent_settings_field_t *test_field(const char *key)
+{
+  return ws_br_agent_settings_find_field(key, strlen(key));
+}
+
+/// Every field in use survives an encode/decode round trip onto blank settings
+static void test_round_trip(const ws_br_agent_settings_t *defaults)
+{
+  char expected[WS_BR_AGENT_SETTINGS_FIELD_TEXT_MAX_SIZE];
+  char actual[WS_BR_AGENT_SETTINGS_FIELD_TEXT_MAX_SIZE];
+  const ws_br_agent_settings_field_t *fields = NULL;
+  ws_br_agent_settings_t settings = { 0 };
+  size_t field_count = 0U;
+  size_t in_use = 0U;
+  size_t count = 0U;
+  size_t len = 0U;
+
+  TEST_CHECK(ws_br_agent_settings_tlv_encode(defaults, NULL, 0U, test_buf, sizeof(test_buf), &len)
+             == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(ws_br_agent_settings_tlv_detect(test_buf, len));
+  TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, len, &settings, &field_count) == WS_BR_AGENT_RET_OK);
+
+  fields = ws_br_agent_settings_fields(&count);
+  for (size_t i = 0U; i < count; ++i) {
+    if (!fields[i].tag || !ws_br_agent_settings_field_applies(&fields[i], defaults)) {
+      continue;
+    }
+    in_use++;
+    ws_br_agent_settings_format(&fields[i], defaults, expected, sizeof(expected));
+    ws_br_agent_settings_format(&fields[i], &settings, actual, sizeof(actual));
+    if (strcmp(expected, actual)) {
+      fprintf(stderr, "%s: %s != %s\n", fields[i].key, actual, expected);
+      TEST_CHECK(!strcmp(expected, actual));
+    }
+  }
+  TEST_CHECK(field_count == in_use);
+
+  // Too small a buffer is an error, not a truncated payload
+  TEST_CHECK(ws_br_agent_settings_tlv_encode(defaults, NULL, 0U, test_buf, len - 1U, &len)
+             != WS_BR_AGENT_RET_OK);
+}
+
+/// Only the fields present are applied, payloads that do not decode as a whole change nothing
+static void test_partial(const ws_br_agent_settings_t *defaults)
+{
+  const ws_br_agent_settings_field_t *fields[] = {
+    test_field("network_name"),
+    test_field("bc_interval_ms"),
+  };
+  ws_br_agent_settings_t expected = *defaults;
+  ws_br_agent_settings_t settings = *defaults;
+  size_t field_count = 0U;
+  size_t len = 0U;
+
+  TEST_CHECK(fields[0] != NULL && fields[1] != NULL);
+  TEST_CHECK(ws_br_agent_settings_set_str(fields[0], &expected, "Partial") == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(ws_br_agent_settings_set_int(fields[1], &expected, 1234) == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(ws_br_agent_settings_tlv_encode(&expected, fields, 2U, test_buf, sizeof(test_buf), &len)
+             == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(len == WS_BR_AGENT_SETTINGS_TLV_HDR_SIZE + 2U * WS_BR_AGENT_SETTINGS_TLV_FIELD_HDR_SIZE
+                    + strlen("Partial") + fields[1]->size);
+
+  // Every truncation is rejected
+  for (size_t i = 0U; i < len; ++i) {
+    TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, i, &settings, NULL) != WS_BR_AGENT_RET_OK);
+  }
+  TEST_CHECK(!memcmp(&settings, defaults, sizeof(settings)));
+
+  TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, len, &settings, &field_count) == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(field_count == 2U);
+  TEST_CHECK(!memcmp(&settings, &expected, sizeof(settings)));
+
+  // An unknown tag is skipped
+  settings = *defaults;
+  ws_br_agent_put_be16(test_buf + len, 0x7FFFU);
+  ws_br_agent_put_be16(test_buf + len + 2U, 3U);
+  memset(test_buf + len + 4U, 0xA5, 3U);
+  ws_br_agent_put_be16(test_buf + 6U, 3U);
+  TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, len + 7U, &settings, &field_count) == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(field_count == 2U);
+  TEST_CHECK(!memcmp(&settings, &expected, sizeof(settings)));
+
+  // Trailing bytes
+  settings = *defaults;
+  TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, len + 8U, &settings, NULL) != WS_BR_AGENT_RET_OK);
+  TEST_CHECK(!memcmp(&settings, defaults, sizeof(settings)));
+}
+
+/// Single field payload
+static size_t test_payload(uint8_t version, uint16_t tag, const void *value, uint16_t value_len)
+{
+  ws_br_agent_put_be32(test_buf, WS_BR_AGENT_SETTINGS_TLV_MAGIC);
+  test_buf[4] = version;
+  test_buf[5] = 0U;
+  ws_br_agent_put_be16(test_buf + 6U, 1U);
+  ws_br_agent_put_be16(test_buf + 8U, tag);
+  ws_br_agent_put_be16(test_buf + 10U, value_len);
+  memcpy(test_buf + 12U, value, value_len);
+  return 12U + value_len;
+}
+
+static void test_malformed(const ws_br_agent_settings_t *defaults)
+{
+  const ws_br_agent_settings_field_t *name = test_field("network_name");
+  const ws_br_agent_settings_field_t *dwell = test_field("uc_dwell_interval_ms");
+  ws_br_agent_settings_t settings = *defaults;
+  uint8_t value[WS_BR_AGENT_NETWORK_NAME_SIZE + 1U] = { 0 };
+  size_t len = 0U;
+
+  TEST_CHECK(name != NULL && dwell != NULL);
+  // Well formed
+  value[0] = 255U;
+  len = test_payload(WS_BR_AGENT_SETTINGS_TLV_VERSION, dwell->tag, value, 1U);
+  TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, len, &settings, NULL) == WS_BR_AGENT_RET_OK);
+  TEST_CHECK(settings.uc_dwell_interval_ms == 255U);
+  settings = *defaults;
+
+  // Unsupported version
+  len = test_payload(WS_BR_AGENT_SETTINGS_TLV_VERSION + 1U, dwell->tag, value, 1U);
+  TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, len, &settings, NULL) != WS_BR_AGENT_RET_OK);
+  // Out of range
+  value[0] = 14U;
+  len = test_payload(WS_BR_AGENT_SETTINGS_TLV_VERSION, dwell->tag, value, 1U);
+  TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, len, &settings, NULL) != WS_BR_AGENT_RET_OK);
+  // Integer wider than the field
+  len = test_payload(WS_BR_AGENT_SETTINGS_TLV_VERSION, dwell->tag, value, 9U);
+  TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, len, &settings, NULL) != WS_BR_AGENT_RET_OK);
+  // Empty integer
+  len = test_payload(WS_BR_AGENT_SETTINGS_TLV_VERSION, dwell->tag, value, 0U);
+  TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, len, &settings, NULL) != WS_BR_AGENT_RET_OK);
+  // String with a NUL, string with no room for its NUL
+  memcpy(value, "Bad\0Name", 8U);
+  len = test_payload(WS_BR_AGENT_SETTINGS_TLV_VERSION, name->tag, value, 8U);
+  TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, len, &settings, NULL) != WS_BR_AGENT_RET_OK);
+  memset(value, 'N', sizeof(value));
+  len = test_payload(WS_BR_AGENT_SETTINGS_TLV_VERSION, name->tag, value, name->size);
+  TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, len, &settings, NULL) != WS_BR_AGENT_RET_OK);
+  TEST_CHECK(!memcmp(&settings, defaults, sizeof(settings)));
+
+  // A legacy payload starts with the network name
+  memset(test_buf, 0, sizeof(test_buf));
+  memcpy(test_buf, defaults->network_name, strlen(defaults->network_name));
+  TEST_CHECK(!ws_br_agent_settings_tlv_detect(test_buf, sizeof(ws_br_agent_settings_t)));
+  TEST_CHECK(ws_br_agent_settings_tlv_decode(test_buf, sizeof(ws_br_agent_settings_t), &settings, NULL)
+             != WS_BR_AGENT_RET_OK);
+}
+
+int main(int argc, char **argv)
+{
+  const ws_br_agent_settings_t *defaults = NULL;
+
+  if (!test_init(argc, argv)) {
+    return EXIT_FAILURE;
+  }
+  defaults = ws_br_agent_soc_host_get_default_settings();
+  test_round_trip(defaults);
+  test_partial(defaults);
+  test_malformed(defaults);
+  return test_result();
+}
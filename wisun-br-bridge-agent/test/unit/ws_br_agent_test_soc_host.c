@@ -0,0 +1,151 @@
+/***************************************************************************//**
+ * @file ws_br_agent_test_soc_host.c
+ * @brief Unit tests of the SoC host shards: topology, node metrics and RoutingGraph on every SoC
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <systemd/sd-bus.h>
+
+#include "ws_br_agent_soc_host.h"
+#include "ws_br_agent_node_stats.h"
+#include "ws_br_agent_dbus.h"
+#include "ws_br_agent_test.h"
+
+/// Update rounds per SoC, each one a changed topology
+#define TEST_ROUNDS 3U
+
+/// Node counts tested, up to a full topology
+static const uint32_t test_node_counts[] = { 100U, 2000U, WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES };
+
+static ws_br_agent_soc_host_topology_entry_t test_entries[WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES];
+static ws_br_agent_node_stats_entry_t test_stats[WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES];
+static uint32_t test_ids[WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES];
+
+/// Binary tree of count nodes under the Border Router of a SoC, the round changes the leaf ids
+static void test_fill(uint32_t count, size_t shard, uint32_t round)
+{
+  for (uint32_t i = 0U; i < count; ++i) {
+    test_ids[i] = i >= count / 2U ? i | (round << 24) : i;
+  }
+  test_tree(test_entries, (uint8_t)shard, test_ids, count, 2U);
+  for (uint32_t i = 0U; i < count; ++i) {
+    test_node_stats_entry(&test_stats[i], test_entries[i].target);
+  }
+}
+
+static int test_count_rows(void *ctx, const ws_br_agent_node_stats_row_t *row)
+{
+  (void)row;
+  (*(uint32_t *)ctx)++;
+  return 0;
+}
+
+/// Push TOPOLOGY and NODE_STATS to a SoC, then read its RoutingGraph back
+static void test_shard(sd_bus *bus, size_t shard, uint32_t count)
+{
+  ws_br_agent_soc_host_topology_t topology = { 0 };
+  sd_bus_message *reply = NULL;
+  uint32_t unknown = 0U;
+  uint32_t rows = 0U;
+  uint32_t node_count = 0U;
+
+  for (uint32_t round = 0U; round < TEST_ROUNDS; ++round) {
+    test_fill(count, shard, round);
+    topology.entry_count = count;
+    topology.entries = test_entries;
+    TEST_CHECK(ws_br_agent_soc_host_shard_set_topology(shard, &topology, NULL) == WS_BR_AGENT_RET_OK);
+    TEST_CHECK(ws_br_agent_soc_host_shard_set_node_stats(shard, test_stats, count, &unknown)
+               == WS_BR_AGENT_RET_OK);
+    TEST_CHECK(unknown == 0U);
+
+    rows = 0U;
+    TEST_CHECK(ws_br_agent_soc_host_shard_foreach_node_stats(shard, 0U, 0U, test_count_rows, &rows, &node_count)
+               == WS_BR_AGENT_RET_OK);
+    TEST_CHECK(rows == count && node_count == count);
+
+    topology = (ws_br_agent_soc_host_topology_t) { 0 };
+    TEST_CHECK(ws_br_agent_soc_host_shard_get_topology(shard, &topology) == WS_BR_AGENT_RET_OK);
+    TEST_CHECK(topology.entry_count == count);
+    if (topology.entries != NULL) {
+      TEST_CHECK(!memcmp(topology.entries, test_entries, count * sizeof(test_entries[0])));
+    }
+    TEST_CHECK(sd_bus_message_new_method_call(bus, &reply, "com.silabs.Wisun.SocBorderRouterAgent",
+                                              "/com/silabs/Wisun/SocBorderRouterAgent",
+                                              "org.freedesktop.DBus.Properties", "Get") >= 0);
+    TEST_CHECK(ws_br_agent_dbus_append_routing_graph(reply, &topology) >= 0);
+    reply = sd_bus_message_unref(reply);
+    ws_br_agent_soc_host_free_topology(&topology);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  struct in6_addr addr = { 0 };
+  sd_bus *bus = NULL;
+  size_t shard = 0U;
+  int fds[2] = { -1, -1 };
+
+  if (!test_init(argc, argv) || ws_br_agent_soc_host_init(WS_BR_AGENT_SOC_HOST_MAX_COUNT) != WS_BR_AGENT_RET_OK) {
+    return EXIT_FAILURE;
+  }
+  // Messages can be built on a bus that is started on an unconnected socket
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0
+      || sd_bus_new(&bus) < 0
+      || sd_bus_set_fd(bus, fds[0], fds[0]) < 0
+      || sd_bus_start(bus) < 0) {
+    fprintf(stderr, "Failed to set up the D-Bus message factory\n");
+    return EXIT_FAILURE;
+  }
+
+  // Every SoC at once: the tables of all of them are held together
+  for (size_t i = 0U; i < WS_BR_AGENT_SOC_HOST_MAX_COUNT; ++i) {
+    addr.s6_addr[0] = 0xFDU;
+    addr.s6_addr[15] = (uint8_t)(i + 1U);
+    TEST_CHECK(ws_br_agent_soc_host_shard_lookup(&addr, true, &shard, NULL) == WS_BR_AGENT_RET_OK);
+  }
+  TEST_CHECK(ws_br_agent_soc_host_shard_count() == WS_BR_AGENT_SOC_HOST_MAX_COUNT);
+  // No pool blocks are left for one more SoC
+  addr.s6_addr[15] = 0xFFU;
+  TEST_CHECK(ws_br_agent_soc_host_shard_lookup(&addr, true, &shard, NULL) != WS_BR_AGENT_RET_OK);
+  for (size_t i = 0U; i < sizeof(test_node_counts) / sizeof(test_node_counts[0]); ++i) {
+    for (shard = 0U; shard < ws_br_agent_soc_host_shard_count(); ++shard) {
+      test_shard(bus, shard, test_node_counts[i]);
+    }
+  }
+
+  sd_bus_unref(bus);
+  close(fds[1]);
+  return test_result();
+}
@@ -0,0 +1,723 @@
+/***************************************************************************//**
+ * @file ws_br_agent_loadgen.c
+ * @brief Load generator and benchmark for the Wi-SUN SoC Border Router Agent
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <systemd/sd-bus.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "loadgen"
+#include "ws_br_agent_defs.h"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_msg.h"
+#include "ws_br_agent_utils.h"
+#include "ws_br_agent_soc_host.h"
+
+#define HELP_STR \
+"Usage: wisun-br-bridge-agent-loadgen [--agent <agent address>] \
+[--port <agent port>] \
+[--connections <count>] \
+[--entries <count>] \
+[--unchanged] \
+[--dbus-clients <count>] \
+[--dbus-address <bus address>] \
+[--watch] \
+[--duration <s>] \
+[--pid <agent pid>] \
+[--label <name>] \
+[--output <json file>] \
+[--help]\n"
+
+/// Default agent address
+#define DEFAULT_AGENT_ADDR_STR "::1"
+
+/// D-Bus names of the agent
+#define AGENT_DBUS_NAME "com.silabs.Wisun.SocBorderRouterAgent"
+#define AGENT_DBUS_PATH "/com/silabs/Wisun/SocBorderRouterAgent"
+
+/// Agent process sampling period in us
+#define SAMPLE_PERIOD_US 100000ULL
+
+/// Initial latency sample capacity per worker
+#define SAMPLES_INIT_CAPACITY 4096U
+
+/// Drain buffer size for agent responses
+#define DRAIN_BUF_SIZE 256U
+
+/// @brief Latency samples of a worker
+typedef struct samples {
+  /// Latencies in us
+  uint32_t *data;
+  /// Number of samples
+  size_t count;
+  /// Allocated sample count
+  size_t capacity;
+  /// Failed requests
+  unsigned long errors;
+} samples_t;
+
+/// @brief Worker context
+typedef struct worker {
+  /// Thread
+  pthread_t thr;
+  /// Worker index
+  unsigned int index;
+  /// Samples
+  samples_t samples;
+} worker_t;
+
+/// @brief Agent process usage
+typedef struct proc_usage {
+  /// User + system CPU time in clock ticks
+  unsigned long long cpu_ticks;
+  /// Resident set size in kB
+  unsigned long rss_kb;
+  /// Peak resident set size in kB
+  unsigned long hwm_kb;
+} proc_usage_t;
+
+/// @brief Latency summary
+typedef struct summary {
+  unsigned long requests;
+  unsigned long errors;
+  double throughput;
+  uint32_t p50_us;
+  uint32_t p99_us;
+  uint32_t p999_us;
+  uint32_t max_us;
+} summary_t;
+
+static const char * const dbus_properties[] = {
+  "RoutingGraph", "WisunNetworkName", "WisunSize", "WisunDomain", "WisunPhyModeId",
+  "WisunChanPlanId", "WisunFanVersion", "WisunPanId", "WisunClass", "WisunMode"
+};
+
+static struct sockaddr_in6 agent_addr = { .sin6_family = AF_INET6 };
+static const char *dbus_address = NULL;
+static uint32_t entry_count = 100U;
+static bool unchanged = false;
+static atomic_bool watcher_ready = false;
+static atomic_bool workers_stop = false;
+static atomic_uint_fast32_t topology_seq = 0U;
+
+static ws_br_agent_ret_t push_topology(ws_br_agent_soc_host_topology_entry_t *entries,
+                                       uint32_t seq);
+static void *tcp_worker_fnc(void *arg);
+static void *dbus_worker_fnc(void *arg);
+static void *watch_worker_fnc(void *arg);
+static ws_br_agent_ret_t dbus_connect(sd_bus **bus);
+static ws_br_agent_ret_t samples_add(samples_t * const samples, uint64_t latency_us);
+static void summarize(worker_t * const workers, unsigned int count, double duration_s,
+                      summary_t * const summary);
+static ws_br_agent_ret_t read_proc_usage(pid_t pid, proc_usage_t * const usage);
+static void print_summary_json(FILE *out, const char *name, const summary_t * const summary,
+                               bool last);
+
+int main(int argc, char *argv[])
+{
+  const char *agent_addr_str = DEFAULT_AGENT_ADDR_STR;
+  const char *output_path = NULL;
+  const char *label = "";
+  uint16_t port = WS_BR_AGENT_SERVICE_PORT;
+  unsigned int tcp_count = 4U;
+  unsigned int dbus_count = 2U;
+  double duration_s = 10.0;
+  pid_t agent_pid = 0;
+  worker_t *tcp_workers = NULL;
+  worker_t *dbus_workers = NULL;
+  worker_t watch_worker = { 0 };
+  bool watch = false;
+  ws_br_agent_soc_host_topology_entry_t *prime_entries = NULL;
+  proc_usage_t usage_start = { 0U };
+  proc_usage_t usage = { 0U };
+  unsigned long rss_max_kb = 0UL;
+  bool have_usage = false;
+  uint64_t start_us = 0ULL;
+  uint64_t end_us = 0ULL;
+  double elapsed_s = 0.0;
+  summary_t tcp_summary = { 0U };
+  summary_t dbus_summary = { 0U };
+  summary_t watch_summary = { 0U };
+  FILE *out = stdout;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--agent") && (i + 1 < argc)) {
+      agent_addr_str = argv[++i];
+    } else if (!strcmp(argv[i], "--port") && (i + 1 < argc)) {
+      port = (uint16_t)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--connections") && (i + 1 < argc)) {
+      tcp_count = (unsigned int)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--entries") && (i + 1 < argc)) {
+      entry_count = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--unchanged")) {
+      unchanged = true;
+    } else if (!strcmp(argv[i], "--dbus-clients") && (i + 1 < argc)) {
+      dbus_count = (unsigned int)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--dbus-address") && (i + 1 < argc)) {
+      dbus_address = argv[++i];
+    } else if (!strcmp(argv[i], "--watch")) {
+      watch = true;
+    } else if (!strcmp(argv[i], "--duration") && (i + 1 < argc)) {
+      duration_s = strtod(argv[++i], NULL);
+    } else if (!strcmp(argv[i], "--pid") && (i + 1 < argc)) {
+      agent_pid = (pid_t)strtol(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--label") && (i + 1 < argc)) {
+      label = argv[++i];
+    } else if (!strcmp(argv[i], "--output") && (i + 1 < argc)) {
+      output_path = argv[++i];
+    } else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+      printf(HELP_STR);
+      return EXIT_SUCCESS;
+    } else {
+      printf("Unknown argument: %s\n", argv[i]);
+      printf(HELP_STR);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!entry_count || entry_count > WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES || duration_s <= 0.0
+      || (!tcp_count && !dbus_count) || strchr(label, '"') != NULL) {
+    printf("Invalid parameters (up to %u entries)\n", WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES);
+    printf(HELP_STR);
+    return EXIT_FAILURE;
+  }
+
+  // Keep stdout clean when the JSON report goes there
+  ws_br_agent_log_sinks = output_path != NULL ? WS_BR_AGENT_LOG_SINK_CONSOLE : 0U;
+
+  if (inet_pton(AF_INET6, agent_addr_str, &agent_addr.sin6_addr) != 1) {
+    fprintf(stderr, "Invalid agent IPv6 address: %s\n", agent_addr_str);
+    return EXIT_FAILURE;
+  }
+  agent_addr.sin6_port = htons(port);
+
+  tcp_workers = calloc(tcp_count + 1U, sizeof(worker_t));
+  dbus_workers = calloc(dbus_count + 1U, sizeof(worker_t));
+  if (tcp_workers == NULL || dbus_workers == NULL) {
+    fprintf(stderr, "Memory allocation failed\n");
+    return EXIT_FAILURE;
+  }
+
+  if (agent_pid > 0) {
+    have_usage = read_proc_usage(agent_pid, &usage_start) == WS_BR_AGENT_RET_OK;
+    if (!have_usage) {
+      fprintf(stderr, "Cannot read agent process %d usage\n", (int)agent_pid);
+    }
+    rss_max_kb = usage_start.rss_kb;
+  }
+
+  // Prime the agent so that RoutingGraph is readable from the first D-Bus request
+  prime_entries = malloc(entry_count * sizeof(ws_br_agent_soc_host_topology_entry_t));
+  if (prime_entries == NULL || push_topology(prime_entries, 0U) != WS_BR_AGENT_RET_OK) {
+    fprintf(stderr, "Failed to push the initial topology to [%s]:%u\n", agent_addr_str, port);
+    free(prime_entries);
+    return EXIT_FAILURE;
+  }
+  free(prime_entries);
+
+  // Subscribe to the change signals before the first push
+  if (watch) {
+    if (pthread_create(&watch_worker.thr, NULL, watch_worker_fnc, &watch_worker) != 0) {
+      fprintf(stderr, "Failed to create watch worker\n");
+      return EXIT_FAILURE;
+    }
+    while (!atomic_load(&watcher_ready)) {
+      usleep(1000U);
+    }
+  }
+
+  start_us = ws_br_agent_utils_get_monotonic_us();
+  for (unsigned int i = 0U; i < tcp_count; ++i) {
+    tcp_workers[i].index = i;
+    if (pthread_create(&tcp_workers[i].thr, NULL, tcp_worker_fnc, &tcp_workers[i]) != 0) {
+      fprintf(stderr, "Failed to create TCP worker\n");
+      return EXIT_FAILURE;
+    }
+  }
+  for (unsigned int i = 0U; i < dbus_count; ++i) {
+    dbus_workers[i].index = i;
+    if (pthread_create(&dbus_workers[i].thr, NULL, dbus_worker_fnc, &dbus_workers[i]) != 0) {
+      fprintf(stderr, "Failed to create D-Bus worker\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  end_us = start_us + (uint64_t)(duration_s * 1e6);
+  while (ws_br_agent_utils_get_monotonic_us() < end_us) {
+    usleep((useconds_t)SAMPLE_PERIOD_US);
+    if (have_usage && read_proc_usage(agent_pid, &usage) == WS_BR_AGENT_RET_OK
+        && usage.rss_kb > rss_max_kb) {
+      rss_max_kb = usage.rss_kb;
+    }
+  }
+  atomic_store(&workers_stop, true);
+
+  for (unsigned int i = 0U; i < tcp_count; ++i) {
+    pthread_join(tcp_workers[i].thr, NULL);
+  }
+  for (unsigned int i = 0U; i < dbus_count; ++i) {
+    pthread_join(dbus_workers[i].thr, NULL);
+  }
+  if (watch) {
+    pthread_join(watch_worker.thr, NULL);
+  }
+  elapsed_s = (double)(ws_br_agent_utils_get_monotonic_us() - start_us) / 1e6;
+
+  if (have_usage) {
+    have_usage = read_proc_usage(agent_pid, &usage) == WS_BR_AGENT_RET_OK;
+  }
+
+  summarize(tcp_workers, tcp_count, elapsed_s, &tcp_summary);
+  summarize(dbus_workers, dbus_count, elapsed_s, &dbus_summary);
+  summarize(&watch_worker, watch ? 1U : 0U, elapsed_s, &watch_summary);
+
+  if (output_path != NULL) {
+    out = fopen(output_path, "w");
+    if (out == NULL) {
+      ws_br_agent_log_error("Failed to open output file: %s\n", output_path);
+      return EXIT_FAILURE;
+    }
+  }
+
+  fprintf(out, "{\n"
+               "  \"label\": \"%s\",\n"
+               "  \"config\": { \"connections\": %u, \"entries\": %u, \"unchanged\": %s, "
+               "\"dbus_clients\": %u, \"duration_s\": %.3f },\n",
+          label, tcp_count, entry_count, unchanged ? "true" : "false", dbus_count, elapsed_s);
+  print_summary_json(out, "topology", &tcp_summary, false);
+  print_summary_json(out, "dbus_get", &dbus_summary, false);
+  if (watch) {
+    print_summary_json(out, "topology_notify", &watch_summary, false);
+  }
+  if (have_usage) {
+    fprintf(out, "  \"agent\": { \"pid\": %d, \"cpu_percent\": %.1f, \"rss_kb_max\": %lu, "
+                 "\"rss_kb_peak\": %lu }\n",
+            (int)agent_pid,
+            (double)(usage.cpu_ticks - usage_start.cpu_ticks) * 100.0
+            / ((double)sysconf(_SC_CLK_TCK) * elapsed_s),
+            rss_max_kb > usage.rss_kb ? rss_max_kb : usage.rss_kb, usage.hwm_kb);
+  } else {
+    fprintf(out, "  \"agent\": null\n");
+  }
+  fprintf(out, "}\n");
+
+  if (out != stdout) {
+    fclose(out);
+    ws_br_agent_log_info("TOPOLOGY: %.1f req/s, p50 %u us, p99 %u us, p999 %u us (%lu errors)\n",
+                         tcp_summary.throughput, tcp_summary.p50_us, tcp_summary.p99_us,
+                         tcp_summary.p999_us, tcp_summary.errors);
+    ws_br_agent_log_info("D-Bus Get: %.1f req/s, p50 %u us, p99 %u us, p999 %u us (%lu errors)\n",
+                         dbus_summary.throughput, dbus_summary.p50_us, dbus_summary.p99_us,
+                         dbus_summary.p999_us, dbus_summary.errors);
+  }
+
+  for (unsigned int i = 0U; i < tcp_count; ++i) {
+    free(tcp_workers[i].samples.data);
+  }
+  for (unsigned int i = 0U; i < dbus_count; ++i) {
+    free(dbus_workers[i].samples.data);
+  }
+  free(watch_worker.samples.data);
+  free(tcp_workers);
+  free(dbus_workers);
+
+  return tcp_summary.errors || dbus_summary.errors || watch_summary.errors
+         ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static void build_topology(ws_br_agent_soc_host_topology_entry_t *entries, uint32_t seq)
+{
+  static const uint8_t prefix[8] = { 0xfd, 0x12, 0x34, 0x56, 0x00, 0x00, 0x00, 0x00 };
+
+  // Border Router first, then a two level mesh below it
+  memset(entries, 0, entry_count * sizeof(ws_br_agent_soc_host_topology_entry_t));
+  for (uint32_t i = 0U; i < entry_count; ++i) {
+    memcpy(entries[i].target, prefix, sizeof(prefix));
+    entries[i].target[12] = (uint8_t)((i + 1U) >> 24);
+    entries[i].target[13] = (uint8_t)((i + 1U) >> 16);
+    entries[i].target[14] = (uint8_t)((i + 1U) >> 8);
+    entries[i].target[15] = (uint8_t)(i + 1U);
+    if (i) {
+      memcpy(entries[i].preferred, entries[i < 32U ? 0U : i % 32U].target, 16U);
+    }
+  }
+  // Each push reparents one node so the agent sees a change
+  if (entry_count > 33U) {
+    memcpy(entries[entry_count - 1U].backup, entries[1U + seq % 32U].target, 16U);
+  }
+}
+
+static ws_br_agent_ret_t push_topology(ws_br_agent_soc_host_topology_entry_t *entries,
+                                       uint32_t seq)
+{
+  ws_br_agent_msg_t msg = { .msg_code = WS_BR_AGENT_MSG_CODE_TOPOLOGY };
+  uint8_t drain_buf[DRAIN_BUF_SIZE];
+  uint8_t *buf = NULL;
+  size_t buf_size = 0U;
+  size_t sent = 0U;
+  ssize_t r = 0;
+  int sockfd = -1;
+
+  build_topology(entries, seq);
+  msg.payload = (uint8_t *)entries;
+  msg.payload_len = entry_count * sizeof(ws_br_agent_soc_host_topology_entry_t);
+  buf = ws_br_agent_msg_build_buf(&msg, &buf_size);
+  if (buf == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  sockfd = socket(AF_INET6, SOCK_STREAM, 0);
+  if (sockfd < 0 || connect(sockfd, (struct sockaddr *)&agent_addr, sizeof(agent_addr)) < 0) {
+    if (sockfd >= 0) {
+      close(sockfd);
+    }
+    ws_br_agent_msg_free_buf(buf);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  for (sent = 0U; sent < buf_size; sent += (size_t)r) {
+    r = send(sockfd, buf + sent, buf_size - sent, MSG_NOSIGNAL);
+    if (r < 0) {
+      break;
+    }
+  }
+  ws_br_agent_msg_free_buf(buf);
+  if (r < 0) {
+    close(sockfd);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // The agent closes the connection once the message is handled
+  shutdown(sockfd, SHUT_WR);
+  do {
+    r = recv(sockfd, drain_buf, sizeof(drain_buf), 0);
+  } while (r > 0 || (r < 0 && errno == EINTR));
+  close(sockfd);
+  return WS_BR_AGENT_RET_OK;
+}
+
+static void *tcp_worker_fnc(void *arg)
+{
+  worker_t *worker = (worker_t *)arg;
+  ws_br_agent_soc_host_topology_entry_t *entries = NULL;
+  uint64_t start_us = 0ULL;
+
+  entries = malloc(entry_count * sizeof(ws_br_agent_soc_host_topology_entry_t));
+  if (entries == NULL) {
+    worker->samples.errors++;
+    return NULL;
+  }
+
+  while (!atomic_load(&workers_stop)) {
+    // Latency covers connection, transfer and handling until the agent closes
+    start_us = ws_br_agent_utils_get_monotonic_us();
+    if (push_topology(entries, unchanged ? 0U : (uint32_t)atomic_fetch_add(&topology_seq, 1U))
+        != WS_BR_AGENT_RET_OK) {
+      worker->samples.errors++;
+      usleep(1000U);
+      continue;
+    }
+    if (samples_add(&worker->samples, ws_br_agent_utils_get_monotonic_us() - start_us)
+        != WS_BR_AGENT_RET_OK) {
+      break;
+    }
+  }
+
+  free(entries);
+  return NULL;
+}
+
+static void *dbus_worker_fnc(void *arg)
+{
+  worker_t *worker = (worker_t *)arg;
+  sd_bus *bus = NULL;
+  sd_bus_message *reply = NULL;
+  sd_bus_error error = SD_BUS_ERROR_NULL;
+  const char *property = NULL;
+  uint64_t start_us = 0ULL;
+  size_t seq = worker->index;
+  int r = 0;
+
+  if (dbus_connect(&bus) != WS_BR_AGENT_RET_OK) {
+    worker->samples.errors++;
+    return NULL;
+  }
+
+  while (!atomic_load(&workers_stop)) {
+    // RoutingGraph on every other call, settings properties in turn otherwise
+    property = dbus_properties[seq % 2U ? 1U + (seq / 2U) % 9U : 0U];
+    seq++;
+
+    start_us = ws_br_agent_utils_get_monotonic_us();
+    r = sd_bus_call_method(bus, AGENT_DBUS_NAME, AGENT_DBUS_PATH,
+                           "org.freedesktop.DBus.Properties", "Get", &error, &reply,
+                           "ss", AGENT_DBUS_NAME, property);
+    if (r < 0) {
+      worker->samples.errors++;
+      sd_bus_error_free(&error);
+      usleep(1000U);
+      continue;
+    }
+    sd_bus_message_unref(reply);
+    reply = NULL;
+
+    if (samples_add(&worker->samples, ws_br_agent_utils_get_monotonic_us() - start_us)
+        != WS_BR_AGENT_RET_OK) {
+      break;
+    }
+  }
+
+  sd_bus_flush_close_unref(bus);
+  return NULL;
+}
+
+static ws_br_agent_ret_t dbus_connect(sd_bus **bus)
+{
+  int r = 0;
+
+  // Private connection per worker, on the given bus or the system bus
+  r = sd_bus_new(bus);
+  if (r >= 0) {
+    if (dbus_address != NULL) {
+      r = sd_bus_set_address(*bus, dbus_address);
+    } else if (getenv("DBUS_SYSTEM_BUS_ADDRESS") != NULL) {
+      r = sd_bus_set_address(*bus, getenv("DBUS_SYSTEM_BUS_ADDRESS"));
+    } else {
+      r = sd_bus_set_address(*bus, "unix:path=/run/dbus/system_bus_socket");
+    }
+  }
+  if (r >= 0) {
+    r = sd_bus_set_bus_client(*bus, 1);
+  }
+  if (r >= 0) {
+    r = sd_bus_start(*bus);
+  }
+  if (r < 0) {
+    ws_br_agent_log_error("Failed to connect to D-Bus: %s\n", strerror(-r));
+    *bus = sd_bus_unref(*bus);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  return WS_BR_AGENT_RET_OK;
+}
+
+// PropertiesChanged handler: the RoutingGraphTrace receive time gives the agent path latency
+static int on_properties_changed(sd_bus_message *m, void *userdata, sd_bus_error *ret_error)
+{
+  worker_t *worker = (worker_t *)userdata;
+  uint64_t rx_us = ws_br_agent_utils_get_monotonic_us();
+  const char *interface = NULL;
+  const char *name = NULL;
+  uint64_t trace_id = 0ULL;
+  uint64_t recv_us = 0ULL;
+  int r = 0;
+
+  (void) ret_error;
+
+  r = sd_bus_message_read(m, "s", &interface);
+  if (r >= 0) {
+    r = sd_bus_message_enter_container(m, 'a', "{sv}");
+  }
+  while (r >= 0 && (r = sd_bus_message_enter_container(m, 'e', "sv")) > 0) {
+    r = sd_bus_message_read(m, "s", &name);
+    if (r >= 0 && !strcmp(name, "RoutingGraphTrace")) {
+      r = sd_bus_message_read(m, "v", "(tt)", &trace_id, &recv_us);
+      if (r >= 0 && recv_us && rx_us >= recv_us) {
+        (void) samples_add(&worker->samples, rx_us - recv_us);
+      }
+    } else if (r >= 0) {
+      r = sd_bus_message_skip(m, "v");
+    }
+    if (r >= 0) {
+      r = sd_bus_message_exit_container(m);
+    }
+  }
+  if (r < 0) {
+    worker->samples.errors++;
+  }
+  return 0;
+}
+
+static void *watch_worker_fnc(void *arg)
+{
+  worker_t *worker = (worker_t *)arg;
+  sd_bus *bus = NULL;
+  int r = 0;
+
+  if (dbus_connect(&bus) != WS_BR_AGENT_RET_OK
+      || sd_bus_match_signal(bus, NULL, AGENT_DBUS_NAME, AGENT_DBUS_PATH,
+                             "org.freedesktop.DBus.Properties", "PropertiesChanged",
+                             on_properties_changed, worker) < 0) {
+    worker->samples.errors++;
+    sd_bus_unref(bus);
+    atomic_store(&watcher_ready, true);
+    return NULL;
+  }
+  atomic_store(&watcher_ready, true);
+
+  while (!atomic_load(&workers_stop)) {
+    r = sd_bus_process(bus, NULL);
+    if (r < 0) {
+      worker->samples.errors++;
+      break;
+    }
+    if (r == 0) {
+      (void) sd_bus_wait(bus, SAMPLE_PERIOD_US);
+    }
+  }
+
+  sd_bus_flush_close_unref(bus);
+  return NULL;
+}
+
+static ws_br_agent_ret_t samples_add(samples_t * const samples, uint64_t latency_us)
+{
+  uint32_t *data = NULL;
+  size_t capacity = 0U;
+
+  if (samples->count == samples->capacity) {
+    capacity = samples->capacity ? samples->capacity * 2U : SAMPLES_INIT_CAPACITY;
+    data = realloc(samples->data, capacity * sizeof(uint32_t));
+    if (data == NULL) {
+      return WS_BR_AGENT_RET_ERR;
+    }
+    samples->data = data;
+    samples->capacity = capacity;
+  }
+  samples->data[samples->count++] = latency_us > UINT32_MAX ? UINT32_MAX : (uint32_t)latency_us;
+  return WS_BR_AGENT_RET_OK;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+  uint32_t va = *(const uint32_t *)a;
+  uint32_t vb = *(const uint32_t *)b;
+  return (va > vb) - (va < vb);
+}
+
+static uint32_t percentile(const uint32_t *sorted, size_t count, double p)
+{
+  size_t idx = 0U;
+
+  if (!count) {
+    return 0U;
+  }
+  // Nearest rank
+  idx = (size_t)(p * (double)count + 0.999999);
+  return sorted[idx ? idx - 1U : 0U];
+}
+
+static void summarize(worker_t * const workers, unsigned int count, double duration_s,
+                      summary_t * const summary)
+{
+  uint32_t *all = NULL;
+  size_t total = 0U;
+  size_t pos = 0U;
+
+  memset(summary, 0, sizeof(summary_t));
+  for (unsigned int i = 0U; i < count; ++i) {
+    total += workers[i].samples.count;
+    summary->errors += workers[i].samples.errors;
+  }
+  summary->requests = (unsigned long)total;
+  summary->throughput = duration_s > 0.0 ? (double)total / duration_s : 0.0;
+  if (!total) {
+    return;
+  }
+
+  all = malloc(total * sizeof(uint32_t));
+  if (all == NULL) {
+    return;
+  }
+  for (unsigned int i = 0U; i < count; ++i) {
+    memcpy(all + pos, workers[i].samples.data, workers[i].samples.count * sizeof(uint32_t));
+    pos += workers[i].samples.count;
+  }
+  qsort(all, total, sizeof(uint32_t), compare_u32);
+  summary->p50_us = percentile(all, total, 0.5);
+  summary->p99_us = percentile(all, total, 0.99);
+  summary->p999_us = percentile(all, total, 0.999);
+  summary->max_us = all[total - 1U];
+  free(all);
+}
+
+static ws_br_agent_ret_t read_proc_usage(pid_t pid, proc_usage_t * const usage)
+{
+  char path[64];
+  char line[256];
+  char *p = NULL;
+  unsigned long long utime = 0ULL;
+  unsigned long long stime = 0ULL;
+  FILE *f = NULL;
+
+  snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+  f = fopen(path, "r");
+  if (f == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  if (fgets(line, sizeof(line), f) == NULL) {
+    fclose(f);
+    return WS_BR_AGENT_RET_ERR;
+  }
+  fclose(f);
+  // Fields after the command name: state is field 3, utime and stime are fields 14 and 15
+  p = strrchr(line, ')');
+  if (p == NULL || sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+                          &utime, &stime) != 2) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  usage->cpu_ticks = utime + stime;
+
+  snprintf(path, sizeof(path), "/proc/%d/status", (int)pid);
+  f = fopen(path, "r");
+  if (f == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  while (fgets(line, sizeof(line), f) != NULL) {
+    (void) sscanf(line, "VmRSS: %lu", &usage->rss_kb);
+    (void) sscanf(line, "VmHWM: %lu", &usage->hwm_kb);
+  }
+  fclose(f);
+  return WS_BR_AGENT_RET_OK;
+}
+
+static void print_summary_json(FILE *out, const char *name, const summary_t * const summary,
+                               bool last)
+{
+  fprintf(out, "  \"%s\": { \"requests\": %lu, \"errors\": %lu, \"throughput_rps\": %.1f, "
+               "\"latency_us\": { \"p50\": %u, \"p99\": %u, \"p999\": %u, \"max\": %u } }%s\n",
+          name, summary->requests, summary->errors, summary->throughput,
+          summary->p50_us, summary->p99_us, summary->p999_us, summary->max_us, last ? "" : ",");
+}
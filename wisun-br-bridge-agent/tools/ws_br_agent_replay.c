@@ -0,0 +1,222 @@
+/***************************************************************************//**
+ * @file ws_br_agent_replay.c
+ * @brief Replay captured traffic into the Wi-SUN SoC Border Router Agent
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "replay"
+#include "ws_br_agent_defs.h"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_msg.h"
+#include "ws_br_agent_utils.h"
+#include "ws_br_agent_capture.h"
+
+#define HELP_STR \
+"Usage: wisun-br-bridge-agent-replay [--agent <agent address>] \
+[--port <agent port>] \
+[--speed <factor>|max] \
+[--loop <count>] \
+[--help] \
+<capture file>\n"
+
+/// Default agent address
+#define DEFAULT_AGENT_ADDR_STR "::1"
+
+/// Drain buffer size for agent responses
+#define DRAIN_BUF_SIZE 4096U
+
+static ws_br_agent_ret_t replay_frame(const struct sockaddr_in6 * const agent_addr,
+                                      const ws_br_agent_capture_record_t * const record);
+static void sleep_us(uint64_t us);
+
+int main(int argc, char *argv[])
+{
+  const char *agent_addr_str = DEFAULT_AGENT_ADDR_STR;
+  const char *capture_path = NULL;
+  uint16_t port = WS_BR_AGENT_SERVICE_PORT;
+  double speed = 1.0;
+  unsigned long loop_count = 1UL;
+  struct sockaddr_in6 agent_addr = { .sin6_family = AF_INET6 };
+  ws_br_agent_capture_reader_t reader;
+  ws_br_agent_capture_record_t record;
+  uint64_t first_ts_us = 0ULL;
+  uint64_t start_us = 0ULL;
+  uint64_t target_us = 0ULL;
+  uint64_t now_us = 0ULL;
+  unsigned long sent = 0UL;
+  unsigned long failed = 0UL;
+  size_t bytes = 0U;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--agent") && (i + 1 < argc)) {
+      agent_addr_str = argv[++i];
+    } else if (!strcmp(argv[i], "--port") && (i + 1 < argc)) {
+      port = (uint16_t)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--speed") && (i + 1 < argc)) {
+      ++i;
+      // Zero speed means no pacing at all
+      speed = !strcmp(argv[i], "max") ? 0.0 : strtod(argv[i], NULL);
+    } else if (!strcmp(argv[i], "--loop") && (i + 1 < argc)) {
+      loop_count = strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+      printf(HELP_STR);
+      return EXIT_SUCCESS;
+    } else if (argv[i][0] != '-' && capture_path == NULL) {
+      capture_path = argv[i];
+    } else {
+      printf("Unknown argument: %s\n", argv[i]);
+      printf(HELP_STR);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (capture_path == NULL || speed < 0.0) {
+    printf(HELP_STR);
+    return EXIT_FAILURE;
+  }
+
+  ws_br_agent_log_sinks = WS_BR_AGENT_LOG_SINK_CONSOLE;
+
+  if (inet_pton(AF_INET6, agent_addr_str, &agent_addr.sin6_addr) != 1) {
+    ws_br_agent_log_error("Invalid agent IPv6 address: %s\n", agent_addr_str);
+    return EXIT_FAILURE;
+  }
+  agent_addr.sin6_port = htons(port);
+
+  start_us = ws_br_agent_utils_get_monotonic_us();
+
+  for (unsigned long loop = 0UL; loop < loop_count; ++loop) {
+    if (ws_br_agent_capture_reader_open(&reader, capture_path) != WS_BR_AGENT_RET_OK) {
+      return EXIT_FAILURE;
+    }
+
+    first_ts_us = 0ULL;
+    while (ws_br_agent_capture_reader_next(&reader, &record) == WS_BR_AGENT_RET_OK) {
+      // Only pushes received by the agent service are replayed
+      if (record.dir != WS_BR_AGENT_CAPTURE_DIR_IN
+          || record.channel != WS_BR_AGENT_CAPTURE_CHANNEL_SRV) {
+        continue;
+      }
+
+      if (!first_ts_us) {
+        first_ts_us = record.timestamp_us;
+        if (loop) {
+          // Keep the capture cadence across loop iterations
+          start_us = ws_br_agent_utils_get_monotonic_us();
+        }
+      }
+
+      if (speed > 0.0) {
+        target_us = start_us + (uint64_t)((double)(record.timestamp_us - first_ts_us) / speed);
+        now_us = ws_br_agent_utils_get_monotonic_us();
+        if (target_us > now_us) {
+          sleep_us(target_us - now_us);
+        }
+      }
+
+      if (replay_frame(&agent_addr, &record) == WS_BR_AGENT_RET_OK) {
+        sent++;
+        bytes += record.len;
+      } else {
+        failed++;
+      }
+    }
+
+    if (!reader.eof) {
+      ws_br_agent_log_error("Failed to read capture file: %s\n", capture_path);
+      ws_br_agent_capture_reader_close(&reader);
+      return EXIT_FAILURE;
+    }
+    ws_br_agent_capture_reader_close(&reader);
+  }
+
+  now_us = ws_br_agent_utils_get_monotonic_us() - start_us;
+  ws_br_agent_log_info("Replayed %lu frames (%zu bytes, %lu failed) in %.3f s (%.1f frames/s)\n",
+                       sent, bytes, failed, (double)now_us / 1e6,
+                       now_us ? (double)sent * 1e6 / (double)now_us : 0.0);
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static ws_br_agent_ret_t replay_frame(const struct sockaddr_in6 * const agent_addr,
+                                      const ws_br_agent_capture_record_t * const record)
+{
+  static uint8_t drain_buf[DRAIN_BUF_SIZE];
+  size_t sent = 0U;
+  ssize_t r = 0;
+  int sockfd = -1;
+
+  sockfd = socket(AF_INET6, SOCK_STREAM, 0);
+  if (sockfd < 0) {
+    ws_br_agent_log_error("Failed: Socket creation\n");
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  if (connect(sockfd, (const struct sockaddr *)agent_addr, sizeof(*agent_addr)) < 0) {
+    ws_br_agent_log_error("Failed: Connection to agent (%s)\n", strerror(errno));
+    close(sockfd);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  while (sent < record->len) {
+    r = send(sockfd, record->data + sent, record->len - sent, MSG_NOSIGNAL);
+    if (r < 0) {
+      ws_br_agent_log_error("Failed: Sending frame (%s)\n", strerror(errno));
+      close(sockfd);
+      return WS_BR_AGENT_RET_ERR;
+    }
+    sent += (size_t)r;
+  }
+
+  // Wait for the agent to close the connection so frames are handled in capture order
+  shutdown(sockfd, SHUT_WR);
+  do {
+    r = recv(sockfd, drain_buf, sizeof(drain_buf), 0);
+  } while (r > 0 || (r < 0 && errno == EINTR));
+
+  close(sockfd);
+  return WS_BR_AGENT_RET_OK;
+}
+
+static void sleep_us(uint64_t us)
+{
+  struct timespec ts = {
+    .tv_sec = (time_t)(us / 1000000ULL),
+    .tv_nsec = (long)(us % 1000000ULL) * 1000L
+  };
+
+  while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {
+  }
+}
@@ -0,0 +1,869 @@
+/***************************************************************************//**
+ * @file ws_br_agent_soc_emu.c
+ * @brief Wi-SUN SoC Border Router emulator for the Agent
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2025 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#define WS_BR_AGENT_LOG_SUBSYSTEM "soc_emu"
+#include "ws_br_agent_defs.h"
+#include "ws_br_agent_log.h"
+#include "ws_br_agent_msg.h"
+#include "ws_br_agent_utils.h"
+#include "ws_br_agent_settings.h"
+#include "ws_br_agent_node_stats.h"
+#include "ws_br_agent_soc_host.h"
+
+#define HELP_STR \
+"Usage: wisun-br-bridge-agent-soc-emu [--agent <agent address>] \
+[--agent-port <port>] \
+[--listen-port <port>] \
+[--config <config file path>] \
+[--tlv] \
+[--crc] \
+[--nodes <count>] \
+[--max-depth <depth>] \
+[--depth-skew <factor>] \
+[--lfn-ratio <ratio>] \
+[--backup-ratio <ratio>] \
+[--churn <ratio>] \
+[--topology-rate <Hz>] \
+[--config-rate <Hz>] \
+[--stats-rate <Hz>] \
+[--count <pushes>] \
+[--cmd-latency <ms>] \
+[--cmd-failure-rate <ratio>] \
+[--seed <seed>] \
+[--help]\n"
+
+/// Default agent address
+#define DEFAULT_AGENT_ADDR_STR "::1"
+
+/// Drain buffer size for agent responses
+#define DRAIN_BUF_SIZE 4096U
+
+/// Command receive timeout in ms
+#define CMD_RECV_TIMEOUT_MS 1000
+
+/// Share of churn events that reparent a node, the rest changes backup parents or replaces leaves
+#define CHURN_REPARENT_RATIO 0.7
+#define CHURN_BACKUP_RATIO 0.2
+
+/// @brief Emulated mesh node
+typedef struct emu_node {
+  /// Interface identifier
+  uint64_t iid;
+  /// Depth in the DODAG (0 for the Border Router)
+  uint32_t depth;
+  /// Preferred parent index (-1 for the Border Router)
+  int32_t parent;
+  /// Backup parent index (-1 if none)
+  int32_t backup;
+  /// Number of nodes using this node as preferred parent
+  uint32_t child_count;
+  /// Limited Function Node (never a parent)
+  bool lfn;
+} emu_node_t;
+
+/// @brief Emulator configuration
+typedef struct emu_cfg {
+  uint32_t node_count;
+  uint32_t max_depth;
+  double depth_skew;
+  double lfn_ratio;
+  double backup_ratio;
+  double churn;
+  double topology_rate_hz;
+  double config_rate_hz;
+  double stats_rate_hz;
+  unsigned long push_count;
+  uint32_t cmd_latency_ms;
+  double cmd_failure_rate;
+  bool tlv;
+  bool crc;
+} emu_cfg_t;
+
+/// @brief Emulator statistics
+typedef struct emu_stats {
+  unsigned long topology_pushes;
+  unsigned long config_pushes;
+  unsigned long stats_pushes;
+  unsigned long push_failures;
+  unsigned long churn_events;
+  unsigned long commands;
+  unsigned long injected_failures;
+} emu_stats_t;
+
+static emu_cfg_t cfg = {
+  .node_count = 100U,
+  .max_depth = 6U,
+  .depth_skew = 1.0,
+  .lfn_ratio = 0.0,
+  .backup_ratio = 0.5,
+  .churn = 0.01,
+  .topology_rate_hz = 1.0,
+  .config_rate_hz = 0.0,
+  .stats_rate_hz = 0.0,
+  .push_count = 0UL,
+  .cmd_latency_ms = 0U,
+  .cmd_failure_rate = 0.0,
+  .tlv = false,
+  .crc = false
+};
+
+static emu_stats_t stats = { 0U };
+static emu_node_t *nodes = NULL;
+static uint8_t prefix[8] = { 0U };
+static ws_br_agent_settings_t settings = { 0U };
+static pthread_mutex_t emu_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile sig_atomic_t emu_stop = 0;
+static bool br_stopped = false;
+static bool br_restart = false;
+static bool settings_dirty = true;
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+static uint64_t cmd_rng_state = 0ULL;
+static int listen_fd = -1;
+
+static uint64_t rand_u64(uint64_t *state);
+static double rand_double(uint64_t *state);
+static ws_br_agent_ret_t parse_prefix(const char *prefix_str);
+static ws_br_agent_ret_t generate_topology(void);
+static void churn_topology(void);
+static ws_br_agent_ret_t push_topology(const struct sockaddr_in6 * const agent_addr);
+static ws_br_agent_ret_t push_settings(const struct sockaddr_in6 * const agent_addr);
+static ws_br_agent_ret_t push_node_stats(const struct sockaddr_in6 * const agent_addr);
+static ws_br_agent_ret_t push_msg(const struct sockaddr_in6 * const agent_addr,
+                                  const ws_br_agent_msg_t * const msg);
+static void *cmd_thr_fnc(void *arg);
+static void handle_cmd(int conn_fd);
+static void sleep_us(uint64_t us);
+static void sig_hnd(int signum);
+
+int main(int argc, char *argv[])
+{
+  const char *agent_addr_str = DEFAULT_AGENT_ADDR_STR;
+  const char *conf_file_path = NULL;
+  uint16_t agent_port = WS_BR_AGENT_SERVICE_PORT;
+  uint16_t listen_port = WS_BR_AGENT_SOC_PORT;
+  uint64_t seed = 0ULL;
+  struct sockaddr_in6 agent_addr = { .sin6_family = AF_INET6 };
+  struct sockaddr_in6 listen_addr = { .sin6_family = AF_INET6, .sin6_addr = IN6ADDR_ANY_INIT };
+  struct sigaction sa = { 0 };
+  pthread_t cmd_thr;
+  uint64_t now_us = 0ULL;
+  uint64_t next_topology_us = 0ULL;
+  uint64_t next_config_us = 0ULL;
+  uint64_t next_stats_us = 0ULL;
+  uint64_t next_us = 0ULL;
+  bool stopped = false;
+  bool restart = false;
+  bool push_config = false;
+  int optval = 1;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--agent") && (i + 1 < argc)) {
+      agent_addr_str = argv[++i];
+    } else if (!strcmp(argv[i], "--agent-port") && (i + 1 < argc)) {
+      agent_port = (uint16_t)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--listen-port") && (i + 1 < argc)) {
+      listen_port = (uint16_t)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--config") && (i + 1 < argc)) {
+      conf_file_path = argv[++i];
+    } else if (!strcmp(argv[i], "--nodes") && (i + 1 < argc)) {
+      cfg.node_count = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--max-depth") && (i + 1 < argc)) {
+      cfg.max_depth = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--depth-skew") && (i + 1 < argc)) {
+      cfg.depth_skew = strtod(argv[++i], NULL);
+    } else if (!strcmp(argv[i], "--lfn-ratio") && (i + 1 < argc)) {
+      cfg.lfn_ratio = strtod(argv[++i], NULL);
+    } else if (!strcmp(argv[i], "--backup-ratio") && (i + 1 < argc)) {
+      cfg.backup_ratio = strtod(argv[++i], NULL);
+    } else if (!strcmp(argv[i], "--churn") && (i + 1 < argc)) {
+      cfg.churn = strtod(argv[++i], NULL);
+    } else if (!strcmp(argv[i], "--topology-rate") && (i + 1 < argc)) {
+      cfg.topology_rate_hz = strtod(argv[++i], NULL);
+    } else if (!strcmp(argv[i], "--config-rate") && (i + 1 < argc)) {
+      cfg.config_rate_hz = strtod(argv[++i], NULL);
+    } else if (!strcmp(argv[i], "--stats-rate") && (i + 1 < argc)) {
+      cfg.stats_rate_hz = strtod(argv[++i], NULL);
+    } else if (!strcmp(argv[i], "--count") && (i + 1 < argc)) {
+      cfg.push_count = strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--cmd-latency") && (i + 1 < argc)) {
+      cfg.cmd_latency_ms = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--cmd-failure-rate") && (i + 1 < argc)) {
+      cfg.cmd_failure_rate = strtod(argv[++i], NULL);
+    } else if (!strcmp(argv[i], "--tlv")) {
+      cfg.tlv = true;
+    } else if (!strcmp(argv[i], "--crc")) {
+      cfg.crc = true;
+    } else if (!strcmp(argv[i], "--seed") && (i + 1 < argc)) {
+      seed = strtoull(argv[++i], NULL, 0);
+    } else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+      printf(HELP_STR);
+      return EXIT_SUCCESS;
+    } else {
+      printf("Unknown argument: %s\n", argv[i]);
+      printf(HELP_STR);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!cfg.node_count || cfg.node_count > WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES
+      || !cfg.max_depth || cfg.depth_skew <= 0.0
+      || cfg.lfn_ratio < 0.0 || cfg.lfn_ratio > 1.0
+      || cfg.backup_ratio < 0.0 || cfg.backup_ratio > 1.0
+      || cfg.churn < 0.0 || cfg.topology_rate_hz < 0.0 || cfg.config_rate_hz < 0.0
+      || cfg.stats_rate_hz < 0.0
+      || cfg.cmd_failure_rate < 0.0 || cfg.cmd_failure_rate > 1.0) {
+    printf("Invalid parameters (up to %u nodes)\n", WS_BR_AGENT_MAX_TOPOLOGY_ENTRIES);
+    printf(HELP_STR);
+    return EXIT_FAILURE;
+  }
+
+  ws_br_agent_log_sinks = WS_BR_AGENT_LOG_SINK_CONSOLE;
+
+  if (inet_pton(AF_INET6, agent_addr_str, &agent_addr.sin6_addr) != 1) {
+    ws_br_agent_log_error("Invalid agent IPv6 address: %s\n", agent_addr_str);
+    return EXIT_FAILURE;
+  }
+  agent_addr.sin6_port = htons(agent_port);
+
+  memcpy(&settings, ws_br_agent_soc_host_get_default_settings(), sizeof(settings));
+  if (conf_file_path != NULL
+      && ws_br_agent_settings_load_config(conf_file_path, &settings, NULL) != WS_BR_AGENT_RET_OK) {
+    return EXIT_FAILURE;
+  }
+  if (parse_prefix(settings.ipv6_prefix) != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_error("Invalid IPv6 prefix: %s\n", settings.ipv6_prefix);
+    return EXIT_FAILURE;
+  }
+
+  if (seed) {
+    rng_state = seed;
+  }
+  cmd_rng_state = rng_state ^ 0xd1b54a32d192ed03ULL;
+
+  nodes = calloc(cfg.node_count, sizeof(emu_node_t));
+  if (nodes == NULL || generate_topology() != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_error("Failed to generate topology\n");
+    return EXIT_FAILURE;
+  }
+
+  listen_fd = socket(AF_INET6, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    ws_br_agent_log_error("Command socket creation failed\n");
+    return EXIT_FAILURE;
+  }
+  (void) setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+  listen_addr.sin6_port = htons(listen_port);
+  if (bind(listen_fd, (struct sockaddr *)&listen_addr, sizeof(listen_addr)) < 0
+      || listen(listen_fd, 5) < 0) {
+    ws_br_agent_log_error("Command socket bind/listen on port %u failed: %s\n",
+                          listen_port, strerror(errno));
+    close(listen_fd);
+    return EXIT_FAILURE;
+  }
+
+  sa.sa_handler = sig_hnd;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  if (pthread_create(&cmd_thr, NULL, cmd_thr_fnc, NULL) != 0) {
+    ws_br_agent_log_error("Failed to create command thread\n");
+    close(listen_fd);
+    return EXIT_FAILURE;
+  }
+
+  ws_br_agent_log_info("Emulating %u nodes (max depth %u, %.0f%% LFN, %.0f%% backup), "
+                       "commands on port %u, agent [%s]:%u\n",
+                       cfg.node_count, cfg.max_depth, cfg.lfn_ratio * 100.0,
+                       cfg.backup_ratio * 100.0, listen_port, agent_addr_str, agent_port);
+
+  now_us = ws_br_agent_utils_get_monotonic_us();
+  next_topology_us = now_us;
+  next_config_us = now_us;
+  next_stats_us = now_us;
+
+  while (!emu_stop && (!cfg.push_count || stats.topology_pushes < cfg.push_count)) {
+    now_us = ws_br_agent_utils_get_monotonic_us();
+
+    pthread_mutex_lock(&emu_mutex);
+    stopped = br_stopped;
+    restart = br_restart;
+    br_restart = false;
+    push_config = settings_dirty;
+    settings_dirty = false;
+    pthread_mutex_unlock(&emu_mutex);
+
+    if (restart) {
+      // A restarted Border Router rebuilds its DODAG from scratch
+      pthread_mutex_lock(&emu_mutex);
+      if (parse_prefix(settings.ipv6_prefix) != WS_BR_AGENT_RET_OK) {
+        ws_br_agent_log_warn("Invalid IPv6 prefix, keeping the previous one\n");
+      }
+      pthread_mutex_unlock(&emu_mutex);
+      (void) generate_topology();
+      push_config = true;
+      next_topology_us = now_us;
+    }
+
+    if (!stopped && (push_config || (cfg.config_rate_hz > 0.0 && now_us >= next_config_us))) {
+      if (push_settings(&agent_addr) == WS_BR_AGENT_RET_OK) {
+        stats.config_pushes++;
+      } else {
+        stats.push_failures++;
+      }
+      if (cfg.config_rate_hz > 0.0) {
+        next_config_us = now_us + (uint64_t)(1e6 / cfg.config_rate_hz);
+      }
+    }
+
+    if (!stopped && now_us >= next_topology_us) {
+      if (stats.topology_pushes) {
+        churn_topology();
+      }
+      if (push_topology(&agent_addr) == WS_BR_AGENT_RET_OK) {
+        stats.topology_pushes++;
+      } else {
+        stats.push_failures++;
+      }
+      // Zero rate pushes the topology once
+      next_topology_us = cfg.topology_rate_hz > 0.0
+                         ? now_us + (uint64_t)(1e6 / cfg.topology_rate_hz) : UINT64_MAX;
+    }
+
+    // Link metrics follow the topology they describe
+    if (!stopped && cfg.stats_rate_hz > 0.0 && stats.topology_pushes && now_us >= next_stats_us) {
+      if (push_node_stats(&agent_addr) == WS_BR_AGENT_RET_OK) {
+        stats.stats_pushes++;
+      } else {
+        stats.push_failures++;
+      }
+      next_stats_us = now_us + (uint64_t)(1e6 / cfg.stats_rate_hz);
+    }
+
+    next_us = next_topology_us;
+    if (cfg.config_rate_hz > 0.0 && next_config_us < next_us) {
+      next_us = next_config_us;
+    }
+    if (cfg.stats_rate_hz > 0.0 && next_stats_us < next_us) {
+      next_us = next_stats_us;
+    }
+    now_us = ws_br_agent_utils_get_monotonic_us();
+    // Wake up at least every 100 ms to handle commands
+    sleep_us(next_us > now_us ? (next_us - now_us < 100000ULL ? next_us - now_us : 100000ULL) : 0U);
+  }
+
+  emu_stop = 1;
+  pthread_join(cmd_thr, NULL);
+  close(listen_fd);
+  free(nodes);
+
+  ws_br_agent_log_info("Pushed %lu topologies (%lu churn events), %lu settings and %lu node metrics, "
+                       "%lu push failures, %lu commands (%lu injected failures)\n",
+                       stats.topology_pushes, stats.churn_events, stats.config_pushes,
+                       stats.stats_pushes, stats.push_failures, stats.commands, stats.injected_failures);
+
+  return stats.push_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static uint64_t rand_u64(uint64_t *state)
+{
+  // xorshift64*
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 0x2545f4914f6cdd1dULL;
+}
+
+static double rand_double(uint64_t *state)
+{
+  return (double)(rand_u64(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static uint32_t rand_below(uint32_t bound)
+{
+  return (uint32_t)(rand_u64(&rng_state) % bound);
+}
+
+static ws_br_agent_ret_t parse_prefix(const char *prefix_str)
+{
+  char addr_str[WS_BR_AGENT_IPV6_PREFIX_SIZE] = { 0 };
+  struct in6_addr addr;
+  char *slash = NULL;
+
+  snprintf(addr_str, sizeof(addr_str), "%s", prefix_str);
+  slash = strchr(addr_str, '/');
+  if (slash != NULL) {
+    *slash = '\0';
+  }
+  if (inet_pton(AF_INET6, addr_str, &addr) != 1) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+  memcpy(prefix, addr.s6_addr, sizeof(prefix));
+  return WS_BR_AGENT_RET_OK;
+}
+
+static uint64_t random_iid(void)
+{
+  // EUI-64 based IID: universal/local bit set
+  return rand_u64(&rng_state) | 0x0200000000000000ULL;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+  uint32_t va = *(const uint32_t *)a;
+  uint32_t vb = *(const uint32_t *)b;
+  return (va > vb) - (va < vb);
+}
+
+/// Pick a random FFN at the given depth, different from exclude (-1 if none)
+static int32_t pick_ffn_at_depth(uint32_t depth, uint32_t count, int32_t exclude)
+{
+  uint32_t candidates = 0U;
+  int32_t pick = -1;
+
+  // Reservoir sampling over the nodes generated so far
+  for (uint32_t i = 0U; i < count; ++i) {
+    if (nodes[i].depth != depth || nodes[i].lfn || (int32_t)i == exclude) {
+      continue;
+    }
+    candidates++;
+    if (!rand_below(candidates)) {
+      pick = (int32_t)i;
+    }
+  }
+  return pick;
+}
+
+static ws_br_agent_ret_t generate_topology(void)
+{
+  uint32_t *depths = NULL;
+  double weight_sum = 0.0;
+  double r = 0.0;
+  uint32_t *ffn_per_depth = NULL;
+  emu_node_t *node = NULL;
+
+  depths = calloc(cfg.node_count, sizeof(uint32_t));
+  ffn_per_depth = calloc(cfg.max_depth + 1U, sizeof(uint32_t));
+  if (depths == NULL || ffn_per_depth == NULL) {
+    free(depths);
+    free(ffn_per_depth);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Depth d is drawn with a weight of skew^(d - 1): below 1 favors shallow meshes
+  for (uint32_t d = 1U; d <= cfg.max_depth; ++d) {
+    weight_sum += pow(cfg.depth_skew, (double)(d - 1U));
+  }
+  for (uint32_t i = 1U; i < cfg.node_count; ++i) {
+    r = rand_double(&rng_state) * weight_sum;
+    depths[i] = cfg.max_depth;
+    for (uint32_t d = 1U; d <= cfg.max_depth; ++d) {
+      r -= pow(cfg.depth_skew, (double)(d - 1U));
+      if (r < 0.0) {
+        depths[i] = d;
+        break;
+      }
+    }
+  }
+  // Parents must exist before their children
+  qsort(depths + 1, cfg.node_count - 1U, sizeof(uint32_t), compare_u32);
+
+  memset(nodes, 0, cfg.node_count * sizeof(emu_node_t));
+  nodes[0].iid = 1ULL;
+  nodes[0].parent = -1;
+  nodes[0].backup = -1;
+  ffn_per_depth[0] = 1U;
+
+  for (uint32_t i = 1U; i < cfg.node_count; ++i) {
+    node = &nodes[i];
+    node->iid = random_iid();
+    node->depth = depths[i];
+    // Attach to the deepest populated level when the requested one has no FFN
+    while (!ffn_per_depth[node->depth - 1U]) {
+      node->depth--;
+    }
+    node->lfn = rand_double(&rng_state) < cfg.lfn_ratio;
+    node->parent = pick_ffn_at_depth(node->depth - 1U, i, -1);
+    node->backup = -1;
+    if (!node->lfn && rand_double(&rng_state) < cfg.backup_ratio) {
+      node->backup = pick_ffn_at_depth(node->depth - 1U, i, node->parent);
+    }
+    nodes[node->parent].child_count++;
+    if (!node->lfn) {
+      ffn_per_depth[node->depth]++;
+    }
+  }
+
+  free(depths);
+  free(ffn_per_depth);
+  return WS_BR_AGENT_RET_OK;
+}
+
+static void churn_topology(void)
+{
+  double events = cfg.churn * (double)(cfg.node_count - 1U);
+  uint32_t count = (uint32_t)events;
+  emu_node_t *node = NULL;
+  int32_t new_parent = -1;
+  double kind = 0.0;
+
+  if (cfg.node_count < 2U) {
+    return;
+  }
+  // Fractional part as a probability so low churn still moves the mesh
+  if (rand_double(&rng_state) < events - (double)count) {
+    count++;
+  }
+
+  for (uint32_t e = 0U; e < count; ++e) {
+    node = &nodes[1U + rand_below(cfg.node_count - 1U)];
+    kind = rand_double(&rng_state);
+
+    if (kind < CHURN_REPARENT_RATIO) {
+      // Parents are one level up, so reparenting never creates loops
+      new_parent = pick_ffn_at_depth(node->depth - 1U, cfg.node_count, node->parent);
+      if (new_parent < 0) {
+        continue;
+      }
+      nodes[node->parent].child_count--;
+      if (node->backup == new_parent) {
+        node->backup = node->parent;
+      }
+      node->parent = new_parent;
+      nodes[new_parent].child_count++;
+    } else if (kind < CHURN_REPARENT_RATIO + CHURN_BACKUP_RATIO) {
+      if (node->lfn) {
+        continue;
+      }
+      node->backup = node->backup >= 0 ? -1
+                     : pick_ffn_at_depth(node->depth - 1U, cfg.node_count, node->parent);
+    } else {
+      // A leaf leaves and a new device joins in its place
+      if (node->child_count) {
+        continue;
+      }
+      node->iid = random_iid();
+    }
+    stats.churn_events++;
+  }
+}
+
+static void fill_addr(uint8_t addr[16], uint64_t iid)
+{
+  memcpy(addr, prefix, sizeof(prefix));
+  for (size_t i = 0U; i < 8U; ++i) {
+    addr[8U + i] = (uint8_t)(iid >> (56U - 8U * i));
+  }
+}
+
+static ws_br_agent_ret_t push_topology(const struct sockaddr_in6 * const agent_addr)
+{
+  ws_br_agent_soc_host_topology_entry_t *entries = NULL;
+  ws_br_agent_msg_t msg = { .msg_code = WS_BR_AGENT_MSG_CODE_TOPOLOGY, .crc = cfg.crc };
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_ERR;
+
+  entries = calloc(cfg.node_count, sizeof(ws_br_agent_soc_host_topology_entry_t));
+  if (entries == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  // Border Router first, without parents
+  for (uint32_t i = 0U; i < cfg.node_count; ++i) {
+    fill_addr(entries[i].target, nodes[i].iid);
+    if (nodes[i].parent >= 0) {
+      fill_addr(entries[i].preferred, nodes[nodes[i].parent].iid);
+    }
+    if (nodes[i].backup >= 0) {
+      fill_addr(entries[i].backup, nodes[nodes[i].backup].iid);
+    }
+  }
+
+  msg.payload = (uint8_t *)entries;
+  msg.payload_len = cfg.node_count * sizeof(ws_br_agent_soc_host_topology_entry_t);
+  ret = push_msg(agent_addr, &msg);
+  free(entries);
+  return ret;
+}
+
+static ws_br_agent_ret_t push_node_stats(const struct sockaddr_in6 * const agent_addr)
+{
+  ws_br_agent_node_stats_entry_t *entries = NULL;
+  ws_br_agent_msg_t msg = { .msg_code = WS_BR_AGENT_MSG_CODE_NODE_STATS, .crc = cfg.crc };
+  ws_br_agent_ret_t ret = WS_BR_AGENT_RET_ERR;
+  uint8_t phy_mode_id = 0U;
+  int32_t rsl = 0;
+
+  entries = calloc(cfg.node_count, sizeof(ws_br_agent_node_stats_entry_t));
+  if (entries == NULL) {
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  pthread_mutex_lock(&emu_mutex);
+  phy_mode_id = settings.rx_phy_mode_ids_count ? settings.rx_phy_mode_ids[0] : 0U;
+  pthread_mutex_unlock(&emu_mutex);
+
+  // Same order as the topology, links weaken with the depth
+  for (uint32_t i = 0U; i < cfg.node_count; ++i) {
+    fill_addr(entries[i].target, nodes[i].iid);
+    rsl = -60 - 6 * (int32_t)nodes[i].depth - (int32_t)rand_below(20U);
+    entries[i].rsl_in = (uint8_t)(rsl + WS_BR_AGENT_NODE_STATS_RSL_OFFSET);
+    rsl = -60 - 6 * (int32_t)nodes[i].depth - (int32_t)rand_below(20U);
+    entries[i].rsl_out = (uint8_t)(rsl + WS_BR_AGENT_NODE_STATS_RSL_OFFSET);
+    ws_br_agent_put_be16(entries[i].etx, (uint16_t)(WS_BR_AGENT_NODE_STATS_ETX_UNIT
+                                                    + rand_below(WS_BR_AGENT_NODE_STATS_ETX_UNIT)));
+    entries[i].phy_mode_id = phy_mode_id;
+    ws_br_agent_put_be32(entries[i].last_heard_s, rand_below(60U));
+  }
+
+  msg.payload = (uint8_t *)entries;
+  msg.payload_len = cfg.node_count * sizeof(ws_br_agent_node_stats_entry_t);
+  ret = push_msg(agent_addr, &msg);
+  free(entries);
+  return ret;
+}
+
+static ws_br_agent_ret_t push_settings(const struct sockaddr_in6 * const agent_addr)
+{
+  uint8_t payload[WS_BR_AGENT_SETTINGS_TLV_MAX_SIZE];
+  size_t payload_len = sizeof(ws_br_agent_settings_t);
+  ws_br_agent_msg_t msg = {
+    .msg_code = WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS,
+    .payload_len = 0U,
+    .payload = payload,
+    .crc = cfg.crc
+  };
+
+  pthread_mutex_lock(&emu_mutex);
+  if (cfg.tlv) {
+    (void) ws_br_agent_settings_tlv_encode(&settings, NULL, 0U, payload, sizeof(payload), &payload_len);
+  } else {
+    memcpy(payload, &settings, sizeof(ws_br_agent_settings_t));
+  }
+  pthread_mutex_unlock(&emu_mutex);
+  msg.payload_len = (ws_br_agent_msg_len_t)payload_len;
+
+  return push_msg(agent_addr, &msg);
+}
+
+static ws_br_agent_ret_t push_msg(const struct sockaddr_in6 * const agent_addr,
+                                  const ws_br_agent_msg_t * const msg)
+{
+  static uint8_t drain_buf[DRAIN_BUF_SIZE];
+  uint8_t *buf = NULL;
+  size_t buf_size = 0U;
+  size_t sent = 0U;
+  ssize_t r = 0;
+  int sockfd = -1;
+
+  buf = ws_br_agent_msg_build_buf(msg, &buf_size);
+  if (buf == NULL) {
+    ws_br_agent_log_error("Failed: Building message\n");
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  sockfd = socket(AF_INET6, SOCK_STREAM, 0);
+  if (sockfd < 0) {
+    ws_br_agent_log_error("Failed: Socket creation\n");
+    ws_br_agent_msg_free_buf(buf);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  if (connect(sockfd, (const struct sockaddr *)agent_addr, sizeof(*agent_addr)) < 0) {
+    ws_br_agent_log_error("Failed: Connection to agent (%s)\n", strerror(errno));
+    close(sockfd);
+    ws_br_agent_msg_free_buf(buf);
+    return WS_BR_AGENT_RET_ERR;
+  }
+
+  while (sent < buf_size) {
+    r = send(sockfd, buf + sent, buf_size - sent, MSG_NOSIGNAL);
+    if (r < 0) {
+      ws_br_agent_log_error("Failed: Sending message (%s)\n", strerror(errno));
+      close(sockfd);
+      ws_br_agent_msg_free_buf(buf);
+      return WS_BR_AGENT_RET_ERR;
+    }
+    sent += (size_t)r;
+  }
+  ws_br_agent_msg_free_buf(buf);
+
+  // Wait for the agent to close the connection, one message per connection
+  shutdown(sockfd, SHUT_WR);
+  do {
+    r = recv(sockfd, drain_buf, sizeof(drain_buf), 0);
+  } while (r > 0 || (r < 0 && errno == EINTR));
+
+  close(sockfd);
+  return WS_BR_AGENT_RET_OK;
+}
+
+static void *cmd_thr_fnc(void *arg)
+{
+  struct pollfd pfd = { .fd = listen_fd, .events = POLLIN };
+  int conn_fd = -1;
+
+  (void) arg;
+
+  while (!emu_stop) {
+    // Poll with timeout to check emu_stop
+    if (poll(&pfd, 1, 100) <= 0 || !(pfd.revents & POLLIN)) {
+      continue;
+    }
+    conn_fd = accept(listen_fd, NULL, NULL);
+    if (conn_fd < 0) {
+      continue;
+    }
+    handle_cmd(conn_fd);
+    close(conn_fd);
+  }
+  return NULL;
+}
+
+static void handle_cmd(int conn_fd)
+{
+  uint8_t buf[WS_BR_AGENT_MSG_SET_PARAM_MSG_MAX_BUF_SIZE];
+  struct pollfd pfd = { .fd = conn_fd, .events = POLLIN };
+  struct linger lin = { .l_onoff = 1, .l_linger = 0 };
+  ws_br_agent_msg_t *msg = NULL;
+  size_t received = 0U;
+  size_t expected = WS_BR_AGENT_MSG_MIN_BUF_SIZE;
+  size_t field_count = 0U;
+  ssize_t r = 0;
+
+  stats.commands++;
+
+  if (cfg.cmd_failure_rate > 0.0 && rand_double(&cmd_rng_state) < cfg.cmd_failure_rate) {
+    // Reset the connection as a crashed SoC application would
+    ws_br_agent_log_warn("Injected command failure\n");
+    stats.injected_failures++;
+    (void) setsockopt(conn_fd, SOL_SOCKET, SO_LINGER, &lin, sizeof(lin));
+    return;
+  }
+
+  if (cfg.cmd_latency_ms) {
+    sleep_us((uint64_t)cfg.cmd_latency_ms * 1000ULL);
+  }
+
+  while (received < expected) {
+    if (poll(&pfd, 1, CMD_RECV_TIMEOUT_MS) <= 0) {
+      break;
+    }
+    r = recv(conn_fd, buf + received, sizeof(buf) - received, 0);
+    if (r <= 0) {
+      break;
+    }
+    received += (size_t)r;
+    if (received >= WS_BR_AGENT_MSG_MIN_BUF_SIZE) {
+      expected = ws_br_agent_msg_frame_size(buf);
+      if (expected > sizeof(buf)) {
+        ws_br_agent_log_error("Command too large (%zu bytes)\n", expected);
+        return;
+      }
+    }
+  }
+
+  if (ws_br_agent_msg_check_crc(buf, received) != WS_BR_AGENT_RET_OK) {
+    ws_br_agent_log_warn("Dropped command with a bad CRC32C trailer\n");
+    return;
+  }
+  msg = ws_br_agent_msg_parse_buf(buf, received);
+  if (msg == NULL) {
+    ws_br_agent_log_warn("Failed to parse command\n");
+    return;
+  }
+
+  ws_br_agent_log_info("Received '%s' command\n",
+                       ws_br_agent_utils_val_to_str(msg->msg_code, ws_br_agent_msg_code_strs,
+                                                    "Unknown"));
+
+  pthread_mutex_lock(&emu_mutex);
+  switch (msg->msg_code) {
+  case WS_BR_AGENT_MSG_CODE_RESTART_BR:
+    br_stopped = false;
+    br_restart = true;
+    break;
+  case WS_BR_AGENT_MSG_CODE_STOP_BR:
+    br_stopped = true;
+    break;
+  case WS_BR_AGENT_MSG_CODE_SET_CONFIG_PARAMS:
+    // TLV settings only carry the changed fields
+    if (ws_br_agent_msg_get_settings_enc(msg) == WS_BR_AGENT_MSG_SETTINGS_ENC_TLV) {
+      if (ws_br_agent_settings_tlv_decode(msg->payload, msg->payload_len, &settings, &field_count)
+          != WS_BR_AGENT_RET_OK) {
+        ws_br_agent_log_warn("Invalid TLV settings\n");
+        break;
+      }
+      ws_br_agent_log_info("Applied %zu TLV settings fields\n", field_count);
+    } else if (msg->payload_len == sizeof(ws_br_agent_settings_t)) {
+      memcpy(&settings, msg->payload, sizeof(ws_br_agent_settings_t));
+    } else {
+      break;
+    }
+    // New settings restart the Border Router
+    br_stopped = false;
+    br_restart = true;
+    break;
+  default:
+    break;
+  }
+  pthread_mutex_unlock(&emu_mutex);
+
+  ws_br_agent_msg_free(msg);
+}
+
+static void sleep_us(uint64_t us)
+{
+  struct timespec ts = {
+    .tv_sec = (time_t)(us / 1000000ULL),
+    .tv_nsec = (long)(us % 1000000ULL) * 1000L
+  };
+
+  // Interrupted by a stop signal, the main loop checks emu_stop
+  (void) nanosleep(&ts, NULL);
+}
+
+static void sig_hnd(int signum)
+{
+  (void) signum;
+  emu_stop = 1;
+}